@@ -76,6 +76,19 @@ const std::map <std::string, AttrDesc> WanIfConfigConnLinkPropertiesAttrs =
     {"downMaxBitrate", {ATTR_TYPE_INT,    false, NULL}}
 };
 
+const std::map <std::string, AttrDesc> WanIfConfigTrafficHistoryAttrs =
+{
+    {"timestamp",           {ATTR_TYPE_INT64, false, NULL}},
+    {"bytesSent",           {ATTR_TYPE_INT64, false, NULL}},
+    {"bytesReceived",       {ATTR_TYPE_INT64, false, NULL}},
+    {"packetsSent",         {ATTR_TYPE_INT64, false, NULL}},
+    {"packetsReceived",     {ATTR_TYPE_INT64, false, NULL}},
+    {"bytesSentRate",       {ATTR_TYPE_INT64, false, NULL}},
+    {"bytesReceivedRate",   {ATTR_TYPE_INT64, false, NULL}},
+    {"packetsSentRate",     {ATTR_TYPE_INT64, false, NULL}},
+    {"packetsReceivedRate", {ATTR_TYPE_INT64, false, NULL}}
+};
+
 const std::map <std::string, AttrDesc> WanIfConfigAttrs =
 {
     {"inetEnabled",        {ATTR_TYPE_BOOL,   true,  NULL}},
@@ -87,7 +100,9 @@ const std::map <std::string, AttrDesc> WanIfConfigAttrs =
     {"packetsSent",        {ATTR_TYPE_INT,    false, NULL}},
     {"packetsReceived",    {ATTR_TYPE_INT,    false, NULL}},
     {"numConnections",     {ATTR_TYPE_INT,    true,  NULL}},
-    {"connectionInfo",     {ATTR_TYPE_VECTOR, false, &WanIfConfigConnInfoAttrs}}
+    {"connectionInfo",     {ATTR_TYPE_VECTOR, false, &WanIfConfigConnInfoAttrs}},
+    {"trafficHistory",     {ATTR_TYPE_VECTOR, false, &WanIfConfigTrafficHistoryAttrs}},
+    {"trafficSamplePeriod",{ATTR_TYPE_INT,    false, NULL}}
 };
 
 // Layer3Forwarding
@@ -219,6 +234,29 @@ const std::map <std::string, AttrDesc> WanIpConnectionStateAttrs =
     {"uptime",      {ATTR_TYPE_INT, false,  NULL}},
 };
 
+const std::map <std::string, AttrDesc> WanIpConnectionPortMappingAttrs =
+{
+    {"remoteHost",     {ATTR_TYPE_STRING, false, NULL}},
+    {"externalPort",   {ATTR_TYPE_INT,    false, NULL}},
+    {"protocol",       {ATTR_TYPE_STRING, false, NULL}},
+    {"internalPort",   {ATTR_TYPE_INT,    false, NULL}},
+    {"internalClient", {ATTR_TYPE_STRING, false, NULL}},
+    {"enabled",        {ATTR_TYPE_BOOL,   false, NULL}},
+    {"description",    {ATTR_TYPE_STRING, false, NULL}},
+    {"leaseDuration",  {ATTR_TYPE_INT,    false, NULL}}
+};
+
+// Results of a port mapping batch
+const std::map <std::string, AttrDesc> WanIpConnectionPortMappingBatchAttrs =
+{
+    {"op",               {ATTR_TYPE_STRING, false, NULL}},
+    {"protocol",         {ATTR_TYPE_STRING, false, NULL}},
+    {"externalPort",     {ATTR_TYPE_INT,    false, NULL}},
+    {"success",          {ATTR_TYPE_BOOL,   false, NULL}},
+    {"errorCode",        {ATTR_TYPE_INT,    false, NULL}},
+    {"errorDescription", {ATTR_TYPE_STRING, false, NULL}}
+};
+
 const std::map <std::string, AttrDesc> WanIpConnectionAttrs =
 {
     {"autoDiscoTime",      {ATTR_TYPE_INT,    false, NULL}},
@@ -229,6 +267,8 @@ const std::map <std::string, AttrDesc> WanIpConnectionAttrs =
     {"nat",                {ATTR_TYPE_VECTOR, false, &WanIpConnectionNatStatusAttrs}},
     {"updateId",           {ATTR_TYPE_INT,    true,  NULL}},
     {"sizePortMap",        {ATTR_TYPE_INT,    true,  NULL}},
+    {"portMappings",       {ATTR_TYPE_VECTOR, false, &WanIpConnectionPortMappingAttrs}},
+    {"portMappingBatch",   {ATTR_TYPE_VECTOR, false, &WanIpConnectionPortMappingBatchAttrs}},
     {"connectionState",    {ATTR_TYPE_VECTOR, true,  &WanIpConnectionStateAttrs}},
 };
 
@@ -246,6 +286,8 @@ const std::map <std::string, AttrDesc> WanPppConnectionAttrs =
     {"warnDiscoTime",      {ATTR_TYPE_INT,    false, NULL}},
     {"externAddr",         {ATTR_TYPE_STRING, true,  NULL}},
     {"sizePortMap",        {ATTR_TYPE_INT,    true,  NULL}},
+    {"portMappings",       {ATTR_TYPE_VECTOR, false, &WanIpConnectionPortMappingAttrs}},
+    {"portMappingBatch",   {ATTR_TYPE_VECTOR, false, &WanIpConnectionPortMappingBatchAttrs}},
     {"user",               {ATTR_TYPE_STRING, false, NULL}},
     {"pwd",                {ATTR_TYPE_STRING, false, NULL}},
     {"maxBitRate",         {ATTR_TYPE_VECTOR, false, &WanPppConnectionMaxBitRateAttrs}},
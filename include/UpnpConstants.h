@@ -57,6 +57,11 @@ static const std::string UPNP_OIC_TYPE_WAN_POTS_LINK_CONFIG       = "oic.r.wan.p
 static const std::string UPNP_OIC_TYPE_WAN_IP_CONNECTION          = "oic.r.wan.ip";
 static const std::string UPNP_OIC_TYPE_WAN_PPP_CONNECTION         = "oic.r.wan.ppp";
 static const std::string UPNP_OIC_TYPE_LAN_HOST_CONFIG            = "oic.r.lan.config";
+// Bridge hosted resources
+static const std::string UPNP_OIC_TYPE_GROUP                      = "oic.r.upnp.group";
+static const std::string UPNP_OIC_TYPE_AV_GROUP                   = "oic.r.upnp.av.group";
+// Bundle configuration of the devices and services to bridge (not a resource)
+static const std::string UPNP_OIC_TYPE_FILTER                     = "oic.r.upnp.filter";
 
 // URI prefix (URI = URI_PREFIX + UDN)
 static const std::string UPNP_OIC_URI_PREFIX_LIGHT                  = "/upnp/light/";
@@ -85,7 +90,15 @@ static const std::string UPNP_OIC_URI_PREFIX_AV_TRANSPORT           = "/upnp/av-
 static const std::string UPNP_OIC_URI_PREFIX_CONTENT_DIRECTORY      = "/upnp/content-directory/";
 static const std::string UPNP_OIC_URI_PREFIX_RENDERING_CONTROL      = "/upnp/rendering-control/";
 static const std::string UPNP_OIC_URI_PREFIX_SCHEDULED_RECORDING    = "/upnp/scheduled-recording/";
+static const std::string UPNP_OIC_URI_PREFIX_GROUP                  = "/upnp/group/";
+static const std::string UPNP_OIC_URI_PREFIX_AV_GROUP               = "/upnp/av-group/";
 
+// Any resource: time (ms) the request may take before it fails
+static const std::string UPNP_OIC_QUERY_PARAM_TIMEOUT = "to";
+// Any resource: "etag" attribute (an opaque string) of the last response
+// the client got. If the attributes have not changed since, only "etag" and
+// "valid" are sent.
+static const std::string UPNP_OIC_QUERY_PARAM_ETAG = "etag";
 // AV transport service, and Rendering control service query params
 static const std::string UPNP_OIC_QUERY_PARAM_INSTANCE_ID = "iid";
 static const std::string UPNP_OIC_QUERY_PARAM_CHANNEL = "c";
@@ -107,5 +120,10 @@ static const std::string UPNP_OIC_SEARCH_QUERY_PARAM_SORT_CRITERIA = "ssc";
 // Device Protection service query params
 static const std::string UPNP_OIC_QUERY_PARAM_MESSAGE = "m";
 static const std::string UPNP_OIC_QUERY_PARAM_PROTOCOL = "p";
+// WAN IP and PPP connection service query params (port mapping filters)
+static const std::string UPNP_OIC_QUERY_PARAM_PM_PROTOCOL = "pmp";
+static const std::string UPNP_OIC_QUERY_PARAM_PM_EXTERNAL_PORT = "pmep";
+static const std::string UPNP_OIC_QUERY_PARAM_PM_INTERNAL_CLIENT = "pmic";
+static const std::string UPNP_OIC_QUERY_PARAM_PM_REMOTE_HOST = "pmrh";
 
 #endif
@@ -0,0 +1,144 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#ifndef UPNP_ACTION_STATS_H_
+#define UPNP_ACTION_STATS_H_
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <gupnp.h>
+
+#include "UpnpLatencyHistogram.h"
+
+using namespace std;
+
+// Latency and outcome statistics per (device, service, action).
+//
+// The static wrappers replace the gupnp_service_proxy_*_action() calls and
+// record every action: latency into the histogram, outcome into the
+// success/SOAP fault/timeout counters. Transport failures (no response,
+// connection or HTTP errors) count as timeouts.
+//
+// Recording takes no global lock and allocates nothing in steady state: the
+// statistics of the service actions are resolved once per proxy (see
+// attach), and the actions in progress are kept with the proxy. Actions are
+// begun on the OCF threads and completed on the main loop thread, so the
+// proxy's entries are guarded by a lock of its own (uncontended but for the
+// proxy's own requests).
+class UpnpActionStats
+{
+    public:
+        typedef struct _Summary
+        {
+            string udn;
+            string serviceType;
+            string action;
+            uint64_t success;
+            uint64_t soapFaults;
+            uint64_t timeouts;
+            UpnpLatencyHistogram::Snapshot latency;
+        } Summary;
+
+        static GUPnPServiceProxyAction *beginAction(GUPnPServiceProxy *proxy,
+                                                    const char *action,
+                                                    GUPnPServiceProxyActionCallback callback,
+                                                    gpointer userData,
+                                                    ...);
+
+        static gboolean endAction(GUPnPServiceProxy *proxy,
+                                  GUPnPServiceProxyAction *action,
+                                  GError **error,
+                                  ...);
+
+        static gboolean sendAction(GUPnPServiceProxy *proxy,
+                                   const char *action,
+                                   GError **error,
+                                   ...);
+
+        // Does nothing if the action has completed already
+        static void cancelAction(GUPnPServiceProxy *proxy,
+                                 GUPnPServiceProxyAction *action);
+
+        // Resolves the statistics of the actions of the service, before the
+        // first request. Actions not listed are resolved on first use.
+        static void attach(GUPnPServiceProxy *proxy, GUPnPServiceIntrospection *introspection);
+
+        // Records an action invoked by other means (e.g. *_action_list()),
+        // startTime is g_get_monotonic_time() when the action was issued.
+        static void record(GUPnPServiceProxy *proxy,
+                           const char *action,
+                           gint64 startTime,
+                           const GError *error);
+
+        static vector<Summary> getSummaries();
+
+        // One line per action: counters and latency percentiles (ms)
+        static void dump(ostream &os);
+
+    private:
+        string m_udn;
+        string m_serviceType;
+        string m_action;
+        UpnpLatencyHistogram m_latency;
+        atomic<uint64_t> m_success;
+        atomic<uint64_t> m_soapFaults;
+        atomic<uint64_t> m_timeouts;
+
+        // Registry lock protects the map only, taken when an action is
+        // first resolved for a proxy and by getSummaries()
+        static mutex s_lock;
+        static map<string, UpnpActionStats *> s_stats;
+
+        typedef struct _PendingAction
+        {
+            GUPnPServiceProxyAction *action;
+            UpnpActionStats *stats;
+            gint64 startTime;
+        } PendingAction;
+
+        // Kept with the proxy (qdata)
+        typedef struct _ProxyStats
+        {
+            mutex lock;
+            // Sorted by action name (the name is owned by the statistics)
+            vector< pair<const char *, UpnpActionStats *> > actions;
+            // Actions in progress, the capacity is kept
+            vector< PendingAction > pending;
+        } ProxyStats;
+
+        UpnpActionStats(const string &udn, const string &serviceType, const string &action);
+
+        static UpnpActionStats *find(GUPnPServiceProxy *proxy, const char *action);
+        static ProxyStats *getProxyStats(GUPnPServiceProxy *proxy);
+        // With the proxy's lock held
+        static UpnpActionStats *lookup(ProxyStats *proxyStats, GUPnPServiceProxy *proxy,
+                                       const char *action);
+        static bool takePending(ProxyStats *proxyStats, GUPnPServiceProxyAction *action,
+                                PendingAction *pending);
+        static void deleteProxyStats(gpointer data);
+        void record(gint64 latency, const GError *error);
+};
+
+#endif
@@ -16,6 +16,7 @@
 //-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
 
 #include "UpnpAttribute.h"
+#include "UpnpActionStats.h"
 
 using namespace std;
 
@@ -36,13 +37,13 @@ void UpnpAttribute::getCb(GUPnPServiceProxy *proxy,
 
     attrInfo = it->second;
     DEBUG_PRINT(attrInfo->actions[0].varName);
-    bool status = gupnp_service_proxy_end_action (proxy,
-                                                  actionProxy,
-                                                  &error,
-                                                  attrInfo->actions[0].varName,
-                                                  attrInfo->actions[0].varType,
-                                                  &value.var_int64,
-                                                  NULL);
+    bool status = UpnpActionStats::endAction (proxy,
+                                              actionProxy,
+                                              &error,
+                                              attrInfo->actions[0].varName,
+                                              attrInfo->actions[0].varType,
+                                              &value.var_int64,
+                                              NULL);
 
     if (error)
     {
@@ -112,11 +113,11 @@ bool UpnpAttribute::get(GUPnPServiceProxy *serviceProxy,
                         UpnpAttributeInfo *attrInfo)
 {
     DEBUG_PRINT("");
-    GUPnPServiceProxyAction *actionProxy = gupnp_service_proxy_begin_action (serviceProxy,
-                                                                             attrInfo->actions[0].name,
-                                                                             getCb,
-                                                                             (gpointer *) request,
-                                                                             NULL);
+    GUPnPServiceProxyAction *actionProxy = UpnpActionStats::beginAction (serviceProxy,
+                                                                         attrInfo->actions[0].name,
+                                                                         getCb,
+                                                                         (gpointer *) request,
+                                                                         NULL);
     if (NULL == actionProxy)
     {
         return false;
@@ -135,10 +136,10 @@ void UpnpAttribute::setCb(GUPnPServiceProxy *proxy,
     GError *error = NULL;
     UpnpRequest *request = static_cast<UpnpRequest *> (userData);
 
-    bool status = gupnp_service_proxy_end_action (proxy,
-                                                  proxyAction,
-                                                  &error,
-                                                  NULL);
+    bool status = UpnpActionStats::endAction (proxy,
+                                              proxyAction,
+                                              &error,
+                                              NULL);
     if (error)
     {
         ERROR_PRINT("Set action failed: " << error->code << ", " << error->message);
@@ -19,6 +19,7 @@
 //-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
 
 #include "UpnpAvTransportService.h"
+#include "UpnpActionStats.h"
 
 static const string MODULE = "UpnpAvTransportService";
 
@@ -75,10 +76,35 @@ static const char *unitRelTime = "REL_TIME";
 
 static const int defaultInstanceID = 0;
 
+static const char *lastChangeVarName = "LastChange";
+
+// LastChange variables (default instance) -> OCF properties
+static const map <string, string> s_lastChangeProperties =
+{
+    {"TransportState",          playStatePropertyName},
+    {"TransportPlaySpeed",      mediaSpeedPropertyName},
+    {"AVTransportURI",          mediaLocationPropertyName},
+    {"CurrentTransportActions", actionsPropertyName}
+};
+
 vector <UpnpAttributeInfo> UpnpAvTransport::Attributes =
 {
 };
 
+map <string, GType> UpnpAvTransport::getEventedVariables()
+{
+    return {{lastChangeVarName, G_TYPE_STRING}};
+}
+
+bool UpnpAvTransport::processNotification(const string &variable, GValue *value)
+{
+    if (variable != lastChangeVarName)
+    {
+        return false;
+    }
+    return processLastChange(value, s_lastChangeProperties);
+}
+
 OCEntityHandlerResult UpnpAvTransport::processGetRequest(string uri, OCRepPayload *payload, string resourceType)
 {
     if (payload == NULL)
@@ -110,7 +136,7 @@ OCEntityHandlerResult UpnpAvTransport::processGetRequest(string uri, OCRepPayloa
     GError *error = NULL;
 
     // get playState, mediaSpeed (from Upnp TransportInfo)
-    if (! gupnp_service_proxy_send_action(m_proxy, getTransportInfoAction, &error,
+    if (! UpnpActionStats::sendAction(m_proxy, getTransportInfoAction, &error,
         // IN args
         instanceIdParamName, G_TYPE_UINT, defaultInstanceID,
         NULL,
@@ -160,7 +186,7 @@ OCEntityHandlerResult UpnpAvTransport::processGetRequest(string uri, OCRepPayloa
     DEBUG_PRINT(mediaSpeedPropertyName << ": " << mediaSpeedValue);
 
     // get mediaLocation (from Upnp PositionInfo)
-    if (! gupnp_service_proxy_send_action(m_proxy, getPositionInfoAction, &error,
+    if (! UpnpActionStats::sendAction(m_proxy, getPositionInfoAction, &error,
         // IN args
         instanceIdParamName, G_TYPE_UINT, defaultInstanceID,
         NULL,
@@ -191,7 +217,7 @@ OCEntityHandlerResult UpnpAvTransport::processGetRequest(string uri, OCRepPayloa
     DEBUG_PRINT(mediaLocationPropertyName << ": " << mediaLocationValue);
 
     // get actions (from Upnp CurrentTransportActions)
-    if (! gupnp_service_proxy_send_action(m_proxy, getCurrentTransportActionsAction, &error,
+    if (! UpnpActionStats::sendAction(m_proxy, getCurrentTransportActionsAction, &error,
         // IN args
         instanceIdParamName, G_TYPE_UINT, defaultInstanceID,
         NULL,
@@ -497,7 +523,7 @@ OCEntityHandlerResult UpnpAvTransport::processPutRequest(OCEntityHandlerRequest
             GError *error = NULL;
             if (doUpnpStop)
             {
-                if (! gupnp_service_proxy_send_action(m_proxy, upnpStopAction, &error,
+                if (! UpnpActionStats::sendAction(m_proxy, upnpStopAction, &error,
                     // IN args
                     instanceIdParamName, G_TYPE_UINT, defaultInstanceID,
                     NULL,
@@ -514,7 +540,7 @@ OCEntityHandlerResult UpnpAvTransport::processPutRequest(OCEntityHandlerRequest
             }
             else if (doUpnpPause)
             {
-                if (! gupnp_service_proxy_send_action(m_proxy, upnpPauseAction, &error,
+                if (! UpnpActionStats::sendAction(m_proxy, upnpPauseAction, &error,
                     // IN args
                     instanceIdParamName, G_TYPE_UINT, defaultInstanceID,
                     NULL,
@@ -531,7 +557,7 @@ OCEntityHandlerResult UpnpAvTransport::processPutRequest(OCEntityHandlerRequest
             }
             else if (doUpnpPlay)
             {
-                if (! gupnp_service_proxy_send_action(m_proxy, upnpPlayAction, &error,
+                if (! UpnpActionStats::sendAction(m_proxy, upnpPlayAction, &error,
                     // IN args
                     instanceIdParamName, G_TYPE_UINT, defaultInstanceID,
                     speedParamName, G_TYPE_STRING, upnpPlaySpeed,
@@ -549,7 +575,7 @@ OCEntityHandlerResult UpnpAvTransport::processPutRequest(OCEntityHandlerRequest
             }
             else if (doUpnpSeek)
             {
-                if (! gupnp_service_proxy_send_action(m_proxy, upnpSeekAction, &error,
+                if (! UpnpActionStats::sendAction(m_proxy, upnpSeekAction, &error,
                     // IN args
                     instanceIdParamName, G_TYPE_UINT, defaultInstanceID,
                     unitParamName, G_TYPE_STRING, unitAbsTime,
@@ -559,7 +585,7 @@ OCEntityHandlerResult UpnpAvTransport::processPutRequest(OCEntityHandlerRequest
                     NULL))
                 {
                     // absolute time failed, try again as relative time
-                    if (! gupnp_service_proxy_send_action(m_proxy, upnpSeekAction, &error,
+                    if (! UpnpActionStats::sendAction(m_proxy, upnpSeekAction, &error,
                         // IN args
                         instanceIdParamName, G_TYPE_UINT, defaultInstanceID,
                         unitParamName, G_TYPE_STRING, unitRelTime,
@@ -47,6 +47,11 @@ class UpnpAvTransport: public UpnpService
         OCEntityHandlerResult processPutRequest(OCEntityHandlerRequest *ehRequest,
                     string uri, string resourceType, OCRepPayload *payload);
 
+    protected:
+        // Evented through LastChange
+        map <string, GType> getEventedVariables();
+        bool processNotification(const string &variable, GValue *value);
+
     private:
         static vector <UpnpAttributeInfo> Attributes;
 };
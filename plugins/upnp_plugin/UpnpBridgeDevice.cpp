@@ -29,6 +29,7 @@
 
 #include <ConcurrentIotivityUtils.h>
 
+#include "UpnpActionStats.h"
 #include "UpnpBridgeDevice.h"
 #include "UpnpException.h"
 #include "UpnpInternal.h"
@@ -40,12 +41,16 @@ static const string MODULE = "UpnpBridgeDevice";
 
 static const string BRIDGE_RESOURCE_TYPE = "oic.d.bridge";
 static const string SECUREMODE_RESOURCE_TYPE = "oic.r.securemode";
+static const string DIAGNOSTICS_RESOURCE_TYPE = "oic.r.upnp.diagnostics";
 
 const uint SECUREMODE_CALLBACK = 0;
 const uint COLLECTION_CALLBACK = 1;
+const uint DIAGNOSTICS_CALLBACK = 2;
 
 static const string SECUREMODE_PROPERTY_KEY = "secureMode";
 static const string SECUREMODE_RESOURCE_URI = "/securemode";
+static const string DIAGNOSTICS_RESOURCE_URI = "/upnp-diagnostics";
+static const string DIAGNOSTICS_ACTIONS_KEY = "actions";
 static const string BRIDGE_RESOURCE_URI_PREFIX = "/upnp-bridge/";
 
 static string s_bridgeUri = BRIDGE_RESOURCE_URI_PREFIX + "0";
@@ -132,6 +137,13 @@ UpnpBridgeDevice::UpnpBridgeDevice()
         DEBUG_PRINT("CreateResource() = " << result);
     }
 
+    result = createResource(DIAGNOSTICS_RESOURCE_URI, DIAGNOSTICS_RESOURCE_TYPE.c_str(),
+            OC_RSRVD_INTERFACE_READ, entityHandler, (void *) DIAGNOSTICS_CALLBACK, resourceProperties);
+    if (result != OC_STACK_OK)
+    {
+        DEBUG_PRINT("CreateResource() = " << result);
+    }
+
     result = createResource(s_bridgeUri, BRIDGE_RESOURCE_TYPE.c_str(),
             OC_RSRVD_INTERFACE_READ, entityHandler, (void *) COLLECTION_CALLBACK, resourceProperties);
     if (result == OC_STACK_OK)
@@ -205,6 +217,10 @@ OCEntityHandlerResult UpnpBridgeDevice::entityHandler(OCEntityHandlerFlag flag,
     {
         resourceType = OC_RSRVD_RESOURCE_TYPE_COLLECTION;
     }
+    else if (callbackParamResourceType == DIAGNOSTICS_CALLBACK)
+    {
+        resourceType = DIAGNOSTICS_RESOURCE_TYPE;
+    }
 
     if (! resourceType.empty()) {
         return handleEntityHandlerRequests(flag, entityHandlerRequest, resourceType);
@@ -311,6 +327,33 @@ OCEntityHandlerResult UpnpBridgeDevice::processGetRequest(string uri, string res
         }
         OCRepPayloadSetPropObjectArray(payload, OC_RSRVD_LINKS, links, dimensions);
     }
+    else if (DIAGNOSTICS_RESOURCE_TYPE == resType)
+    {
+        vector<UpnpActionStats::Summary> summaries = UpnpActionStats::getSummaries();
+        const OCRepPayload *actions[summaries.size()];
+        size_t dimensions[MAX_REP_ARRAY_DEPTH] = {summaries.size(), 0, 0};
+        int actionsIndex = 0;
+        for (const auto& summary : summaries) {
+            // Latencies in microseconds
+            OCRepPayload *actionPayload = OCRepPayloadCreate();
+            OCRepPayloadSetPropString(actionPayload, "udn", summary.udn.c_str());
+            OCRepPayloadSetPropString(actionPayload, "serviceType", summary.serviceType.c_str());
+            OCRepPayloadSetPropString(actionPayload, "action", summary.action.c_str());
+            OCRepPayloadSetPropInt(actionPayload, "count", summary.latency.count);
+            OCRepPayloadSetPropInt(actionPayload, "success", summary.success);
+            OCRepPayloadSetPropInt(actionPayload, "soapFaults", summary.soapFaults);
+            OCRepPayloadSetPropInt(actionPayload, "timeouts", summary.timeouts);
+            OCRepPayloadSetPropInt(actionPayload, "mean", (int64_t) summary.latency.getMean());
+            OCRepPayloadSetPropInt(actionPayload, "p50", summary.latency.getPercentile(50));
+            OCRepPayloadSetPropInt(actionPayload, "p90", summary.latency.getPercentile(90));
+            OCRepPayloadSetPropInt(actionPayload, "p99", summary.latency.getPercentile(99));
+            OCRepPayloadSetPropInt(actionPayload, "max", summary.latency.max);
+            actions[actionsIndex] = actionPayload;
+            ++actionsIndex;
+        }
+        OCRepPayloadSetPropObjectArray(payload, DIAGNOSTICS_ACTIONS_KEY.c_str(), actions, dimensions);
+        DEBUG_PRINT(uri << " -- " << DIAGNOSTICS_ACTIONS_KEY << ": " << summaries.size());
+    }
     else
     {
         throw "Failed due to unknown resource type";
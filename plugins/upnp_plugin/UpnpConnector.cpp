@@ -19,7 +19,9 @@
 //-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
 
 #include <string.h>
+#include <stdlib.h>
 #include <iostream>
+#include <sstream>
 #include <future>
 #include <glib.h>
 #include <glib-object.h>
@@ -30,10 +32,12 @@
 
 #include <UpnpConstants.h>
 
+#include "UpnpActionStats.h"
 #include "UpnpConnector.h"
 #include "UpnpException.h"
 #include "UpnpInternal.h"
 #include "UpnpRequest.h"
+#include "UpnpSubscriptionManager.h"
 
 #include <octypes.h>
 #include <ocstack.h>
@@ -58,10 +62,16 @@ static GMainContext *s_mainContext;
 static GUPnPContextManager *s_contextManager;
 static UpnpManager *s_manager;
 static UpnpRequestState s_requestState;
+static UpnpSubscriptionManager *s_subscriptions;
 static map <gulong, GUPnPControlPoint *> s_signalMap;
 
 static bool isRootDiscovery[] = {false, true};
 
+// Period (seconds) of the action statistics dump, overridden by
+// UPNP_STATS_DUMP_INTERVAL (0 disables the dump)
+static const guint ACTION_STATS_DUMP_INTERVAL = 60;
+static GSource *s_statsDumpSource;
+
 const uint LIGHT_CALLBACK = 0;
 const uint BINARY_SWITCH_CALLBACK = 1;
 const uint BRIGHTNESS_CALLBACK = 2;
@@ -141,11 +151,21 @@ void UpnpConnector::gupnpStop()
     g_source_destroy(s_requestState.source);
     s_requestState.sourceId = 0;
 
+    if (s_statsDumpSource != NULL)
+    {
+        g_source_destroy(s_statsDumpSource);
+        g_source_unref(s_statsDumpSource);
+        s_statsDumpSource = NULL;
+    }
+
     for (auto it : s_signalMap)
     {
         g_signal_handler_disconnect (it.second, it.first);
     }
 
+    delete s_subscriptions;
+    s_subscriptions = NULL;
+
     g_object_unref(s_contextManager);
     g_main_loop_quit(s_mainLoop);
     g_main_loop_unref(s_mainLoop);
@@ -207,10 +227,47 @@ void UpnpConnector::gupnpStart()
     DEBUG_PRINT("main context" << s_mainContext);
 
     s_requestState.context = s_mainContext;
+    s_subscriptions = new UpnpSubscriptionManager(s_mainContext);
     initResourceCallbackHandler();
+    initActionStatsDump();
     g_main_loop_run(s_mainLoop);
 }
 
+void UpnpConnector::initActionStatsDump()
+{
+    guint interval = ACTION_STATS_DUMP_INTERVAL;
+    const char *env = getenv("UPNP_STATS_DUMP_INTERVAL");
+
+    if (env != NULL)
+    {
+        interval = (guint) strtoul(env, NULL, 10);
+    }
+
+    if (interval == 0)
+    {
+        DEBUG_PRINT("Action statistics dump disabled");
+        return;
+    }
+
+    s_statsDumpSource = g_timeout_source_new_seconds(interval);
+    g_source_set_callback(s_statsDumpSource, dumpActionStats, NULL, NULL);
+    g_source_attach(s_statsDumpSource, s_mainContext);
+}
+
+int UpnpConnector::dumpActionStats(gpointer data)
+{
+    (void) data;
+    std::stringstream stats;
+    string line;
+
+    UpnpActionStats::dump(stats);
+    while (std::getline(stats, line))
+    {
+        INFO_PRINT(line);
+    }
+    return G_SOURCE_CONTINUE;
+}
+
 int UpnpConnector::checkRequestQueue(gpointer data)
 {
     (void) data;
@@ -371,12 +428,8 @@ void UpnpConnector::onDeviceProxyAvailable(GUPnPControlPoint *controlPoint,
                     s_discoveryCallback(pUpnpResourceService);
                     pUpnpResourceService->setRegistered(true);
 
-                    // Subscribe to notifications
-                    // Important!!! UpnpService object associated with this info/proxy
-                    // must stay valid until we unsubscribe from notificatons. This
-                    // means we have to keep a reference to the object inside the
-                    // UpnpManager as long as we are subscribed to notifications.
-                    gupnp_service_proxy_set_subscribed(GUPNP_SERVICE_PROXY(serviceInfo), true);
+                    // Notifications are subscribed to while the resource is observed
+                    // (see updateObservers)
                 }
             }
             g_object_unref (childService->data);
@@ -417,6 +470,11 @@ void UpnpConnector::onIntrospectionAvailable(GUPnPServiceInfo          *info,
         return;
     }
 
+    if (introspection != NULL)
+    {
+        UpnpActionStats::attach(GUPNP_SERVICE_PROXY (info), introspection);
+    }
+
     UpnpResource::Ptr pUpnpResourceService = nullptr;
     pUpnpResourceService = s_manager->processService(GUPNP_SERVICE_PROXY (info), info, introspection, &s_requestState);
 
@@ -440,12 +498,8 @@ void UpnpConnector::onIntrospectionAvailable(GUPnPServiceInfo          *info,
         s_discoveryCallback(pUpnpResourceService);
         pUpnpResourceService->setRegistered(true);
 
-        // Subscribe to notifications
-        // Important!!! UpnpService object associated with this info/proxy
-        // must stay valid until we unsubscribe from notificatons. This
-        // means we have to keep a reference to the object inside the
-        // UpnpManager as long as we are subscribed to notifications.
-        gupnp_service_proxy_set_subscribed(GUPNP_SERVICE_PROXY(info), true);
+        // Notifications are subscribed to while the resource is observed
+        // (see updateObservers)
     }
 }
 
@@ -472,7 +526,7 @@ void UpnpConnector::unregisterDeviceResource(string udn)
             // Unsubscribe from notifications
             if (pService->getProxy() != nullptr)
             {
-                gupnp_service_proxy_set_subscribed(pService->getProxy(), false);
+                s_subscriptions->remove(pService->getProxy());
             }
 
             if (pService->isRegistered())
@@ -523,7 +577,7 @@ void UpnpConnector::onServiceProxyUnavailable(GUPnPControlPoint *controlPoint,
     if (pUpnpResourceService != nullptr)
     {
         // Unsubscribe from notifications
-        gupnp_service_proxy_set_subscribed(proxy, false);
+        s_subscriptions->remove(std::static_pointer_cast<UpnpService>(pUpnpResourceService)->getProxy());
 
         if (pUpnpResourceService->isRegistered())
         {
@@ -628,6 +682,10 @@ OCEntityHandlerResult handleEntityHandlerRequests( OCEntityHandlerRequest *entit
             MPMExtractFiltersFromQuery(dupQuery, &interfaceQuery, &resourceTypeQuery);
         }
 
+        // Complete before the request is processed: a PUT answered later
+        // (OC_EH_SLOW) sends a copy of it
+        responsePayload = getCommonPayload(uri.c_str(), interfaceQuery, resourceType, payload);
+
         for (const auto& service : s_manager->m_services)
         {
             // service entity handler does all service related resources
@@ -644,6 +702,8 @@ OCEntityHandlerResult handleEntityHandlerRequests( OCEntityHandlerRequest *entit
                     case OC_REST_PUT:
                     case OC_REST_POST:
                         DEBUG_PRINT("PUT / POST Request on " << uri);
+                        // OC_EH_SLOW: the service responds (and notifies the
+                        // observers) once the device has answered
                         ehResult = service.second->processPutRequest(entityHandlerRequest, uri, resourceType, payload);
                         notifyObservers = (ehResult == OC_EH_OK);
                         break;
@@ -679,8 +739,10 @@ OCEntityHandlerResult handleEntityHandlerRequests( OCEntityHandlerRequest *entit
             }
         }
 
-        responsePayload = getCommonPayload(uri.c_str(), interfaceQuery, resourceType, payload);
-        ConcurrentIotivityUtils::respondToRequest(entityHandlerRequest, responsePayload, ehResult);
+        if (ehResult != OC_EH_SLOW)
+        {
+            ConcurrentIotivityUtils::respondToRequest(entityHandlerRequest, responsePayload, ehResult);
+        }
         OICFree(dupQuery);
 
         if (notifyObservers)
@@ -699,7 +761,56 @@ OCEntityHandlerResult handleEntityHandlerRequests( OCEntityHandlerRequest *entit
     return ehResult;
 }
 
-OCEntityHandlerResult resourceEntityHandler(OCEntityHandlerFlag,
+typedef struct _ObserverChange
+{
+    std::string uri;
+    bool registered;
+} ObserverChange;
+
+// Runs on the gupnp thread: the observers of a service resource, or of
+// any of its action/state variable resources, drive its GENA subscription
+static gboolean updateSubscription(gpointer userData)
+{
+    ObserverChange *change = static_cast<ObserverChange *> (userData);
+
+    for (const auto& service : s_manager->m_services)
+    {
+        if (change->uri.find(service.second->m_uri) == 0 && service.second->getProxy() != nullptr)
+        {
+            if (change->registered)
+            {
+                s_subscriptions->addObserver(service.second->getProxy());
+            }
+            else
+            {
+                s_subscriptions->removeObserver(service.second->getProxy());
+            }
+            break;
+        }
+    }
+
+    delete change;
+    return G_SOURCE_REMOVE;
+}
+
+static void updateObservers(OCEntityHandlerRequest *entityHandlerRequest)
+{
+    OCObserveAction action = entityHandlerRequest->obsInfo.action;
+
+    if ((action != OC_OBSERVE_REGISTER && action != OC_OBSERVE_DEREGISTER) || s_mainContext == NULL)
+    {
+        return;
+    }
+
+    ObserverChange *change = new ObserverChange();
+    change->uri = OCGetResourceUri(entityHandlerRequest->resource);
+    change->registered = (action == OC_OBSERVE_REGISTER);
+    DEBUG_PRINT((change->registered ? "Observer registered on " : "Observer deregistered from ") << change->uri);
+
+    g_main_context_invoke(s_mainContext, updateSubscription, change);
+}
+
+OCEntityHandlerResult resourceEntityHandler(OCEntityHandlerFlag flag,
         OCEntityHandlerRequest *entityHandlerRequest,
         void *callback)
 {
@@ -707,6 +818,11 @@ OCEntityHandlerResult resourceEntityHandler(OCEntityHandlerFlag,
     uintptr_t callbackParamResourceType = (uintptr_t)callback;
     std::string resourceType;
 
+    if ((flag & OC_OBSERVE_FLAG) && entityHandlerRequest != NULL)
+    {
+        updateObservers(entityHandlerRequest);
+    }
+
     if (callbackParamResourceType == LIGHT_CALLBACK)
     {
         return handleEntityHandlerRequests(entityHandlerRequest, UPNP_OIC_TYPE_DEVICE_LIGHT);
@@ -67,6 +67,7 @@ class UpnpConnector
         static void onServiceProxyAvailable(GUPnPControlPoint *cp, GUPnPServiceProxy *proxy);
         static void onServiceProxyUnavailable(GUPnPControlPoint *cp, GUPnPServiceProxy *proxy);
         static int checkRequestQueue(gpointer data);
+        static int dumpActionStats(gpointer data);
 
         static void onIntrospectionAvailable(GUPnPServiceInfo  *serviceInfo,
                                              GUPnPServiceIntrospection *introspection,
@@ -74,6 +75,7 @@ class UpnpConnector
                                              gpointer                   userContext);
         static void unregisterDeviceResource(string udn);
         static void initResourceCallbackHandler();
+        static void initActionStatsDump();
 
         OCStackResult createResource(const string uri, const string resourceTypeName,
                 const char *resourceInterfaceName, OCEntityHandler resourceEntityHandler,
@@ -19,6 +19,7 @@
 //-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
 
 #include "UpnpDimmingService.h"
+#include "UpnpActionStats.h"
 
 static const string MODULE = "UpnpDimmingService";
 
@@ -77,7 +78,7 @@ OCEntityHandlerResult UpnpDimming::processGetRequest(string uri, OCRepPayload *p
     //TODO use async version with callback
     int64_t brightnessLevelValue = 0;
     GError *error = NULL;
-    if (! gupnp_service_proxy_send_action(m_proxy, "GetLoadLevelStatus", &error,
+    if (! UpnpActionStats::sendAction(m_proxy, "GetLoadLevelStatus", &error,
             // IN args (none)
             NULL,
             // OUT args
@@ -105,7 +106,6 @@ OCEntityHandlerResult UpnpDimming::processGetRequest(string uri, OCRepPayload *p
 OCEntityHandlerResult UpnpDimming::processPutRequest(OCEntityHandlerRequest *ehRequest,
         string uri, string resourceType, OCRepPayload *payload)
 {
-    (void) uri;
     if (!ehRequest || !ehRequest->payload ||
             ehRequest->payload->type != PAYLOAD_TYPE_REPRESENTATION)
     {
@@ -127,34 +127,30 @@ OCEntityHandlerResult UpnpDimming::processPutRequest(OCEntityHandlerRequest *ehR
         }
         DEBUG_PRINT("New " << brightnessLevelName << ": " << brightnessLevelValue);
 
-        //TODO use async version with callback
-        GError *error = NULL;
-        if (! gupnp_service_proxy_send_action(m_proxy, "SetLoadLevelTarget", &error,
-                // IN args
-                "newLoadlevelTarget", G_TYPE_UINT, brightnessLevelValue,
-                NULL,
-                // OUT args (none)
-                NULL))
-        {
-            ERROR_PRINT("SetLoadLevelTarget action failed");
-            if (error)
-            {
-                DEBUG_PRINT("Error message: " << error->message);
-                g_error_free(error);
-            }
-            return OC_EH_ERROR;
-        }
-
         if (!OCRepPayloadSetPropInt(payload, brightnessLevelName, brightnessLevelValue))
         {
             throw "Failed to set brightness value in payload";
         }
         DEBUG_PRINT(brightnessLevelName << ": " << brightnessLevelValue);
+
+        // Answered once the action carrying the level (or a newer one) is
+        // done, only the latest level is sent
+        UpnpSetResponse::Ptr response = std::make_shared< UpnpSetResponse >(ehRequest, uri);
+        guint upnpBrightnessLevelValue = brightnessLevelValue;
+        m_loadLevelTarget.write(m_proxy, [upnpBrightnessLevelValue](GUPnPServiceProxy *proxy,
+                GUPnPServiceProxyActionCallback callback, gpointer userData)
+        {
+            return UpnpActionStats::beginAction(proxy, "SetLoadLevelTarget", callback, userData,
+                    // IN args
+                    "newLoadlevelTarget", G_TYPE_UINT, upnpBrightnessLevelValue,
+                    NULL);
+        }, UpnpSetResponse::done(response));
+        response->setPayload(payload);
     }
     else
     {
         throw "Failed due to unknown resource type";
     }
 
-    return OC_EH_OK;
+    return OC_EH_SLOW;
 }
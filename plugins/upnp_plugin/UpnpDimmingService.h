@@ -29,6 +29,7 @@
 #include "UpnpResource.h"
 #include "UpnpInternal.h"
 #include "UpnpService.h"
+#include "UpnpSetCoalescer.h"
 
 using namespace std;
 
@@ -39,7 +40,8 @@ class UpnpDimming: public UpnpService
     public:
         UpnpDimming(GUPnPServiceInfo *serviceInfo,
                     UpnpRequestState *requestState):
-            UpnpService(serviceInfo, UPNP_OIC_TYPE_BRIGHTNESS, requestState, &Attributes)
+            UpnpService(serviceInfo, UPNP_OIC_TYPE_BRIGHTNESS, requestState, &Attributes),
+            m_loadLevelTarget(requestState->context, "SetLoadLevelTarget")
         {
         }
 
@@ -49,6 +51,8 @@ class UpnpDimming: public UpnpService
 
     private:
         static vector <UpnpAttributeInfo> Attributes;
+
+        UpnpSetCoalescer m_loadLevelTarget;
 };
 
 #endif
@@ -19,6 +19,7 @@
 //-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
 
 #include "UpnpGenericService.h"
+#include "UpnpActionStats.h"
 
 static const string MODULE = "UpnpGenericService";
 
@@ -464,8 +465,11 @@ OCEntityHandlerResult UpnpGenericService::processPutRequest(OCEntityHandlerReque
 
             GError *error = NULL;
             GList *outValues = NULL;
-            if (gupnp_service_proxy_send_action_list(m_proxy, actionName, &error,
-                    inNames, inValues, outNames, outTypes, &outValues))
+            gint64 startTime = g_get_monotonic_time();
+            gboolean sent = gupnp_service_proxy_send_action_list(m_proxy, actionName, &error,
+                    inNames, inValues, outNames, outTypes, &outValues);
+            UpnpActionStats::record(m_proxy, actionName, startTime, error);
+            if (sent)
             {
                 if (OCRepPayloadSetPropString(payload, ACTION_NAME.c_str(), actionName))
                 {
@@ -30,6 +30,8 @@
 
 #include <UpnpConstants.h>
 
+#include "UpnpLog.h"
+
 //IoTivity Link Relationships
 static const std::string LINK_REL_CONTAINS = "contains";
 static const std::string LINK_REL_HOSTS = "hosts";
@@ -191,10 +193,12 @@ typedef union _UpnpVar
     gchar       *var_pchar;
 } UpnpVar;
 
-#define ERROR_PRINT(x) do { std::cerr << MODULE << ":" << __func__ << "(): ERROR: " << x << std::endl; } while (0)
+// Asynchronous, see UpnpLog.h (levels are set per MODULE)
+#define ERROR_PRINT(x) UPNP_LOG(UpnpLog::LEVEL_ERROR, x)
+#define INFO_PRINT(x) UPNP_LOG(UpnpLog::LEVEL_INFO, x)
 
 #ifndef NDEBUG
-#define DEBUG_PRINT(x) do { std::cout << MODULE << ":" << __func__ << "(): " << x << std::endl; } while (0)
+#define DEBUG_PRINT(x) UPNP_LOG(UpnpLog::LEVEL_DEBUG, x)
 #else
 #define DEBUG_PRINT(x)
 #endif
@@ -0,0 +1,150 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include <cmath>
+
+#include "UpnpLatencyHistogram.h"
+
+UpnpLatencyHistogram::UpnpLatencyHistogram()
+{
+    reset();
+}
+
+void UpnpLatencyHistogram::reset()
+{
+    for (size_t i = 0; i < NUM_BUCKETS; ++i)
+    {
+        m_buckets[i].store(0, std::memory_order_relaxed);
+    }
+    m_count.store(0, std::memory_order_relaxed);
+    m_sum.store(0, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+size_t UpnpLatencyHistogram::getBucketIndex(uint64_t value)
+{
+    if (value < SUB_BUCKETS)
+    {
+        return (size_t) value;
+    }
+
+    unsigned int exponent = 63;
+    while ((value & (1ull << exponent)) == 0)
+    {
+        exponent--;
+    }
+
+    if (exponent > MAX_EXPONENT)
+    {
+        return NUM_BUCKETS - 1;
+    }
+
+    // Bits following the leading one select the linear sub-bucket
+    unsigned int shift = exponent - SUB_BUCKET_BITS;
+    size_t subBucket = (size_t) ((value >> shift) & (SUB_BUCKETS - 1));
+
+    return SUB_BUCKETS + (exponent - SUB_BUCKET_BITS) * SUB_BUCKETS + subBucket;
+}
+
+uint64_t UpnpLatencyHistogram::getBucketLowerBound(size_t index)
+{
+    if (index < SUB_BUCKETS)
+    {
+        return index;
+    }
+
+    unsigned int shift = (unsigned int) ((index - SUB_BUCKETS) / SUB_BUCKETS);
+    uint64_t subBucket = (index - SUB_BUCKETS) % SUB_BUCKETS;
+
+    return (SUB_BUCKETS + subBucket) << shift;
+}
+
+uint64_t UpnpLatencyHistogram::getBucketUpperBound(size_t index)
+{
+    if (index < SUB_BUCKETS)
+    {
+        return index;
+    }
+
+    unsigned int shift = (unsigned int) ((index - SUB_BUCKETS) / SUB_BUCKETS);
+    return getBucketLowerBound(index) + (1ull << shift) - 1;
+}
+
+void UpnpLatencyHistogram::record(uint64_t value)
+{
+    m_buckets[getBucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(value, std::memory_order_relaxed);
+
+    uint64_t max = m_max.load(std::memory_order_relaxed);
+    while ((value > max) &&
+           !m_max.compare_exchange_weak(max, value, std::memory_order_relaxed))
+    {
+    }
+}
+
+UpnpLatencyHistogram::Snapshot UpnpLatencyHistogram::getSnapshot() const
+{
+    Snapshot snapshot;
+
+    snapshot.buckets.resize(NUM_BUCKETS);
+    snapshot.count = 0;
+    for (size_t i = 0; i < NUM_BUCKETS; ++i)
+    {
+        snapshot.buckets[i] = m_buckets[i].load(std::memory_order_relaxed);
+        snapshot.count += snapshot.buckets[i];
+    }
+    snapshot.sum = m_sum.load(std::memory_order_relaxed);
+    snapshot.max = m_max.load(std::memory_order_relaxed);
+
+    return snapshot;
+}
+
+uint64_t UpnpLatencyHistogram::Snapshot::getPercentile(double percentile) const
+{
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    uint64_t rank = (uint64_t) std::ceil(percentile / 100 * count);
+    uint64_t cumulative = 0;
+
+    if (rank == 0)
+    {
+        rank = 1;
+    }
+
+    for (size_t i = 0; i < buckets.size(); ++i)
+    {
+        cumulative += buckets[i];
+        if (cumulative >= rank)
+        {
+            uint64_t value = getBucketUpperBound(i);
+            return (value < max) ? value : max;
+        }
+    }
+    return max;
+}
+
+double UpnpLatencyHistogram::Snapshot::getMean() const
+{
+    return (count != 0) ? ((double) sum / count) : 0;
+}
@@ -0,0 +1,75 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#ifndef UPNP_LATENCY_HISTOGRAM_H_
+#define UPNP_LATENCY_HISTOGRAM_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Log-linear (HDR style) latency histogram: every power of two range is
+// split into 2^SUB_BUCKET_BITS linear buckets, which bounds the relative
+// error of the reported values to 1/2^SUB_BUCKET_BITS (12.5%).
+//
+// Values are in microseconds. Recording is lock-free (relaxed atomic
+// increments), so readers never block the recording threads; a snapshot
+// taken while values are being recorded may be off by the in-flight values.
+class UpnpLatencyHistogram
+{
+    public:
+        static const unsigned int SUB_BUCKET_BITS = 3;
+        static const unsigned int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+        // Largest tracked power of two (2^35 us ~ 9.5 hours), larger
+        // values end up in the last bucket
+        static const unsigned int MAX_EXPONENT = 35;
+        static const size_t NUM_BUCKETS = SUB_BUCKETS + (MAX_EXPONENT - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+        typedef struct _Snapshot
+        {
+            uint64_t count;
+            uint64_t sum;
+            uint64_t max;
+            std::vector<uint64_t> buckets;
+
+            // Value (bucket upper bound, capped by max) at the given percentile
+            uint64_t getPercentile(double percentile) const;
+            double getMean() const;
+        } Snapshot;
+
+        UpnpLatencyHistogram();
+
+        void record(uint64_t value);
+        Snapshot getSnapshot() const;
+        void reset();
+
+        static size_t getBucketIndex(uint64_t value);
+        static uint64_t getBucketLowerBound(size_t index);
+        static uint64_t getBucketUpperBound(size_t index);
+
+    private:
+        std::atomic<uint64_t> m_buckets[NUM_BUCKETS];
+        std::atomic<uint64_t> m_count;
+        std::atomic<uint64_t> m_sum;
+        std::atomic<uint64_t> m_max;
+};
+
+#endif
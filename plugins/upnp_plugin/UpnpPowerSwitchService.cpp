@@ -19,6 +19,7 @@
 //-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
 
 #include "UpnpPowerSwitchService.h"
+#include "UpnpActionStats.h"
 
 static const string MODULE = "UpnpPowerSwitchService";
 
@@ -56,7 +57,7 @@ OCEntityHandlerResult UpnpPowerSwitch::processGetRequest(string uri, OCRepPayloa
     //TODO use async version with callback
     bool powerSwitchStateValue = false;
     GError *error = NULL;
-    if (! gupnp_service_proxy_send_action(m_proxy, "GetTarget", &error,
+    if (! UpnpActionStats::sendAction(m_proxy, "GetTarget", &error,
             // IN args (none)
             NULL,
             // OUT args
@@ -108,7 +109,7 @@ OCEntityHandlerResult UpnpPowerSwitch::processPutRequest(OCEntityHandlerRequest
 
         //TODO use async version with callback
         GError *error = NULL;
-        if (! gupnp_service_proxy_send_action(m_proxy, "SetTarget", &error,
+        if (! UpnpActionStats::sendAction(m_proxy, "SetTarget", &error,
                 // IN args
                 "newTargetValue", G_TYPE_BOOLEAN, powerSwitchStateValue,
                 NULL,
@@ -19,6 +19,7 @@
 //-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
 
 #include "UpnpRenderingControlService.h"
+#include "UpnpActionStats.h"
 
 static const string MODULE = "UpnpRenderingControlService";
 
@@ -42,10 +43,33 @@ static const char *desiredVolumeParamName = "DesiredVolume";
 static const int defaultInstanceID = 0;
 static const char *defaultChannel = "Master";
 
+static const char *lastChangeVarName = "LastChange";
+
+// LastChange variables (default instance and channel) -> OCF properties
+static const map <string, string> s_lastChangeProperties =
+{
+    {"Mute",    mutePropertyName},
+    {"Volume",  volumePropertyName}
+};
+
 vector <UpnpAttributeInfo> UpnpRenderingControl::Attributes =
 {
 };
 
+map <string, GType> UpnpRenderingControl::getEventedVariables()
+{
+    return {{lastChangeVarName, G_TYPE_STRING}};
+}
+
+bool UpnpRenderingControl::processNotification(const string &variable, GValue *value)
+{
+    if (variable != lastChangeVarName)
+    {
+        return false;
+    }
+    return processLastChange(value, s_lastChangeProperties);
+}
+
 OCEntityHandlerResult UpnpRenderingControl::processGetRequest(string uri, OCRepPayload *payload, string resourceType)
 {
     if (payload == NULL)
@@ -60,7 +84,7 @@ OCEntityHandlerResult UpnpRenderingControl::processGetRequest(string uri, OCRepP
     GError *error = NULL;
 
     // get mute
-    if (! gupnp_service_proxy_send_action(m_proxy, getMuteAction, &error,
+    if (! UpnpActionStats::sendAction(m_proxy, getMuteAction, &error,
         // IN args
         instanceIdParamName, G_TYPE_UINT, defaultInstanceID,
         channelParamName, G_TYPE_STRING, defaultChannel,
@@ -85,7 +109,7 @@ OCEntityHandlerResult UpnpRenderingControl::processGetRequest(string uri, OCRepP
     DEBUG_PRINT(mutePropertyName << ": " << (muteValue ? "true" : "false"));
 
     // get volume
-    if (! gupnp_service_proxy_send_action(m_proxy, getVolumeAction, &error,
+    if (! UpnpActionStats::sendAction(m_proxy, getVolumeAction, &error,
         // IN args
         instanceIdParamName, G_TYPE_UINT, defaultInstanceID,
         channelParamName, G_TYPE_STRING, defaultChannel,
@@ -116,7 +140,6 @@ OCEntityHandlerResult UpnpRenderingControl::processGetRequest(string uri, OCRepP
 OCEntityHandlerResult UpnpRenderingControl::processPutRequest(OCEntityHandlerRequest *ehRequest,
         string uri, string resourceType, OCRepPayload *payload)
 {
-    (void) uri;
     if (!ehRequest || !ehRequest->payload ||
             ehRequest->payload->type != PAYLOAD_TYPE_REPRESENTATION)
     {
@@ -131,37 +154,32 @@ OCEntityHandlerResult UpnpRenderingControl::processPutRequest(OCEntityHandlerReq
 
     if (UPNP_OIC_TYPE_AUDIO == resourceType)
     {
-        //TODO use async version with callback
-        GError *error = NULL;
+        // Answered once the actions carrying the values (or newer ones)
+        // are done, only the latest values are sent
+        UpnpSetResponse::Ptr response = std::make_shared< UpnpSetResponse >(ehRequest, uri);
 
         // set mute
         bool muteValue = false;
         if (OCRepPayloadGetPropBool(input, mutePropertyName, &muteValue))
         {
             DEBUG_PRINT("New " << mutePropertyName << ": " << (muteValue ? "true" : "false"));
-            if (! gupnp_service_proxy_send_action(m_proxy, setMuteAction, &error,
-                // IN args
-                instanceIdParamName, G_TYPE_UINT, defaultInstanceID,
-                channelParamName, G_TYPE_STRING, defaultChannel,
-                desiredMuteParamName, G_TYPE_BOOLEAN, muteValue,
-                NULL,
-                // OUT args (none)
-                NULL))
-            {
-                ERROR_PRINT(setMuteAction << " action failed");
-                if (error)
-                {
-                    DEBUG_PRINT("Error message: " << error->message);
-                    g_error_free(error);
-                }
-                return OC_EH_ERROR;
-            }
-
             if (!OCRepPayloadSetPropBool(payload, mutePropertyName, muteValue))
             {
                 throw "Failed to set mute value in payload";
             }
             DEBUG_PRINT(mutePropertyName << ": " << (muteValue ? "true" : "false"));
+
+            gboolean upnpMuteValue = muteValue;
+            m_mute.write(m_proxy, [upnpMuteValue](GUPnPServiceProxy *proxy,
+                    GUPnPServiceProxyActionCallback callback, gpointer userData)
+            {
+                return UpnpActionStats::beginAction(proxy, setMuteAction, callback, userData,
+                        // IN args
+                        instanceIdParamName, G_TYPE_UINT, defaultInstanceID,
+                        channelParamName, G_TYPE_STRING, defaultChannel,
+                        desiredMuteParamName, G_TYPE_BOOLEAN, upnpMuteValue,
+                        NULL);
+            }, UpnpSetResponse::done(response));
         }
 
         // set volume
@@ -169,36 +187,30 @@ OCEntityHandlerResult UpnpRenderingControl::processPutRequest(OCEntityHandlerReq
         if (OCRepPayloadGetPropInt(input, volumePropertyName, &volumeValue))
         {
             DEBUG_PRINT("New " << volumePropertyName << ": " << volumeValue);
-            int upnpVolumeValue = volumeValue;
-            if (! gupnp_service_proxy_send_action(m_proxy, setVolumeAction, &error,
-                // IN args
-                instanceIdParamName, G_TYPE_UINT, defaultInstanceID,
-                channelParamName, G_TYPE_STRING, defaultChannel,
-                desiredVolumeParamName, G_TYPE_UINT, upnpVolumeValue,
-                NULL,
-                // OUT args (none)
-                NULL))
-            {
-                ERROR_PRINT(setVolumeAction << " action failed");
-                if (error)
-                {
-                    DEBUG_PRINT("Error message: " << error->message);
-                    g_error_free(error);
-                }
-                return OC_EH_ERROR;
-            }
-
             if (!OCRepPayloadSetPropInt(payload, volumePropertyName, volumeValue))
             {
                 throw "Failed to set volume value in payload";
             }
             DEBUG_PRINT(volumePropertyName << ": " << volumeValue);
+
+            guint upnpVolumeValue = volumeValue;
+            m_volume.write(m_proxy, [upnpVolumeValue](GUPnPServiceProxy *proxy,
+                    GUPnPServiceProxyActionCallback callback, gpointer userData)
+            {
+                return UpnpActionStats::beginAction(proxy, setVolumeAction, callback, userData,
+                        // IN args
+                        instanceIdParamName, G_TYPE_UINT, defaultInstanceID,
+                        channelParamName, G_TYPE_STRING, defaultChannel,
+                        desiredVolumeParamName, G_TYPE_UINT, upnpVolumeValue,
+                        NULL);
+            }, UpnpSetResponse::done(response));
         }
+        response->setPayload(payload);
     }
     else
     {
         throw "Failed due to unknown resource type";
     }
 
-    return OC_EH_OK;
+    return OC_EH_SLOW;
 }
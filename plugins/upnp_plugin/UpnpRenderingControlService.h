@@ -29,6 +29,7 @@
 #include "UpnpResource.h"
 #include "UpnpInternal.h"
 #include "UpnpService.h"
+#include "UpnpSetCoalescer.h"
 
 using namespace std;
 
@@ -39,7 +40,9 @@ class UpnpRenderingControl: public UpnpService
     public:
         UpnpRenderingControl(GUPnPServiceInfo *serviceInfo,
                         UpnpRequestState *requestState):
-            UpnpService(serviceInfo, UPNP_OIC_TYPE_AUDIO, requestState, &Attributes)
+            UpnpService(serviceInfo, UPNP_OIC_TYPE_AUDIO, requestState, &Attributes),
+            m_mute(requestState->context, "SetMute"),
+            m_volume(requestState->context, "SetVolume")
         {
         }
 
@@ -47,8 +50,17 @@ class UpnpRenderingControl: public UpnpService
         OCEntityHandlerResult processPutRequest(OCEntityHandlerRequest *ehRequest,
                     string uri, string resourceType, OCRepPayload *payload);
 
+    protected:
+        // Evented through LastChange
+        map <string, GType> getEventedVariables();
+        bool processNotification(const string &variable, GValue *value);
+
     private:
         static vector <UpnpAttributeInfo> Attributes;
+
+        // Default instance and channel only
+        UpnpSetCoalescer m_mute;
+        UpnpSetCoalescer m_volume;
 };
 
 #endif
@@ -46,6 +46,7 @@ UpnpService::UpnpService(GUPnPServiceInfo *serviceInfo,
 {
     DEBUG_PRINT("(" << std::this_thread::get_id() << ")");
     m_proxy = nullptr;
+    m_notifySource = nullptr;
     m_resourceType = type;
 
     if (attributeInfo == nullptr)
@@ -109,32 +110,210 @@ UpnpService::UpnpService(GUPnPServiceInfo *serviceInfo,
 
 void UpnpService::stop()
 {
+    if (m_notifySource != nullptr)
+    {
+        g_source_destroy(m_notifySource);
+        g_source_unref(m_notifySource);
+        m_notifySource = nullptr;
+    }
+
     if (!m_stateVarMap.empty())
     {
-        std::map<string, StateVarAttr>::iterator it;
+        std::map<string, GType>::iterator it;
         for (it = m_stateVarMap.begin(); it != m_stateVarMap.end(); ++it)
         {
             DEBUG_PRINT("remove notify for \"" << it->first << "\"");
 
-//            gupnp_service_proxy_remove_notify (m_proxy,
-//                                               (it->first).c_str(),
-//                                               onStateChanged,
-//                                               this);
+            gupnp_service_proxy_remove_notify (m_proxy,
+                                               (it->first).c_str(),
+                                               onStateChanged,
+                                               this);
         }
         m_stateVarMap.clear();
     }
+    m_properties.clear();
 }
 
 UpnpService::~UpnpService()
 {
     DEBUG_PRINT("(" << std::this_thread::get_id() << "), uri:" << m_uri);
-//    this->stop();
+    this->stop();
     m_proxy = nullptr;
 }
 
 void UpnpService::setProxy(GUPnPServiceProxy *proxy)
 {
+    if (proxy == m_proxy)
+    {
+        return;
+    }
+
+    stop();
     m_proxy = proxy;
+    if (m_proxy == nullptr)
+    {
+        return;
+    }
+
+    for (auto &var : getEventedVariables())
+    {
+        if (!gupnp_service_proxy_add_notify (m_proxy,
+                                             var.first.c_str(),
+                                             var.second,
+                                             onStateChanged,
+                                             this))
+        {
+            ERROR_PRINT("Failed to add notify for " << var.first);
+            continue;
+        }
+        DEBUG_PRINT("Added notify for: " << var.first << ", " << g_type_name(var.second));
+        m_stateVarMap[var.first] = var.second;
+    }
+}
+
+map <string, GType> UpnpService::getEventedVariables()
+{
+    map <string, GType> variables;
+
+    for (auto &attr : *m_serviceAttributeInfo)
+    {
+        if (attr.evented && string(attr.varName) != "")
+        {
+            variables[attr.varName] = attr.type;
+        }
+    }
+    return variables;
+}
+
+void UpnpService::onStateChanged(GUPnPServiceProxy *proxy,
+                                 const char *variable,
+                                 GValue *value,
+                                 gpointer userData)
+{
+    (void) proxy;
+    UpnpService *pService = static_cast<UpnpService *> (userData);
+
+    if (!pService->processNotification(variable, value))
+    {
+        return;
+    }
+
+    // Coalesced: one notification per window whatever the events
+    if (pService->m_notifySource == nullptr)
+    {
+        pService->m_notifySource = g_timeout_source_new(NOTIFY_DELAY);
+        g_source_set_callback(pService->m_notifySource, onNotify, pService, NULL);
+        g_source_attach(pService->m_notifySource, pService->m_requestState->context);
+    }
+}
+
+gboolean UpnpService::onNotify(gpointer userData)
+{
+    UpnpService *pService = static_cast<UpnpService *> (userData);
+
+    g_source_unref(pService->m_notifySource);
+    pService->m_notifySource = nullptr;
+
+    DEBUG_PRINT("notify observers of " << pService->m_uri);
+    ConcurrentIotivityUtils::queueNotifyObservers(pService->m_uri);
+    return G_SOURCE_REMOVE;
+}
+
+bool UpnpService::processNotification(const string &variable, GValue *value)
+{
+    for (auto &attr : *m_serviceAttributeInfo)
+    {
+        if (attr.evented && variable == attr.varName)
+        {
+            gchar *contents = g_strdup_value_contents(value);
+            bool changed = updateProperty(attr.name, contents);
+            g_free(contents);
+            return changed;
+        }
+    }
+    return false;
+}
+
+bool UpnpService::processLastChange(GValue *value, const map <string, string> &properties)
+{
+    const gchar *lastChange = g_value_get_string(value);
+    bool changed = false;
+
+    if (lastChange == NULL)
+    {
+        return false;
+    }
+
+    for (auto &property : properties)
+    {
+        string propertyValue;
+        if (getLastChangeValue(lastChange, property.first, propertyValue))
+        {
+            changed = updateProperty(property.second, propertyValue) || changed;
+        }
+    }
+    return changed;
+}
+
+bool UpnpService::updateProperty(const string &name, const string &value)
+{
+    map <string, string>::iterator it = m_properties.find(name);
+
+    if (it != m_properties.end() && it->second == value)
+    {
+        return false;
+    }
+
+    DEBUG_PRINT(m_uri << ": " << name << " = " << value);
+    m_properties[name] = value;
+    return true;
+}
+
+bool UpnpService::getLastChangeValue(const string &lastChange, const string &variable, string &value)
+{
+    // <Event><InstanceID val="0"><Volume channel="Master" val="24"/>...</InstanceID>...</Event>
+    size_t begin = lastChange.find("<InstanceID val=\"0\"");
+    if (begin == string::npos)
+    {
+        return false;
+    }
+    size_t end = lastChange.find("</InstanceID>", begin);
+    if (end == string::npos)
+    {
+        end = lastChange.size();
+    }
+
+    const string tag = "<" + variable + " ";
+    for (size_t pos = lastChange.find(tag, begin); pos < end; pos = lastChange.find(tag, pos + 1))
+    {
+        size_t close = lastChange.find('>', pos);
+        if (close == string::npos)
+        {
+            return false;
+        }
+
+        string element = lastChange.substr(pos, close - pos);
+        if (element.find("channel=\"") != string::npos &&
+            element.find("channel=\"Master\"") == string::npos)
+        {
+            continue;
+        }
+
+        size_t val = element.find(" val=\"");
+        if (val == string::npos)
+        {
+            continue;
+        }
+        val += 6;
+        size_t valEnd = element.find('"', val);
+        if (valEnd == string::npos)
+        {
+            continue;
+        }
+        value = element.substr(val, valEnd - val);
+        return true;
+    }
+    return false;
 }
 
 GUPnPServiceProxy *UpnpService::getProxy()
@@ -48,6 +48,7 @@ public:
 
     virtual ~UpnpService();
 
+    // Notifications of the evented state variables are (re)added on the proxy
     void setProxy(GUPnPServiceProxy *proxy);
     GUPnPServiceProxy *getProxy();
 
@@ -60,6 +61,31 @@ public:
 
 
 protected:
+       // Window (ms) over which the notifications to the observers of the
+       // resource are coalesced
+       static const guint NOTIFY_DELAY = 200;
+
+       // Evented state variables to add notifications for (name -> type).
+       // Default: those of the evented attributes.
+       virtual map <string, GType> getEventedVariables();
+
+       // Maps an event to the OCF properties of the resource (gupnp
+       // thread). Returns true if any changed, for the observers to be
+       // notified. Default: the evented attribute of the variable.
+       virtual bool processNotification(const string &variable, GValue *value);
+
+       // Maps the variables of a LastChange event to the OCF properties
+       // (variable -> property). Returns true if any changed.
+       bool processLastChange(GValue *value, const map <string, string> &properties);
+
+       // Records the last value seen for an OCF property. Returns true if
+       // it changed.
+       bool updateProperty(const string &name, const string &value);
+
+       // Raw "val" of variable for instance 0 (and the Master channel, if
+       // per channel) in a LastChange event. Returns false if not present.
+       static bool getLastChangeValue(const string &lastChange, const string &variable, string &value);
+
        // Map of associated attributes (OIC)
        // "OCF Attribute name" -> (attribute info, supported operations)
        map <string, pair <UpnpAttributeInfo *, int>> m_attributeMap;
@@ -74,16 +100,20 @@ private:
 
     string m_serviceId;
 
-    typedef struct _StateVarAttr
-    {
-        string attrName;
-        GType type;
-        string parentName;
-    } StateVarAttr;
+    // UPnP state variables with notifications added
+    map <string, GType> m_stateVarMap;
+
+    // Last values of the OCF properties changed by events
+    map <string, string> m_properties;
+
+    // Pending (coalesced) notification of the observers
+    GSource *m_notifySource;
 
-    // Mapping of UPnP state variables that are observed/notified to
-    // corresponding OCF attributes
-    map <string, StateVarAttr> m_stateVarMap;
+    static void onStateChanged(GUPnPServiceProxy *proxy,
+                               const char *variable,
+                               GValue *value,
+                               gpointer userData);
+    static gboolean onNotify(gpointer userData);
 
     static string getStringField(function< char *(GUPnPServiceInfo *serviceInfo)> f,
                                  GUPnPServiceInfo *serviceInfo);
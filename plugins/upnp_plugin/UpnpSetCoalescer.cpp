@@ -0,0 +1,220 @@
+//******************************************************************
+//
+// Copyright 2018 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include <ocpayload.h>
+#include <ConcurrentIotivityUtils.h>
+
+#include "UpnpSetCoalescer.h"
+#include "UpnpActionStats.h"
+#include "UpnpInternal.h"
+
+using namespace std;
+using namespace OC::Bridging;
+
+static const string MODULE = "UpnpSetCoalescer";
+
+UpnpSetCoalescer::UpnpSetCoalescer(GMainContext *context, string name) :
+    m_context(context),
+    m_name(name),
+    m_pendingProxy(NULL),
+    m_source(NULL),
+    m_inFlightProxy(NULL),
+    m_inFlight(NULL),
+    m_coalesced(0)
+{
+}
+
+UpnpSetCoalescer::~UpnpSetCoalescer()
+{
+    std::unique_lock< std::mutex > lock(m_lock);
+
+    if (m_source != NULL)
+    {
+        g_source_destroy(m_source);
+        g_source_unref(m_source);
+        m_source = NULL;
+    }
+
+    if (m_inFlight != NULL)
+    {
+        // The action callback is not invoked once cancelled
+        UpnpActionStats::cancelAction(m_inFlightProxy, m_inFlight);
+        m_inFlight = NULL;
+    }
+
+    if (m_coalesced != 0)
+    {
+        DEBUG_PRINT(m_name << ": " << m_coalesced << " coalesced");
+    }
+
+    std::vector< Done > dropped;
+    dropped.swap(m_inFlightDone);
+    dropped.insert(dropped.end(), m_pendingDone.begin(), m_pendingDone.end());
+    m_pendingDone.clear();
+    lock.unlock();
+
+    complete(dropped, false);
+}
+
+void UpnpSetCoalescer::write(GUPnPServiceProxy *proxy, Action action, Done done)
+{
+    std::lock_guard< std::mutex > lock(m_lock);
+
+    if (m_pending)
+    {
+        m_coalesced++;
+    }
+    m_pendingProxy = proxy;
+    m_pending = action;
+    m_pendingDone.push_back(done);
+
+    // Sent from onActionDone when in flight
+    if (m_inFlight == NULL && m_source == NULL)
+    {
+        m_source = g_idle_source_new();
+        g_source_set_priority(m_source, G_PRIORITY_HIGH_IDLE);
+        g_source_set_callback(m_source, onSend, this, NULL);
+        g_source_attach(m_source, m_context);
+    }
+}
+
+// Called with m_lock held. The SETs of an action that could not be begun
+// are moved to failed, to be completed once the lock is released.
+void UpnpSetCoalescer::sendPending(std::vector< Done > &failed)
+{
+    if (!m_pending)
+    {
+        return;
+    }
+
+    Action action;
+    action.swap(m_pending);
+    m_inFlightDone.swap(m_pendingDone);
+
+    m_inFlightProxy = m_pendingProxy;
+    m_inFlight = action(m_inFlightProxy, onActionDone, this);
+    if (m_inFlight == NULL)
+    {
+        ERROR_PRINT(m_name << " action failed");
+        failed.swap(m_inFlightDone);
+    }
+}
+
+void UpnpSetCoalescer::complete(std::vector< Done > &done, bool status)
+{
+    for (const Done &callback : done)
+    {
+        callback(status);
+    }
+    done.clear();
+}
+
+gboolean UpnpSetCoalescer::onSend(gpointer userData)
+{
+    UpnpSetCoalescer *coalescer = static_cast< UpnpSetCoalescer * >(userData);
+    std::vector< Done > failed;
+
+    {
+        std::lock_guard< std::mutex > lock(coalescer->m_lock);
+
+        g_source_unref(coalescer->m_source);
+        coalescer->m_source = NULL;
+
+        coalescer->sendPending(failed);
+    }
+
+    complete(failed, false);
+    return G_SOURCE_REMOVE;
+}
+
+void UpnpSetCoalescer::onActionDone(GUPnPServiceProxy *proxy, GUPnPServiceProxyAction *action,
+                                    gpointer userData)
+{
+    UpnpSetCoalescer *coalescer = static_cast< UpnpSetCoalescer * >(userData);
+    GError *error = NULL;
+    bool status = true;
+
+    if (!UpnpActionStats::endAction(proxy, action, &error, NULL))
+    {
+        ERROR_PRINT(coalescer->m_name << " action failed");
+        if (error)
+        {
+            DEBUG_PRINT("Error message: " << error->message);
+            g_error_free(error);
+        }
+        status = false;
+    }
+
+    std::vector< Done > done;
+    std::vector< Done > failed;
+    {
+        std::lock_guard< std::mutex > lock(coalescer->m_lock);
+
+        coalescer->m_inFlight = NULL;
+        done.swap(coalescer->m_inFlightDone);
+        coalescer->sendPending(failed);
+    }
+
+    complete(done, status);
+    complete(failed, false);
+}
+
+UpnpSetResponse::UpnpSetResponse(OCEntityHandlerRequest *request, string uri) :
+    m_request(*request),
+    m_uri(uri),
+    m_payload(NULL),
+    m_failed(false)
+{
+    // Only the handles are kept past the entity handler
+    m_request.query = NULL;
+    m_request.payload = NULL;
+}
+
+UpnpSetResponse::~UpnpSetResponse()
+{
+    if (m_payload == NULL)
+    {
+        return;
+    }
+
+    OCEntityHandlerResult result = m_failed ? OC_EH_ERROR : OC_EH_OK;
+    ConcurrentIotivityUtils::respondToRequest(&m_request, m_payload, result);
+    if (result == OC_EH_OK)
+    {
+        ConcurrentIotivityUtils::queueNotifyObservers(m_uri);
+    }
+    OCRepPayloadDestroy(m_payload);
+}
+
+UpnpSetCoalescer::Done UpnpSetResponse::done(Ptr response)
+{
+    return [response](bool status)
+    {
+        if (!status)
+        {
+            response->m_failed = true;
+        }
+    };
+}
+
+void UpnpSetResponse::setPayload(OCRepPayload *payload)
+{
+    m_payload = OCRepPayloadClone(payload);
+}
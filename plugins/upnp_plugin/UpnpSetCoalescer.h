@@ -0,0 +1,114 @@
+//******************************************************************
+//
+// Copyright 2018 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#ifndef UPNP_SET_COALESCER_H_
+#define UPNP_SET_COALESCER_H_
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <gupnp.h>
+#include <octypes.h>
+
+// Last-write-wins SET of one attribute of one service.
+//
+// The action is sent asynchronously from the gupnp thread; while one is in
+// flight, the SETs written replace each other and only the newest is sent
+// once the device has acknowledged the previous one. Every SET written
+// completes (on the gupnp thread) with the status of the action that
+// carried its value, or false if the coalescer is destroyed first.
+//
+// write() may be called from any thread, the coalescer is to be destroyed
+// from the gupnp thread.
+class UpnpSetCoalescer
+{
+    public:
+        // Begins the action on the proxy (UpnpActionStats::beginAction)
+        typedef std::function< GUPnPServiceProxyAction *(GUPnPServiceProxy *proxy,
+                GUPnPServiceProxyActionCallback callback, gpointer userData) > Action;
+        typedef std::function< void(bool status) > Done;
+
+        UpnpSetCoalescer(GMainContext *context, std::string name);
+        ~UpnpSetCoalescer();
+
+        void write(GUPnPServiceProxy *proxy, Action action, Done done);
+
+    private:
+        std::mutex m_lock;
+        GMainContext *m_context;
+        std::string m_name;
+
+        GUPnPServiceProxy *m_pendingProxy;
+        Action m_pending;
+        std::vector< Done > m_pendingDone;
+        GSource *m_source;
+
+        GUPnPServiceProxy *m_inFlightProxy;
+        GUPnPServiceProxyAction *m_inFlight;
+        std::vector< Done > m_inFlightDone;
+
+        unsigned int m_coalesced;
+
+        void sendPending(std::vector< Done > &failed);
+        static void complete(std::vector< Done > &done, bool status);
+        static gboolean onSend(gpointer userData);
+        static void onActionDone(GUPnPServiceProxy *proxy, GUPnPServiceProxyAction *action,
+                                 gpointer userData);
+
+        UpnpSetCoalescer(const UpnpSetCoalescer &);
+        UpnpSetCoalescer &operator=(const UpnpSetCoalescer &);
+};
+
+// Response to a PUT whose SETs are written to coalescers. The entity
+// handler returns OC_EH_SLOW, and the response is sent once the actions
+// carrying all of them are done: OC_EH_ERROR if any failed, else OC_EH_OK
+// (and the observers of uri are notified).
+//
+// Nothing is sent unless setPayload() is called: the entity handler
+// answers itself if the request fails before.
+class UpnpSetResponse
+{
+    public:
+        typedef std::shared_ptr< UpnpSetResponse > Ptr;
+
+        UpnpSetResponse(OCEntityHandlerRequest *request, std::string uri);
+        ~UpnpSetResponse();
+
+        // Completion of one SET, to write with it
+        static UpnpSetCoalescer::Done done(Ptr response);
+
+        // Copied, to be sent as the response
+        void setPayload(OCRepPayload *payload);
+
+    private:
+        OCEntityHandlerRequest m_request;
+        std::string m_uri;
+        OCRepPayload *m_payload;
+        std::atomic< bool > m_failed;
+
+        UpnpSetResponse(const UpnpSetResponse &);
+        UpnpSetResponse &operator=(const UpnpSetResponse &);
+};
+
+#endif
@@ -0,0 +1,229 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+
+#include "UpnpSubscriptionManager.h"
+#include "UpnpInternal.h"
+
+using namespace std;
+
+static const string MODULE = "UpnpSubscriptionManager";
+
+const guint UpnpSubscriptionManager::SUBSCRIBE_JITTER;
+const guint UpnpSubscriptionManager::UNSUBSCRIBE_GRACE;
+const guint UpnpSubscriptionManager::RESUBSCRIBE_DELAY;
+
+UpnpSubscriptionManager::UpnpSubscriptionManager(GMainContext *context) :
+    m_context(context), m_timer(NULL), m_timerDue(0)
+{
+}
+
+UpnpSubscriptionManager::~UpnpSubscriptionManager()
+{
+    stopTimer();
+    for (auto &it : m_subscriptions)
+    {
+        g_signal_handler_disconnect(it.first, it.second.lostHandler);
+    }
+}
+
+void UpnpSubscriptionManager::addObserver(GUPnPServiceProxy *proxy)
+{
+    Subscription &subscription = find(proxy);
+
+    if (++subscription.observers > 1)
+    {
+        return;
+    }
+
+    if (gupnp_service_proxy_get_subscribed(proxy))
+    {
+        // Still within the grace period
+        subscription.due = 0;
+        rearm();
+    }
+    else
+    {
+        schedule(subscription, g_random_int_range(0, SUBSCRIBE_JITTER));
+    }
+}
+
+void UpnpSubscriptionManager::removeObserver(GUPnPServiceProxy *proxy)
+{
+    auto it = m_subscriptions.find(proxy);
+
+    if (it == m_subscriptions.end() || it->second.observers == 0)
+    {
+        return;
+    }
+
+    Subscription &subscription = it->second;
+    if (--subscription.observers > 0)
+    {
+        return;
+    }
+
+    if (gupnp_service_proxy_get_subscribed(proxy))
+    {
+        schedule(subscription, UNSUBSCRIBE_GRACE);
+    }
+    else
+    {
+        // Subscription not made yet
+        subscription.due = 0;
+        rearm();
+    }
+}
+
+unsigned int UpnpSubscriptionManager::getObservers(GUPnPServiceProxy *proxy)
+{
+    auto it = m_subscriptions.find(proxy);
+
+    return (it == m_subscriptions.end()) ? 0 : it->second.observers;
+}
+
+void UpnpSubscriptionManager::remove(GUPnPServiceProxy *proxy)
+{
+    auto it = m_subscriptions.find(proxy);
+
+    if (it == m_subscriptions.end())
+    {
+        return;
+    }
+
+    g_signal_handler_disconnect(proxy, it->second.lostHandler);
+    if (gupnp_service_proxy_get_subscribed(proxy))
+    {
+        gupnp_service_proxy_set_subscribed(proxy, false);
+    }
+    m_subscriptions.erase(it);
+    rearm();
+}
+
+UpnpSubscriptionManager::Subscription &UpnpSubscriptionManager::find(GUPnPServiceProxy *proxy)
+{
+    auto it = m_subscriptions.find(proxy);
+
+    if (it == m_subscriptions.end())
+    {
+        Subscription subscription;
+        subscription.observers = 0;
+        subscription.due = 0;
+        subscription.lostHandler = g_signal_connect(proxy, "subscription-lost",
+                                   G_CALLBACK(&UpnpSubscriptionManager::onSubscriptionLost), this);
+        it = m_subscriptions.insert({proxy, subscription}).first;
+    }
+    return it->second;
+}
+
+void UpnpSubscriptionManager::schedule(Subscription &subscription, guint delay)
+{
+    subscription.due = g_get_monotonic_time() + (gint64) delay * 1000;
+    rearm();
+}
+
+// Points the timer at the earliest pending operation
+void UpnpSubscriptionManager::rearm()
+{
+    gint64 due = 0;
+
+    for (auto &it : m_subscriptions)
+    {
+        if (it.second.due != 0 && (due == 0 || it.second.due < due))
+        {
+            due = it.second.due;
+        }
+    }
+
+    if (m_timer != NULL && m_timerDue == due)
+    {
+        return;
+    }
+    stopTimer();
+
+    if (due == 0)
+    {
+        return;
+    }
+
+    gint64 delay = due - g_get_monotonic_time();
+    m_timer = g_timeout_source_new((delay > 0) ? (guint) (delay / 1000) : 0);
+    g_source_set_callback(m_timer, onTimer, this, NULL);
+    g_source_attach(m_timer, m_context);
+    m_timerDue = due;
+}
+
+void UpnpSubscriptionManager::stopTimer()
+{
+    if (m_timer != NULL)
+    {
+        g_source_destroy(m_timer);
+        g_source_unref(m_timer);
+        m_timer = NULL;
+    }
+}
+
+gboolean UpnpSubscriptionManager::onTimer(gpointer userData)
+{
+    UpnpSubscriptionManager *manager = static_cast<UpnpSubscriptionManager *> (userData);
+    gint64 now = g_get_monotonic_time();
+
+    // Removed on return
+    g_source_unref(manager->m_timer);
+    manager->m_timer = NULL;
+
+    for (auto &it : manager->m_subscriptions)
+    {
+        Subscription &subscription = it.second;
+
+        if (subscription.due == 0 || subscription.due > now)
+        {
+            continue;
+        }
+        subscription.due = 0;
+
+        bool subscribe = (subscription.observers > 0);
+        if (subscribe != (bool) gupnp_service_proxy_get_subscribed(it.first))
+        {
+            DEBUG_PRINT((subscribe ? "Subscribing " : "Unsubscribing ") <<
+                        gupnp_service_info_get_service_type(GUPNP_SERVICE_INFO(it.first)) << ", udn: " <<
+                        gupnp_service_info_get_udn(GUPNP_SERVICE_INFO(it.first)));
+            gupnp_service_proxy_set_subscribed(it.first, subscribe);
+        }
+    }
+
+    manager->rearm();
+    return G_SOURCE_REMOVE;
+}
+
+void UpnpSubscriptionManager::onSubscriptionLost(GUPnPServiceProxy *proxy,
+        const GError *error,
+        gpointer userData)
+{
+    UpnpSubscriptionManager *manager = static_cast<UpnpSubscriptionManager *> (userData);
+    auto it = manager->m_subscriptions.find(proxy);
+
+    ERROR_PRINT("Subscription lost: " << ((error != NULL) ? error->message : "unknown error"));
+
+    if (it != manager->m_subscriptions.end() && it->second.observers > 0)
+    {
+        manager->schedule(it->second, RESUBSCRIBE_DELAY + g_random_int_range(0, SUBSCRIBE_JITTER));
+    }
+}
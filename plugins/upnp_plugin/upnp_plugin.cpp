@@ -204,6 +204,8 @@ extern "C" DLL_PUBLIC MPMResult pluginStop(MPMPluginCtx *)
 
     delete s_bridge;
 
+    UpnpLog::stop();
+
     return MPM_RESULT_OK;
 }
 
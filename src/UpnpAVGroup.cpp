@@ -0,0 +1,203 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include <algorithm>
+#include <thread>
+
+#include <UpnpConstants.h>
+
+#include "UpnpAVGroup.h"
+#include "UpnpAVTransportService.h"
+
+static const string MODULE = "UpnpAVGroup";
+
+const gint64 UpnpAVGroup::BARRIER_LEAD;
+const gint64 UpnpAVGroup::WARM_INTERVAL;
+
+// AVTransport attributes dispatched to the members
+static const vector< string > TransportActions = {"play", "pause", "seek", "stop"};
+
+UpnpAVGroup::UpnpAVGroup(string name, string uri, const vector< string > &memberUris) :
+    UpnpGroup(name, uri, memberUris, UPNP_OIC_TYPE_AV_GROUP)
+{
+    setAttribute("results", CompositeAttribute(), false);
+    updateSkewAttributes();
+}
+
+UpnpAVGroup::~UpnpAVGroup()
+{
+}
+
+bool UpnpAVGroup::isMemberType(const string &resourceType)
+{
+    return resourceType == UPNP_OIC_TYPE_AV_TRANSPORT;
+}
+
+// Called with m_lock held
+UpnpAVGroup::MemberSkew &UpnpAVGroup::getSkew(const string &uri)
+{
+    unique_ptr< MemberSkew > &skew = m_skew[uri];
+    if (skew == nullptr)
+    {
+        skew.reset(new MemberSkew());
+        skew->lastContact = 0;
+    }
+    return *skew;
+}
+
+void UpnpAVGroup::warmUp(const vector< std::shared_ptr< UpnpService > > &members)
+{
+    vector< UpnpRequest * > requests;
+    gint64 now = g_get_monotonic_time();
+    {
+        std::lock_guard< std::mutex > lock(m_lock);
+        for (auto &member : members)
+        {
+            if (now - getSkew(member->m_uri).lastContact > WARM_INTERVAL)
+            {
+                DEBUG_PRINT("warming up " << member->m_uri);
+                requests.push_back(std::static_pointer_cast< UpnpAVTransport >(member)->beginWarmUp());
+            }
+        }
+    }
+
+    // Failures show up in the actual dispatch
+    for (auto request : requests)
+    {
+        UpnpService::endRequest(request);
+    }
+}
+
+void UpnpAVGroup::handleSetAttributesRequest(const RCSResourceAttributes &value,
+        const map< string, string > &queryParams)
+{
+    DEBUG_PRINT("(" << std::this_thread::get_id() << "), uri:" << m_uri);
+
+    RCSResourceAttributes memberValue;
+    for (auto &action : TransportActions)
+    {
+        if (value.contains(action))
+        {
+            memberValue[action] = value.at(action);
+        }
+    }
+    if (memberValue.empty())
+    {
+        DEBUG_PRINT("nothing to set");
+        return;
+    }
+
+    vector< std::shared_ptr< UpnpService > > members;
+    {
+        std::lock_guard< std::mutex > lock(m_lock);
+        for (auto &member : m_members)
+        {
+            members.push_back(member.second);
+        }
+    }
+    if (members.empty())
+    {
+        return;
+    }
+
+    warmUp(members);
+
+    // All the requests are queued well before the barrier
+    gint64 barrier = g_get_monotonic_time() + BARRIER_LEAD;
+    vector< UpnpRequest * > requests;
+    for (auto &member : members)
+    {
+        requests.push_back(member->beginSetAttributesRequest(memberValue, queryParams, barrier));
+    }
+
+    CompositeAttribute results;
+    gint64 firstAck = G_MAXINT64;
+    gint64 lastAck = 0;
+    for (size_t i = 0; i < members.size(); ++i)
+    {
+        bool status = requests[i]->wait();
+        gint64 started = requests[i]->startedAt;
+        gint64 finished = requests[i]->finishedAt;
+        UpnpRequest::release(requests[i]);
+
+        RCSResourceAttributes result;
+        result["href"] = members[i]->m_uri;
+        result["status"] = status;
+        results.push_back(result);
+
+        if (!status || started == 0)
+        {
+            ERROR_PRINT(m_uri << ": " << members[i]->m_uri << " failed");
+            continue;
+        }
+
+        std::lock_guard< std::mutex > lock(m_lock);
+        MemberSkew &skew = getSkew(members[i]->m_uri);
+        skew.lastContact = finished;
+        skew.dispatch.record(std::max(started - barrier, (gint64) 0));
+        skew.ack.record(finished - barrier);
+
+        firstAck = std::min(firstAck, finished);
+        lastAck = std::max(lastAck, finished);
+    }
+
+    if (lastAck != 0)
+    {
+        m_spread.record(lastAck - firstAck);
+        DEBUG_PRINT(m_uri << ": acknowledgement spread " << (lastAck - firstAck) << " us");
+    }
+
+    setAttribute("results", results, false);
+    updateSkewAttributes();
+}
+
+void UpnpAVGroup::updateSkewAttributes()
+{
+    CompositeAttribute skews;
+    {
+        std::lock_guard< std::mutex > lock(m_lock);
+        for (auto &entry : m_skew)
+        {
+            UpnpLatencyHistogram::Snapshot dispatch = entry.second->dispatch.getSnapshot();
+            UpnpLatencyHistogram::Snapshot ack = entry.second->ack.getSnapshot();
+
+            RCSResourceAttributes skew;
+            skew["href"] = entry.first;
+            skew["count"] = (int) ack.count;
+            skew["dispatchP50"] = (int) dispatch.getPercentile(50);
+            skew["dispatchMax"] = (int) dispatch.max;
+            skew["ackP50"] = (int) ack.getPercentile(50);
+            skew["ackP95"] = (int) ack.getPercentile(95);
+            skew["ackMax"] = (int) ack.max;
+            skews.push_back(skew);
+        }
+    }
+
+    UpnpLatencyHistogram::Snapshot spread = m_spread.getSnapshot();
+    RCSResourceAttributes spreadAttrs;
+    spreadAttrs["count"] = (int) spread.count;
+    spreadAttrs["p50"] = (int) spread.getPercentile(50);
+    spreadAttrs["p95"] = (int) spread.getPercentile(95);
+    spreadAttrs["max"] = (int) spread.max;
+
+    // Values in us, relative to the barrier
+    setAttribute("skew", skews, false);
+    setAttribute("spread", spreadAttrs, false);
+}
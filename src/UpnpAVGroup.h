@@ -0,0 +1,77 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#ifndef UPNP_AV_GROUP_H_
+#define UPNP_AV_GROUP_H_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "UpnpGroup.h"
+#include "UpnpLatencyHistogram.h"
+
+using namespace std;
+
+// Group of media renderers (AVTransport services) played in sync.
+//
+// A SET of "play", "pause", "seek" or "stop" (same values as on the
+// AVTransport resource) is dispatched to all the members from a timed
+// barrier: the member requests are queued first and their actions all
+// start BARRIER_LEAD us later. Members idle for WARM_INTERVAL us get a
+// GetTransportInfo first so that no connection is set up at the barrier.
+//
+// For each member, the delay of the dispatch and of the acknowledgement
+// relative to the barrier are recorded and reported in "skew", along with
+// the spread of the acknowledgements ("spread").
+class UpnpAVGroup: public UpnpGroup
+{
+    public:
+        static const gint64 BARRIER_LEAD = 20000;
+        static const gint64 WARM_INTERVAL = 10 * G_USEC_PER_SEC;
+
+        UpnpAVGroup(string name, string uri, const vector< string > &memberUris);
+        virtual ~UpnpAVGroup();
+
+        virtual void handleSetAttributesRequest(const RCSResourceAttributes &value,
+                                                const map< string, string > &queryParams);
+
+    protected:
+        virtual bool isMemberType(const string &resourceType);
+
+    private:
+        typedef struct _MemberSkew
+        {
+            gint64 lastContact;
+            UpnpLatencyHistogram dispatch;
+            UpnpLatencyHistogram ack;
+        } MemberSkew;
+
+        // By member URI, guarded by m_lock
+        map< string, unique_ptr< MemberSkew > > m_skew;
+        UpnpLatencyHistogram m_spread;
+
+        MemberSkew &getSkew(const string &uri);
+        void warmUp(const vector< std::shared_ptr< UpnpService > > &members);
+        void updateSkewAttributes();
+};
+
+#endif
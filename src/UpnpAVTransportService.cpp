@@ -19,6 +19,7 @@
 //-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
 
 #include "UpnpAVTransportService.h"
+#include "UpnpActionStats.h"
 
 using namespace OIC::Service;
 
@@ -246,6 +247,36 @@ map <const string, UpnpAVTransport::SetAttributeHandler>
 
 // TODO Implement additional OCF attributes/UPnP Actions as necessary
 
+UpnpRequest *UpnpAVTransport::beginWarmUp()
+{
+    UpnpRequest *request = UpnpRequest::acquire();
+    request->handler = startWarmUp;
+    request->resource = this;
+    queueRequest(request);
+
+    return request;
+}
+
+bool UpnpAVTransport::startWarmUp(UpnpRequest *request)
+{
+    static const map< string, string > noQueryParams;
+    UpnpAVTransport *pService = static_cast<UpnpAVTransport *> (request->resource);
+
+    // Fetching the SCPD warms the connection up just as well
+    if (!pService->isIntrospected())
+    {
+        return pService->deferRequest(request);
+    }
+
+    request->expected = 1;
+    if (!pService->getTransportInfo(request, noQueryParams))
+    {
+        request->done++;
+        return false;
+    }
+    return true;
+}
+
 void UpnpAVTransport::getCurrentTransportActionsCb(GUPnPServiceProxy *proxy, GUPnPServiceProxyAction *actionProxy, gpointer userData)
 {
     GError *error = NULL;
@@ -253,13 +284,13 @@ void UpnpAVTransport::getCurrentTransportActionsCb(GUPnPServiceProxy *proxy, GUP
 
     UpnpRequest *request = static_cast<UpnpRequest *> (userData);
 
-    bool status = gupnp_service_proxy_end_action (proxy,
-                                                  actionProxy,
-                                                  &error,
-                                                  "Actions",
-                                                  G_TYPE_STRING,
-                                                  &actions,
-                                                  NULL);
+    bool status = UpnpActionStats::endAction (proxy,
+                                              actionProxy,
+                                              &error,
+                                              "Actions",
+                                              G_TYPE_STRING,
+                                              &actions,
+                                              NULL);
     if (error)
     {
         ERROR_PRINT("GetCurrentTransportActions failed: " << error->code << ", " << error->message);
@@ -303,14 +334,14 @@ bool UpnpAVTransport::getCurrentTransportActions(UpnpRequest *request, const map
     }
 
     GUPnPServiceProxyAction *actionProxy =
-        gupnp_service_proxy_begin_action (m_proxy,
-                                          "GetCurrentTransportActions",
-                                          getCurrentTransportActionsCb,
-                                          (gpointer *) request,
-                                          "InstanceID",
-                                          G_TYPE_UINT,
-                                          instanceId,
-                                          NULL);
+        UpnpActionStats::beginAction (m_proxy,
+                                      "GetCurrentTransportActions",
+                                      getCurrentTransportActionsCb,
+                                      (gpointer *) request,
+                                      "InstanceID",
+                                      G_TYPE_UINT,
+                                      instanceId,
+                                      NULL);
     if (NULL == actionProxy)
     {
         return false;
@@ -329,19 +360,19 @@ void UpnpAVTransport::getDeviceCapabilitiesCb(GUPnPServiceProxy *proxy, GUPnPSer
 
     UpnpRequest *request = static_cast<UpnpRequest *> (userData);
 
-    bool status = gupnp_service_proxy_end_action (proxy,
-                                                  actionProxy,
-                                                  &error,
-                                                  "PlayMedia",
-                                                  G_TYPE_STRING,
-                                                  &playMedia,
-                                                  "RecMedia",
-                                                  G_TYPE_STRING,
-                                                  &recMedia,
-                                                  "RecQualityModes",
-                                                  G_TYPE_STRING,
-                                                  &recQualityModes,
-                                                  NULL);
+    bool status = UpnpActionStats::endAction (proxy,
+                                              actionProxy,
+                                              &error,
+                                              "PlayMedia",
+                                              G_TYPE_STRING,
+                                              &playMedia,
+                                              "RecMedia",
+                                              G_TYPE_STRING,
+                                              &recMedia,
+                                              "RecQualityModes",
+                                              G_TYPE_STRING,
+                                              &recQualityModes,
+                                              NULL);
     if (error)
     {
         ERROR_PRINT("GetDeviceCapabilities failed: " << error->code << ", " << error->message);
@@ -391,14 +422,14 @@ bool UpnpAVTransport::getDeviceCapabilities(UpnpRequest *request, const map< str
     }
 
     GUPnPServiceProxyAction *actionProxy =
-        gupnp_service_proxy_begin_action (m_proxy,
-                                          "GetDeviceCapabilities",
-                                          getDeviceCapabilitiesCb,
-                                          (gpointer *) request,
-                                          "InstanceID",
-                                          G_TYPE_UINT,
-                                          instanceId,
-                                          NULL);
+        UpnpActionStats::beginAction (m_proxy,
+                                      "GetDeviceCapabilities",
+                                      getDeviceCapabilitiesCb,
+                                      (gpointer *) request,
+                                      "InstanceID",
+                                      G_TYPE_UINT,
+                                      instanceId,
+                                      NULL);
     if (NULL == actionProxy)
     {
         return false;
@@ -423,37 +454,37 @@ void UpnpAVTransport::getMediaInfoCb(GUPnPServiceProxy *proxy, GUPnPServiceProxy
 
     UpnpRequest *request = static_cast<UpnpRequest *> (userData);
 
-    bool status = gupnp_service_proxy_end_action (proxy,
-                                                  actionProxy,
-                                                  &error,
-                                                  "NrTracks",
-                                                  G_TYPE_UINT,
-                                                  &nrTracks,
-                                                  "MediaDuration",
-                                                  G_TYPE_STRING,
-                                                  &mediaDuration,
-                                                  "CurrentURI",
-                                                  G_TYPE_STRING,
-                                                  &currentUri,
-                                                  "CurrentURIMetaData",
-                                                  G_TYPE_STRING,
-                                                  &currentUriMetadata,
-                                                  "NextURI",
-                                                  G_TYPE_STRING,
-                                                  &nextUri,
-                                                  "NextURIMetaData",
-                                                  G_TYPE_STRING,
-                                                  &nextUriMetadata,
-                                                  "PlayMedium",
-                                                  G_TYPE_STRING,
-                                                  &playMedium,
-                                                  "RecordMedium",
-                                                  G_TYPE_STRING,
-                                                  &recordMedium,
-                                                  "WriteStatus",
-                                                  G_TYPE_STRING,
-                                                  &writeStatus,
-                                                  NULL);
+    bool status = UpnpActionStats::endAction (proxy,
+                                              actionProxy,
+                                              &error,
+                                              "NrTracks",
+                                              G_TYPE_UINT,
+                                              &nrTracks,
+                                              "MediaDuration",
+                                              G_TYPE_STRING,
+                                              &mediaDuration,
+                                              "CurrentURI",
+                                              G_TYPE_STRING,
+                                              &currentUri,
+                                              "CurrentURIMetaData",
+                                              G_TYPE_STRING,
+                                              &currentUriMetadata,
+                                              "NextURI",
+                                              G_TYPE_STRING,
+                                              &nextUri,
+                                              "NextURIMetaData",
+                                              G_TYPE_STRING,
+                                              &nextUriMetadata,
+                                              "PlayMedium",
+                                              G_TYPE_STRING,
+                                              &playMedium,
+                                              "RecordMedium",
+                                              G_TYPE_STRING,
+                                              &recordMedium,
+                                              "WriteStatus",
+                                              G_TYPE_STRING,
+                                              &writeStatus,
+                                              NULL);
     if (error)
     {
         ERROR_PRINT("GetMediaInfo failed: " << error->code << ", " << error->message);
@@ -520,14 +551,14 @@ bool UpnpAVTransport::getMediaInfo(UpnpRequest *request, const map< string, stri
     }
 
     GUPnPServiceProxyAction *actionProxy =
-        gupnp_service_proxy_begin_action (m_proxy,
-                                          "GetMediaInfo",
-                                          getMediaInfoCb,
-                                          (gpointer *) request,
-                                          "InstanceID",
-                                          G_TYPE_UINT,
-                                          instanceId,
-                                          NULL);
+        UpnpActionStats::beginAction (m_proxy,
+                                      "GetMediaInfo",
+                                      getMediaInfoCb,
+                                      (gpointer *) request,
+                                      "InstanceID",
+                                      G_TYPE_UINT,
+                                      instanceId,
+                                      NULL);
     if (NULL == actionProxy)
     {
         return false;
@@ -551,34 +582,34 @@ void UpnpAVTransport::getPositionInfoCb(GUPnPServiceProxy *proxy, GUPnPServicePr
 
     UpnpRequest *request = static_cast<UpnpRequest *> (userData);
 
-    bool status = gupnp_service_proxy_end_action (proxy,
-                                                  actionProxy,
-                                                  &error,
-                                                  "Track",
-                                                  G_TYPE_UINT,
-                                                  &track,
-                                                  "TrackDuration",
-                                                  G_TYPE_STRING,
-                                                  &trackDuration,
-                                                  "TrackMetaData",
-                                                  G_TYPE_STRING,
-                                                  &trackMetadata,
-                                                  "TrackURI",
-                                                  G_TYPE_STRING,
-                                                  &trackUri,
-                                                  "RelTime",
-                                                  G_TYPE_STRING,
-                                                  &relTime,
-                                                  "AbsTime",
-                                                  G_TYPE_STRING,
-                                                  &absTime,
-                                                  "RelCount",
-                                                  G_TYPE_UINT,
-                                                  &relCount,
-                                                  "AbsCount",
-                                                  G_TYPE_UINT,
-                                                  &absCount,
-                                                  NULL);
+    bool status = UpnpActionStats::endAction (proxy,
+                                              actionProxy,
+                                              &error,
+                                              "Track",
+                                              G_TYPE_UINT,
+                                              &track,
+                                              "TrackDuration",
+                                              G_TYPE_STRING,
+                                              &trackDuration,
+                                              "TrackMetaData",
+                                              G_TYPE_STRING,
+                                              &trackMetadata,
+                                              "TrackURI",
+                                              G_TYPE_STRING,
+                                              &trackUri,
+                                              "RelTime",
+                                              G_TYPE_STRING,
+                                              &relTime,
+                                              "AbsTime",
+                                              G_TYPE_STRING,
+                                              &absTime,
+                                              "RelCount",
+                                              G_TYPE_UINT,
+                                              &relCount,
+                                              "AbsCount",
+                                              G_TYPE_UINT,
+                                              &absCount,
+                                              NULL);
     if (error)
     {
         ERROR_PRINT("GetPositionInfo failed: " << error->code << ", " << error->message);
@@ -640,14 +671,14 @@ bool UpnpAVTransport::getPositionInfo(UpnpRequest *request, const map< string, s
     }
 
     GUPnPServiceProxyAction *actionProxy =
-        gupnp_service_proxy_begin_action (m_proxy,
-                                          "GetPositionInfo",
-                                          getPositionInfoCb,
-                                          (gpointer *) request,
-                                          "InstanceID",
-                                          G_TYPE_UINT,
-                                          instanceId,
-                                          NULL);
+        UpnpActionStats::beginAction (m_proxy,
+                                      "GetPositionInfo",
+                                      getPositionInfoCb,
+                                      (gpointer *) request,
+                                      "InstanceID",
+                                      G_TYPE_UINT,
+                                      instanceId,
+                                      NULL);
     if (NULL == actionProxy)
     {
         return false;
@@ -666,19 +697,19 @@ void UpnpAVTransport::getTransportInfoCb(GUPnPServiceProxy *proxy, GUPnPServiceP
 
     UpnpRequest *request = static_cast<UpnpRequest *> (userData);
 
-    bool status = gupnp_service_proxy_end_action (proxy,
-                                                  actionProxy,
-                                                  &error,
-                                                  "CurrentTransportState",
-                                                  G_TYPE_STRING,
-                                                  &transportState,
-                                                  "CurrentTransportStatus",
-                                                  G_TYPE_STRING,
-                                                  &transportStatus,
-                                                  "CurrentSpeed",
-                                                  G_TYPE_STRING,
-                                                  &speed,
-                                                  NULL);
+    bool status = UpnpActionStats::endAction (proxy,
+                                              actionProxy,
+                                              &error,
+                                              "CurrentTransportState",
+                                              G_TYPE_STRING,
+                                              &transportState,
+                                              "CurrentTransportStatus",
+                                              G_TYPE_STRING,
+                                              &transportStatus,
+                                              "CurrentSpeed",
+                                              G_TYPE_STRING,
+                                              &speed,
+                                              NULL);
     if (error)
     {
         ERROR_PRINT("GetTransportInfo failed: " << error->code << ", " << error->message);
@@ -728,14 +759,14 @@ bool UpnpAVTransport::getTransportInfo(UpnpRequest *request, const map< string,
     }
 
     GUPnPServiceProxyAction *actionProxy =
-        gupnp_service_proxy_begin_action (m_proxy,
-                                          "GetTransportInfo",
-                                          getTransportInfoCb,
-                                          (gpointer *) request,
-                                          "InstanceID",
-                                          G_TYPE_UINT,
-                                          instanceId,
-                                          NULL);
+        UpnpActionStats::beginAction (m_proxy,
+                                      "GetTransportInfo",
+                                      getTransportInfoCb,
+                                      (gpointer *) request,
+                                      "InstanceID",
+                                      G_TYPE_UINT,
+                                      instanceId,
+                                      NULL);
     if (NULL == actionProxy)
     {
         return false;
@@ -753,16 +784,16 @@ void UpnpAVTransport::getTransportSettingsCb(GUPnPServiceProxy *proxy, GUPnPServ
 
     UpnpRequest *request = static_cast<UpnpRequest *> (userData);
 
-    bool status = gupnp_service_proxy_end_action (proxy,
-                                                  actionProxy,
-                                                  &error,
-                                                  "PlayMode",
-                                                  G_TYPE_STRING,
-                                                  &playMode,
-                                                  "RecQualityMode",
-                                                  G_TYPE_STRING,
-                                                  &recQualityMode,
-                                                  NULL);
+    bool status = UpnpActionStats::endAction (proxy,
+                                              actionProxy,
+                                              &error,
+                                              "PlayMode",
+                                              G_TYPE_STRING,
+                                              &playMode,
+                                              "RecQualityMode",
+                                              G_TYPE_STRING,
+                                              &recQualityMode,
+                                              NULL);
     if (error)
     {
         ERROR_PRINT("GetTransportSettings failed: " << error->code << ", " << error->message);
@@ -809,14 +840,14 @@ bool UpnpAVTransport::getTransportSettings(UpnpRequest *request, const map< stri
     }
 
     GUPnPServiceProxyAction *actionProxy =
-        gupnp_service_proxy_begin_action (m_proxy,
-                                          "GetTransportSettings",
-                                          getTransportSettingsCb,
-                                          (gpointer *) request,
-                                          "InstanceID",
-                                          G_TYPE_UINT,
-                                          instanceId,
-                                          NULL);
+        UpnpActionStats::beginAction (m_proxy,
+                                      "GetTransportSettings",
+                                      getTransportSettingsCb,
+                                      (gpointer *) request,
+                                      "InstanceID",
+                                      G_TYPE_UINT,
+                                      instanceId,
+                                      NULL);
     if (NULL == actionProxy)
     {
         return false;
@@ -832,10 +863,10 @@ void UpnpAVTransport::setAvTransportUriCb(GUPnPServiceProxy *proxy, GUPnPService
 
     UpnpRequest *request = static_cast<UpnpRequest *> (userData);
 
-    bool status = gupnp_service_proxy_end_action (proxy,
-                                                  actionProxy,
-                                                  &error,
-                                                  NULL);
+    bool status = UpnpActionStats::endAction (proxy,
+                                              actionProxy,
+                                              &error,
+                                              NULL);
     if (error)
     {
         ERROR_PRINT("setAvTransportUri failed: " << error->code << ", " << error->message);
@@ -882,20 +913,20 @@ bool UpnpAVTransport::setAvTransportUri(UpnpRequest *request, RCSResourceAttribu
     }
 
     GUPnPServiceProxyAction *actionProxy =
-        gupnp_service_proxy_begin_action (m_proxy,
-                                          "SetAVTransportURI",
-                                          setAvTransportUriCb,
-                                          (gpointer *) request,
-                                          "InstanceID",
-                                          G_TYPE_UINT,
-                                          instanceId,
-                                          "CurrentURI",
-                                          G_TYPE_STRING,
-                                          currentUri.c_str(),
-                                          "CurrentURIMetaData",
-                                          G_TYPE_STRING,
-                                          currentUriMetadata.c_str(),
-                                          NULL);
+        UpnpActionStats::beginAction (m_proxy,
+                                      "SetAVTransportURI",
+                                      setAvTransportUriCb,
+                                      (gpointer *) request,
+                                      "InstanceID",
+                                      G_TYPE_UINT,
+                                      instanceId,
+                                      "CurrentURI",
+                                      G_TYPE_STRING,
+                                      currentUri.c_str(),
+                                      "CurrentURIMetaData",
+                                      G_TYPE_STRING,
+                                      currentUriMetadata.c_str(),
+                                      NULL);
     if (NULL == actionProxy)
     {
         return false;
@@ -912,10 +943,10 @@ void UpnpAVTransport::setNextAvTransportUriCb(GUPnPServiceProxy *proxy, GUPnPSer
 
     UpnpRequest *request = static_cast<UpnpRequest *> (userData);
 
-    bool status = gupnp_service_proxy_end_action (proxy,
-                                                  actionProxy,
-                                                  &error,
-                                                  NULL);
+    bool status = UpnpActionStats::endAction (proxy,
+                                              actionProxy,
+                                              &error,
+                                              NULL);
     if (error)
     {
         ERROR_PRINT("SetNextAvTransportUri failed: " << error->code << ", " << error->message);
@@ -962,20 +993,20 @@ bool UpnpAVTransport::setNextAvTransportUri(UpnpRequest *request, RCSResourceAtt
     }
 
     GUPnPServiceProxyAction *actionProxy =
-        gupnp_service_proxy_begin_action (m_proxy,
-                                          "SetNextAVTransportURI",
-                                          setNextAvTransportUriCb,
-                                          (gpointer *) request,
-                                          "InstanceID",
-                                          G_TYPE_UINT,
-                                          instanceId,
-                                          "NextURI",
-                                          G_TYPE_STRING,
-                                          nextUri.c_str(),
-                                          "NextURIMetaData",
-                                          G_TYPE_STRING,
-                                          nextUriMetadata.c_str(),
-                                          NULL);
+        UpnpActionStats::beginAction (m_proxy,
+                                      "SetNextAVTransportURI",
+                                      setNextAvTransportUriCb,
+                                      (gpointer *) request,
+                                      "InstanceID",
+                                      G_TYPE_UINT,
+                                      instanceId,
+                                      "NextURI",
+                                      G_TYPE_STRING,
+                                      nextUri.c_str(),
+                                      "NextURIMetaData",
+                                      G_TYPE_STRING,
+                                      nextUriMetadata.c_str(),
+                                      NULL);
     if (NULL == actionProxy)
     {
         return false;
@@ -992,10 +1023,10 @@ void UpnpAVTransport::setPlayModeCb(GUPnPServiceProxy *proxy, GUPnPServiceProxyA
 
     UpnpRequest *request = static_cast<UpnpRequest *> (userData);
 
-    bool status = gupnp_service_proxy_end_action (proxy,
-                                                  actionProxy,
-                                                  &error,
-                                                  NULL);
+    bool status = UpnpActionStats::endAction (proxy,
+                                              actionProxy,
+                                              &error,
+                                              NULL);
     if (error)
     {
         ERROR_PRINT("SetPlayMode failed: " << error->code << ", " << error->message);
@@ -1035,17 +1066,17 @@ bool UpnpAVTransport::setPlayMode(UpnpRequest *request, RCSResourceAttributes::V
     }
 
     GUPnPServiceProxyAction *actionProxy =
-        gupnp_service_proxy_begin_action (m_proxy,
-                                          "SetPlayMode",
-                                          setPlayModeCb,
-                                          (gpointer *) request,
-                                          "InstanceID",
-                                          G_TYPE_UINT,
-                                          instanceId,
-                                          "NewPlayMode",
-                                          G_TYPE_STRING,
-                                          newPlayMode.c_str(),
-                                          NULL);
+        UpnpActionStats::beginAction (m_proxy,
+                                      "SetPlayMode",
+                                      setPlayModeCb,
+                                      (gpointer *) request,
+                                      "InstanceID",
+                                      G_TYPE_UINT,
+                                      instanceId,
+                                      "NewPlayMode",
+                                      G_TYPE_STRING,
+                                      newPlayMode.c_str(),
+                                      NULL);
     if (NULL == actionProxy)
     {
         return false;
@@ -1062,10 +1093,10 @@ void UpnpAVTransport::nextCb(GUPnPServiceProxy *proxy, GUPnPServiceProxyAction *
 
     UpnpRequest *request = static_cast<UpnpRequest *> (userData);
 
-    bool status = gupnp_service_proxy_end_action (proxy,
-                                                  actionProxy,
-                                                  &error,
-                                                  NULL);
+    bool status = UpnpActionStats::endAction (proxy,
+                                              actionProxy,
+                                              &error,
+                                              NULL);
     if (error)
     {
         ERROR_PRINT("Next failed: " << error->code << ", " << error->message);
@@ -1100,14 +1131,14 @@ bool UpnpAVTransport::next(UpnpRequest *request, RCSResourceAttributes::Value *v
     }
 
     GUPnPServiceProxyAction *actionProxy =
-        gupnp_service_proxy_begin_action (m_proxy,
-                                          "Next",
-                                          nextCb,
-                                          (gpointer *) request,
-                                          "InstanceID",
-                                          G_TYPE_UINT,
-                                          instanceId,
-                                          NULL);
+        UpnpActionStats::beginAction (m_proxy,
+                                      "Next",
+                                      nextCb,
+                                      (gpointer *) request,
+                                      "InstanceID",
+                                      G_TYPE_UINT,
+                                      instanceId,
+                                      NULL);
     if (NULL == actionProxy)
     {
         return false;
@@ -1124,10 +1155,10 @@ void UpnpAVTransport::playCb(GUPnPServiceProxy *proxy, GUPnPServiceProxyAction *
 
     UpnpRequest *request = static_cast<UpnpRequest *> (userData);
 
-    bool status = gupnp_service_proxy_end_action (proxy,
-                                                  actionProxy,
-                                                  &error,
-                                                  NULL);
+    bool status = UpnpActionStats::endAction (proxy,
+                                              actionProxy,
+                                              &error,
+                                              NULL);
     if (error)
     {
         ERROR_PRINT("Play failed: " << error->code << ", " << error->message);
@@ -1169,17 +1200,17 @@ bool UpnpAVTransport::play(UpnpRequest *request, RCSResourceAttributes::Value *v
     }
 
     GUPnPServiceProxyAction *actionProxy =
-        gupnp_service_proxy_begin_action (m_proxy,
-                                          "Play",
-                                          playCb,
-                                          (gpointer *) request,
-                                          "InstanceID",
-                                          G_TYPE_UINT,
-                                          instanceId,
-                                          "Speed",
-                                          G_TYPE_STRING,
-                                          speed.c_str(),
-                                          NULL);
+        UpnpActionStats::beginAction (m_proxy,
+                                      "Play",
+                                      playCb,
+                                      (gpointer *) request,
+                                      "InstanceID",
+                                      G_TYPE_UINT,
+                                      instanceId,
+                                      "Speed",
+                                      G_TYPE_STRING,
+                                      speed.c_str(),
+                                      NULL);
     if (NULL == actionProxy)
     {
         return false;
@@ -1196,10 +1227,10 @@ void UpnpAVTransport::pauseCb(GUPnPServiceProxy *proxy, GUPnPServiceProxyAction
 
     UpnpRequest *request = static_cast<UpnpRequest *> (userData);
 
-    bool status = gupnp_service_proxy_end_action (proxy,
-                                                  actionProxy,
-                                                  &error,
-                                                  NULL);
+    bool status = UpnpActionStats::endAction (proxy,
+                                              actionProxy,
+                                              &error,
+                                              NULL);
     if (error)
     {
         ERROR_PRINT("Pause failed: " << error->code << ", " << error->message);
@@ -1234,14 +1265,14 @@ bool UpnpAVTransport::pause(UpnpRequest *request, RCSResourceAttributes::Value *
     }
 
     GUPnPServiceProxyAction *actionProxy =
-        gupnp_service_proxy_begin_action (m_proxy,
-                                          "Pause",
-                                          pauseCb,
-                                          (gpointer *) request,
-                                          "InstanceID",
-                                          G_TYPE_UINT,
-                                          instanceId,
-                                          NULL);
+        UpnpActionStats::beginAction (m_proxy,
+                                      "Pause",
+                                      pauseCb,
+                                      (gpointer *) request,
+                                      "InstanceID",
+                                      G_TYPE_UINT,
+                                      instanceId,
+                                      NULL);
     if (NULL == actionProxy)
     {
         return false;
@@ -1258,10 +1289,10 @@ void UpnpAVTransport::previousCb(GUPnPServiceProxy *proxy, GUPnPServiceProxyActi
 
     UpnpRequest *request = static_cast<UpnpRequest *> (userData);
 
-    bool status = gupnp_service_proxy_end_action (proxy,
-                                                  actionProxy,
-                                                  &error,
-                                                  NULL);
+    bool status = UpnpActionStats::endAction (proxy,
+                                              actionProxy,
+                                              &error,
+                                              NULL);
     if (error)
     {
         ERROR_PRINT("Previous failed: " << error->code << ", " << error->message);
@@ -1296,14 +1327,14 @@ bool UpnpAVTransport::previous(UpnpRequest *request, RCSResourceAttributes::Valu
     }
 
     GUPnPServiceProxyAction *actionProxy =
-        gupnp_service_proxy_begin_action (m_proxy,
-                                          "Previous",
-                                          previousCb,
-                                          (gpointer *) request,
-                                          "InstanceID",
-                                          G_TYPE_UINT,
-                                          instanceId,
-                                          NULL);
+        UpnpActionStats::beginAction (m_proxy,
+                                      "Previous",
+                                      previousCb,
+                                      (gpointer *) request,
+                                      "InstanceID",
+                                      G_TYPE_UINT,
+                                      instanceId,
+                                      NULL);
     if (NULL == actionProxy)
     {
         return false;
@@ -1320,10 +1351,10 @@ void UpnpAVTransport::seekCb(GUPnPServiceProxy *proxy, GUPnPServiceProxyAction *
 
     UpnpRequest *request = static_cast<UpnpRequest *> (userData);
 
-    bool status = gupnp_service_proxy_end_action (proxy,
-                                                  actionProxy,
-                                                  &error,
-                                                  NULL);
+    bool status = UpnpActionStats::endAction (proxy,
+                                              actionProxy,
+                                              &error,
+                                              NULL);
     if (error)
     {
         ERROR_PRINT("Seek failed: " << error->code << ", " << error->message);
@@ -1370,20 +1401,20 @@ bool UpnpAVTransport::seek(UpnpRequest *request, RCSResourceAttributes::Value *v
     }
 
     GUPnPServiceProxyAction *actionProxy =
-        gupnp_service_proxy_begin_action (m_proxy,
-                                          "Seek",
-                                          seekCb,
-                                          (gpointer *) request,
-                                          "InstanceID",
-                                          G_TYPE_UINT,
-                                          instanceId,
-                                          "Unit",
-                                          G_TYPE_STRING,
-                                          unit.c_str(),
-                                          "Target",
-                                          G_TYPE_STRING,
-                                          target.c_str(),
-                                          NULL);
+        UpnpActionStats::beginAction (m_proxy,
+                                      "Seek",
+                                      seekCb,
+                                      (gpointer *) request,
+                                      "InstanceID",
+                                      G_TYPE_UINT,
+                                      instanceId,
+                                      "Unit",
+                                      G_TYPE_STRING,
+                                      unit.c_str(),
+                                      "Target",
+                                      G_TYPE_STRING,
+                                      target.c_str(),
+                                      NULL);
     if (NULL == actionProxy)
     {
         return false;
@@ -1400,10 +1431,10 @@ void UpnpAVTransport::stopCb(GUPnPServiceProxy *proxy, GUPnPServiceProxyAction *
 
     UpnpRequest *request = static_cast<UpnpRequest *> (userData);
 
-    bool status = gupnp_service_proxy_end_action (proxy,
-                                                  actionProxy,
-                                                  &error,
-                                                  NULL);
+    bool status = UpnpActionStats::endAction (proxy,
+                                              actionProxy,
+                                              &error,
+                                              NULL);
     if (error)
     {
         ERROR_PRINT("Stop failed: " << error->code << ", " << error->message);
@@ -1438,14 +1469,14 @@ bool UpnpAVTransport::stop(UpnpRequest *request, RCSResourceAttributes::Value *v
     }
 
     GUPnPServiceProxyAction *actionProxy =
-        gupnp_service_proxy_begin_action (m_proxy,
-                                          "Stop",
-                                          stopCb,
-                                          (gpointer *) request,
-                                          "InstanceID",
-                                          G_TYPE_UINT,
-                                          instanceId,
-                                          NULL);
+        UpnpActionStats::beginAction (m_proxy,
+                                      "Stop",
+                                      stopCb,
+                                      (gpointer *) request,
+                                      "InstanceID",
+                                      G_TYPE_UINT,
+                                      instanceId,
+                                      NULL);
     if (NULL == actionProxy)
     {
         return false;
@@ -1464,7 +1495,7 @@ bool UpnpAVTransport::getAttributesRequest(UpnpRequest *request, const map< stri
     {
         DEBUG_PRINT(" \"" << it->first << "\"");
         // Check the request
-        if (!UpnpAttribute::isValidRequest(&m_attributeMap, it->first, UPNP_ACTION_GET))
+        if (!isGetRequested(request, it->first))
         {
             request->done++;
             continue;
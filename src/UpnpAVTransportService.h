@@ -45,6 +45,10 @@ class UpnpAVTransport: public UpnpService
         {
         }
 
+        // Queues a GetTransportInfo, which keeps the HTTP connection to
+        // the renderer open. Completed with endRequest.
+        UpnpRequest *beginWarmUp();
+
     private:
         static map< const string, UpnpAVTransport::GetAttributeHandler > GetAttributeActionMap;
         static map< const string, UpnpAVTransport::SetAttributeHandler > SetAttributeActionMap;
@@ -54,6 +58,8 @@ class UpnpAVTransport: public UpnpService
         bool getAttributesRequest(UpnpRequest *request, const map< string, string > &queryParams);
         bool setAttributesRequest(const RCSResourceAttributes &attrs, UpnpRequest *request, const map< string, string > &queryParams);
 
+        static bool startWarmUp(UpnpRequest *request);
+
         static void getCurrentTransportActionsCb(GUPnPServiceProxy *proxy, GUPnPServiceProxyAction *action, gpointer userData);
         bool getCurrentTransportActions(UpnpRequest *request, const map< string, string > &queryParams);
 
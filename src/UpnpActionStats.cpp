@@ -0,0 +1,328 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstring>
+#include <iomanip>
+
+#include "UpnpActionStats.h"
+#include "UpnpDeviceHealth.h"
+
+mutex UpnpActionStats::s_lock;
+map<string, UpnpActionStats *> UpnpActionStats::s_stats;
+
+static bool isActionBefore(const pair<const char *, UpnpActionStats *> &entry, const char *action)
+{
+    return strcmp(entry.first, action) < 0;
+}
+
+UpnpActionStats::UpnpActionStats(const string &udn, const string &serviceType, const string &action) :
+    m_udn(udn), m_serviceType(serviceType), m_action(action)
+{
+    m_success = 0;
+    m_soapFaults = 0;
+    m_timeouts = 0;
+}
+
+UpnpActionStats *UpnpActionStats::find(GUPnPServiceProxy *proxy, const char *action)
+{
+    const char *udn = gupnp_service_info_get_udn(GUPNP_SERVICE_INFO(proxy));
+    const char *serviceType = gupnp_service_info_get_service_type(GUPNP_SERVICE_INFO(proxy));
+    string key = string(udn ? udn : "") + " " + string(serviceType ? serviceType : "") + " " + action;
+
+    // Entries are never removed: the returned pointer stays valid
+    std::lock_guard< std::mutex > lock(s_lock);
+    UpnpActionStats *&stats = s_stats[key];
+    if (stats == nullptr)
+    {
+        stats = new UpnpActionStats(udn ? udn : "", serviceType ? serviceType : "", action);
+    }
+    return stats;
+}
+
+UpnpActionStats::ProxyStats *UpnpActionStats::getProxyStats(GUPnPServiceProxy *proxy)
+{
+    static const GQuark quark = g_quark_from_static_string("upnp-action-stats");
+
+    ProxyStats *proxyStats = static_cast<ProxyStats *> (g_object_get_qdata(G_OBJECT(proxy), quark));
+    if (proxyStats == nullptr)
+    {
+        proxyStats = new ProxyStats();
+        g_object_set_qdata_full(G_OBJECT(proxy), quark, proxyStats, deleteProxyStats);
+    }
+    return proxyStats;
+}
+
+void UpnpActionStats::deleteProxyStats(gpointer data)
+{
+    delete static_cast<ProxyStats *> (data);
+}
+
+UpnpActionStats *UpnpActionStats::lookup(ProxyStats *proxyStats, GUPnPServiceProxy *proxy,
+                                         const char *action)
+{
+    auto it = lower_bound(proxyStats->actions.begin(), proxyStats->actions.end(), action,
+                          isActionBefore);
+    if (it == proxyStats->actions.end() || strcmp(it->first, action) != 0)
+    {
+        UpnpActionStats *stats = find(proxy, action);
+        it = proxyStats->actions.insert(it, make_pair(stats->m_action.c_str(), stats));
+    }
+    return it->second;
+}
+
+bool UpnpActionStats::takePending(ProxyStats *proxyStats, GUPnPServiceProxyAction *action,
+                                  PendingAction *pending)
+{
+    vector< PendingAction > &actions = proxyStats->pending;
+
+    for (size_t i = 0; i < actions.size(); ++i)
+    {
+        if (actions[i].action == action)
+        {
+            *pending = actions[i];
+            actions[i] = actions.back();
+            actions.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+void UpnpActionStats::attach(GUPnPServiceProxy *proxy, GUPnPServiceIntrospection *introspection)
+{
+    ProxyStats *proxyStats = getProxyStats(proxy);
+    const GList *actionNames = gupnp_service_introspection_list_action_names(introspection);
+
+    for (const GList *l = actionNames; l != NULL; l = l->next)
+    {
+        lookup(proxyStats, proxy, static_cast<const char *> (l->data));
+    }
+}
+
+void UpnpActionStats::record(gint64 latency, const GError *error)
+{
+    m_latency.record((latency > 0) ? (uint64_t) latency : 0);
+
+    if (error == NULL)
+    {
+        m_success.fetch_add(1, std::memory_order_relaxed);
+    }
+    else if (error->domain == GUPNP_CONTROL_ERROR)
+    {
+        // UPnP error returned by the device
+        m_soapFaults.fetch_add(1, std::memory_order_relaxed);
+    }
+    else
+    {
+        m_timeouts.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void UpnpActionStats::record(GUPnPServiceProxy *proxy,
+                             const char *action,
+                             gint64 startTime,
+                             const GError *error)
+{
+    lookup(getProxyStats(proxy), proxy, action)->record(g_get_monotonic_time() - startTime, error);
+    UpnpDeviceHealth::record(proxy, error);
+}
+
+GUPnPServiceProxyAction *UpnpActionStats::beginAction(GUPnPServiceProxy *proxy,
+                                                      const char *action,
+                                                      GUPnPServiceProxyActionCallback callback,
+                                                      gpointer userData,
+                                                      ...)
+{
+    va_list args;
+    ProxyStats *proxyStats = getProxyStats(proxy);
+    UpnpActionStats *stats = lookup(proxyStats, proxy, action);
+    gint64 startTime = g_get_monotonic_time();
+
+    va_start(args, userData);
+    GUPnPServiceProxyAction *actionProxy =
+        gupnp_service_proxy_begin_action_valist(proxy, action, callback, userData, args);
+    va_end(args);
+
+    if (actionProxy != NULL)
+    {
+        proxyStats->pending.push_back({actionProxy, stats, startTime, userData});
+    }
+    return actionProxy;
+}
+
+gboolean UpnpActionStats::endAction(GUPnPServiceProxy *proxy,
+                                    GUPnPServiceProxyAction *action,
+                                    GError **error,
+                                    ...)
+{
+    va_list args;
+    PendingAction pending;
+    gint64 endTime = g_get_monotonic_time();
+    GError *localError = NULL;
+    bool found = takePending(getProxyStats(proxy), action, &pending);
+
+    if (error == NULL)
+    {
+        error = &localError;
+    }
+
+    va_start(args, error);
+    gboolean status = gupnp_service_proxy_end_action_valist(proxy, action, error, args);
+    va_end(args);
+
+    if (found)
+    {
+        pending.stats->record(endTime - pending.startTime, *error);
+    }
+    UpnpDeviceHealth::record(proxy, *error);
+
+    if (localError != NULL)
+    {
+        g_error_free(localError);
+    }
+    return status;
+}
+
+gboolean UpnpActionStats::sendAction(GUPnPServiceProxy *proxy,
+                                     const char *action,
+                                     GError **error,
+                                     ...)
+{
+    va_list args;
+    UpnpActionStats *stats = lookup(getProxyStats(proxy), proxy, action);
+    gint64 startTime = g_get_monotonic_time();
+    GError *localError = NULL;
+
+    if (error == NULL)
+    {
+        error = &localError;
+    }
+
+    va_start(args, error);
+    gboolean status = gupnp_service_proxy_send_action_valist(proxy, action, error, args);
+    va_end(args);
+
+    stats->record(g_get_monotonic_time() - startTime, *error);
+    UpnpDeviceHealth::record(proxy, *error);
+
+    if (localError != NULL)
+    {
+        g_error_free(localError);
+    }
+    return status;
+}
+
+void UpnpActionStats::cancelAction(GUPnPServiceProxy *proxy,
+                                   GUPnPServiceProxyAction *action)
+{
+    PendingAction pending;
+
+    if (!takePending(getProxyStats(proxy), action, &pending))
+    {
+        // Completed: the action has been freed by gupnp
+        return;
+    }
+    gupnp_service_proxy_cancel_action(proxy, action);
+}
+
+unsigned int UpnpActionStats::cancelActions(GUPnPServiceProxy *proxy,
+                                            gpointer userData)
+{
+    vector< PendingAction > &pending = getProxyStats(proxy)->pending;
+    gint64 endTime = g_get_monotonic_time();
+    unsigned int cancelled = 0;
+
+    for (size_t i = 0; i < pending.size();)
+    {
+        if (pending[i].userData == userData)
+        {
+            // gupnp has no request timeout: a hung device (half-open
+            // connection, sleeping radio) only shows here
+            gupnp_service_proxy_cancel_action(proxy, pending[i].action);
+            pending[i].stats->record(endTime - pending[i].startTime, getDeadlineError());
+            UpnpDeviceHealth::record(proxy, getDeadlineError());
+            pending[i] = pending.back();
+            pending.pop_back();
+            cancelled++;
+        }
+        else
+        {
+            ++i;
+        }
+    }
+    return cancelled;
+}
+
+const GError *UpnpActionStats::getDeadlineError()
+{
+    static const GError *error = g_error_new_literal(G_IO_ERROR, G_IO_ERROR_TIMED_OUT,
+                                                     "Request deadline passed");
+    return error;
+}
+
+vector<UpnpActionStats::Summary> UpnpActionStats::getSummaries()
+{
+    vector<Summary> summaries;
+    vector<UpnpActionStats *> stats;
+
+    {
+        std::lock_guard< std::mutex > lock(s_lock);
+        for (auto &entry : s_stats)
+        {
+            stats.push_back(entry.second);
+        }
+    }
+
+    for (auto pStats : stats)
+    {
+        Summary summary;
+
+        summary.udn = pStats->m_udn;
+        summary.serviceType = pStats->m_serviceType;
+        summary.action = pStats->m_action;
+        summary.success = pStats->m_success.load(std::memory_order_relaxed);
+        summary.soapFaults = pStats->m_soapFaults.load(std::memory_order_relaxed);
+        summary.timeouts = pStats->m_timeouts.load(std::memory_order_relaxed);
+        summary.latency = pStats->m_latency.getSnapshot();
+        summaries.push_back(summary);
+    }
+    return summaries;
+}
+
+void UpnpActionStats::dump(ostream &os)
+{
+    os << "UPnP action statistics (latency in ms)" << std::endl;
+    os << std::fixed << std::setprecision(1);
+
+    for (auto &summary : getSummaries())
+    {
+        os << summary.udn << " " << summary.serviceType << " " << summary.action <<
+           ": ok=" << summary.success <<
+           " fault=" << summary.soapFaults <<
+           " timeout=" << summary.timeouts <<
+           " mean=" << summary.latency.getMean() / 1000 <<
+           " p50=" << summary.latency.getPercentile(50) / 1000.0 <<
+           " p90=" << summary.latency.getPercentile(90) / 1000.0 <<
+           " p99=" << summary.latency.getPercentile(99) / 1000.0 <<
+           " max=" << summary.latency.max / 1000.0 << std::endl;
+    }
+}
@@ -16,6 +16,7 @@
 //-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
 
 #include "UpnpAttribute.h"
+#include "UpnpActionStats.h"
 
 using namespace std;
 
@@ -67,19 +68,19 @@ void UpnpAttribute::getCb(GUPnPServiceProxy *proxy,
     UpnpRequest *request = static_cast<UpnpRequest *> (userData);
     UpnpAttributeInfo *attrInfo;
 
-    std::map< GUPnPServiceProxyAction *, UpnpAttributeInfo *>::iterator it = request->proxyMap.find(actionProxy);
+    UpnpRequestBindings::iterator it = request->proxyMap.find(actionProxy);
 
     assert(it != request->proxyMap.end());
 
     attrInfo = it->second;
     DEBUG_PRINT(attrInfo->actions[0].varName);
-    bool status = gupnp_service_proxy_end_action (proxy,
-                                                  actionProxy,
-                                                  &error,
-                                                  attrInfo->actions[0].varName,
-                                                  attrInfo->actions[0].varType,
-                                                  &value.var_int64,
-                                                  NULL);
+    bool status = UpnpActionStats::endAction (proxy,
+                                              actionProxy,
+                                              &error,
+                                              attrInfo->actions[0].varName,
+                                              attrInfo->actions[0].varType,
+                                              &value.var_int64,
+                                              NULL);
 
     if (error)
     {
@@ -149,11 +150,11 @@ bool UpnpAttribute::get(GUPnPServiceProxy *serviceProxy,
                         UpnpAttributeInfo *attrInfo)
 {
     DEBUG_PRINT("");
-    GUPnPServiceProxyAction *actionProxy = gupnp_service_proxy_begin_action (serviceProxy,
-                                                                             attrInfo->actions[0].name,
-                                                                             getCb,
-                                                                             (gpointer *) request,
-                                                                             NULL);
+    GUPnPServiceProxyAction *actionProxy = UpnpActionStats::beginAction (serviceProxy,
+                                                                         attrInfo->actions[0].name,
+                                                                         getCb,
+                                                                         (gpointer *) request,
+                                                                         NULL);
     if (NULL == actionProxy)
     {
         return false;
@@ -172,10 +173,10 @@ void UpnpAttribute::setCb(GUPnPServiceProxy *proxy,
     GError *error = NULL;
     UpnpRequest *request = static_cast<UpnpRequest *> (userData);
 
-    bool status = gupnp_service_proxy_end_action (proxy,
-                                                  proxyAction,
-                                                  &error,
-                                                  NULL);
+    bool status = UpnpActionStats::endAction (proxy,
+                                              proxyAction,
+                                              &error,
+                                              NULL);
     if (error)
     {
         ERROR_PRINT("Set action failed: " << error->code << ", " << error->message);
@@ -242,24 +243,24 @@ bool UpnpAttribute::set(GUPnPServiceProxy *serviceProxy,
     if (string(attrInfo->actions[1].varName) == "")
     {
         DEBUG_PRINT("action (no args): " << attrInfo->actions[1].name);
-        actionProxy = gupnp_service_proxy_begin_action (serviceProxy,
-                                                        attrInfo->actions[1].name,
-                                                        setCb,
-                                                        (gpointer *) request,
-                                                        NULL);
+        actionProxy = UpnpActionStats::beginAction (serviceProxy,
+                                                    attrInfo->actions[1].name,
+                                                    setCb,
+                                                    (gpointer *) request,
+                                                    NULL);
     }
     else
     {
         DEBUG_PRINT("action: " << attrInfo->actions[1].name << "( " << attrInfo->actions[1].varName <<
                     " )");
-        actionProxy = gupnp_service_proxy_begin_action (serviceProxy,
-                                                        attrInfo->actions[1].name,
-                                                        setCb,
-                                                        (gpointer *) request,
-                                                        attrInfo->actions[1].varName,
-                                                        attrInfo->actions[1].varType,
-                                                        value.var_int64,
-                                                        NULL);
+        actionProxy = UpnpActionStats::beginAction (serviceProxy,
+                                                    attrInfo->actions[1].name,
+                                                    setCb,
+                                                    (gpointer *) request,
+                                                    attrInfo->actions[1].varName,
+                                                    attrInfo->actions[1].varType,
+                                                    value.var_int64,
+                                                    NULL);
     }
 
     if (NULL == actionProxy)
@@ -55,7 +55,12 @@ int UpnpBundleActivator::connectorDiscoveryCb(UpnpResource::Ptr pUpnpResource)
     result = m_pResourceContainer->registerResource(pUpnpResource);
     if (result == 0)
     {
+        std::lock_guard< std::mutex > lock(m_lock);
         m_vecResources.push_back(pUpnpResource);
+        for (auto &group : m_groups)
+        {
+            group->addMember(pUpnpResource);
+        }
     } else {
         ERROR_PRINT(result << " Failed to register resource: " << pUpnpResource->m_uri);
     }
@@ -68,6 +73,13 @@ int UpnpBundleActivator::connectorDiscoveryCb(UpnpResource::Ptr pUpnpResource)
  */
 void UpnpBundleActivator::connectorLostCb(UpnpResource::Ptr pUpnpResource)
 {
+    {
+        std::lock_guard< std::mutex > lock(m_lock);
+        for (auto &group : m_groups)
+        {
+            group->removeMember(pUpnpResource);
+        }
+    }
     destroyResource(pUpnpResource);
 }
 
@@ -82,31 +94,131 @@ void UpnpBundleActivator::activateBundle(ResourceContainerBundleAPI *resourceCon
                                          std::placeholders::_1);
 
     m_connector = new UpnpConnector(discoveryCb, lostCb);
+    UpnpConnector::setFilter(readFilter());
     m_connector->connect();
 }
 
+/*
+ The filter is taken from the resources of the bundle configuration with
+ <resourceType> UPNP_OIC_TYPE_FILTER, before any discovery: each <allow>
+ and <deny> property is a rule (see UpnpFilter).
+ */
+UpnpFilter UpnpBundleActivator::readFilter()
+{
+    UpnpFilter filter;
+    std::vector< resourceInfo > resources;
+
+    m_pResourceContainer->getResourceConfiguration(m_bundleId, &resources);
+    for (auto &resource : resources)
+    {
+        if (resource.resourceType != UPNP_OIC_TYPE_FILTER)
+        {
+            continue;
+        }
+
+        for (auto &property : resource.resourceProperty)
+        {
+            if (property.first != "allow" && property.first != "deny")
+            {
+                ERROR_PRINT("Unsupported filter property: " << property.first);
+                continue;
+            }
+            for (auto &rule : property.second)
+            {
+                filter.addRule(property.first == "allow", rule);
+            }
+        }
+    }
+    return filter;
+}
+
 void UpnpBundleActivator::deactivateBundle()
 {
     DEBUG_PRINT("");
-    std::vector< BundleResource::Ptr >::iterator itor;
-    for (itor = m_vecResources.begin(); itor != m_vecResources.end(); ++itor)
     {
-        DEBUG_PRINT((*itor)->m_uri);
-        m_pResourceContainer->unregisterResource(*itor);
+        std::lock_guard< std::mutex > lock(m_lock);
+        std::vector< BundleResource::Ptr >::iterator itor;
+        for (itor = m_vecResources.begin(); itor != m_vecResources.end(); ++itor)
+        {
+            DEBUG_PRINT((*itor)->m_uri);
+            m_pResourceContainer->unregisterResource(*itor);
+        }
+        m_vecResources.clear();
+        m_groups.clear();
     }
-    m_vecResources.clear();
     m_connector->disconnect();
     delete m_connector;
 }
 
+/*
+ This method gets called back from the container for the resources of the
+ bundle configuration. Groups are the only resources created this way:
+ <resourceType> is UPNP_OIC_TYPE_GROUP (binary switch and brightness
+ members) or UPNP_OIC_TYPE_AV_GROUP (AVTransport members) and each <member>
+ property holds the <uri> of a member resource.
+ */
 void UpnpBundleActivator::createResource(resourceInfo resourceInfo)
 {
+    if (resourceInfo.resourceType == UPNP_OIC_TYPE_FILTER)
+    {
+        // Applied on activation (see readFilter)
+        return;
+    }
 
+    if (resourceInfo.resourceType != UPNP_OIC_TYPE_GROUP &&
+        resourceInfo.resourceType != UPNP_OIC_TYPE_AV_GROUP)
+    {
+        ERROR_PRINT("Unsupported resource type: " << resourceInfo.resourceType);
+        return;
+    }
+
+    std::vector< std::string > memberUris;
+    auto members = resourceInfo.resourceProperty.find("member");
+    if (members != resourceInfo.resourceProperty.end())
+    {
+        for (auto &member : members->second)
+        {
+            auto uri = member.find("uri");
+            if (uri != member.end())
+            {
+                memberUris.push_back(uri->second);
+            }
+        }
+    }
+
+    UpnpGroup::Ptr pGroup;
+    if (resourceInfo.resourceType == UPNP_OIC_TYPE_AV_GROUP)
+    {
+        pGroup = std::make_shared< UpnpAVGroup >(resourceInfo.name, resourceInfo.uri, memberUris);
+    }
+    else
+    {
+        pGroup = std::make_shared< UpnpGroup >(resourceInfo.name, resourceInfo.uri, memberUris);
+    }
+    pGroup->m_bundleId = m_bundleId;
+
+    DEBUG_PRINT("UpnpGroup URI " << pGroup->m_uri << ", " << memberUris.size() << " members");
+    int result = m_pResourceContainer->registerResource(pGroup);
+    if (result != 0)
+    {
+        ERROR_PRINT(result << " Failed to register resource: " << pGroup->m_uri);
+        return;
+    }
+
+    std::lock_guard< std::mutex > lock(m_lock);
+    // Members discovered so far
+    for (auto &resource : m_vecResources)
+    {
+        pGroup->addMember(std::static_pointer_cast< UpnpResource >(resource));
+    }
+    m_vecResources.push_back(pGroup);
+    m_groups.push_back(pGroup);
 }
 
 void UpnpBundleActivator::destroyResource(BundleResource::Ptr pBundleResource)
 {
     DEBUG_PRINT(pBundleResource->m_uri);
+    std::lock_guard< std::mutex > lock(m_lock);
     std::vector< BundleResource::Ptr >::iterator itor;
     itor = std::find(m_vecResources.begin(), m_vecResources.end(), pBundleResource);
     if (itor != m_vecResources.end())
@@ -114,6 +226,12 @@ void UpnpBundleActivator::destroyResource(BundleResource::Ptr pBundleResource)
         m_pResourceContainer->unregisterResource(pBundleResource);
         m_vecResources.erase(itor);
     }
+
+    auto group = std::find(m_groups.begin(), m_groups.end(), pBundleResource);
+    if (group != m_groups.end())
+    {
+        m_groups.erase(group);
+    }
 }
 
 #define DLL_PUBLIC __attribute__((__visibility__("default")))
@@ -129,6 +247,7 @@ extern "C" DLL_PUBLIC void upnp_externalDeactivateBundle()
 {
     g_upnpBundle->deactivateBundle();
     delete g_upnpBundle;
+    UpnpLog::stop();
 }
 
 extern "C" DLL_PUBLIC void upnp_externalCreateResource(resourceInfo resourceInfo)
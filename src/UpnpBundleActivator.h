@@ -21,11 +21,16 @@
 #ifndef UPNPBUNDLEACTIVATOR_H_
 #define UPNPBUNDLEACTIVATOR_H_
 
+#include <mutex>
+
 #include <BundleActivator.h>
 #include <BundleResource.h>
 #include <ResourceContainerBundleAPI.h>
 
+#include "UpnpAVGroup.h"
 #include "UpnpConnector.h"
+#include "UpnpFilter.h"
+#include "UpnpGroup.h"
 #include "UpnpManager.h"
 #include "BundleResource.h"
 
@@ -45,11 +50,15 @@ class UpnpBundleActivator: public BundleActivator
         std::string m_bundleId;
         ResourceContainerBundleAPI *m_pResourceContainer;
         std::vector< BundleResource::Ptr > m_vecResources;
+        // Bridge hosted groups, created from the resource configuration
+        std::vector< UpnpGroup::Ptr > m_groups;
+        std::mutex m_lock;
 
         UpnpConnector *m_connector;
 
         int connectorDiscoveryCb(UpnpResource::Ptr pBundleResource);
         void connectorLostCb(UpnpResource::Ptr pBundleResource);
+        UpnpFilter readFilter();
 
 };
 
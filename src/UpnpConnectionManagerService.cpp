@@ -19,6 +19,7 @@
 //-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
 
 #include "UpnpConnectionManagerService.h"
+#include "UpnpActionStats.h"
 
 using namespace OIC::Service;
 
@@ -93,7 +94,7 @@ void UpnpConnectionManager::getProtocolInfoCb(GUPnPServiceProxy *proxy,
 
     UpnpRequest *request = static_cast<UpnpRequest *> (userData);
 
-    bool status = gupnp_service_proxy_end_action (proxy,
+    bool status = UpnpActionStats::endAction (proxy,
                   actionProxy,
                   &error,
                   "Source",
@@ -130,7 +131,7 @@ void UpnpConnectionManager::getProtocolInfoCb(GUPnPServiceProxy *proxy,
 bool UpnpConnectionManager::getProtocolInfo(UpnpRequest *request, const map< string, string > &queryParams)
 {
     DEBUG_PRINT("");
-    GUPnPServiceProxyAction *actionProxy = gupnp_service_proxy_begin_action (m_proxy,
+    GUPnPServiceProxyAction *actionProxy = UpnpActionStats::beginAction (m_proxy,
                                            "GetProtocolInfo",
                                            getProtocolInfoCb,
                                            (gpointer *) request,
@@ -157,31 +158,31 @@ void UpnpConnectionManager::getCurrentConnectionInfoCb(GUPnPServiceProxy *proxy,
 
     UpnpRequest *request = static_cast<UpnpRequest *> (userData);
 
-    bool status = gupnp_service_proxy_end_action (proxy,
-                                                  actionProxy,
-                                                  &error,
-                                                  "RcsID",
-                                                  G_TYPE_UINT,
-                                                  &rcsId,
-                                                  "AVTransportID",
-                                                  G_TYPE_UINT,
-                                                  &avTransportId,
-                                                  "ProtocolInfo",
-                                                  G_TYPE_STRING,
-                                                  &protocolInfo,
-                                                  "PeerConnectionManager",
-                                                  G_TYPE_STRING,
-                                                  &peerConnectionManager,
-                                                  "PeerConnectionID",
-                                                  G_TYPE_UINT,
-                                                  &peerConnectionId,
-                                                  "Direction",
-                                                  G_TYPE_STRING,
-                                                  &direction,
-                                                  "Status",
-                                                  G_TYPE_STRING,
-                                                  &connectionStatus,
-                                                  NULL);
+    bool status = UpnpActionStats::endAction (proxy,
+                                              actionProxy,
+                                              &error,
+                                              "RcsID",
+                                              G_TYPE_UINT,
+                                              &rcsId,
+                                              "AVTransportID",
+                                              G_TYPE_UINT,
+                                              &avTransportId,
+                                              "ProtocolInfo",
+                                              G_TYPE_STRING,
+                                              &protocolInfo,
+                                              "PeerConnectionManager",
+                                              G_TYPE_STRING,
+                                              &peerConnectionManager,
+                                              "PeerConnectionID",
+                                              G_TYPE_UINT,
+                                              &peerConnectionId,
+                                              "Direction",
+                                              G_TYPE_STRING,
+                                              &direction,
+                                              "Status",
+                                              G_TYPE_STRING,
+                                              &connectionStatus,
+                                              NULL);
     if (error)
     {
         ERROR_PRINT("GetCurrentConnectionInfo failed: " << error->code << ", " << error->message);
@@ -240,14 +241,14 @@ bool UpnpConnectionManager::getCurrentConnectionInfo(UpnpRequest *request, const
     }
 
     GUPnPServiceProxyAction *actionProxy =
-        gupnp_service_proxy_begin_action (m_proxy,
-                                          "GetCurrentConnectionInfo",
-                                          getCurrentConnectionInfoCb,
-                                          (gpointer *) request,
-                                          "ConnectionID",
-                                          G_TYPE_UINT,
-                                          connectionId,
-                                          NULL);
+        UpnpActionStats::beginAction (m_proxy,
+                                      "GetCurrentConnectionInfo",
+                                      getCurrentConnectionInfoCb,
+                                      (gpointer *) request,
+                                      "ConnectionID",
+                                      G_TYPE_UINT,
+                                      connectionId,
+                                      NULL);
     if (NULL == actionProxy)
     {
         return false;
@@ -266,7 +267,7 @@ bool UpnpConnectionManager::getAttributesRequest(UpnpRequest *request,
     {
         DEBUG_PRINT(" \"" << it->first << "\"");
         // Check the request
-        if (!UpnpAttribute::isValidRequest(&m_attributeMap, it->first, UPNP_ACTION_GET))
+        if (!isGetRequested(request, it->first))
         {
             request->done++;
             continue;
@@ -19,8 +19,9 @@
 //-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
 
 #include <string.h>
+#include <stdlib.h>
 #include <iostream>
-#include <future>
+#include <sstream>
 #include <glib.h>
 #include <glib-object.h>
 #include <gssdp.h>
@@ -30,10 +31,15 @@
 
 #include <UpnpConstants.h>
 
+#include "UpnpActionStats.h"
 #include "UpnpConnector.h"
+#include "UpnpDeviceHealth.h"
 #include "UpnpException.h"
+#include "UpnpHelper.h"
 #include "UpnpInternal.h"
+#include "UpnpPoller.h"
 #include "UpnpRequest.h"
+#include "UpnpRequestScheduler.h"
 
 using namespace std;
 using namespace boost;
@@ -44,14 +50,41 @@ static const string MODULE = "UpnpConnector";
 static UpnpConnector::DiscoveryCallback s_discoveryCallback;
 static UpnpConnector::LostCallback s_lostCallback;
 
-static GMainLoop *s_mainLoop;
-static GMainContext *s_mainContext;
-static GUPnPContextManager *s_contextManager;
-static UpnpManager *s_manager;
-static UpnpRequestState s_requestState;
-static map <gulong, GUPnPControlPoint *> s_signalMap;
-
-static bool isRootDiscovery[] = {false, true};
+static std::mutex s_callbackLock;
+
+// Number of GLib loop threads, overridden by UPNP_EVENT_LOOPS. Every shard
+// opens SSDP sockets on each network interface (see Shard), hence the cap.
+static const unsigned int EVENT_LOOPS = 1;
+static const unsigned int MAX_EVENT_LOOPS = 8;
+
+// Period (seconds) of the action statistics dump, overridden by
+// UPNP_STATS_DUMP_INTERVAL (0 disables the dump)
+static const guint ACTION_STATS_DUMP_INTERVAL = 60;
+static GSource *s_statsDumpSource;
+
+// Time (ms) a GET/SET may take before its actions are cancelled, overridden
+// by UPNP_REQUEST_TIMEOUT (0 disables the deadline) or per request by the
+// "to" query param
+static const gint64 REQUEST_TIMEOUT = 30000;
+
+// Requests outstanding (queued or in progress) at once, in total and per
+// device, overridden by UPNP_MAX_REQUESTS and UPNP_MAX_DEVICE_REQUESTS
+// (0: unlimited). Requests past the limits fail right away.
+static const unsigned int MAX_REQUESTS = 256;
+static const unsigned int MAX_DEVICE_REQUESTS = 32;
+
+// Time (ms) the contexts on the preferred interface (UPNP_PREFERRED_INTERFACE)
+// get to claim a device first announced on another interface
+static const guint PREFERRED_GRACE = 3000;
+
+vector <UpnpConnector::Shard *> UpnpConnector::s_shards;
+UpnpConnector::DiscoveryMode UpnpConnector::s_discoveryMode = UpnpConnector::DISCOVERY_ALL;
+bool UpnpConnector::s_lazyIntrospection = false;
+string UpnpConnector::s_preferredInterface;
+UpnpFilter UpnpConnector::s_filter;
+std::mutex UpnpConnector::s_ownersLock;
+std::map <std::string, UpnpConnector::Owner> UpnpConnector::s_owners;
+std::mutex UpnpConnector::s_browsersLock;
 
 UpnpConnector::UpnpConnector(DiscoveryCallback discoveryCallback, LostCallback lostCallback)
 {
@@ -62,190 +95,921 @@ UpnpConnector::UpnpConnector(DiscoveryCallback discoveryCallback, LostCallback l
 
     s_discoveryCallback = m_discoveryCallback;
     s_lostCallback = m_lostCallback;
-    s_manager = new UpnpManager();
-    s_signalMap.clear();
 }
 
 UpnpConnector::~UpnpConnector()
 {
     DEBUG_PRINT("");
-    s_signalMap.clear();
-    delete s_manager;
-    s_manager = NULL;
 }
 
 void UpnpConnector::disconnect()
 {
     DEBUG_PRINT("");
 
-    if (!s_mainLoop)
+    if (s_shards.empty())
     {
         DEBUG_PRINT("Already disconnected");
         return;
     }
 
-    std::promise< bool > promise;
-    UpnpRequest request;
-    request.done = 0;
-    request.expected = 0;
+    // Stop all the shards, then wait for their threads to exit
+    vector< UpnpRequest * > requests(s_shards.size());
+    for (size_t i = 0; i < s_shards.size(); ++i)
     {
-        std::lock_guard< std::mutex > lock(s_requestState.queueLock);
-        request.start = [&] ()
-        {
-            s_manager->stop();
-            gupnpStop();
-            return true;
-        };
-        request.finish = [&] (bool status) { promise.set_value(true); };
-        s_requestState.requestQueue.push(&request);
+        Shard *shard = s_shards[i];
+        UpnpRequest *request = UpnpRequest::acquire();
 
-        if (s_requestState.sourceId == 0)
-        {
-            s_requestState.sourceId = g_source_attach(s_requestState.source, s_mainContext);
-            DEBUG_PRINT("sourceId: " << s_requestState.sourceId << "context: " << s_mainContext);
-        }
+        request->handler = stopShard;
+        request->data = shard;
+        requests[i] = request;
 
+        shard->requestState.scheduler->push(request);
+    }
+
+    for (size_t i = 0; i < s_shards.size(); ++i)
+    {
+        Shard *shard = s_shards[i];
+
+        requests[i]->wait();
+        UpnpRequest::release(requests[i]);
+        shard->thread.join();
+        delete shard->manager;
+        delete shard->requestState.scheduler;
+        delete shard;
     }
-    promise.get_future().get();
+    s_shards.clear();
 }
 
-void UpnpConnector::gupnpStop()
+bool UpnpConnector::stopShard(UpnpRequest *request)
 {
-    DEBUG_PRINT("");
-    g_source_unref(s_requestState.source);
-    g_source_destroy(s_requestState.source);
-    s_requestState.sourceId = 0;
+    Shard *shard = static_cast<Shard *> (request->data);
+
+    shard->manager->stop();
+    gupnpStop(shard);
+    return true;
+}
+
+void UpnpConnector::gupnpStop(Shard *shard)
+{
+    DEBUG_PRINT(shard->index);
+    // The requests still queued fail
+    shard->requestState.scheduler->stop();
+
+    if (shard->index == 0 && s_statsDumpSource != NULL)
+    {
+        g_source_destroy(s_statsDumpSource);
+        g_source_unref(s_statsDumpSource);
+        s_statsDumpSource = NULL;
+    }
 
-    for (auto it : s_signalMap)
+    {
+        // Nothing is forwarded to the shard past this point
+        std::lock_guard< std::mutex > lock(s_browsersLock);
+        shard->browsers.clear();
+    }
+    shard->forwarded.clear();
+
+    for (auto it : shard->signalMap)
     {
         g_signal_handler_disconnect (it.second, it.first);
     }
+    shard->signalMap.clear();
+
+    for (auto &entry : shard->ownedProxies)
+    {
+        for (auto proxy : entry.second)
+        {
+            g_object_unref(proxy);
+        }
+    }
+    shard->ownedProxies.clear();
+
+    for (auto &entry : shard->introspections)
+    {
+        g_cancellable_cancel(entry.second);
+        g_object_unref(entry.second);
+    }
+    shard->introspections.clear();
 
-    g_object_unref(s_contextManager);
-    g_main_loop_quit(s_mainLoop);
-    g_main_loop_unref(s_mainLoop);
-    s_mainLoop = NULL;
+    delete shard->requestState.subscriptions;
+    shard->requestState.subscriptions = NULL;
+    delete shard->requestState.poller;
+    shard->requestState.poller = NULL;
+
+    releaseShard(shard);
+
+    g_object_unref(shard->contextManager);
+    g_main_loop_quit(shard->loop);
 }
 
 void UpnpConnector::connect()
 {
-    std::thread discoveryThread(&UpnpConnector::gupnpStart, this);
-    discoveryThread.detach();
+    gupnpStart();
 }
 
-void UpnpConnector::startDiscovery(GUPnPControlPoint *controlPoint)
+void UpnpConnector::setFilter(const UpnpFilter &filter)
+{
+    s_filter = filter;
+}
+
+void UpnpConnector::startDiscovery(Shard *shard, GUPnPControlPoint *controlPoint)
 {
     gulong instanceId;
 
     // the 'device-proxy-unavailable' signal is sent when any devices are lost
     instanceId = g_signal_connect(controlPoint, "device-proxy-unavailable",
-                                  G_CALLBACK (&UpnpConnector::onDeviceProxyUnavailable), NULL);
-    s_signalMap[instanceId] = controlPoint;
+                                  G_CALLBACK (&UpnpConnector::onDeviceProxyUnavailable), shard);
+    shard->signalMap[instanceId] = controlPoint;
 
     // the 'device-proxy-available' signal is sent when any devices are found
     instanceId = g_signal_connect(controlPoint, "device-proxy-available",
-                                  G_CALLBACK (&UpnpConnector::onDeviceProxyAvailable), (gpointer *) (&isRootDiscovery[0]));
-    s_signalMap[instanceId] = controlPoint;
+                                  G_CALLBACK (&UpnpConnector::onDeviceProxyAvailable), &shard->allDiscovery);
+    shard->signalMap[instanceId] = controlPoint;
 
     // the 'service-proxy-unavailable' signal is sent when any services are lost
     instanceId = g_signal_connect(controlPoint, "service-proxy-unavailable",
-                                  G_CALLBACK (&UpnpConnector::onServiceProxyUnavailable), NULL);
-    s_signalMap[instanceId] = controlPoint;
+                                  G_CALLBACK (&UpnpConnector::onServiceProxyUnavailable), shard);
+    shard->signalMap[instanceId] = controlPoint;
 
     // the 'service-proxy-available' signal is sent when any services are found
     instanceId = g_signal_connect(controlPoint, "service-proxy-available",
-                                  G_CALLBACK (&UpnpConnector::onServiceProxyAvailable), NULL);
-    s_signalMap[instanceId] = controlPoint;
+                                  G_CALLBACK (&UpnpConnector::onServiceProxyAvailable), shard);
+    shard->signalMap[instanceId] = controlPoint;
+
+    // tell the control point to start searching (see forward for the
+    // other shards)
+    if (shard->index == 0)
+    {
+        gssdp_resource_browser_set_active(GSSDP_RESOURCE_BROWSER(controlPoint), true);
+    }
+}
+
+void UpnpConnector::startTargetedDiscovery(Shard *shard, GUPnPContext *context,
+        GUPnPControlPoint *controlPoint)
+{
+    gulong instanceId;
+
+    instanceId = g_signal_connect(controlPoint, "resource-available",
+                                  G_CALLBACK (&UpnpConnector::onResourceAvailable), shard);
+    shard->signalMap[instanceId] = controlPoint;
+
+    instanceId = g_signal_connect(controlPoint, "resource-unavailable",
+                                  G_CALLBACK (&UpnpConnector::onResourceUnavailable), shard);
+    shard->signalMap[instanceId] = controlPoint;
+
+    // the 'device-proxy-unavailable' signal is sent when any devices are lost
+    instanceId = g_signal_connect(controlPoint, "device-proxy-unavailable",
+                                  G_CALLBACK (&UpnpConnector::onDeviceProxyUnavailable), shard);
+    shard->signalMap[instanceId] = controlPoint;
+
+    // the 'device-proxy-available' signal is sent when any devices are found,
+    // embedded devices and services are taken from their description
+    instanceId = g_signal_connect(controlPoint, "device-proxy-available",
+                                  G_CALLBACK (&UpnpConnector::onDeviceProxyAvailable), &shard->rootDiscovery);
+    shard->signalMap[instanceId] = controlPoint;
+
+    // The other shards get the announcements from the first one
+    if (shard->index != 0)
+    {
+        return;
+    }
+
+    if (s_discoveryMode == DISCOVERY_PASSIVE)
+    {
+        // Wait for a device of this type to announce itself before searching
+        // (disconnected when the control point goes away)
+        g_signal_connect_object(context, "message-received",
+                                G_CALLBACK (&UpnpConnector::onMessageReceived), controlPoint,
+                                (GConnectFlags) 0);
+    }
+    else
+    {
+        // tell the control point to start searching
+        gssdp_resource_browser_set_active(GSSDP_RESOURCE_BROWSER(controlPoint), true);
+    }
+}
+
+// Walks the description of a device discovered by a targeted control point:
+// the embedded devices and services of supported types are processed as
+// if they had been discovered, the others are dropped before their SCPD
+// is fetched.
+void UpnpConnector::discoverDeviceTree(Shard *shard, GUPnPDeviceInfo *deviceInfo)
+{
+    const string udn = gupnp_device_info_get_udn(deviceInfo);
+    vector <gpointer> &owned = shard->ownedProxies[udn];
+
+    GList *childService = gupnp_device_info_list_services(deviceInfo);
+    while (childService)
+    {
+        GUPnPServiceInfo *serviceInfo = GUPNP_SERVICE_INFO (childService->data);
+
+        if (findResourceType(gupnp_service_info_get_service_type(serviceInfo)).empty() ||
+            !isAccepted(serviceInfo))
+        {
+            g_object_unref(childService->data);
+        }
+        else
+        {
+            // The service proxy must stay valid while the service is in use
+            owned.push_back(childService->data);
+            onServiceProxyAvailable(NULL, GUPNP_SERVICE_PROXY(serviceInfo), shard);
+        }
+        childService = g_list_delete_link(childService, childService);
+    }
+
+    GList *childDev = gupnp_device_info_list_devices(deviceInfo);
+    while (childDev)
+    {
+        GUPnPDeviceInfo *childInfo = GUPNP_DEVICE_INFO (childDev->data);
+
+        if (findResourceType(gupnp_device_info_get_device_type(childInfo)).empty() ||
+            !isAccepted(childInfo))
+        {
+            g_object_unref(childDev->data);
+        }
+        else
+        {
+            owned.push_back(childDev->data);
+            onDeviceProxyAvailable(NULL, GUPNP_DEVICE_PROXY(childInfo), &shard->allDiscovery);
+        }
+        childDev = g_list_delete_link(childDev, childDev);
+    }
+}
 
-    // tell the control point to start searching
-    gssdp_resource_browser_set_active(GSSDP_RESOURCE_BROWSER(controlPoint), true);
+void UpnpConnector::releaseProxies(Shard *shard, string udn)
+{
+    auto it = shard->ownedProxies.find(udn);
+
+    if (it != shard->ownedProxies.end())
+    {
+        for (auto proxy : it->second)
+        {
+            cancelIntrospection(shard, static_cast<GUPnPServiceProxy *> (proxy));
+            g_object_unref(proxy);
+        }
+        shard->ownedProxies.erase(it);
+    }
+}
+
+void UpnpConnector::cancelIntrospection(Shard *shard, GUPnPServiceProxy *proxy)
+{
+    auto it = shard->introspections.find(proxy);
+
+    if (it != shard->introspections.end())
+    {
+        // The callback is invoked with G_IO_ERROR_CANCELLED, erase first
+        GCancellable *cancellable = it->second;
+        shard->introspections.erase(it);
+        g_cancellable_cancel(cancellable);
+        g_object_unref(cancellable);
+    }
+}
+
+// Checks a device against the filter once its description is fetched:
+// all the fields are known, the missing ones are empty
+bool UpnpConnector::isAccepted(GUPnPDeviceInfo *deviceInfo)
+{
+    if (s_filter.isEmpty())
+    {
+        return true;
+    }
+
+    UpnpFilter::Subject subject = {};
+    char *manufacturer = gupnp_device_info_get_manufacturer(deviceInfo);
+    char *model = gupnp_device_info_get_model_name(deviceInfo);
+    GUPnPContext *context = gupnp_device_info_get_context(deviceInfo);
+
+    subject.fields[UpnpFilter::FIELD_UDN] = gupnp_device_info_get_udn(deviceInfo);
+    subject.fields[UpnpFilter::FIELD_DEVICE_TYPE] = gupnp_device_info_get_device_type(deviceInfo);
+    subject.fields[UpnpFilter::FIELD_MANUFACTURER] = (manufacturer != NULL) ? manufacturer : "";
+    subject.fields[UpnpFilter::FIELD_MODEL] = (model != NULL) ? model : "";
+    subject.fields[UpnpFilter::FIELD_INTERFACE] = gssdp_client_get_interface(GSSDP_CLIENT(context));
+    bool accepted = s_filter.accepts(subject);
+
+    g_free(manufacturer);
+    g_free(model);
+    return accepted;
+}
+
+// Checks a service against the filter before its SCPD is fetched, the
+// hosting device has been checked already
+bool UpnpConnector::isAccepted(GUPnPServiceInfo *serviceInfo)
+{
+    if (s_filter.isEmpty())
+    {
+        return true;
+    }
+
+    UpnpFilter::Subject subject = {};
+    GUPnPContext *context = gupnp_service_info_get_context(serviceInfo);
+
+    subject.fields[UpnpFilter::FIELD_UDN] = gupnp_service_info_get_udn(serviceInfo);
+    subject.fields[UpnpFilter::FIELD_SERVICE_TYPE] = gupnp_service_info_get_service_type(serviceInfo);
+    subject.fields[UpnpFilter::FIELD_INTERFACE] = gssdp_client_get_interface(GSSDP_CLIENT(context));
+    return s_filter.accepts(subject);
 }
 
 void UpnpConnector::gupnpStart()
 {
     DEBUG_PRINT("");
-    if (s_mainLoop)
+    if (!s_shards.empty())
     {
         DEBUG_PRINT("Don't start UPnP discovery twice!");
         return;
     }
 
+    unsigned int eventLoops = EVENT_LOOPS;
+    const char *env = getenv("UPNP_EVENT_LOOPS");
+    if (env != NULL)
+    {
+        eventLoops = (unsigned int) strtoul(env, NULL, 10);
+        eventLoops = std::max(1u, std::min(eventLoops, MAX_EVENT_LOOPS));
+    }
+
+    // Discovery mode: "all" (default), or "targeted" / "passive", which only
+    // find the root device types of UpnpSearchTargetMap
+    const char *mode = getenv("UPNP_DISCOVERY_MODE");
+    if (mode != NULL)
+    {
+        if (strcmp(mode, "all") == 0)
+        {
+            s_discoveryMode = DISCOVERY_ALL;
+        }
+        else if (strcmp(mode, "targeted") == 0)
+        {
+            s_discoveryMode = DISCOVERY_TARGETED;
+        }
+        else if (strcmp(mode, "passive") == 0)
+        {
+            s_discoveryMode = DISCOVERY_PASSIVE;
+        }
+        else
+        {
+            ERROR_PRINT("Unknown discovery mode " << mode);
+        }
+    }
+
+    const char *lazy = getenv("UPNP_LAZY_INTROSPECTION");
+    s_lazyIntrospection = (lazy != NULL && strcmp(lazy, "0") != 0);
+
+    // Network interface to handle the devices through when reachable
+    // through several (see claim)
+    const char *preferred = getenv("UPNP_PREFERRED_INTERFACE");
+    if (preferred != NULL)
+    {
+        s_preferredInterface = preferred;
+    }
+
+    gint64 requestTimeout = REQUEST_TIMEOUT;
+    const char *timeout = getenv("UPNP_REQUEST_TIMEOUT");
+    if (timeout != NULL)
+    {
+        requestTimeout = (gint64) strtoul(timeout, NULL, 10);
+    }
+
+    unsigned int maxRequests = MAX_REQUESTS;
+    env = getenv("UPNP_MAX_REQUESTS");
+    if (env != NULL)
+    {
+        maxRequests = (unsigned int) strtoul(env, NULL, 10);
+    }
+    unsigned int maxDeviceRequests = MAX_DEVICE_REQUESTS;
+    env = getenv("UPNP_MAX_DEVICE_REQUESTS");
+    if (env != NULL)
+    {
+        maxDeviceRequests = (unsigned int) strtoul(env, NULL, 10);
+    }
+    UpnpRequestScheduler::setLimits(maxRequests, maxDeviceRequests);
+
+    // Polling of the attributes that are not evented: off unless enabled
+    const char *poll = getenv("UPNP_POLLING");
+    bool polling = (poll != NULL && strcmp(poll, "0") != 0);
+
+    // Priorities of the request classes: "weighted" (default) or "strict"
+    UpnpRequestScheduler::Policy policy = UpnpRequestScheduler::POLICY_WEIGHTED;
+    const char *scheduling = getenv("UPNP_SCHEDULER_POLICY");
+    if (scheduling != NULL)
+    {
+        if (strcmp(scheduling, "strict") == 0)
+        {
+            policy = UpnpRequestScheduler::POLICY_STRICT;
+        }
+        else if (strcmp(scheduling, "weighted") != 0)
+        {
+            ERROR_PRINT("Unknown scheduler policy " << scheduling);
+        }
+    }
+
+    for (unsigned int i = 0; i < eventLoops; ++i)
+    {
+        Shard *shard = new Shard();
+
+        shard->index = i;
+        shard->manager = new UpnpManager();
+        shard->rootDiscovery = {shard, true};
+        shard->allDiscovery = {shard, false};
+
+        // The first shard keeps the default context
+        shard->context = (i == 0) ? g_main_context_ref(g_main_context_default()) : g_main_context_new();
+        shard->loop = g_main_loop_new(shard->context, false);
+        shard->requestState.context = shard->context;
+        shard->requestState.scheduler = new UpnpRequestScheduler(shard->context, policy);
+        shard->requestState.requestTimeout = requestTimeout;
+        shard->requestState.subscriptions = new UpnpSubscriptionManager(shard->context);
+        shard->requestState.poller = new UpnpPoller(shard->context, polling);
+
+        s_shards.push_back(shard);
+    }
+
+    for (auto shard : s_shards)
+    {
+        shard->thread = std::thread(&UpnpConnector::runShard, shard);
+    }
+}
+
+void UpnpConnector::runShard(Shard *shard)
+{
+    // gupnp and libsoup attach their sources (SSDP sockets, HTTP, GENA)
+    // to the thread default context of the thread creating the contexts
+    g_main_context_push_thread_default(shard->context);
+
     // create a new gupnp context manager
-    s_contextManager = gupnp_context_manager_create(0);
+    shard->contextManager = gupnp_context_manager_create(0);
+
+    g_signal_connect(shard->contextManager, "context-available",
+                     G_CALLBACK(&UpnpConnector::onContextAvailable), shard);
+    g_signal_connect(shard->contextManager, "context-unavailable",
+                     G_CALLBACK(&UpnpConnector::onContextUnavailable), shard);
+
+    DEBUG_PRINT("UPnP main loop " << shard->index << " starting... (" << std::this_thread::get_id() << ")");
+    DEBUG_PRINT("main context" << shard->context);
+
+    if (shard->index == 0)
+    {
+        initActionStatsDump(shard);
+    }
+    g_main_loop_run(shard->loop);
+
+    g_main_context_pop_thread_default(shard->context);
+    g_main_loop_unref(shard->loop);
+    g_main_context_unref(shard->context);
+}
+
+void UpnpConnector::initActionStatsDump(Shard *shard)
+{
+    guint interval = ACTION_STATS_DUMP_INTERVAL;
+    const char *env = getenv("UPNP_STATS_DUMP_INTERVAL");
+
+    if (env != NULL)
+    {
+        interval = (guint) strtoul(env, NULL, 10);
+    }
+
+    if (interval == 0)
+    {
+        DEBUG_PRINT("Action statistics dump disabled");
+        return;
+    }
+
+    s_statsDumpSource = g_timeout_source_new_seconds(interval);
+    g_source_set_callback(s_statsDumpSource, dumpActionStats, NULL, NULL);
+    g_source_attach(s_statsDumpSource, shard->context);
+}
+
+int UpnpConnector::dumpActionStats(gpointer data)
+{
+    std::stringstream stats;
+    string line;
+
+    UpnpActionStats::dump(stats);
+    while (std::getline(stats, line))
+    {
+        INFO_PRINT(line);
+    }
+    INFO_PRINT("requests: " << UpnpRequest::getAcquired() << " acquired, " << UpnpRequest::getAllocated() <<
+               " allocated, " << UpnpRequestScheduler::getOutstanding() << " outstanding");
+    INFO_PRINT("devices: " << UpnpDeviceHealth::getOpenCircuits() << " unresponsive");
+    for (auto shard : s_shards)
+    {
+        UpnpPoller *poller = shard->requestState.poller;
+        INFO_PRINT("shard " << shard->index << " polling: " << poller->getServices() << " services, " <<
+                   poller->getPollCount() << " polls, " << poller->getChangeCount() << " changes");
+    }
+
+    stats.str("");
+    stats.clear();
+    for (auto shard : s_shards)
+    {
+        shard->requestState.scheduler->dump(stats, "shard " + std::to_string(shard->index));
+    }
+    while (std::getline(stats, line))
+    {
+        INFO_PRINT(line);
+    }
+    return G_SOURCE_CONTINUE;
+}
+
+int UpnpConnector::discovered(UpnpResource::Ptr pUpnpResource)
+{
+    std::lock_guard< std::mutex > lock(s_callbackLock);
+    return s_discoveryCallback(pUpnpResource);
+}
+
+void UpnpConnector::lost(UpnpResource::Ptr pUpnpResource)
+{
+    std::lock_guard< std::mutex > lock(s_callbackLock);
+    s_lostCallback(pUpnpResource);
+}
+
+// A device tree reachable through several contexts (network interfaces,
+// IPv4 and IPv6) is handled through one of them only: the first to get
+// its announcement, i.e. the fastest to answer the search, unless another
+// is on the preferred interface. The announcements the other contexts get
+// are set aside before any description or SCPD fetch, and replayed when
+// the owner loses the device (failover).
+// Returns false if the announcement was set aside.
+bool UpnpConnector::claim(Shard *shard, GSSDPResourceBrowser *browser, const char *usn,
+                          GList *locations)
+{
+    string udn = usn;
+    size_t end = udn.find("::");
+    if (end != string::npos)
+    {
+        udn.erase(end);
+    }
+
+    GSSDPClient *client = gssdp_resource_browser_get_client(browser);
+    bool preferred = s_preferredInterface.empty() ||
+                     s_preferredInterface == gssdp_client_get_interface(client);
+
+    std::lock_guard< std::mutex > lock(s_ownersLock);
+    Owner &owner = s_owners[udn];
+
+    if (owner.client == client)
+    {
+        return true;
+    }
+
+    if (owner.client == nullptr && (preferred || owner.failover))
+    {
+        owner.client = client;
+        owner.shard = shard;
+        owner.failover = false;
+        return true;
+    }
+
+    for (auto &standby : owner.standbys)
+    {
+        if (standby.browser == browser && standby.usn == usn)
+        {
+            return false;
+        }
+    }
+
+    Standby standby;
+    standby.shard = shard;
+    standby.browser = GSSDP_RESOURCE_BROWSER(g_object_ref(browser));
+    standby.usn = usn;
+    for (GList *l = locations; l != NULL; l = l->next)
+    {
+        standby.locations.push_back(static_cast<const char *> (l->data));
+    }
+    owner.standbys.push_back(standby);
+    DEBUG_PRINT(usn << " set aside on " << gssdp_client_get_interface(client));
+
+    if (owner.client == nullptr && owner.standbys.size() == 1)
+    {
+        // Claimed through this context if none on the preferred interface
+        // has meanwhile
+        GSource *source = g_timeout_source_new(PREFERRED_GRACE);
+        g_source_set_callback(source, onPreferredGrace, new string(udn),
+                              [](gpointer data) { delete static_cast<string *> (data); });
+        g_source_attach(source, shard->context);
+        g_source_unref(source);
+    }
+    return false;
+}
+
+// The owner lost the device: fail over to a context it was set aside by
+void UpnpConnector::release(GSSDPClient *client, const string &udn)
+{
+    std::lock_guard< std::mutex > lock(s_ownersLock);
+    auto it = s_owners.find(udn);
+
+    if (it == s_owners.end() || it->second.client != client)
+    {
+        return;
+    }
+
+    it->second.client = nullptr;
+    promote(it->second);
+    if (!it->second.failover)
+    {
+        s_owners.erase(it);
+    }
+}
+
+void UpnpConnector::releaseContext(Shard *shard, GSSDPClient *client)
+{
+    vector <string> owned;
+
+    {
+        std::lock_guard< std::mutex > lock(s_ownersLock);
+        for (auto &entry : s_owners)
+        {
+            vector <Standby> &standbys = entry.second.standbys;
+            for (auto it = standbys.begin(); it != standbys.end();)
+            {
+                if (gssdp_resource_browser_get_client(it->browser) == client)
+                {
+                    g_object_unref(it->browser);
+                    it = standbys.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+
+            if (entry.second.client == client)
+            {
+                entry.second.client = nullptr;
+                owned.push_back(entry.first);
+            }
+        }
+    }
 
-    g_signal_connect(s_contextManager, "context-available",
-                     G_CALLBACK(&UpnpConnector::onContextAvailable), NULL);
+    // Gone before failing over: the resources keep their URIs
+    for (auto &udn : owned)
+    {
+        unregisterDeviceResource(shard, udn);
+    }
 
-    DEBUG_PRINT("UPnP main loop starting... (" << std::this_thread::get_id() << ")");
-    s_mainLoop = g_main_loop_new(NULL, false);
-    s_mainContext = g_main_context_default();
-    DEBUG_PRINT("main context" << s_mainContext);
+    std::lock_guard< std::mutex > lock(s_ownersLock);
+    for (auto &udn : owned)
+    {
+        auto it = s_owners.find(udn);
+        if (it == s_owners.end() || it->second.client != nullptr)
+        {
+            continue;
+        }
 
-    s_requestState.context = s_mainContext;
-    initResourceCallbackHandler();
-    g_main_loop_run(s_mainLoop);
+        promote(it->second);
+        if (!it->second.failover)
+        {
+            s_owners.erase(it);
+        }
+    }
 }
 
-int UpnpConnector::checkRequestQueue(gpointer data)
+void UpnpConnector::releaseShard(Shard *shard)
 {
-    // Check request queue
-    std::lock_guard< std::mutex > lock(s_requestState.queueLock);
-    DEBUG_PRINT("(" << s_requestState.requestQueue.size() << ")");
+    std::lock_guard< std::mutex > lock(s_ownersLock);
+
+    for (auto entry = s_owners.begin(); entry != s_owners.end();)
+    {
+        vector <Standby> &standbys = entry->second.standbys;
+        for (auto it = standbys.begin(); it != standbys.end();)
+        {
+            if (it->shard == shard)
+            {
+                g_object_unref(it->browser);
+                it = standbys.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        if (entry->second.shard == shard || (entry->second.client == nullptr && standbys.empty()))
+        {
+            entry = s_owners.erase(entry);
+        }
+        else
+        {
+            ++entry;
+        }
+    }
+}
 
-    while (!s_requestState.requestQueue.empty())
+// Replays the announcements set aside by the context of the first standby,
+// to be claimed by it. Called with s_ownersLock held.
+void UpnpConnector::promote(Owner &owner)
+{
+    if (owner.standbys.empty())
     {
-        UpnpRequest *request = s_requestState.requestQueue.front();
-        bool status = request->start();
+        return;
+    }
+
+    GSSDPClient *client = gssdp_resource_browser_get_client(owner.standbys.front().browser);
+    owner.failover = true;
 
-        // If request completed, finalize here
-        if (request->done == request->expected)
+    for (auto it = owner.standbys.begin(); it != owner.standbys.end();)
+    {
+        if (gssdp_resource_browser_get_client(it->browser) != client)
         {
-            DEBUG_PRINT("finish " << request);
-            request->finish(status);
+            ++it;
+            continue;
         }
-        s_requestState.requestQueue.pop();
+
+        // Never synchronously: the replay claims
+        GSource *source = g_idle_source_new();
+        g_source_set_callback(source, onPromote, new Standby(*it), NULL);
+        g_source_attach(source, it->shard->context);
+        g_source_unref(source);
+        it = owner.standbys.erase(it);
     }
+}
 
-    DEBUG_PRINT("sourceId: " << s_requestState.sourceId << ", context: " << g_source_get_context (
-                    s_requestState.source));
-    if (s_requestState.sourceId != 0)
+gboolean UpnpConnector::onPromote(gpointer userData)
+{
+    Standby *standby = static_cast<Standby *> (userData);
+    GSSDPClient *client = gssdp_resource_browser_get_client(standby->browser);
+    GList *locations = NULL;
+
+    for (auto it = standby->locations.rbegin(); it != standby->locations.rend(); ++it)
     {
-        g_source_unref(s_requestState.source);
-        g_source_destroy(s_requestState.source);
-        s_requestState.sourceId = 0;
+        locations = g_list_prepend(locations, (gpointer) it->c_str());
+    }
+
+    INFO_PRINT("Failing over " << standby->usn << " to " << gssdp_client_get_interface(client));
+
+    // Claimed in onResourceAvailable, then fetched by the control point
+    g_signal_emit_by_name(standby->browser, "resource-available", standby->usn.c_str(), locations);
+
+    g_list_free(locations);
+    g_object_unref(standby->browser);
+    delete standby;
+    return G_SOURCE_REMOVE;
+}
+
+gboolean UpnpConnector::onPreferredGrace(gpointer userData)
+{
+    const string *udn = static_cast<const string *> (userData);
+    std::lock_guard< std::mutex > lock(s_ownersLock);
+    auto it = s_owners.find(*udn);
 
-        // Prepare for the next scheduling call
-        initResourceCallbackHandler();
+    if (it != s_owners.end() && it->second.client == nullptr && !it->second.failover)
+    {
+        DEBUG_PRINT(*udn << " not announced on " << s_preferredInterface);
+        promote(it->second);
     }
     return G_SOURCE_REMOVE;
 }
 
-void UpnpConnector::initResourceCallbackHandler()
+// Control points of the shards are matched by the address of their
+// context and their target
+string UpnpConnector::getBrowserKey(GSSDPResourceBrowser *browser)
 {
-    s_requestState.source = g_idle_source_new();
-    g_source_set_priority(s_requestState.source, G_PRIORITY_HIGH_IDLE);
-    g_source_set_callback(s_requestState.source,
-                          checkRequestQueue,
-                          NULL,
-                          NULL);
+    GSSDPClient *client = gssdp_resource_browser_get_client(browser);
+    return string(gssdp_client_get_host_ip(client)) + " " + gssdp_resource_browser_get_target(browser);
+}
+
+void UpnpConnector::addBrowser(Shard *shard, GUPnPControlPoint *controlPoint)
+{
+    GSSDPResourceBrowser *browser = GSSDP_RESOURCE_BROWSER(controlPoint);
+    std::lock_guard< std::mutex > lock(s_browsersLock);
+
+    shard->browsers[getBrowserKey(browser)] = browser;
+}
+
+void UpnpConnector::removeBrowsers(Shard *shard, GSSDPClient *client)
+{
+    string prefix = string(gssdp_client_get_host_ip(client)) + " ";
+
+    {
+        std::lock_guard< std::mutex > lock(s_browsersLock);
+        for (auto it = shard->browsers.begin(); it != shard->browsers.end();)
+        {
+            if (gssdp_resource_browser_get_client(it->second) == client)
+            {
+                it = shard->browsers.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    for (auto it = shard->forwarded.begin(); it != shard->forwarded.end();)
+    {
+        if (it->first.compare(0, prefix.size(), prefix) == 0)
+        {
+            it = shard->forwarded.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+// Emits signal (resource-available or resource-unavailable) for usn on
+// the control point of shard matching browser, from the thread of shard.
+// Returns false if shard has no such control point.
+bool UpnpConnector::forward(Shard *shard, GSSDPResourceBrowser *browser, const char *usn,
+                            GList *locations, const char *signal)
+{
+    std::lock_guard< std::mutex > lock(s_browsersLock);
+    auto it = shard->browsers.find(getBrowserKey(browser));
+
+    if (it == shard->browsers.end())
+    {
+        return false;
+    }
+
+    Standby *forwarded = new Standby();
+    forwarded->shard = shard;
+    forwarded->browser = GSSDP_RESOURCE_BROWSER(g_object_ref(it->second));
+    forwarded->usn = usn;
+    for (GList *l = locations; l != NULL; l = l->next)
+    {
+        forwarded->locations.push_back(static_cast<const char *> (l->data));
+    }
+
+    // Attached with the lock held: the shard has not stopped
+    GSource *source = g_idle_source_new();
+    g_source_set_callback(source, (strcmp(signal, "resource-available") == 0) ?
+                          onForwardAvailable : onForwardUnavailable, forwarded,
+                          [](gpointer data)
+                          {
+                              Standby *forwarded = static_cast<Standby *> (data);
+                              g_object_unref(forwarded->browser);
+                              delete forwarded;
+                          });
+    g_source_attach(source, shard->context);
+    g_source_unref(source);
+    return true;
+}
+
+gboolean UpnpConnector::onForwardAvailable(gpointer userData)
+{
+    Standby *forwarded = static_cast<Standby *> (userData);
+    GList *locations = NULL;
+
+    for (auto it = forwarded->locations.rbegin(); it != forwarded->locations.rend(); ++it)
+    {
+        locations = g_list_prepend(locations, (gpointer) it->c_str());
+    }
+
+    // Claimed in onResourceAvailable, then fetched by the control point
+    g_signal_emit_by_name(forwarded->browser, "resource-available", forwarded->usn.c_str(), locations);
+
+    g_list_free(locations);
+    return G_SOURCE_REMOVE;
+}
+
+gboolean UpnpConnector::onForwardUnavailable(gpointer userData)
+{
+    Standby *forwarded = static_cast<Standby *> (userData);
+
+    g_signal_emit_by_name(forwarded->browser, "resource-unavailable", forwarded->usn.c_str());
+    return G_SOURCE_REMOVE;
 }
 
 // Callback: a gupnp context is available
-void UpnpConnector::onContextAvailable(GUPnPContextManager *manager, GUPnPContext *context)
+void UpnpConnector::onContextAvailable(GUPnPContextManager *manager, GUPnPContext *context,
+                                       gpointer userData)
 {
+    Shard *shard = static_cast<Shard *> (userData);
     GUPnPControlPoint * controlPointRoot;
     GUPnPControlPoint * controlPointAll;
     gulong instanceId;
 
-    DEBUG_PRINT("context: " << context << ", manager: " << manager);
+    DEBUG_PRINT("context: " << context << ", manager: " << manager << ", shard: " << shard->index);
+
+    if (s_discoveryMode != DISCOVERY_ALL)
+    {
+        // one control point per supported root device type
+        for (const auto &entry : UpnpSearchTargetMap)
+        {
+            for (const auto &target : entry.second)
+            {
+                GUPnPControlPoint *controlPoint = gupnp_control_point_new(context, target.c_str());
+                startTargetedDiscovery(shard, context, controlPoint);
+                addBrowser(shard, controlPoint);
+
+                // let the context manager take care of this control point's life cycle
+                gupnp_context_manager_manage_control_point(manager, controlPoint);
+                g_object_unref(controlPoint);
+            }
+        }
+        return;
+    }
 
     // create a control point for root devices
     controlPointRoot = gupnp_control_point_new(context, "upnp:rootdevice");
 
+    instanceId = g_signal_connect(controlPointRoot, "resource-available",
+                                  G_CALLBACK (&UpnpConnector::onResourceAvailable), shard);
+    shard->signalMap[instanceId] = controlPointRoot;
+
     // the 'device-proxy-available' signal is sent when any devices are found
     instanceId = g_signal_connect(controlPointRoot, "device-proxy-available",
-                                  G_CALLBACK (&UpnpConnector::onDeviceProxyAvailable), (gpointer *) (&isRootDiscovery[1]));
-    s_signalMap[instanceId] = controlPointRoot;
+                                  G_CALLBACK (&UpnpConnector::onDeviceProxyAvailable), &shard->rootDiscovery);
+    shard->signalMap[instanceId] = controlPointRoot;
 
     // let the context manager take care of this control point's life cycle
     gupnp_context_manager_manage_control_point(manager, controlPointRoot);
@@ -253,13 +1017,140 @@ void UpnpConnector::onContextAvailable(GUPnPContextManager *manager, GUPnPContex
 
     // create a control point (for all devices and services)
     controlPointAll = gupnp_control_point_new(context, "ssdp:all");
-    startDiscovery(controlPointAll);
+
+    instanceId = g_signal_connect(controlPointAll, "resource-available",
+                                  G_CALLBACK (&UpnpConnector::onResourceAvailable), shard);
+    shard->signalMap[instanceId] = controlPointAll;
+    instanceId = g_signal_connect(controlPointAll, "resource-unavailable",
+                                  G_CALLBACK (&UpnpConnector::onResourceUnavailable), shard);
+    shard->signalMap[instanceId] = controlPointAll;
+    startDiscovery(shard, controlPointAll);
+    addBrowser(shard, controlPointAll);
 
     // let the context manager take care of this control point's life cycle
     gupnp_context_manager_manage_control_point(manager, controlPointAll);
     g_object_unref(controlPointAll);
 }
 
+// Callback: a gupnp context is no longer available (network interface down)
+void UpnpConnector::onContextUnavailable(GUPnPContextManager *manager, GUPnPContext *context,
+                                         gpointer userData)
+{
+    Shard *shard = static_cast<Shard *> (userData);
+
+    DEBUG_PRINT("context: " << context << ", manager: " << manager << ", shard: " << shard->index);
+    removeBrowsers(shard, GSSDP_CLIENT(context));
+    releaseContext(shard, GSSDP_CLIENT(context));
+}
+
+// Callback: an SSDP resource has been announced, runs before the control
+// point fetches its description.
+// Announcements of types that are not bridged are dropped here.
+// Only the first shard gets the announcements, it forwards the ones
+// hashing to another shard to it. The key is the description location: it
+// is shared by the root device, its embedded devices and all their
+// services (the root UDN is not part of the embedded announcements), so a
+// whole device tree is handled by one shard.
+// Announcements excluded by the filter are dropped before the control point
+// fetches anything, as far as the USN and the interface tell (manufacturer
+// and model rules wait for the description, see isAccepted).
+// Announcements of devices handled through another context are set aside
+// (see claim).
+void UpnpConnector::onResourceAvailable(GSSDPResourceBrowser *browser,
+                                        const char *usn,
+                                        GList *locations,
+                                        gpointer userData)
+{
+    Shard *shard = static_cast<Shard *> (userData);
+    unsigned int index = 0;
+    const char *type = strstr(usn, "::urn:");
+
+    // uuid:<udn>::<type>, the bare uuid:<udn> and upnp:rootdevice ones
+    // cannot be filtered by type
+    if (type != NULL && findResourceType(type + 2).empty())
+    {
+        g_signal_stop_emission_by_name(browser, "resource-available");
+        return;
+    }
+
+    if (locations != NULL && locations->data != NULL)
+    {
+        index = g_str_hash(locations->data) % s_shards.size();
+    }
+
+    // Not ours: skip the control point default handler. Handled here if
+    // the shard has no context on this interface (yet).
+    if (index != shard->index &&
+        forward(s_shards[index], browser, usn, locations, "resource-available"))
+    {
+        shard->forwarded[getBrowserKey(browser) + " " + usn] = s_shards[index];
+        g_signal_stop_emission_by_name(browser, "resource-available");
+        return;
+    }
+
+    if (!s_filter.isEmpty())
+    {
+        string udn;
+        GSSDPClient *client = gssdp_resource_browser_get_client(browser);
+        if (!s_filter.accepts(UpnpFilter::fromUsn(usn, udn, gssdp_client_get_interface(client))))
+        {
+            g_signal_stop_emission_by_name(browser, "resource-available");
+            return;
+        }
+    }
+
+    if (!claim(shard, browser, usn, locations))
+    {
+        g_signal_stop_emission_by_name(browser, "resource-available");
+    }
+}
+
+// Callback: an SSDP resource is gone (byebye or expired), forwarded to
+// the shard its announcement was (see onResourceAvailable)
+void UpnpConnector::onResourceUnavailable(GSSDPResourceBrowser *browser,
+                                          const char *usn,
+                                          gpointer userData)
+{
+    Shard *shard = static_cast<Shard *> (userData);
+    auto it = shard->forwarded.find(getBrowserKey(browser) + " " + usn);
+
+    if (it != shard->forwarded.end())
+    {
+        forward(it->second, browser, usn, NULL, "resource-unavailable");
+        shard->forwarded.erase(it);
+    }
+}
+
+// Callback: SSDP message received in passive discovery mode
+void UpnpConnector::onMessageReceived(GSSDPClient *client,
+                                      const char *fromIp,
+                                      gushort fromPort,
+                                      int type,
+                                      gpointer headers,
+                                      gpointer userData)
+{
+    GSSDPResourceBrowser *browser = GSSDP_RESOURCE_BROWSER(userData);
+    SoupMessageHeaders *messageHeaders = static_cast<SoupMessageHeaders *> (headers);
+    const char *nt = soup_message_headers_get_one(messageHeaders, "NT");
+    const char *nts = soup_message_headers_get_one(messageHeaders, "NTS");
+
+    if (nt == NULL || nts == NULL || strcmp(nts, "ssdp:alive") != 0 ||
+        gssdp_resource_browser_get_active(browser))
+    {
+        return;
+    }
+
+    // Announced versions may be higher than the searched one
+    string target = gssdp_resource_browser_get_target(browser);
+    string announced = nt;
+    target = target.substr(0, target.rfind(':') + 1);
+    if (announced.compare(0, target.size(), target) == 0)
+    {
+        DEBUG_PRINT("Activating discovery of " << nt << " announced by " << fromIp);
+        gssdp_resource_browser_set_active(browser, true);
+    }
+}
+
 // Callback: a device has been discovered
 void UpnpConnector::onDeviceProxyAvailable(GUPnPControlPoint *controlPoint,
                                            GUPnPDeviceProxy *proxy,
@@ -268,7 +1159,16 @@ void UpnpConnector::onDeviceProxyAvailable(GUPnPControlPoint *controlPoint,
     GUPnPDeviceInfo *deviceInfo = GUPNP_DEVICE_INFO(proxy);
     UpnpResource::Ptr pUpnpResource;
     const string udn = gupnp_device_info_get_udn(deviceInfo);
-    bool isRoot = *(static_cast <bool *> (userData));
+    Discovery *discovery = static_cast <Discovery *> (userData);
+    Shard *shard = discovery->shard;
+    bool isRoot = discovery->isRoot;
+
+    if (!isAccepted(deviceInfo))
+    {
+        // Neither registered nor walked: no SCPD fetch for its services
+        DEBUG_PRINT("Filtered out: " << udn);
+        return;
+    }
 
     DEBUG_PRINT("Device type: " << gupnp_device_info_get_device_type(deviceInfo));
 #ifndef NDEBUG
@@ -291,24 +1191,24 @@ void UpnpConnector::onDeviceProxyAvailable(GUPnPControlPoint *controlPoint,
     if (isRoot)
     {
         // Root device
-        pUpnpResource = s_manager->processDevice(proxy, deviceInfo, true, &s_requestState);
+        pUpnpResource = shard->manager->processDevice(proxy, deviceInfo, true, &shard->requestState);
     }
     else
     {
-        pUpnpResource = s_manager->processDevice(proxy, deviceInfo, false, &s_requestState);
+        pUpnpResource = shard->manager->processDevice(proxy, deviceInfo, false, &shard->requestState);
     }
 
     if (pUpnpResource != nullptr && !pUpnpResource->isRegistered())
     {
         DEBUG_PRINT("Register device resource: " << pUpnpResource->m_uri);
-        if (s_discoveryCallback(pUpnpResource) == 0)
+        if (discovered(pUpnpResource) == 0)
         {
             pUpnpResource->setRegistered(true);
         }
         else
         {
             pUpnpResource->setRegistered(false);
-            unregisterDeviceResource(udn);
+            unregisterDeviceResource(shard, udn);
             return;
         }
 
@@ -320,7 +1220,7 @@ void UpnpConnector::onDeviceProxyAvailable(GUPnPControlPoint *controlPoint,
         while (childService)
         {
             GUPnPServiceInfo *serviceInfo = GUPNP_SERVICE_INFO (childService->data);
-            std::shared_ptr<UpnpResource> pUpnpResourceService = s_manager->findResource(serviceInfo);
+            std::shared_ptr<UpnpResource> pUpnpResourceService = shard->manager->findResource(serviceInfo);
             if (pUpnpResourceService == nullptr)
             {
                 DEBUG_PRINT("Registering device: Service link is empty!");
@@ -334,7 +1234,7 @@ void UpnpConnector::onDeviceProxyAvailable(GUPnPControlPoint *controlPoint,
                 {
                     DEBUG_PRINT("Register resource for previously discovered child service: " <<
                                 pUpnpResourceService->m_uri);
-                    s_discoveryCallback(pUpnpResourceService);
+                    discovered(pUpnpResourceService);
                     pUpnpResourceService->setRegistered(true);
 
                     // Subscribe to notifications
@@ -342,28 +1242,64 @@ void UpnpConnector::onDeviceProxyAvailable(GUPnPControlPoint *controlPoint,
                     // must stay valid until we unsubscribe from notificatons. This
                     // means we have to keep a reference to the object inside the
                     // UpnpManager as long as we are subscribed to notifications.
-                    gupnp_service_proxy_set_subscribed(GUPNP_SERVICE_PROXY(serviceInfo), true);
+                    // Services not introspected yet subscribe once they are.
+                    // The bundle API does not expose OCF observers, a
+                    // registered resource counts as one.
+                    std::shared_ptr<UpnpService> pService =
+                        std::static_pointer_cast<UpnpService>(pUpnpResourceService);
+                    if (pService->isIntrospected())
+                    {
+                        shard->requestState.subscriptions->addObserver(pService->getProxy());
+                        shard->requestState.poller->add(pService.get());
+                    }
                 }
             }
             g_object_unref (childService->data);
             childService = g_list_delete_link (childService, childService);
         }
+
+        if (s_discoveryMode != DISCOVERY_ALL)
+        {
+            discoverDeviceTree(shard, deviceInfo);
+        }
     }
 }
 
 void UpnpConnector::onServiceProxyAvailable(GUPnPControlPoint *controlPoint,
-        GUPnPServiceProxy *proxy)
+        GUPnPServiceProxy *proxy,
+        gpointer userData)
 {
     GUPnPServiceInfo *info = GUPNP_SERVICE_INFO(proxy);
 
     DEBUG_PRINT("Service type: " << gupnp_service_info_get_service_type(info));
     DEBUG_PRINT("\tUdn: " << gupnp_service_info_get_udn(info));
 
-    // Get service introspection.
-    // TODO: consider using gupnp_service_info_get_introspection_full with GCancellable.
-    gupnp_service_info_get_introspection_async (info,
+    if (!isAccepted(info))
+    {
+        return;
+    }
+
+    if (s_lazyIntrospection)
+    {
+        // Register from the device description alone, the SCPD is
+        // fetched on the first request (see UpnpService::startRequest)
+        registerService(static_cast<Shard *> (userData), info, NULL);
+        return;
+    }
+
+    // Get service introspection, cancelled if the service goes away first
+    Shard *shard = static_cast<Shard *> (userData);
+    if (shard->introspections.find(proxy) != shard->introspections.end())
+    {
+        return;
+    }
+
+    GCancellable *cancellable = g_cancellable_new();
+    shard->introspections[proxy] = cancellable;
+    gupnp_service_info_get_introspection_async_full (info,
             onIntrospectionAvailable,
-            NULL);
+            cancellable,
+            userData);
 }
 
 // Introspection callback
@@ -372,23 +1308,45 @@ void UpnpConnector::onIntrospectionAvailable(GUPnPServiceInfo          *info,
         const GError              *error,
         gpointer                  context)
 {
+    Shard *shard = static_cast<Shard *> (context);
+
     DEBUG_PRINT(gupnp_service_info_get_service_type(info) << ", udn: " << gupnp_service_info_get_udn(
                     info));
 
+    if (error && g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    {
+        // See cancelIntrospection
+        DEBUG_PRINT("cancelled");
+        return;
+    }
+
+    auto it = shard->introspections.find(GUPNP_SERVICE_PROXY(info));
+    if (it != shard->introspections.end())
+    {
+        g_object_unref(it->second);
+        shard->introspections.erase(it);
+    }
+
     if (error)
     {
         ERROR_PRINT(error->message);
         return;
     }
 
-    UpnpResource::Ptr pUpnpResourceService = s_manager->processService(GUPNP_SERVICE_PROXY (info), info,
-            introspection,
-            &s_requestState);
+    registerService(shard, info, introspection);
 
     if (introspection != NULL)
     {
         g_object_unref(introspection);
     }
+}
+
+void UpnpConnector::registerService(Shard *shard, GUPnPServiceInfo *info,
+                                    GUPnPServiceIntrospection *introspection)
+{
+    UpnpResource::Ptr pUpnpResourceService = shard->manager->processService(GUPNP_SERVICE_PROXY (info), info,
+            introspection,
+            &shard->requestState);
 
     if (pUpnpResourceService == nullptr || pUpnpResourceService->isRegistered())
     {
@@ -399,10 +1357,10 @@ void UpnpConnector::onIntrospectionAvailable(GUPnPServiceInfo          *info,
     // the resource for the hosting device has been registered.
     // If yes, proceed registering the service resource.
     // Otherwise, the registration will happen when the hosting device proxy becomes available.
-    UpnpResource::Ptr pUpnpResourceDevice = s_manager->findDevice(pUpnpResourceService->getUdn());
+    UpnpResource::Ptr pUpnpResourceDevice = shard->manager->findDevice(pUpnpResourceService->getUdn());
     if ((pUpnpResourceDevice != nullptr) && pUpnpResourceDevice->isRegistered())
     {
-        s_discoveryCallback(pUpnpResourceService);
+        discovered(pUpnpResourceService);
         pUpnpResourceService->setRegistered(true);
 
         // Subscribe to notifications
@@ -410,16 +1368,21 @@ void UpnpConnector::onIntrospectionAvailable(GUPnPServiceInfo          *info,
         // must stay valid until we unsubscribe from notificatons. This
         // means we have to keep a reference to the object inside the
         // UpnpManager as long as we are subscribed to notifications.
-        gupnp_service_proxy_set_subscribed(GUPNP_SERVICE_PROXY(info), true);
+        std::shared_ptr<UpnpService> pService = std::static_pointer_cast<UpnpService>(pUpnpResourceService);
+        if (pService->isIntrospected())
+        {
+            shard->requestState.subscriptions->addObserver(pService->getProxy());
+            shard->requestState.poller->add(pService.get());
+        }
     }
 }
 
 // This is a recursive call. Should be safe as the depth of a UPNP device
 // tree rarely is going to exceed 3 levels. If we ever discover that
 // this is not the case, unravel the call into iterative function.
-void UpnpConnector::unregisterDeviceResource(string udn)
+void UpnpConnector::unregisterDeviceResource(Shard *shard, string udn)
 {
-    std::shared_ptr<UpnpDevice> pDevice = s_manager->findDevice(udn);
+    std::shared_ptr<UpnpDevice> pDevice = shard->manager->findDevice(udn);
 
     if (pDevice == nullptr)
     {
@@ -430,68 +1393,79 @@ void UpnpConnector::unregisterDeviceResource(string udn)
     for (auto serviceID : pDevice->getServiceList())
     {
         string serviceKey = udn + serviceID;
-        std::shared_ptr<UpnpService> pService = s_manager->findService(serviceKey);
+        std::shared_ptr<UpnpService> pService = shard->manager->findService(serviceKey);
 
         if (pService != nullptr)
         {
             // Unsubscribe from notifications
             if (pService->getProxy() != nullptr)
             {
-                gupnp_service_proxy_set_subscribed(pService->getProxy(), false);
+                shard->requestState.subscriptions->remove(pService->getProxy());
             }
+            shard->requestState.poller->remove(pService.get());
 
             if (pService->isRegistered())
             {
                 // Deregister service resource
-                s_lostCallback(pService);
+                lost(pService);
             }
         }
-        s_manager->removeService(serviceKey);
+        shard->manager->removeService(serviceKey);
 
     }
 
     // Unregister resources and remove references for embedded devices
     for (auto udnChild : pDevice->getDeviceList())
     {
-        unregisterDeviceResource(udnChild);
+        unregisterDeviceResource(shard, udnChild);
     }
     if (pDevice->isRegistered())
     {
-        s_lostCallback(pDevice);
+        lost(pDevice);
     }
-    s_manager->removeDevice(udn);
+    shard->manager->removeDevice(udn);
+    releaseProxies(shard, udn);
+    UpnpDeviceHealth::remove(udn);
 }
 
 void UpnpConnector::onDeviceProxyUnavailable(GUPnPControlPoint *controlPoint,
-        GUPnPDeviceProxy *proxy)
+        GUPnPDeviceProxy *proxy,
+        gpointer userData)
 {
+    Shard *shard = static_cast<Shard *> (userData);
     GUPnPDeviceInfo *info = GUPNP_DEVICE_INFO(proxy);
     const string udn = gupnp_device_info_get_udn(info);
 
     DEBUG_PRINT(": " << gupnp_device_info_get_device_type(info));
     DEBUG_PRINT("\tUdn: " << udn);
 
-    unregisterDeviceResource(udn);
+    unregisterDeviceResource(shard, udn);
+    release(gssdp_resource_browser_get_client(GSSDP_RESOURCE_BROWSER(controlPoint)), udn);
 }
 
 void UpnpConnector::onServiceProxyUnavailable(GUPnPControlPoint *controlPoint,
-        GUPnPServiceProxy *proxy)
+        GUPnPServiceProxy *proxy,
+        gpointer userData)
 {
+    Shard *shard = static_cast<Shard *> (userData);
     GUPnPServiceInfo *info = GUPNP_SERVICE_INFO(proxy);
 
     DEBUG_PRINT("Service type: " << gupnp_service_info_get_service_type(info));
     DEBUG_PRINT("\tUdn: " << gupnp_service_info_get_udn(info));
-    UpnpResource::Ptr pUpnpResourceService = s_manager->findResource(info);
+    cancelIntrospection(shard, proxy);
+    UpnpResource::Ptr pUpnpResourceService = shard->manager->findResource(info);
 
     if (pUpnpResourceService != nullptr)
     {
         // Unsubscribe from notifications
-        gupnp_service_proxy_set_subscribed(proxy, false);
+        std::shared_ptr<UpnpService> pService = std::static_pointer_cast<UpnpService>(pUpnpResourceService);
+        shard->requestState.subscriptions->remove(pService->getProxy());
+        shard->requestState.poller->remove(pService.get());
 
         if (pUpnpResourceService->isRegistered())
         {
-            s_lostCallback(pUpnpResourceService);
+            lost(pUpnpResourceService);
         }
-        s_manager->removeService(info);
+        shard->manager->removeService(info);
     }
 }
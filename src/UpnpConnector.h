@@ -22,7 +22,11 @@
 #define UPNP_CONNECTOR_H_
 
 #include <functional>
+#include <map>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include <gupnp-control-point.h>
 #include <gupnp-device-proxy.h>
@@ -32,6 +36,7 @@
 #include <OCPlatform.h>
 #include <ProtocolBridgeConnector.h>
 
+#include "UpnpFilter.h"
 #include "UpnpManager.h"
 #include "UpnpResource.h"
 
@@ -48,29 +53,148 @@ class UpnpConnector: public ProtocolBridgeConnector
         void connect();
         void disconnect();
 
+        // Devices and services to bridge, set before connecting
+        static void setFilter(const UpnpFilter &filter);
+
     private:
+        typedef enum
+        {
+            DISCOVERY_ALL = 0,    // ssdp:all and upnp:rootdevice control points (default)
+            DISCOVERY_TARGETED,   // M-SEARCH per supported root device type
+            DISCOVERY_PASSIVE     // as targeted, searching once a type is announced
+        } DiscoveryMode;
+
+        struct _Shard;
+
+        typedef struct _Discovery
+        {
+            struct _Shard *shard;
+            bool isRoot;
+        } Discovery;
+
+        // One GLib loop thread with its own main context, gupnp contexts,
+        // manager and request queue. Root device trees are spread over
+        // the shards by hash (see onResourceAvailable).
+        // Only the first shard searches and tracks the announcements, the
+        // control points of the others stay inactive and get the
+        // announcements of their device trees from it (see forward). Each
+        // shard still opens the SSDP sockets of its contexts: the
+        // datagrams are received and parsed once per shard.
+        typedef struct _Shard
+        {
+            unsigned int index;
+            GMainContext *context;
+            GMainLoop *loop;
+            GUPnPContextManager *contextManager;
+            UpnpManager *manager;
+            UpnpRequestState requestState;
+            std::map <gulong, GUPnPControlPoint *> signalMap;
+            // References to the proxies found by walking device descriptions
+            // (targeted discovery), by UDN of the device owning them
+            std::map <std::string, std::vector <gpointer> > ownedProxies;
+            // SCPD fetches in progress
+            std::map <GUPnPServiceProxy *, GCancellable *> introspections;
+            std::thread thread;
+            Discovery rootDiscovery;
+            Discovery allDiscovery;
+            // Control points by host IP and target, to forward the
+            // announcements to. Guarded by s_browsersLock.
+            std::map <std::string, GSSDPResourceBrowser *> browsers;
+            // Shards the announcements were forwarded to, by browser key
+            // and USN (first shard only)
+            std::map <std::string, struct _Shard *> forwarded;
+        } Shard;
+
+        // An announcement set aside: the device tree is handled through
+        // another context (see claim). Also one forwarded to another shard.
+        typedef struct _Standby
+        {
+            Shard *shard;
+            GSSDPResourceBrowser *browser;      // referenced
+            std::string usn;
+            std::vector <std::string> locations;
+        } Standby;
+
+        // Context (network interface) a device is handled through, null
+        // until claimed
+        typedef struct _Owner
+        {
+            GSSDPClient *client;
+            Shard *shard;
+            bool failover;
+            std::vector <Standby> standbys;
+        } Owner;
+
         DiscoveryCallback m_discoveryCallback;
         LostCallback m_lostCallback;
 
+        static std::vector <Shard *> s_shards;
+        static DiscoveryMode s_discoveryMode;
+        static bool s_lazyIntrospection;
+        static std::string s_preferredInterface;
+        static UpnpFilter s_filter;
+
+        // Owners by UDN, shared by the shards
+        static std::mutex s_ownersLock;
+        static std::map <std::string, Owner> s_owners;
+
+        static std::mutex s_browsersLock;
+
         void gupnpStart();
-        void gupnpStop();
+        static bool stopShard(UpnpRequest *request);
+        static void gupnpStop(Shard *shard);
+        static void runShard(Shard *shard);
 
-        static void startDiscovery(GUPnPControlPoint *controlPoint);
+        static void startDiscovery(Shard *shard, GUPnPControlPoint *controlPoint);
+        static void startTargetedDiscovery(Shard *shard, GUPnPContext *context, GUPnPControlPoint *controlPoint);
+        static void discoverDeviceTree(Shard *shard, GUPnPDeviceInfo *deviceInfo);
+        static void releaseProxies(Shard *shard, string udn);
+        static void cancelIntrospection(Shard *shard, GUPnPServiceProxy *proxy);
+        static bool isAccepted(GUPnPDeviceInfo *deviceInfo);
+        static bool isAccepted(GUPnPServiceInfo *serviceInfo);
+
+        static bool claim(Shard *shard, GSSDPResourceBrowser *browser, const char *usn, GList *locations);
+        static void release(GSSDPClient *client, const string &udn);
+        static void releaseContext(Shard *shard, GSSDPClient *client);
+        static void releaseShard(Shard *shard);
+        static void promote(Owner &owner);
+        static gboolean onPromote(gpointer userData);
+        static gboolean onPreferredGrace(gpointer userData);
+
+        static string getBrowserKey(GSSDPResourceBrowser *browser);
+        static void addBrowser(Shard *shard, GUPnPControlPoint *controlPoint);
+        static void removeBrowsers(Shard *shard, GSSDPClient *client);
+        static bool forward(Shard *shard, GSSDPResourceBrowser *browser, const char *usn,
+                            GList *locations, const char *signal);
+        static gboolean onForwardAvailable(gpointer userData);
+        static gboolean onForwardUnavailable(gpointer userData);
 
         // static is necessary for callbacks defined with the c gupnp functions (c code)
-        static void onContextAvailable(GUPnPContextManager *manager, GUPnPContext *context);
+        static void onContextAvailable(GUPnPContextManager *manager, GUPnPContext *context, gpointer userData);
+        static void onContextUnavailable(GUPnPContextManager *manager, GUPnPContext *context, gpointer userData);
+        static void onResourceAvailable(GSSDPResourceBrowser *browser, const char *usn, GList *locations,
+                                        gpointer userData);
+        static void onResourceUnavailable(GSSDPResourceBrowser *browser, const char *usn, gpointer userData);
+        static void onMessageReceived(GSSDPClient *client, const char *fromIp, gushort fromPort,
+                                      int type, gpointer headers, gpointer userData);
         static void onDeviceProxyAvailable(GUPnPControlPoint *cp, GUPnPDeviceProxy *proxy, gpointer userData);
-        static void onDeviceProxyUnavailable(GUPnPControlPoint *cp, GUPnPDeviceProxy *proxy);
-        static void onServiceProxyAvailable(GUPnPControlPoint *cp, GUPnPServiceProxy *proxy);
-        static void onServiceProxyUnavailable(GUPnPControlPoint *cp, GUPnPServiceProxy *proxy);
-        static int checkRequestQueue(gpointer data);
+        static void onDeviceProxyUnavailable(GUPnPControlPoint *cp, GUPnPDeviceProxy *proxy, gpointer userData);
+        static void onServiceProxyAvailable(GUPnPControlPoint *cp, GUPnPServiceProxy *proxy, gpointer userData);
+        static void onServiceProxyUnavailable(GUPnPControlPoint *cp, GUPnPServiceProxy *proxy, gpointer userData);
+        static int dumpActionStats(gpointer data);
 
         static void onIntrospectionAvailable(GUPnPServiceInfo  *serviceInfo,
                                              GUPnPServiceIntrospection *introspection,
                                              const GError              *error,
                                              gpointer                   userContext);
-        static void unregisterDeviceResource(string udn);
-        static void initResourceCallbackHandler();
+        static void registerService(Shard *shard, GUPnPServiceInfo *info,
+                                    GUPnPServiceIntrospection *introspection);
+        static void unregisterDeviceResource(Shard *shard, string udn);
+        static void initActionStatsDump(Shard *shard);
+
+        // Discovery/lost callbacks are serialized across the shards
+        static int discovered(UpnpResource::Ptr pUpnpResource);
+        static void lost(UpnpResource::Ptr pUpnpResource);
 };
 
 #endif
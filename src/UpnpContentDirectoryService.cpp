@@ -19,6 +19,7 @@
 //-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
 
 #include "UpnpContentDirectoryService.h"
+#include "UpnpActionStats.h"
 
 using namespace OIC::Service;
 
@@ -115,22 +116,22 @@ void UpnpContentDirectory::getBrowseResultCb(GUPnPServiceProxy *proxy,
 
     UpnpRequest *request = static_cast<UpnpRequest *> (userData);
 
-    bool status = gupnp_service_proxy_end_action (proxy,
-                                                  actionProxy,
-                                                  &error,
-                                                  "Result",
-                                                  G_TYPE_STRING,
-                                                  &result,
-                                                  "NumberReturned",
-                                                  G_TYPE_UINT,
-                                                  &numberReturned,
-                                                  "TotalMatches",
-                                                  G_TYPE_UINT,
-                                                  &totalMatches,
-                                                  "UpdateID",
-                                                  G_TYPE_UINT,
-                                                  &updateId,
-                                                  NULL);
+    bool status = UpnpActionStats::endAction (proxy,
+                                              actionProxy,
+                                              &error,
+                                              "Result",
+                                              G_TYPE_STRING,
+                                              &result,
+                                              "NumberReturned",
+                                              G_TYPE_UINT,
+                                              &numberReturned,
+                                              "TotalMatches",
+                                              G_TYPE_UINT,
+                                              &totalMatches,
+                                              "UpdateID",
+                                              G_TYPE_UINT,
+                                              &updateId,
+                                              NULL);
     if (error)
     {
         ERROR_PRINT("GetBrowseResult failed: " << error->code << ", " << error->message);
@@ -216,29 +217,29 @@ bool UpnpContentDirectory::getBrowseResult(UpnpRequest *request, const map< stri
     }
 
     GUPnPServiceProxyAction *actionProxy =
-        gupnp_service_proxy_begin_action (m_proxy,
-                                          "Browse",
-                                          getBrowseResultCb,
-                                          (gpointer *) request,
-                                          "ObjectID",
-                                          G_TYPE_STRING,
-                                          objectId.c_str(),
-                                          "BrowseFlag",
-                                          G_TYPE_STRING,
-                                          browseFlag.c_str(),
-                                          "Filter",
-                                          G_TYPE_STRING,
-                                          filter.c_str(),
-                                          "StartingIndex",
-                                          G_TYPE_UINT,
-                                          startingIndex,
-                                          "RequestedCount",
-                                          G_TYPE_UINT,
-                                          requestedCount,
-                                          "SortCriteria",
-                                          G_TYPE_STRING,
-                                          sortCriteria.c_str(),
-                                          NULL);
+        UpnpActionStats::beginAction (m_proxy,
+                                      "Browse",
+                                      getBrowseResultCb,
+                                      (gpointer *) request,
+                                      "ObjectID",
+                                      G_TYPE_STRING,
+                                      objectId.c_str(),
+                                      "BrowseFlag",
+                                      G_TYPE_STRING,
+                                      browseFlag.c_str(),
+                                      "Filter",
+                                      G_TYPE_STRING,
+                                      filter.c_str(),
+                                      "StartingIndex",
+                                      G_TYPE_UINT,
+                                      startingIndex,
+                                      "RequestedCount",
+                                      G_TYPE_UINT,
+                                      requestedCount,
+                                      "SortCriteria",
+                                      G_TYPE_STRING,
+                                      sortCriteria.c_str(),
+                                      NULL);
     if (NULL == actionProxy)
     {
         return false;
@@ -260,22 +261,22 @@ void UpnpContentDirectory::getSearchResultCb(GUPnPServiceProxy *proxy,
 
     UpnpRequest *request = static_cast<UpnpRequest *> (userData);
 
-    bool status = gupnp_service_proxy_end_action (proxy,
-                                                  actionProxy,
-                                                  &error,
-                                                  "Result",
-                                                  G_TYPE_STRING,
-                                                  &result,
-                                                  "NumberReturned",
-                                                  G_TYPE_UINT,
-                                                  &numberReturned,
-                                                  "TotalMatches",
-                                                  G_TYPE_UINT,
-                                                  &totalMatches,
-                                                  "UpdateID",
-                                                  G_TYPE_UINT,
-                                                  &updateId,
-                                                  NULL);
+    bool status = UpnpActionStats::endAction (proxy,
+                                              actionProxy,
+                                              &error,
+                                              "Result",
+                                              G_TYPE_STRING,
+                                              &result,
+                                              "NumberReturned",
+                                              G_TYPE_UINT,
+                                              &numberReturned,
+                                              "TotalMatches",
+                                              G_TYPE_UINT,
+                                              &totalMatches,
+                                              "UpdateID",
+                                              G_TYPE_UINT,
+                                              &updateId,
+                                              NULL);
     if (error)
     {
         ERROR_PRINT("GetSearchResult failed: " << error->code << ", " << error->message);
@@ -361,29 +362,29 @@ bool UpnpContentDirectory::getSearchResult(UpnpRequest *request, const map< stri
     }
 
     GUPnPServiceProxyAction *actionProxy =
-        gupnp_service_proxy_begin_action (m_proxy,
-                                          "Search",
-                                          getSearchResultCb,
-                                          (gpointer *) request,
-                                          "ContainerID",
-                                          G_TYPE_STRING,
-                                          containerId.c_str(),
-                                          "SearchCriteria",
-                                          G_TYPE_STRING,
-                                          searchCriteria.c_str(),
-                                          "Filter",
-                                          G_TYPE_STRING,
-                                          filter.c_str(),
-                                          "StartingIndex",
-                                          G_TYPE_UINT,
-                                          startingIndex,
-                                          "RequestedCount",
-                                          G_TYPE_UINT,
-                                          requestedCount,
-                                          "SortCriteria",
-                                          G_TYPE_STRING,
-                                          sortCriteria.c_str(),
-                                          NULL);
+        UpnpActionStats::beginAction (m_proxy,
+                                      "Search",
+                                      getSearchResultCb,
+                                      (gpointer *) request,
+                                      "ContainerID",
+                                      G_TYPE_STRING,
+                                      containerId.c_str(),
+                                      "SearchCriteria",
+                                      G_TYPE_STRING,
+                                      searchCriteria.c_str(),
+                                      "Filter",
+                                      G_TYPE_STRING,
+                                      filter.c_str(),
+                                      "StartingIndex",
+                                      G_TYPE_UINT,
+                                      startingIndex,
+                                      "RequestedCount",
+                                      G_TYPE_UINT,
+                                      requestedCount,
+                                      "SortCriteria",
+                                      G_TYPE_STRING,
+                                      sortCriteria.c_str(),
+                                      NULL);
     if (NULL == actionProxy)
     {
         return false;
@@ -402,7 +403,7 @@ bool UpnpContentDirectory::getAttributesRequest(UpnpRequest *request,
     {
         DEBUG_PRINT(" \"" << it->first << "\"");
         // Check the request
-        if (!UpnpAttribute::isValidRequest(&m_attributeMap, it->first, UPNP_ACTION_GET))
+        if (!isGetRequested(request, it->first))
         {
             request->done++;
             continue;
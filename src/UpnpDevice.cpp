@@ -106,7 +106,7 @@ static const map< string, function< char *(GUPnPDeviceInfo *deviceInfo)>> s_devi
 
 void UpnpDevice::initBasicAttributes(GUPnPDeviceInfo *deviceInfo)
 {
-    BundleResource::setAttribute("device_type", m_deviceType);
+    setAttribute("device_type", m_deviceType);
 
     for (auto const &kv : s_deviceInfo2AttributesMap)
     {
@@ -114,7 +114,7 @@ void UpnpDevice::initBasicAttributes(GUPnPDeviceInfo *deviceInfo)
         if (c_field != NULL)
         {
             string s_field = string(c_field);
-            BundleResource::setAttribute(kv.first, s_field);
+            setAttribute(kv.first, s_field);
             g_free(c_field);
         }
     }
@@ -122,20 +122,20 @@ void UpnpDevice::initBasicAttributes(GUPnPDeviceInfo *deviceInfo)
     char *iconUrl = gupnp_device_info_get_icon_url(deviceInfo, NULL, -1, -1, -1, false, NULL, NULL, NULL, NULL);
     if (iconUrl != NULL)
     {
-        BundleResource::setAttribute("icon_url", string(iconUrl));
+        setAttribute("icon_url", string(iconUrl));
         g_free(iconUrl);
     }
 
-    BundleResource::setAttribute("name",
-                                 m_name); // need to keep name with attributes (OCRepresentation bug)
-    BundleResource::setAttribute("uri",
-                                 m_uri);   // need to keep uri with attributes (OCRepresentation bug)
+    setAttribute("name",
+                 m_name); // need to keep name with attributes (OCRepresentation bug)
+    setAttribute("uri",
+                 m_uri);   // need to keep uri with attributes (OCRepresentation bug)
 }
 
 RCSResourceAttributes UpnpDevice::handleGetAttributesRequest(const std::map< std::string, std::string > &queryParams)
 {
     DEBUG_PRINT("");
-    return BundleResource::getAttributes();
+    return getAttributesResponse(queryParams);
 }
 
 // Assumption: Device attributes are read-only. Ignore. (TODO: send back an error code)
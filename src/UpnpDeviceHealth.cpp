@@ -0,0 +1,212 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "UpnpDeviceHealth.h"
+#include "UpnpInternal.h"
+
+static const string MODULE = "UpnpDeviceHealth";
+
+const unsigned int UpnpDeviceHealth::FAILURE_THRESHOLD;
+const guint UpnpDeviceHealth::PROBE_INTERVAL;
+
+mutex UpnpDeviceHealth::s_lock;
+map<string, UpnpDeviceHealth::Device> UpnpDeviceHealth::s_devices;
+atomic<size_t> UpnpDeviceHealth::s_tracked(0);
+
+void UpnpDeviceHealth::record(GUPnPServiceProxy *proxy, const GError *error)
+{
+    GUPnPServiceInfo *info = GUPNP_SERVICE_INFO(proxy);
+    bool failed = (error != NULL) && (error->domain != GUPNP_CONTROL_ERROR);
+
+    if (!failed && s_tracked.load(std::memory_order_relaxed) == 0)
+    {
+        return;
+    }
+
+    const char *udn = gupnp_service_info_get_udn(info);
+    if (udn == NULL)
+    {
+        return;
+    }
+    record(udn, error, info);
+}
+
+void UpnpDeviceHealth::record(const string &udn, const GError *error, GUPnPServiceInfo *info)
+{
+    bool failed = (error != NULL) && (error->domain != GUPNP_CONTROL_ERROR);
+
+    std::lock_guard< std::mutex > lock(s_lock);
+    auto it = s_devices.find(udn);
+    if (it == s_devices.end())
+    {
+        if (!failed)
+        {
+            // Healthy devices are not tracked
+            return;
+        }
+        Device device = {0, false, "", NULL, NULL, NULL};
+        it = s_devices.insert(make_pair(udn, device)).first;
+        s_tracked = s_devices.size();
+    }
+
+    Device &device = it->second;
+    if (!failed)
+    {
+        if (device.open)
+        {
+            INFO_PRINT(udn << " responding again, closing circuit");
+        }
+        close(device);
+        s_devices.erase(it);
+        s_tracked = s_devices.size();
+        return;
+    }
+
+    device.failures++;
+    if (!device.open && device.failures >= FAILURE_THRESHOLD)
+    {
+        ERROR_PRINT(udn << " unresponsive (" << device.failures << " failures), opening circuit");
+        device.open = true;
+        if (info != NULL)
+        {
+            device.location = gupnp_service_info_get_location(info);
+            device.context = GUPNP_CONTEXT(g_object_ref(gupnp_service_info_get_context(info)));
+            // The thread running the action callbacks
+            device.mainContext = g_main_context_get_thread_default();
+            schedule(it->first, device);
+        }
+    }
+}
+
+bool UpnpDeviceHealth::isAvailable(const string &udn)
+{
+    std::lock_guard< std::mutex > lock(s_lock);
+    auto it = s_devices.find(udn);
+
+    return (it == s_devices.end()) || !it->second.open;
+}
+
+void UpnpDeviceHealth::remove(const string &udn)
+{
+    std::lock_guard< std::mutex > lock(s_lock);
+    auto it = s_devices.find(udn);
+    if (it != s_devices.end())
+    {
+        close(it->second);
+        s_devices.erase(it);
+        s_tracked = s_devices.size();
+    }
+}
+
+unsigned int UpnpDeviceHealth::getOpenCircuits()
+{
+    std::lock_guard< std::mutex > lock(s_lock);
+    unsigned int count = 0;
+
+    for (auto &entry : s_devices)
+    {
+        count += entry.second.open ? 1 : 0;
+    }
+    return count;
+}
+
+// Called with s_lock held
+void UpnpDeviceHealth::schedule(const string &udn, Device &device)
+{
+    device.probe = g_timeout_source_new_seconds(PROBE_INTERVAL);
+    g_source_set_callback(device.probe, onProbe, new string(udn), deleteUdn);
+    g_source_attach(device.probe, device.mainContext);
+}
+
+// Called with s_lock held
+void UpnpDeviceHealth::close(Device &device)
+{
+    if (device.probe != NULL)
+    {
+        g_source_destroy(device.probe);
+        g_source_unref(device.probe);
+        device.probe = NULL;
+    }
+    if (device.context != NULL)
+    {
+        g_object_unref(device.context);
+        device.context = NULL;
+    }
+    device.open = false;
+}
+
+gboolean UpnpDeviceHealth::onProbe(gpointer userData)
+{
+    string *udn = static_cast<string *> (userData);
+
+    std::lock_guard< std::mutex > lock(s_lock);
+    auto it = s_devices.find(*udn);
+    if (it == s_devices.end() || it->second.probe == NULL)
+    {
+        return G_SOURCE_REMOVE;
+    }
+
+    Device &device = it->second;
+    g_source_unref(device.probe);
+    device.probe = NULL;
+
+    DEBUG_PRINT("probing " << *udn << " at " << device.location);
+    SoupMessage *message = soup_message_new("GET", device.location.c_str());
+    if (message == NULL)
+    {
+        schedule(*udn, device);
+        return G_SOURCE_REMOVE;
+    }
+    soup_session_queue_message(gupnp_context_get_session(device.context), message, onProbeDone,
+                               new string(*udn));
+
+    return G_SOURCE_REMOVE;
+}
+
+void UpnpDeviceHealth::onProbeDone(SoupSession *session, SoupMessage *message, gpointer userData)
+{
+    string *udn = static_cast<string *> (userData);
+    {
+        std::lock_guard< std::mutex > lock(s_lock);
+        auto it = s_devices.find(*udn);
+
+        if (it != s_devices.end() && it->second.open)
+        {
+            if (SOUP_STATUS_IS_SUCCESSFUL(message->status_code))
+            {
+                INFO_PRINT(*udn << " responding again, closing circuit");
+                close(it->second);
+                s_devices.erase(it);
+                s_tracked = s_devices.size();
+            }
+            else
+            {
+                DEBUG_PRINT(*udn << " probe failed: " << message->status_code);
+                schedule(*udn, it->second);
+            }
+        }
+    }
+    delete udn;
+}
+
+void UpnpDeviceHealth::deleteUdn(gpointer userData)
+{
+    delete static_cast<string *> (userData);
+}
@@ -0,0 +1,89 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#ifndef UPNP_DEVICE_HEALTH_H_
+#define UPNP_DEVICE_HEALTH_H_
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include <gupnp.h>
+#include <soup.h>
+
+using namespace std;
+
+// Circuit breaker per device (UDN).
+//
+// The outcome of every action is recorded (see UpnpActionStats): transport
+// failures (connection or HTTP errors, actions cancelled by a request
+// deadline as timeouts) count against the device, anything else, SOAP
+// faults included, shows it is alive. The circuit opens after
+// FAILURE_THRESHOLD consecutive failures: the resources of the device then
+// answer GETs from the last known values and fail SETs without sending
+// anything. Every PROBE_INTERVAL seconds, the device description is
+// fetched in the background; the circuit closes once it succeeds.
+//
+// Thread safe, outcomes are recorded from the gupnp threads.
+// Recording a success takes no lock while all the devices are healthy.
+class UpnpDeviceHealth
+{
+    public:
+        static const unsigned int FAILURE_THRESHOLD = 3;
+        static const guint PROBE_INTERVAL = 15;
+
+        static void record(GUPnPServiceProxy *proxy, const GError *error);
+        // As above, the description of info is probed while the circuit is
+        // open (not probed if null)
+        static void record(const string &udn, const GError *error, GUPnPServiceInfo *info);
+
+        // False while the circuit of the device is open
+        static bool isAvailable(const string &udn);
+
+        // Forgets the device (gone)
+        static void remove(const string &udn);
+
+        static unsigned int getOpenCircuits();
+
+    private:
+        typedef struct _Device
+        {
+            unsigned int failures;
+            bool open;
+            string location;
+            GUPnPContext *context;
+            GMainContext *mainContext;
+            GSource *probe;
+        } Device;
+
+        static mutex s_lock;
+        static map<string, Device> s_devices;
+        // Size of s_devices: successes take no lock while no device fails
+        static atomic<size_t> s_tracked;
+
+        static void schedule(const string &udn, Device &device);
+        static void close(Device &device);
+        static gboolean onProbe(gpointer userData);
+        static void onProbeDone(SoupSession *session, SoupMessage *message, gpointer userData);
+        static void deleteUdn(gpointer userData);
+};
+
+#endif
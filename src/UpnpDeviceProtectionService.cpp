@@ -19,6 +19,7 @@
 //-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
 
 #include "UpnpDeviceProtectionService.h"
+#include "UpnpActionStats.h"
 
 using namespace OIC::Service;
 
@@ -87,13 +88,13 @@ void UpnpDeviceProtection::sendSetupMessageCb(GUPnPServiceProxy *proxy,
     char *outMessage;
     GError *error = NULL;
 
-    bool status = gupnp_service_proxy_end_action (proxy,
-                                                  actionProxy,
-                                                  &error,
-                                                  "OutMessage",
-                                                  G_TYPE_STRING,
-                                                  &outMessage,
-                                                  NULL);
+    bool status = UpnpActionStats::endAction (proxy,
+                                              actionProxy,
+                                              &error,
+                                              "OutMessage",
+                                              G_TYPE_STRING,
+                                              &outMessage,
+                                              NULL);
     if (error)
     {
         ERROR_PRINT("SendSetupMessage failed: " << error->code << ", " << error->message);
@@ -160,17 +161,17 @@ bool UpnpDeviceProtection::sendSetupMessage(UpnpRequest *request,
     sendRequest->request = request;
 
         GUPnPServiceProxyAction *actionProxy =
-        gupnp_service_proxy_begin_action (m_proxy,
-                                          "SendSetupMessage",
-                                          sendSetupMessageCb,
-                                          (gpointer *) sendRequest,
-                                          "ProtocolType",
-                                          G_TYPE_STRING,
-                                          (sendRequest->protocol).c_str(),
-                                          "InMessage",
-                                          G_TYPE_STRING,
-                                          inMessage.c_str(),
-                                          NULL);
+        UpnpActionStats::beginAction (m_proxy,
+                                      "SendSetupMessage",
+                                      sendSetupMessageCb,
+                                      (gpointer *) sendRequest,
+                                      "ProtocolType",
+                                      G_TYPE_STRING,
+                                      (sendRequest->protocol).c_str(),
+                                      "InMessage",
+                                      G_TYPE_STRING,
+                                      inMessage.c_str(),
+                                      NULL);
     if (NULL == actionProxy)
     {
         delete sendRequest;
@@ -193,7 +194,7 @@ bool UpnpDeviceProtection::getAttributesRequest(UpnpRequest *request,
 
         DEBUG_PRINT(" \"" << it->first << "\"");
         // Check the request
-        if (!UpnpAttribute::isValidRequest(&m_attributeMap, it->first, UPNP_ACTION_GET))
+        if (!isGetRequested(request, it->first))
         {
             request->done++;
             continue;
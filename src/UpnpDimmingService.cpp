@@ -73,7 +73,7 @@ bool UpnpDimming::getAttributesRequest(UpnpRequest *request,
     {
         DEBUG_PRINT(" \"" << it->first << "\"");
         // Check the request
-        if (!UpnpAttribute::isValidRequest(&m_attributeMap, it->first, UPNP_ACTION_GET))
+        if (!isGetRequested(request, it->first))
         {
             request->done++;
             continue;
@@ -111,8 +111,17 @@ bool UpnpDimming::setAttributesRequest(const RCSResourceAttributes &value,
         }
         RCSResourceAttributes::Value attrValue = it->value();
 
-        UpnpAttributeInfo *attrInfo = m_attributeMap[attrName].first;
-        bool result = UpnpAttribute::set(m_proxy, request, attrInfo, &attrValue);
+        bool result = false;
+
+        if (attrName == "brightness")
+        {
+            result = m_brightness.write(request, attrValue);
+        }
+        else
+        {
+            UpnpAttributeInfo *attrInfo = m_attributeMap[attrName].first;
+            result = UpnpAttribute::set(m_proxy, request, attrInfo, &attrValue);
+        }
 
         status |= result;
         if (!result)
@@ -124,7 +133,18 @@ bool UpnpDimming::setAttributesRequest(const RCSResourceAttributes &value,
     return status;
 }
 
-bool UpnpDimming::processNotification(string attrName, string parent, GValue *value)
+void UpnpDimming::stop()
+{
+    m_brightness.stop();
+    UpnpService::stop();
+}
+
+int UpnpDimming::cancelRequest(UpnpRequest *request)
+{
+    return m_brightness.cancel(request) + UpnpService::cancelRequest(request);
+}
+
+bool UpnpDimming::processNotification(const string &attrName, const string &parent, GValue *value)
 {
     DEBUG_PRINT("");
     //TODO: value range conversion here, set attribute and return
@@ -29,6 +29,7 @@
 #include "UpnpResource.h"
 #include "UpnpInternal.h"
 #include "UpnpService.h"
+#include "UpnpSetCoalescer.h"
 
 class UpnpDimming: public UpnpService
 {
@@ -37,19 +38,30 @@ class UpnpDimming: public UpnpService
     public:
         UpnpDimming(GUPnPServiceInfo *serviceInfo,
                     UpnpRequestState *requestState):
-            UpnpService(serviceInfo, UPNP_OIC_TYPE_BRIGHTNESS, requestState, &Attributes)
+            UpnpService(serviceInfo, UPNP_OIC_TYPE_BRIGHTNESS, requestState, &Attributes),
+            m_brightness(this, [this](UpnpRequest *carrier, RCSResourceAttributes::Value *value)
+            {
+                return UpnpAttribute::set(m_proxy, carrier, m_attributeMap["brightness"].first, value);
+            })
         {
         }
 
+        void stop();
+
     private:
         bool getAttributesRequest(UpnpRequest *request,
                                   const map< string, string > &queryParams);
         bool setAttributesRequest(const RCSResourceAttributes &value,
                                   UpnpRequest *request,
                                   const map< string, string > &queryParams);
-        bool processNotification(string attrName, string parent, GValue *value);
+        bool processNotification(const string &attrName, const string &parent, GValue *value);
 
         static vector <UpnpAttributeInfo> Attributes;
+
+        // SetLoadLevelTarget, sent at the rate the device acknowledges it
+        UpnpSetCoalescer m_brightness;
+
+        int cancelRequest(UpnpRequest *request);
 };
 
 #endif //UPNP_DIMMING_SERVICE_H_
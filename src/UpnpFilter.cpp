@@ -0,0 +1,145 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include <cstring>
+
+#include "UpnpFilter.h"
+#include "UpnpInternal.h"
+
+using namespace std;
+
+static const string MODULE = "UpnpFilter";
+
+static const char *FIELD_NAMES[UpnpFilter::FIELD_COUNT] =
+{
+    "udn", "deviceType", "serviceType", "manufacturer", "model", "interface"
+};
+
+bool UpnpFilter::addRule(bool allow, const map< string, string > &rule)
+{
+    Rule fields;
+
+    for (const auto &entry : rule)
+    {
+        int field = 0;
+        while (field < FIELD_COUNT && entry.first != FIELD_NAMES[field])
+        {
+            ++field;
+        }
+        if (field == FIELD_COUNT)
+        {
+            ERROR_PRINT("Unknown filter field " << entry.first);
+            return false;
+        }
+        fields.push_back(make_pair((Field) field, entry.second));
+    }
+
+    if (fields.empty())
+    {
+        return false;
+    }
+    (allow ? m_allow : m_deny).push_back(fields);
+    return true;
+}
+
+bool UpnpFilter::isEmpty() const
+{
+    return m_allow.empty() && m_deny.empty();
+}
+
+bool UpnpFilter::accepts(const Subject &subject) const
+{
+    for (const auto &rule : m_deny)
+    {
+        if (matches(rule, subject, true))
+        {
+            return false;
+        }
+    }
+
+    if (m_allow.empty())
+    {
+        return true;
+    }
+    for (const auto &rule : m_allow)
+    {
+        if (matches(rule, subject, false))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+UpnpFilter::Subject UpnpFilter::fromUsn(const char *usn, string &udn, const char *interface)
+{
+    Subject subject = {};
+    const char *type = strstr(usn, "::");
+
+    udn.assign(usn, (type != NULL) ? (size_t) (type - usn) : strlen(usn));
+    subject.fields[FIELD_UDN] = udn.c_str();
+    subject.fields[FIELD_INTERFACE] = interface;
+
+    // upnp:rootdevice tells nothing more
+    if (type != NULL)
+    {
+        type += 2;
+        if (strstr(type, ":device:") != NULL)
+        {
+            subject.fields[FIELD_DEVICE_TYPE] = type;
+        }
+        else if (strstr(type, ":service:") != NULL)
+        {
+            subject.fields[FIELD_SERVICE_TYPE] = type;
+        }
+    }
+    return subject;
+}
+
+// strict: a field not known does not match
+bool UpnpFilter::matches(const Rule &rule, const Subject &subject, bool strict)
+{
+    for (const auto &field : rule)
+    {
+        const char *value = subject.fields[field.first];
+        if (value == NULL)
+        {
+            if (strict)
+            {
+                return false;
+            }
+            continue;
+        }
+
+        const string &pattern = field.second;
+        if (!pattern.empty() && pattern[pattern.size() - 1] == '*')
+        {
+            if (strncmp(value, pattern.c_str(), pattern.size() - 1) != 0)
+            {
+                return false;
+            }
+        }
+        else if (pattern != value)
+        {
+            return false;
+        }
+    }
+    return true;
+}
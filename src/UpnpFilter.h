@@ -0,0 +1,75 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#ifndef UPNP_FILTER_H_
+#define UPNP_FILTER_H_
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Allow- and deny-lists of the devices and services to bridge.
+// A rule is a set of fields, all of which must match; a value ending with
+// '*' matches by prefix. Anything matching a deny rule is excluded, and
+// when there are allow rules, so is anything matching none of them.
+// Discovery learns the fields in stages (SSDP announcement, device
+// description): a field not known yet (null) never matches a deny rule and
+// never fails an allow rule, the subject is checked again once known.
+class UpnpFilter
+{
+    public:
+        typedef enum
+        {
+            FIELD_UDN = 0,
+            FIELD_DEVICE_TYPE,
+            FIELD_SERVICE_TYPE,
+            FIELD_MANUFACTURER,
+            FIELD_MODEL,
+            FIELD_INTERFACE,
+            FIELD_COUNT
+        } Field;
+
+        // Field values, indexed by Field
+        typedef struct _Subject
+        {
+            const char *fields[FIELD_COUNT];
+        } Subject;
+
+        // Field names are as in the bundle configuration ("udn",
+        // "deviceType", "serviceType", "manufacturer", "model",
+        // "interface"). Returns false (rule ignored) on an unknown field.
+        bool addRule(bool allow, const std::map< std::string, std::string > &rule);
+        bool isEmpty() const;
+        bool accepts(const Subject &subject) const;
+
+        // Subject of an SSDP announcement: uuid:<udn>[::<type>]
+        static Subject fromUsn(const char *usn, std::string &udn, const char *interface);
+
+    private:
+        typedef std::vector< std::pair< Field, std::string > > Rule;
+
+        std::vector< Rule > m_allow;
+        std::vector< Rule > m_deny;
+
+        static bool matches(const Rule &rule, const Subject &subject, bool strict);
+};
+
+#endif
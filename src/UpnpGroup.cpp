@@ -0,0 +1,189 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include <deque>
+#include <thread>
+
+#include <UpnpConstants.h>
+
+#include "UpnpGroup.h"
+
+static const string MODULE = "UpnpGroup";
+
+const size_t UpnpGroup::MAX_IN_FLIGHT;
+
+UpnpGroup::UpnpGroup(string name, string uri, const vector< string > &memberUris) :
+    UpnpGroup(name, uri, memberUris, UPNP_OIC_TYPE_GROUP)
+{
+    setAttribute("value", false, false);
+    setAttribute("brightness", 0, false);
+    setAttribute("results", CompositeAttribute(), false);
+}
+
+UpnpGroup::UpnpGroup(string name, string uri, const vector< string > &memberUris,
+                     string resourceType) :
+    m_memberUris(memberUris.begin(), memberUris.end())
+{
+    m_name = name;
+    m_uri = uri.empty() ? UpnpUriPrefixMap[resourceType] + name : uri;
+    m_resourceType = resourceType;
+    m_interface = UpnpInterfaceMap[m_resourceType];
+    m_udn = "";
+
+    UpnpGroup::initAttributes();
+    setReady(true);
+}
+
+void UpnpGroup::initAttributes()
+{
+    setAttribute("name", m_name,
+                 false); // need to keep name with attributes (OCRepresentation bug)
+    setAttribute("uri", m_uri,
+                 false);   // need to keep uri with attributes (OCRepresentation bug)
+    setAttribute("if", m_interface, false);
+
+    vector< string > members(m_memberUris.begin(), m_memberUris.end());
+    setAttribute("members", members, false);
+}
+
+UpnpGroup::~UpnpGroup()
+{
+    DEBUG_PRINT("uri:" << m_uri);
+}
+
+bool UpnpGroup::isMemberType(const string &resourceType)
+{
+    return resourceType == UPNP_OIC_TYPE_POWER_SWITCH || resourceType == UPNP_OIC_TYPE_BRIGHTNESS;
+}
+
+bool UpnpGroup::addMember(UpnpResource::Ptr resource)
+{
+    if (!isMemberType(resource->getResourceType()))
+    {
+        return false;
+    }
+
+    std::lock_guard< std::mutex > lock(m_lock);
+    if (m_memberUris.find(resource->m_uri) == m_memberUris.end())
+    {
+        return false;
+    }
+
+    DEBUG_PRINT(m_uri << ": member " << resource->m_uri);
+    m_members[resource->m_uri] = std::static_pointer_cast< UpnpService >(resource);
+    return true;
+}
+
+void UpnpGroup::removeMember(UpnpResource::Ptr resource)
+{
+    std::lock_guard< std::mutex > lock(m_lock);
+    auto it = m_members.find(resource->m_uri);
+    if (it != m_members.end() && it->second == resource)
+    {
+        DEBUG_PRINT(m_uri << ": lost member " << resource->m_uri);
+        m_members.erase(it);
+    }
+}
+
+RCSResourceAttributes UpnpGroup::handleGetAttributesRequest(const map< string, string > &queryParams)
+{
+    DEBUG_PRINT("uri:" << m_uri);
+    return getAttributesResponse(queryParams);
+}
+
+void UpnpGroup::handleSetAttributesRequest(const RCSResourceAttributes &value,
+                                           const map< string, string > &queryParams)
+{
+    DEBUG_PRINT("(" << std::this_thread::get_id() << "), uri:" << m_uri);
+
+    // Member SET values, by member type
+    map< string, RCSResourceAttributes > memberValues;
+    if (value.contains("value"))
+    {
+        memberValues[UPNP_OIC_TYPE_POWER_SWITCH]["value"] = value.at("value");
+    }
+    if (value.contains("brightness"))
+    {
+        memberValues[UPNP_OIC_TYPE_BRIGHTNESS]["brightness"] = value.at("brightness");
+    }
+    if (memberValues.empty())
+    {
+        DEBUG_PRINT("nothing to set");
+        return;
+    }
+
+    vector< std::shared_ptr< UpnpService > > members;
+    {
+        std::lock_guard< std::mutex > lock(m_lock);
+        for (auto &member : m_members)
+        {
+            if (memberValues.find(member.second->getResourceType()) != memberValues.end())
+            {
+                members.push_back(member.second);
+            }
+        }
+    }
+
+    // Keep MAX_IN_FLIGHT requests queued on the members, completing them
+    // in order
+    vector< bool > statuses(members.size(), false);
+    deque< pair< size_t, UpnpRequest * > > inFlight;
+    size_t next = 0;
+
+    while (next < members.size() || !inFlight.empty())
+    {
+        if (next < members.size() && inFlight.size() < MAX_IN_FLIGHT)
+        {
+            const RCSResourceAttributes &memberValue = memberValues[members[next]->getResourceType()];
+            inFlight.push_back(make_pair(next, members[next]->beginSetAttributesRequest(memberValue,
+                                         queryParams)));
+            next++;
+            continue;
+        }
+
+        statuses[inFlight.front().first] = UpnpService::endRequest(inFlight.front().second);
+        inFlight.pop_front();
+    }
+
+    CompositeAttribute results;
+    unsigned int failed = 0;
+    for (size_t i = 0; i < members.size(); ++i)
+    {
+        RCSResourceAttributes result;
+        result["href"] = members[i]->m_uri;
+        result["status"] = statuses[i];
+        results.push_back(result);
+        failed += statuses[i] ? 0 : 1;
+    }
+
+    if (failed != 0)
+    {
+        ERROR_PRINT(m_uri << ": " << failed << " of " << members.size() << " members failed");
+    }
+
+    for (auto &attr : value)
+    {
+        if (attr.key() == "value" || attr.key() == "brightness")
+        {
+            setAttribute(attr.key(), RCSResourceAttributes::Value(attr.value()), false);
+        }
+    }
+    setAttribute("results", results, false);
+}
@@ -0,0 +1,73 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#ifndef UPNP_GROUP_H_
+#define UPNP_GROUP_H_
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "UpnpResource.h"
+#include "UpnpService.h"
+
+using namespace std;
+
+// Group of lights hosted by the bridge (see UpnpBundleActivator::createResource).
+//
+// The members are binary switch and brightness services, listed by URI in
+// the resource configuration and attached as they are discovered. A SET of
+// "value" or "brightness" is issued to all the matching members at once,
+// MAX_IN_FLIGHT at most, so that the SET takes about as long as the slowest
+// member. The status of each member is reported in "results".
+class UpnpGroup: public UpnpResource
+{
+    public:
+        typedef std::shared_ptr< UpnpGroup > Ptr;
+
+        // Member SETs in flight at once
+        static const size_t MAX_IN_FLIGHT = 16;
+
+        UpnpGroup(string name, string uri, const vector< string > &memberUris);
+        virtual ~UpnpGroup();
+
+        // Attaches the resource if it is one of the members
+        bool addMember(UpnpResource::Ptr resource);
+        void removeMember(UpnpResource::Ptr resource);
+
+        virtual RCSResourceAttributes handleGetAttributesRequest(const map< string, string > &queryParams);
+        virtual void handleSetAttributesRequest(const RCSResourceAttributes &value,
+                                                const map< string, string > &queryParams);
+
+    protected:
+        std::mutex m_lock;
+        set< string > m_memberUris;
+        map< string, std::shared_ptr< UpnpService > > m_members;
+
+        UpnpGroup(string name, string uri, const vector< string > &memberUris, string resourceType);
+
+        virtual bool isMemberType(const string &resourceType);
+        virtual void initAttributes();
+};
+
+#endif
@@ -25,11 +25,14 @@
 
 #include <map>
 #include <string>
+#include <vector>
 
 #include <RCSResourceAttributes.h>
 
 #include <UpnpConstants.h>
 
+#include "UpnpLog.h"
+
 using namespace OIC::Service;
 
 //From UPNP spec
@@ -72,6 +75,18 @@ static std::map<std::string, std::string > UpnpSearchPatternMap =
     {UPNP_OIC_TYPE_SCHEDULED_RECORDING,     UPNP_PREFIX_SERVICE + ":.*(?:[Ss]cheduled[Rr]ecording).*"}
 };
 
+// SSDP search targets for type-targeted discovery, by root device type.
+// Embedded devices and services are found in the root device description.
+// Devices answer searches for lower versions of their type.
+static std::map<std::string, std::vector<std::string> > UpnpSearchTargetMap =
+{
+    {UPNP_OIC_TYPE_DEVICE_LIGHT,            {UPNP_PREFIX_DEVICE + ":BinaryLight:1",
+                                             UPNP_PREFIX_DEVICE + ":DimmableLight:1"}},
+    {UPNP_OIC_TYPE_DEVICE_INET_GATEWAY,     {UPNP_PREFIX_DEVICE + ":InternetGatewayDevice:1"}},
+    {UPNP_OIC_TYPE_DEVICE_MEDIA_RENDERER,   {UPNP_PREFIX_DEVICE + ":MediaRenderer:1"}},
+    {UPNP_OIC_TYPE_DEVICE_MEDIA_SERVER,     {UPNP_PREFIX_DEVICE + ":MediaServer:1"}}
+};
+
 // TODO: discuss if the following maps should be moved to external header file like UpnpConstants.h
 
 // Interface map
@@ -100,6 +115,9 @@ static std::map<std::string, std::string > UpnpInterfaceMap =
 // Media Control
     {UPNP_OIC_TYPE_DEVICE_MEDIA_RENDERER,    OC_RSRVD_INTERFACE_LL},
     {UPNP_OIC_TYPE_DEVICE_MEDIA_SERVER,      OC_RSRVD_INTERFACE_LL},
+// Bridge hosted
+    {UPNP_OIC_TYPE_GROUP,                    "oic.if.a"},
+    {UPNP_OIC_TYPE_AV_GROUP,                 "oic.if.a"},
 };
 
 // URI prexfix map
@@ -129,7 +147,9 @@ static std::map<std::string, std::string > UpnpUriPrefixMap =
     {UPNP_OIC_TYPE_AV_TRANSPORT,            UPNP_OIC_URI_PREFIX_AV_TRANSPORT},
     {UPNP_OIC_TYPE_CONTENT_DIRECTORY,       UPNP_OIC_URI_PREFIX_CONTENT_DIRECTORY},
     {UPNP_OIC_TYPE_RENDERING_CONTROL,       UPNP_OIC_URI_PREFIX_RENDERING_CONTROL},
-    {UPNP_OIC_TYPE_SCHEDULED_RECORDING,     UPNP_OIC_URI_PREFIX_SCHEDULED_RECORDING}
+    {UPNP_OIC_TYPE_SCHEDULED_RECORDING,     UPNP_OIC_URI_PREFIX_SCHEDULED_RECORDING},
+    {UPNP_OIC_TYPE_GROUP,                   UPNP_OIC_URI_PREFIX_GROUP},
+    {UPNP_OIC_TYPE_AV_GROUP,                UPNP_OIC_URI_PREFIX_AV_GROUP}
 };
 
 typedef std::vector<RCSResourceAttributes> CompositeAttribute;
@@ -183,10 +203,12 @@ typedef union _UpnpVar
     gchar       *var_pchar;
 } UpnpVar;
 
-#define ERROR_PRINT(x) do { std::cerr << MODULE << ":" << __func__ << "(): ERROR: " << x << std::endl; } while (0)
+// Asynchronous, see UpnpLog.h (levels are set per MODULE)
+#define ERROR_PRINT(x) UPNP_LOG(UpnpLog::LEVEL_ERROR, x)
+#define INFO_PRINT(x) UPNP_LOG(UpnpLog::LEVEL_INFO, x)
 
 #ifndef NDEBUG
-#define DEBUG_PRINT(x) do { std::cout << MODULE << ":" << __func__ << "(): " << x << std::endl; } while (0)
+#define DEBUG_PRINT(x) UPNP_LOG(UpnpLog::LEVEL_DEBUG, x)
 #else
 #define DEBUG_PRINT(x)
 #endif
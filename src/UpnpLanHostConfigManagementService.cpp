@@ -19,6 +19,7 @@
 //-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
 
 #include "UpnpLanHostConfigManagementService.h"
+#include "UpnpActionStats.h"
 
 using namespace OIC::Service;
 
@@ -129,16 +130,16 @@ void UpnpLanHostConfigManagement::getAddressRangeCb(GUPnPServiceProxy *proxy,
 
     UpnpRequest *request = static_cast<UpnpRequest *> (userData);
 
-    bool status = gupnp_service_proxy_end_action (proxy,
-                                                  actionProxy,
-                                                  &error,
-                                                  "NewMinAddress",
-                                                  G_TYPE_STRING,
-                                                  &minAddress,
-                                                  "NewMaxAddress",
-                                                  G_TYPE_STRING,
-                                                  &maxAddress,
-                                                  NULL);
+    bool status = UpnpActionStats::endAction (proxy,
+                                              actionProxy,
+                                              &error,
+                                              "NewMinAddress",
+                                              G_TYPE_STRING,
+                                              &minAddress,
+                                              "NewMaxAddress",
+                                              G_TYPE_STRING,
+                                              &maxAddress,
+                                              NULL);
     if (error)
     {
         ERROR_PRINT("GetAddressRange failed: " << error->code << ", " << error->message);
@@ -165,11 +166,11 @@ bool UpnpLanHostConfigManagement::getAddressRange(UpnpRequest *request)
 {
     DEBUG_PRINT("");
     GUPnPServiceProxyAction *actionProxy =
-        gupnp_service_proxy_begin_action (m_proxy,
-                                          "GetAddressRange",
-                                          getAddressRangeCb,
-                                          (gpointer *) request,
-                                          NULL);
+        UpnpActionStats::beginAction (m_proxy,
+                                      "GetAddressRange",
+                                      getAddressRangeCb,
+                                      (gpointer *) request,
+                                      NULL);
     if (NULL == actionProxy)
     {
         return false;
@@ -186,10 +187,10 @@ void UpnpLanHostConfigManagement::setAddressRangeCb(GUPnPServiceProxy *proxy,
 
     UpnpRequest *request = static_cast<UpnpRequest *> (userData);
 
-    bool status = gupnp_service_proxy_end_action (proxy,
-                                                  actionProxy,
-                                                  &error,
-                                                  NULL);
+    bool status = UpnpActionStats::endAction (proxy,
+                                              actionProxy,
+                                              &error,
+                                              NULL);
     if (error)
     {
         ERROR_PRINT("SetAddressRange failed: " << error->code << ", " << error->message);
@@ -241,17 +242,17 @@ bool UpnpLanHostConfigManagement::setAddressRange(UpnpRequest *request,
         return false;
     }
 
-    actionProxy = gupnp_service_proxy_begin_action (m_proxy,
-                                                    "SetAddressRange",
-                                                    setAddressRangeCb,
-                                                    (gpointer *) request,
-                                                    "MinAddress",
-                                                    G_TYPE_STRING,
-                                                    sMinAddr,
-                                                    "MaxAddress",
-                                                    G_TYPE_STRING,
-                                                    sMaxAddr,
-                                                    NULL);
+    actionProxy = UpnpActionStats::beginAction (m_proxy,
+                                                "SetAddressRange",
+                                                setAddressRangeCb,
+                                                (gpointer *) request,
+                                                "MinAddress",
+                                                G_TYPE_STRING,
+                                                sMinAddr,
+                                                "MaxAddress",
+                                                G_TYPE_STRING,
+                                                sMaxAddr,
+                                                NULL);
     if (NULL == actionProxy)
     {
         return false;
@@ -274,7 +275,7 @@ bool UpnpLanHostConfigManagement::getAttributesRequest(UpnpRequest *request,
 
         DEBUG_PRINT(" \"" << it->first << "\"");
         // Check the request
-        if (!UpnpAttribute::isValidRequest(&m_attributeMap, it->first, UPNP_ACTION_GET))
+        if (!isGetRequested(request, it->first))
         {
             request->done++;
             continue;
@@ -54,7 +54,7 @@ bool UpnpLayer3Forwarding::getAttributesRequest(UpnpRequest *request,
     {
         DEBUG_PRINT(" \"" << it->first << "\"");
         // Check the request
-        if (!UpnpAttribute::isValidRequest(&m_attributeMap, it->first, UPNP_ACTION_GET))
+        if (!isGetRequested(request, it->first))
         {
             request->done++;
             continue;
@@ -0,0 +1,578 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "UpnpLog.h"
+
+using namespace std;
+
+const size_t UpnpLogRing::MESSAGE_SIZE;
+const size_t UpnpLog::RING_CAPACITY;
+const uint32_t UpnpLog::RATE_LIMIT_BURST;
+const uint64_t UpnpLog::RATE_LIMIT_PERIOD;
+
+static const char *BINARY_ENV = "UPNP_LOG_BINARY";
+static const char *LEVEL_ENV = "UPNP_LOG_LEVEL";
+static const char *LEVEL_NAMES[] = {"off", "error", "info", "debug"};
+
+static const unsigned int FLUSH_TIMEOUT_MS = 1000;
+
+typedef struct _Module
+{
+    string name;
+    atomic<int> level;
+} Module;
+
+// Logger state is never freed: log calls may still happen from static
+// destructors and from threads outliving the bundle stop.
+typedef struct _LogState
+{
+    mutex lock;
+    // Held by the writer while it outputs a batch, protects binary
+    mutex writeLock;
+    map<string, Module *> modules;
+    UpnpLog::Level defaultLevel;
+
+    UpnpLogRing ring;
+    thread *writer;
+    atomic<bool> running;
+    // Set by the writer before it waits for records on wake (with
+    // wakeLock held): producers only take the lock to wake it up then
+    atomic<bool> sleeping;
+    mutex wakeLock;
+    condition_variable wake;
+    // Notified when the writer has output everything (see flush)
+    condition_variable drained;
+    FILE *binary;
+    uint64_t reportedDropped;
+
+    _LogState() : ring(UpnpLog::RING_CAPACITY), writer(nullptr), binary(NULL), reportedDropped(0)
+    {
+#ifndef NDEBUG
+        defaultLevel = UpnpLog::LEVEL_DEBUG;
+#else
+        defaultLevel = UpnpLog::LEVEL_ERROR;
+#endif
+        running = false;
+        sleeping = false;
+    }
+} LogState;
+
+static bool configure(LogState *state, const string &spec);
+static bool setBinaryDump(LogState *state, const string &path);
+
+static LogState *getState()
+{
+    static LogState *s_state = nullptr;
+    static once_flag s_once;
+
+    call_once(s_once, [] ()
+    {
+        s_state = new LogState();
+
+        const char *levelSpec = getenv(LEVEL_ENV);
+        const char *binaryPath = getenv(BINARY_ENV);
+        if (levelSpec != NULL)
+        {
+            configure(s_state, levelSpec);
+        }
+        if (binaryPath != NULL)
+        {
+            setBinaryDump(s_state, binaryPath);
+        }
+        atexit(UpnpLog::stop);
+    });
+    return s_state;
+}
+
+static Module *getModule(LogState *state, const string &name)
+{
+    // Caller holds state->lock
+    Module *&module = state->modules[name];
+    if (module == nullptr)
+    {
+        module = new Module();
+        module->name = name;
+        module->level = state->defaultLevel;
+    }
+    return module;
+}
+
+static uint32_t getThreadId()
+{
+    static atomic<uint32_t> s_nextId(1);
+    static thread_local uint32_t t_id = 0;
+
+    if (t_id == 0)
+    {
+        t_id = s_nextId.fetch_add(1, memory_order_relaxed);
+    }
+    return t_id;
+}
+
+static uint64_t getTimestamp()
+{
+    return chrono::duration_cast<chrono::microseconds>(
+               chrono::system_clock::now().time_since_epoch()).count();
+}
+
+static void writeText(FILE *file, uint8_t level, const char *module, const char *function,
+                      const char *message, size_t length)
+{
+    fprintf(file, "%s:%s(): %s%.*s\n", module, function,
+            (level == UpnpLog::LEVEL_ERROR) ? "ERROR: " : "", (int) length, message);
+}
+
+static void writeBinary(FILE *file, const UpnpLogRing::Record &record)
+{
+    uint8_t moduleLength = (uint8_t) min(strlen(record.module), (size_t) UINT8_MAX);
+    uint8_t functionLength = (uint8_t) min(strlen(record.function), (size_t) UINT8_MAX);
+
+    fwrite(&record.timestamp, sizeof(record.timestamp), 1, file);
+    fwrite(&record.thread, sizeof(record.thread), 1, file);
+    fwrite(&record.level, sizeof(record.level), 1, file);
+    fwrite(&moduleLength, sizeof(moduleLength), 1, file);
+    fwrite(&functionLength, sizeof(functionLength), 1, file);
+    fwrite(&record.length, sizeof(record.length), 1, file);
+    fwrite(record.module, 1, moduleLength, file);
+    fwrite(record.function, 1, functionLength, file);
+    fwrite(record.message, 1, record.length, file);
+}
+
+static void runWriter(LogState *state)
+{
+    UpnpLogRing::Record record;
+
+    while (state->running.load(memory_order_acquire) || !state->ring.empty())
+    {
+        bool written = false;
+        unique_lock< mutex > lock(state->writeLock);
+        FILE *binary = state->binary;
+
+        while (state->ring.pop(record))
+        {
+            if (binary != NULL)
+            {
+                writeBinary(binary, record);
+            }
+            else
+            {
+                writeText((record.level == UpnpLog::LEVEL_ERROR) ? stderr : stdout,
+                          record.level, record.module, record.function, record.message, record.length);
+            }
+            written = true;
+        }
+
+        uint64_t dropped = state->ring.getDropped();
+        if (dropped != state->reportedDropped)
+        {
+            fprintf(stderr, "UpnpLog: %llu messages dropped (ring full)\n",
+                    (unsigned long long) (dropped - state->reportedDropped));
+            state->reportedDropped = dropped;
+            written = true;
+        }
+
+        if (written)
+        {
+            fflush(stdout);
+            fflush(stderr);
+            if (binary != NULL)
+            {
+                fflush(binary);
+            }
+            continue;
+        }
+        lock.unlock();
+
+        unique_lock< mutex > wakeLock(state->wakeLock);
+        state->sleeping.store(true, memory_order_relaxed);
+        // Pairs with the fence in write(): either the producer sees
+        // sleeping, or the record it pushed is seen here
+        atomic_thread_fence(memory_order_seq_cst);
+        state->drained.notify_all();
+        state->wake.wait(wakeLock, [state] ()
+        {
+            return !state->ring.empty() || !state->running.load(memory_order_acquire);
+        });
+        state->sleeping.store(false, memory_order_relaxed);
+    }
+
+    lock_guard< mutex > wakeLock(state->wakeLock);
+    state->sleeping.store(true, memory_order_relaxed);
+    state->drained.notify_all();
+}
+
+static void startWriter(LogState *state)
+{
+    lock_guard< mutex > lock(state->lock);
+    if (!state->running.load(memory_order_relaxed))
+    {
+        state->running.store(true, memory_order_release);
+        state->writer = new thread(runWriter, state);
+    }
+}
+
+UpnpLogRing::UpnpLogRing(size_t capacity)
+{
+    // Round up to a power of two
+    size_t size = 2;
+    while (size < capacity)
+    {
+        size <<= 1;
+    }
+
+    m_cells = new Cell[size];
+    m_mask = size - 1;
+    for (size_t i = 0; i < size; ++i)
+    {
+        m_cells[i].sequence.store(i, memory_order_relaxed);
+    }
+    m_enqueuePos = 0;
+    m_dequeuePos = 0;
+    m_dropped = 0;
+}
+
+UpnpLogRing::~UpnpLogRing()
+{
+    delete [] m_cells;
+}
+
+bool UpnpLogRing::pop(Record &record)
+{
+    size_t pos = m_dequeuePos.load(memory_order_relaxed);
+    Cell *cell = &m_cells[pos & m_mask];
+    size_t seq = cell->sequence.load(memory_order_acquire);
+
+    if ((intptr_t) seq - (intptr_t) (pos + 1) < 0)
+    {
+        return false;
+    }
+
+    record = cell->record;
+    cell->sequence.store(pos + m_mask + 1, memory_order_release);
+    m_dequeuePos.store(pos + 1, memory_order_relaxed);
+    return true;
+}
+
+bool UpnpLogRing::empty() const
+{
+    size_t pos = m_dequeuePos.load(memory_order_relaxed);
+    size_t seq = m_cells[pos & m_mask].sequence.load(memory_order_acquire);
+
+    return ((intptr_t) seq - (intptr_t) (pos + 1) < 0);
+}
+
+size_t UpnpLogRing::capacity() const
+{
+    return m_mask + 1;
+}
+
+uint64_t UpnpLogRing::getDropped() const
+{
+    return m_dropped.load(memory_order_relaxed);
+}
+
+UpnpLog::Site::Site(const string &moduleName, Level siteLevel)
+{
+    LogState *state = getState();
+    lock_guard< mutex > lock(state->lock);
+    Module *pModule = getModule(state, moduleName);
+
+    module = pModule->name.c_str();
+    level = siteLevel;
+    m_moduleLevel = &pModule->level;
+    m_windowStart = 0;
+    m_windowCount = 0;
+    m_suppressed = 0;
+}
+
+bool UpnpLog::Site::enabled()
+{
+    if (level > m_moduleLevel->load(memory_order_relaxed))
+    {
+        return false;
+    }
+
+    if (level != LEVEL_ERROR)
+    {
+        return true;
+    }
+
+    // Errors repeating in a loop must not flood the ring: allow a burst
+    // per period, count the rest. Races between threads only blur the
+    // window boundary.
+    uint64_t now = getTimestamp();
+    uint64_t windowStart = m_windowStart.load(memory_order_relaxed);
+    if (now - windowStart >= RATE_LIMIT_PERIOD)
+    {
+        m_windowStart.store(now, memory_order_relaxed);
+        m_windowCount.store(0, memory_order_relaxed);
+    }
+
+    if (m_windowCount.fetch_add(1, memory_order_relaxed) >= RATE_LIMIT_BURST)
+    {
+        m_suppressed.fetch_add(1, memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+uint32_t UpnpLog::Site::takeSuppressed()
+{
+    return m_suppressed.exchange(0, memory_order_relaxed);
+}
+
+static void setLevel(LogState *state, const string &module, UpnpLog::Level level)
+{
+    lock_guard< mutex > lock(state->lock);
+
+    if (module.empty() || module == "*")
+    {
+        state->defaultLevel = level;
+        for (auto &entry : state->modules)
+        {
+            entry.second->level.store(level, memory_order_relaxed);
+        }
+    }
+    else
+    {
+        getModule(state, module)->level.store(level, memory_order_relaxed);
+    }
+}
+
+static bool configure(LogState *state, const string &spec)
+{
+    bool status = true;
+    stringstream entries(spec);
+    string entry;
+
+    while (getline(entries, entry, ','))
+    {
+        UpnpLog::Level level;
+        size_t pos = entry.find('=');
+        string module = (pos == string::npos) ? "*" : entry.substr(0, pos);
+        string levelName = (pos == string::npos) ? entry : entry.substr(pos + 1);
+
+        if (UpnpLog::parseLevel(levelName, level))
+        {
+            setLevel(state, module, level);
+        }
+        else
+        {
+            fprintf(stderr, "UpnpLog: invalid log level '%s'\n", entry.c_str());
+            status = false;
+        }
+    }
+    return status;
+}
+
+static bool setBinaryDump(LogState *state, const string &path)
+{
+    FILE *file = path.empty() ? NULL : fopen(path.c_str(), "wb");
+
+    if (!path.empty() && file == NULL)
+    {
+        fprintf(stderr, "UpnpLog: failed to open %s\n", path.c_str());
+        return false;
+    }
+
+    lock_guard< mutex > lock(state->writeLock);
+    if (state->binary != NULL)
+    {
+        fclose(state->binary);
+    }
+    state->binary = file;
+    return true;
+}
+
+void UpnpLog::setLevel(const string &module, Level level)
+{
+    ::setLevel(getState(), module, level);
+}
+
+UpnpLog::Level UpnpLog::getLevel(const string &module)
+{
+    LogState *state = getState();
+    lock_guard< mutex > lock(state->lock);
+
+    return (Level) getModule(state, module)->level.load(memory_order_relaxed);
+}
+
+bool UpnpLog::parseLevel(const string &name, Level &level)
+{
+    for (size_t i = 0; i < sizeof(LEVEL_NAMES) / sizeof(LEVEL_NAMES[0]); ++i)
+    {
+        if (name == LEVEL_NAMES[i])
+        {
+            level = (Level) i;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool UpnpLog::configure(const string &spec)
+{
+    return ::configure(getState(), spec);
+}
+
+ostringstream &UpnpLog::stream()
+{
+    static thread_local ostringstream t_stream;
+
+    t_stream.str("");
+    t_stream.clear();
+    return t_stream;
+}
+
+void UpnpLog::write(Site &site, const char *function, const string &message)
+{
+    LogState *state = getState();
+    uint32_t suppressed = (site.level == LEVEL_ERROR) ? site.takeSuppressed() : 0;
+
+    if (!state->running.load(memory_order_acquire))
+    {
+        startWriter(state);
+    }
+
+    state->ring.push([&] (UpnpLogRing::Record & record)
+    {
+        size_t length = min(message.size(), UpnpLogRing::MESSAGE_SIZE);
+
+        record.timestamp = getTimestamp();
+        record.thread = getThreadId();
+        record.level = (uint8_t) site.level;
+        record.module = site.module;
+        record.function = function;
+        memcpy(record.message, message.data(), length);
+
+        if (suppressed != 0 && length < UpnpLogRing::MESSAGE_SIZE)
+        {
+            int n = snprintf(record.message + length, UpnpLogRing::MESSAGE_SIZE - length,
+                             " (%u similar messages suppressed)", suppressed);
+            length = min(length + (size_t) max(n, 0), UpnpLogRing::MESSAGE_SIZE - 1);
+        }
+        record.length = (uint16_t) length;
+    });
+
+    // Only wake the writer up if it waits: a fence and a load otherwise
+    atomic_thread_fence(memory_order_seq_cst);
+    if (state->sleeping.load(memory_order_relaxed))
+    {
+        lock_guard< mutex > lock(state->wakeLock);
+        state->wake.notify_one();
+    }
+}
+
+bool UpnpLog::setBinaryDump(const string &path)
+{
+    return ::setBinaryDump(getState(), path);
+}
+
+void UpnpLog::decodeBinary(istream &is, ostream &os)
+{
+    for (;;)
+    {
+        uint64_t timestamp;
+        uint32_t thread;
+        uint8_t level;
+        uint8_t moduleLength;
+        uint8_t functionLength;
+        uint16_t length;
+
+        is.read((char *) &timestamp, sizeof(timestamp));
+        is.read((char *) &thread, sizeof(thread));
+        is.read((char *) &level, sizeof(level));
+        is.read((char *) &moduleLength, sizeof(moduleLength));
+        is.read((char *) &functionLength, sizeof(functionLength));
+        is.read((char *) &length, sizeof(length));
+        if (!is)
+        {
+            break;
+        }
+
+        string module(moduleLength, '\0');
+        string function(functionLength, '\0');
+        string message(length, '\0');
+        is.read(&module[0], moduleLength);
+        is.read(&function[0], functionLength);
+        is.read(&message[0], length);
+        if (!is)
+        {
+            break;
+        }
+
+        char time[32];
+        snprintf(time, sizeof(time), "%llu.%06llu",
+                 (unsigned long long) (timestamp / 1000000), (unsigned long long) (timestamp % 1000000));
+        os << time << " [" << thread << "] " << module << ":" << function << "(): " <<
+           ((level == LEVEL_ERROR) ? "ERROR: " : "") << message << std::endl;
+    }
+}
+
+void UpnpLog::flush()
+{
+    LogState *state = getState();
+    unique_lock< mutex > lock(state->wakeLock);
+
+    state->drained.wait_for(lock, chrono::milliseconds(FLUSH_TIMEOUT_MS), [state] ()
+    {
+        return !state->running.load(memory_order_acquire) ||
+               (state->ring.empty() && state->sleeping.load(memory_order_relaxed));
+    });
+}
+
+void UpnpLog::stop()
+{
+    LogState *state = getState();
+    thread *writer;
+
+    {
+        lock_guard< mutex > lock(state->lock);
+        writer = state->writer;
+        state->writer = nullptr;
+        state->running.store(false, memory_order_release);
+    }
+
+    {
+        lock_guard< mutex > lock(state->wakeLock);
+        state->wake.notify_one();
+    }
+
+    if (writer != nullptr)
+    {
+        writer->join();
+        delete writer;
+    }
+}
+
+uint64_t UpnpLog::getDropped()
+{
+    return getState()->ring.getDropped();
+}
@@ -0,0 +1,194 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#ifndef UPNP_LOG_H_
+#define UPNP_LOG_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <string>
+
+// Bounded lock-free multi-producer ring of fixed size log records
+// (Vyukov's bounded queue). push() never blocks: when the ring is full
+// the record is dropped and counted.
+class UpnpLogRing
+{
+    public:
+        static const size_t MESSAGE_SIZE = 480;
+
+        typedef struct _Record
+        {
+            uint64_t timestamp;    // us since the epoch
+            uint32_t thread;
+            uint8_t level;
+            const char *module;    // static storage (module registry)
+            const char *function;  // static storage (__func__)
+            uint16_t length;
+            char message[MESSAGE_SIZE];
+        } Record;
+
+        explicit UpnpLogRing(size_t capacity);
+        ~UpnpLogRing();
+
+        // Claims a slot and lets fill() write the record in place
+        template <typename F>
+        bool push(F fill)
+        {
+            Cell *cell;
+            size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+
+            for (;;)
+            {
+                cell = &m_cells[pos & m_mask];
+                size_t seq = cell->sequence.load(std::memory_order_acquire);
+                intptr_t diff = (intptr_t) seq - (intptr_t) pos;
+
+                if (diff == 0)
+                {
+                    if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    {
+                        break;
+                    }
+                }
+                else if (diff < 0)
+                {
+                    m_dropped.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+                else
+                {
+                    pos = m_enqueuePos.load(std::memory_order_relaxed);
+                }
+            }
+
+            fill(cell->record);
+            cell->sequence.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Single consumer
+        bool pop(Record &record);
+
+        bool empty() const;
+        size_t capacity() const;
+        uint64_t getDropped() const;
+
+    private:
+        typedef struct _Cell
+        {
+            std::atomic<size_t> sequence;
+            Record record;
+        } Cell;
+
+        Cell *m_cells;
+        size_t m_mask;
+        std::atomic<size_t> m_enqueuePos;
+        std::atomic<size_t> m_dequeuePos;
+        std::atomic<uint64_t> m_dropped;
+
+        UpnpLogRing(const UpnpLogRing &);
+        UpnpLogRing &operator=(const UpnpLogRing &);
+};
+
+// Asynchronous logger behind DEBUG_PRINT/ERROR_PRINT.
+//
+// Callers format the message body only (into a thread local stream) and
+// only when the level is enabled for their module; timestamps, prefixes
+// and the I/O are done by a writer thread draining the ring, so logging
+// never blocks the GLib loop on a stream lock or a flush.
+//
+// Levels are per module (the MODULE name of each file) and can be changed
+// at runtime with setLevel()/configure(). UPNP_LOG_LEVEL is read at start
+// up, e.g. "error,UpnpConnector=debug" (a bare level applies to all modules).
+// Each error call site is rate limited to RATE_LIMIT_BURST messages per
+// second; the number of suppressed messages is reported with the next one.
+// UPNP_LOG_BINARY=<file> (or setBinaryDump()) writes raw records to <file>
+// instead of formatted text, decodeBinary() turns them back into text.
+class UpnpLog
+{
+    public:
+        typedef enum
+        {
+            LEVEL_OFF = 0,
+            LEVEL_ERROR,
+            LEVEL_INFO,
+            LEVEL_DEBUG
+        } Level;
+
+        static const size_t RING_CAPACITY = 1024;
+        static const uint32_t RATE_LIMIT_BURST = 10;
+        static const uint64_t RATE_LIMIT_PERIOD = 1000000;
+
+        // Per call site state, static in the logging macros
+        class Site
+        {
+            public:
+                Site(const std::string &module, Level level);
+
+                bool enabled();
+                uint32_t takeSuppressed();
+
+                const char *module;
+                Level level;
+
+            private:
+                const std::atomic<int> *m_moduleLevel;
+                std::atomic<uint64_t> m_windowStart;
+                std::atomic<uint32_t> m_windowCount;
+                std::atomic<uint32_t> m_suppressed;
+        };
+
+        static void setLevel(const std::string &module, Level level);
+        static Level getLevel(const std::string &module);
+
+        // Comma separated "level" or "module=level" entries
+        static bool configure(const std::string &spec);
+        static bool parseLevel(const std::string &name, Level &level);
+
+        static std::ostringstream &stream();
+        static void write(Site &site, const char *function, const std::string &message);
+
+        static bool setBinaryDump(const std::string &path);
+        static void decodeBinary(std::istream &is, std::ostream &os);
+
+        // Waits until the ring has been drained by the writer
+        static void flush();
+        // Drains the ring and stops the writer (restarted by the next write)
+        static void stop();
+
+        static uint64_t getDropped();
+};
+
+#define UPNP_LOG(lvl, x) \
+    do { \
+        static UpnpLog::Site _logSite(MODULE, lvl); \
+        if (_logSite.enabled()) \
+        { \
+            std::ostringstream &_logStream = UpnpLog::stream(); \
+            _logStream << x; \
+            UpnpLog::write(_logSite, __func__, _logStream.str()); \
+        } \
+    } while (0)
+
+#endif
@@ -258,6 +258,7 @@ UpnpResource::Ptr UpnpManager::processService(GUPnPServiceProxy *proxy,
     if (introspection != NULL)
     {
         pService->processIntrospection(proxy, introspection);
+        pService->setIntrospected(true);
     }
 
     pService->setProxy(proxy);
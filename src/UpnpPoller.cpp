@@ -0,0 +1,255 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include <algorithm>
+#include <vector>
+
+#include "UpnpPoller.h"
+#include "UpnpDeviceHealth.h"
+#include "UpnpInternal.h"
+#include "UpnpService.h"
+
+using namespace std;
+
+static const string MODULE = "UpnpPoller";
+
+const guint UpnpPoller::MIN_INTERVAL;
+const guint UpnpPoller::INITIAL_INTERVAL;
+const guint UpnpPoller::MAX_INTERVAL;
+const guint UpnpPoller::BATCH_WINDOW;
+
+UpnpPoller::UpnpPoller(GMainContext *context, bool enabled) :
+    m_context(context), m_enabled(enabled), m_timer(NULL), m_timerDue(0), m_services(0), m_pollCount(0), m_changeCount(0)
+{
+}
+
+UpnpPoller::~UpnpPoller()
+{
+    stopTimer();
+    for (auto &it : m_polls)
+    {
+        if (it.second->inProgress)
+        {
+            it.second->removed = true;
+        }
+        else
+        {
+            delete it.second;
+        }
+    }
+}
+
+void UpnpPoller::add(UpnpService *service)
+{
+    if (!m_enabled || m_polls.find(service) != m_polls.end())
+    {
+        return;
+    }
+
+    set< string > attributes = service->getUneventedAttributes();
+    if (attributes.empty())
+    {
+        return;
+    }
+
+    DEBUG_PRINT("Polling " << attributes.size() << " attributes of " << service->m_uri);
+    Poll *poll = new Poll();
+    poll->poller = this;
+    poll->service = service;
+    poll->udn = service->getUdn();
+    poll->attributes.swap(attributes);
+    poll->interval = INITIAL_INTERVAL;
+    poll->due = g_get_monotonic_time() + g_random_int_range(0, INITIAL_INTERVAL) * 1000;
+    poll->inProgress = false;
+    poll->removed = false;
+    m_polls[service] = poll;
+    m_services = m_polls.size();
+
+    rearm();
+}
+
+void UpnpPoller::remove(UpnpService *service)
+{
+    auto it = m_polls.find(service);
+
+    if (it == m_polls.end())
+    {
+        return;
+    }
+
+    if (it->second->inProgress)
+    {
+        // The request still refers to the attributes
+        it->second->removed = true;
+    }
+    else
+    {
+        delete it->second;
+    }
+    m_polls.erase(it);
+    m_services = m_polls.size();
+    rearm();
+}
+
+void UpnpPoller::start(Poll *poll, gint64 now)
+{
+    if (!UpnpDeviceHealth::isAvailable(poll->udn))
+    {
+        poll->due = now + poll->interval * 1000;
+        return;
+    }
+
+    poll->inProgress = true;
+    m_pollCount++;
+    poll->service->beginRefresh(&poll->attributes, onPolled, poll);
+}
+
+void UpnpPoller::onPolled(UpnpRequest *request, bool status)
+{
+    Poll *poll = static_cast<Poll *> (request->data);
+
+    UpnpRequest::release(request);
+    if (poll->removed)
+    {
+        delete poll;
+        return;
+    }
+
+    UpnpPoller *poller = poll->poller;
+    bool changed = false;
+
+    poll->inProgress = false;
+    if (status)
+    {
+        // Kept alive by the reference, whatever is set meanwhile
+        UpnpResource::Snapshot snapshot = poll->service->getSnapshot();
+        const RCSResourceAttributes &attrs = *snapshot;
+
+        for (auto &name : poll->attributes)
+        {
+            if (!attrs.contains(name))
+            {
+                continue;
+            }
+
+            const RCSResourceAttributes::Value &value = attrs.at(name);
+            if (poll->values.contains(name) && !(poll->values.at(name) == value))
+            {
+                DEBUG_PRINT(poll->service->m_uri << ": " << name << " changed");
+                poll->service->setAttribute(name, value, true);
+                poller->m_changeCount++;
+                changed = true;
+            }
+            poll->values[name] = value;
+        }
+    }
+
+    if (changed)
+    {
+        poll->interval = std::max(MIN_INTERVAL, poll->interval / 2);
+    }
+    else
+    {
+        poll->interval = std::min(MAX_INTERVAL, poll->interval + poll->interval / 2);
+    }
+    poll->due = g_get_monotonic_time() + poll->interval * 1000;
+
+    poller->rearm();
+}
+
+void UpnpPoller::rearm()
+{
+    gint64 due = 0;
+
+    for (auto &it : m_polls)
+    {
+        if (!it.second->inProgress && (due == 0 || it.second->due < due))
+        {
+            due = it.second->due;
+        }
+    }
+
+    if (m_timer != NULL && m_timerDue == due)
+    {
+        return;
+    }
+    stopTimer();
+
+    if (due == 0)
+    {
+        return;
+    }
+
+    gint64 delay = due - g_get_monotonic_time();
+    m_timer = g_timeout_source_new((delay > 0) ? (guint) (delay / 1000) : 0);
+    g_source_set_callback(m_timer, onTimer, this, NULL);
+    g_source_attach(m_timer, m_context);
+    m_timerDue = due;
+}
+
+void UpnpPoller::stopTimer()
+{
+    if (m_timer != NULL)
+    {
+        g_source_destroy(m_timer);
+        g_source_unref(m_timer);
+        m_timer = NULL;
+    }
+}
+
+gboolean UpnpPoller::onTimer(gpointer userData)
+{
+    UpnpPoller *poller = static_cast<UpnpPoller *> (userData);
+    gint64 now = g_get_monotonic_time();
+    set< string > devices;
+    vector< Poll * > polls;
+
+    // Removed on return
+    g_source_unref(poller->m_timer);
+    poller->m_timer = NULL;
+
+    for (auto &it : poller->m_polls)
+    {
+        if (!it.second->inProgress && it.second->due <= now)
+        {
+            devices.insert(it.second->udn);
+        }
+    }
+
+    // Along with the services of the same devices due soon
+    for (auto &it : poller->m_polls)
+    {
+        Poll *poll = it.second;
+
+        if (!poll->inProgress && poll->due <= now + BATCH_WINDOW * 1000 && devices.count(poll->udn) != 0)
+        {
+            polls.push_back(poll);
+        }
+    }
+
+    // Completions may come before returning
+    for (auto poll : polls)
+    {
+        poller->start(poll, now);
+    }
+
+    poller->rearm();
+    return G_SOURCE_REMOVE;
+}
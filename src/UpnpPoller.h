@@ -0,0 +1,111 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#ifndef UPNP_POLLER_H_
+#define UPNP_POLLER_H_
+
+#include <atomic>
+#include <map>
+#include <set>
+#include <string>
+
+#include <glib.h>
+
+#include <RCSResourceAttributes.h>
+
+#include "UpnpRequest.h"
+
+class UpnpService;
+
+// Polls the attributes of the observed services that are not evented, so
+// that their observers still get notified of the changes.
+//
+// Each service is polled (one GET of its unevented attributes, as observe
+// refresh) at its own interval: halved when a value has changed, grown by
+// half when none has, within [MIN_INTERVAL, MAX_INTERVAL]. The polls of the
+// services of one device are batched: once one is due, those due within
+// BATCH_WINDOW are polled along. Observers are notified of the values that
+// differ from the previous poll only. All the polls share a single timer.
+//
+// Opt-in: the services are enrolled when introspected, but nothing is polled
+// unless the bridge runs with UPNP_POLLING set (and not "0"), as polling every
+// service costs one action per service and interval on the network.
+//
+// Not thread safe: to be used from the thread running the main context.
+class UpnpPoller
+{
+    public:
+        // Intervals (ms)
+        static const guint MIN_INTERVAL = 1000;
+        static const guint INITIAL_INTERVAL = 5000;
+        static const guint MAX_INTERVAL = 60000;
+        static const guint BATCH_WINDOW = 2000;
+
+        // Nothing is polled unless enabled (UPNP_POLLING)
+        UpnpPoller(GMainContext *context, bool enabled);
+        ~UpnpPoller();
+
+        // Does nothing if the (introspected) service has no unevented
+        // attribute
+        void add(UpnpService *service);
+        void remove(UpnpService *service);
+
+        // Any thread
+        size_t getServices() { return m_services; }
+        uint64_t getPollCount() { return m_pollCount; }
+        uint64_t getChangeCount() { return m_changeCount; }
+
+    private:
+        typedef struct _Poll
+        {
+            UpnpPoller *poller;
+            UpnpService *service;
+            std::string udn;
+            std::set< std::string > attributes;
+            // Values from the previous poll
+            OIC::Service::RCSResourceAttributes values;
+            guint interval;
+            gint64 due;
+            bool inProgress;
+            // Removed while in progress, deleted once done
+            bool removed;
+        } Poll;
+
+        GMainContext *m_context;
+        bool m_enabled;
+        GSource *m_timer;
+        gint64 m_timerDue;
+        std::map< UpnpService *, Poll * > m_polls;
+        std::atomic< size_t > m_services;
+        std::atomic< uint64_t > m_pollCount;
+        std::atomic< uint64_t > m_changeCount;
+
+        void start(Poll *poll, gint64 now);
+        void rearm();
+        void stopTimer();
+
+        static gboolean onTimer(gpointer userData);
+        static void onPolled(UpnpRequest *request, bool status);
+
+        UpnpPoller(const UpnpPoller &);
+        UpnpPoller &operator=(const UpnpPoller &);
+};
+
+#endif
@@ -0,0 +1,435 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "UpnpPortMappingBatch.h"
+#include "UpnpActionStats.h"
+
+using namespace OIC::Service;
+
+static const string MODULE = "UpnpPortMappingBatch";
+
+bool UpnpPortMappingBatch::start(GUPnPServiceProxy *proxy,
+                                 UpnpRequest *request,
+                                 const string &attrName,
+                                 const Capabilities &capabilities,
+                                 const CompositeAttribute &entries,
+                                 Set *running,
+                                 function< void() > onComplete)
+{
+    if (entries.empty())
+    {
+        ERROR_PRINT("Empty batch");
+        return false;
+    }
+
+    UpnpPortMappingBatch *batch = new UpnpPortMappingBatch(proxy, request, attrName, capabilities,
+            running, onComplete);
+
+    for (const auto &attrs : entries)
+    {
+        Entry entry;
+
+        if (!parseEntry(attrs, entry))
+        {
+            ERROR_PRINT("Invalid batch entry #" << batch->m_entries.size());
+            delete batch;
+            return false;
+        }
+
+        size_t count = 1;
+        if ((entry.externalPortEnd != 0) && !capabilities.deletePortMappingRange)
+        {
+            count += entry.externalPortEnd - entry.mapping.externalPort;
+        }
+        if (batch->m_entries.size() + count > MAX_ENTRIES)
+        {
+            ERROR_PRINT("Batch larger than " << MAX_ENTRIES << " operations");
+            delete batch;
+            return false;
+        }
+
+        if (count > 1)
+        {
+            // No range deletion on this IGD: one deletion per port
+            unsigned int lastPort = entry.externalPortEnd;
+
+            entry.externalPortEnd = 0;
+            for (; entry.mapping.externalPort < lastPort; entry.mapping.externalPort++)
+            {
+                batch->m_entries.push_back(entry);
+            }
+        }
+        batch->m_entries.push_back(entry);
+    }
+
+    DEBUG_PRINT(batch->m_entries.size() << " entries");
+    batch->fillWindow();
+
+    if (batch->m_pendingActions.empty())
+    {
+        // None of the actions could be issued: report failure right away
+        ERROR_PRINT("Failed to start batch");
+        delete batch;
+        return false;
+    }
+
+    if (running != nullptr)
+    {
+        running->insert(batch);
+    }
+    return true;
+}
+
+void UpnpPortMappingBatch::cancelAll(Set &running)
+{
+    Set batches;
+
+    batches.swap(running);
+    for (auto batch : batches)
+    {
+        batch->m_running = nullptr;
+        batch->cancel();
+    }
+}
+
+void UpnpPortMappingBatch::cancel()
+{
+    DEBUG_PRINT(m_pendingActions.size() << " actions in flight");
+
+    // The action callbacks are not invoked once cancelled
+    for (auto &pending : m_pendingActions)
+    {
+        UpnpActionStats::cancelAction(m_proxy, pending.first);
+    }
+    m_pendingActions.clear();
+
+    UpnpRequest::requestDone(m_request, false);
+    delete this;
+}
+
+UpnpPortMappingBatch::UpnpPortMappingBatch(GUPnPServiceProxy *proxy,
+                                           UpnpRequest *request,
+                                           const string &attrName,
+                                           const Capabilities &capabilities,
+                                           Set *running,
+                                           function< void() > onComplete)
+{
+    m_proxy = proxy;
+    m_request = request;
+    m_attrName = attrName;
+    m_capabilities = capabilities;
+    m_onComplete = onComplete;
+    m_running = running;
+    m_next = 0;
+}
+
+bool UpnpPortMappingBatch::parseEntry(const RCSResourceAttributes &attrs, Entry &entry)
+{
+    if (!attrs.contains("op") || !attrs.contains("protocol") || !attrs.contains("externalPort"))
+    {
+        return false;
+    }
+
+    string op = attrs.at("op").get< string >();
+    if (op == "add")
+    {
+        entry.op = PORT_MAPPING_ADD;
+        if (!attrs.contains("internalPort") || !attrs.contains("internalClient"))
+        {
+            return false;
+        }
+    }
+    else if (op == "delete")
+    {
+        entry.op = PORT_MAPPING_DELETE;
+    }
+    else
+    {
+        return false;
+    }
+
+    entry.mapping.protocol       = attrs.at("protocol").get< string >();
+    entry.mapping.externalPort   = attrs.at("externalPort").get< int >();
+    entry.mapping.remoteHost     = attrs.contains("remoteHost") ?
+                                   attrs.at("remoteHost").get< string >() : "";
+    entry.mapping.internalPort   = attrs.contains("internalPort") ?
+                                   attrs.at("internalPort").get< int >() : 0;
+    entry.mapping.internalClient = attrs.contains("internalClient") ?
+                                   attrs.at("internalClient").get< string >() : "";
+    entry.mapping.enabled        = attrs.contains("enabled") ? attrs.at("enabled").get< bool >() : true;
+    entry.mapping.description    = attrs.contains("description") ?
+                                   attrs.at("description").get< string >() : "";
+    entry.mapping.leaseDuration  = attrs.contains("leaseDuration") ?
+                                   attrs.at("leaseDuration").get< int >() : 0;
+    entry.externalPortEnd        = attrs.contains("externalPortEnd") ?
+                                   attrs.at("externalPortEnd").get< int >() : 0;
+    entry.manage                 = attrs.contains("manage") ? attrs.at("manage").get< bool >() : false;
+
+    if ((entry.externalPortEnd != 0) &&
+        ((entry.op != PORT_MAPPING_DELETE) || (entry.externalPortEnd < entry.mapping.externalPort) ||
+         (entry.externalPortEnd > 65535)))
+    {
+        return false;
+    }
+
+    entry.done = false;
+    entry.success = false;
+    entry.errorCode = 0;
+    return true;
+}
+
+// Whether the operations may act on the same mapping. A range deletion
+// covers the mappings of its protocol on all the ports of the range,
+// whatever their remote host.
+bool UpnpPortMappingBatch::overlaps(const Entry &entry, const Entry &other)
+{
+    if ((entry.externalPortEnd == 0) && (other.externalPortEnd == 0))
+    {
+        return UpnpPortMappingTable::getKey(entry.mapping) == UpnpPortMappingTable::getKey(other.mapping);
+    }
+
+    unsigned int end = (entry.externalPortEnd != 0) ? entry.externalPortEnd : entry.mapping.externalPort;
+    unsigned int otherEnd = (other.externalPortEnd != 0) ? other.externalPortEnd : other.mapping.externalPort;
+
+    return (entry.mapping.protocol == other.mapping.protocol) &&
+           (entry.mapping.externalPort <= otherEnd) && (other.mapping.externalPort <= end);
+}
+
+bool UpnpPortMappingBatch::isPending(const Entry &entry)
+{
+    for (auto &pending : m_pendingActions)
+    {
+        if (overlaps(m_entries[pending.second], entry))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void UpnpPortMappingBatch::fillWindow()
+{
+    while ((m_pendingActions.size() < WINDOW) && (m_next < m_entries.size()))
+    {
+        Entry &entry = m_entries[m_next];
+
+        // Keep the order of the operations on the same mapping
+        if (isPending(entry))
+        {
+            break;
+        }
+
+        GUPnPServiceProxyAction *actionProxy = beginAction(entry);
+        if (NULL == actionProxy)
+        {
+            entry.done = true;
+            entry.errorDescription = "Failed to issue action";
+        }
+        else
+        {
+            m_pendingActions[actionProxy] = m_next;
+        }
+        m_next++;
+    }
+}
+
+GUPnPServiceProxyAction *UpnpPortMappingBatch::beginAction(Entry &entry)
+{
+    const UpnpPortMapping &mapping = entry.mapping;
+
+    if (entry.op == PORT_MAPPING_ADD)
+    {
+        // AddAnyPortMapping picks another external port on conflict
+        // instead of failing
+        const char *action = m_capabilities.addAnyPortMapping ? "AddAnyPortMapping" : "AddPortMapping";
+
+        DEBUG_PRINT(action << ": " << mapping.protocol << " " << mapping.externalPort << " -> " <<
+                    mapping.internalClient << ":" << mapping.internalPort);
+        return UpnpActionStats::beginAction (m_proxy,
+                                             action,
+                                             actionCb,
+                                             (gpointer *) this,
+                                             "NewRemoteHost",
+                                             G_TYPE_STRING,
+                                             mapping.remoteHost.c_str(),
+                                             "NewExternalPort",
+                                             G_TYPE_UINT,
+                                             mapping.externalPort,
+                                             "NewProtocol",
+                                             G_TYPE_STRING,
+                                             mapping.protocol.c_str(),
+                                             "NewInternalPort",
+                                             G_TYPE_UINT,
+                                             mapping.internalPort,
+                                             "NewInternalClient",
+                                             G_TYPE_STRING,
+                                             mapping.internalClient.c_str(),
+                                             "NewEnabled",
+                                             G_TYPE_BOOLEAN,
+                                             (gboolean) mapping.enabled,
+                                             "NewPortMappingDescription",
+                                             G_TYPE_STRING,
+                                             mapping.description.c_str(),
+                                             "NewLeaseDuration",
+                                             G_TYPE_UINT,
+                                             mapping.leaseDuration,
+                                             NULL);
+    }
+
+    if ((entry.externalPortEnd != 0) && m_capabilities.deletePortMappingRange)
+    {
+        DEBUG_PRINT("DeletePortMappingRange: " << mapping.protocol << " " << mapping.externalPort <<
+                    "-" << entry.externalPortEnd);
+        return UpnpActionStats::beginAction (m_proxy,
+                                             "DeletePortMappingRange",
+                                             actionCb,
+                                             (gpointer *) this,
+                                             "NewStartPort",
+                                             G_TYPE_UINT,
+                                             mapping.externalPort,
+                                             "NewEndPort",
+                                             G_TYPE_UINT,
+                                             entry.externalPortEnd,
+                                             "NewProtocol",
+                                             G_TYPE_STRING,
+                                             mapping.protocol.c_str(),
+                                             "NewManage",
+                                             G_TYPE_BOOLEAN,
+                                             (gboolean) entry.manage,
+                                             NULL);
+    }
+
+    DEBUG_PRINT("DeletePortMapping: " << mapping.protocol << " " << mapping.externalPort);
+    return UpnpActionStats::beginAction (m_proxy,
+                                         "DeletePortMapping",
+                                         actionCb,
+                                         (gpointer *) this,
+                                         "NewRemoteHost",
+                                         G_TYPE_STRING,
+                                         mapping.remoteHost.c_str(),
+                                         "NewExternalPort",
+                                         G_TYPE_UINT,
+                                         mapping.externalPort,
+                                         "NewProtocol",
+                                         G_TYPE_STRING,
+                                         mapping.protocol.c_str(),
+                                         NULL);
+}
+
+void UpnpPortMappingBatch::actionCb(GUPnPServiceProxy *proxy,
+                                    GUPnPServiceProxyAction *actionProxy,
+                                    gpointer userData)
+{
+    GError *error = NULL;
+    guint reservedPort = 0;
+    bool status;
+
+    UpnpPortMappingBatch *batch = static_cast<UpnpPortMappingBatch *> (userData);
+
+    std::map< GUPnPServiceProxyAction *, size_t >::iterator it = batch->m_pendingActions.find(actionProxy);
+    assert(it != batch->m_pendingActions.end());
+
+    Entry &entry = batch->m_entries[it->second];
+    batch->m_pendingActions.erase(it);
+
+    if ((entry.op == PORT_MAPPING_ADD) && batch->m_capabilities.addAnyPortMapping)
+    {
+        status = UpnpActionStats::endAction (proxy,
+                                             actionProxy,
+                                             &error,
+                                             "NewReservedPort",
+                                             G_TYPE_UINT,
+                                             &reservedPort,
+                                             NULL);
+    }
+    else
+    {
+        status = UpnpActionStats::endAction (proxy,
+                                             actionProxy,
+                                             &error,
+                                             NULL);
+    }
+
+    if (error)
+    {
+        ERROR_PRINT("Port mapping " << entry.mapping.protocol << " " << entry.mapping.externalPort <<
+                    " failed: " << error->code << ", " << error->message);
+        entry.errorCode = error->code;
+        entry.errorDescription = error->message;
+        g_error_free (error);
+        status = false;
+    }
+
+    if (status && (reservedPort != 0))
+    {
+        // The IGD may have picked a different external port
+        entry.mapping.externalPort = reservedPort;
+    }
+
+    entry.done = true;
+    entry.success = status;
+
+    batch->fillWindow();
+
+    if (batch->m_pendingActions.empty())
+    {
+        batch->finish();
+    }
+}
+
+void UpnpPortMappingBatch::finish()
+{
+    CompositeAttribute results;
+    bool status = false;
+
+    for (auto &entry : m_entries)
+    {
+        RCSResourceAttributes result;
+
+        result["op"]           = string((entry.op == PORT_MAPPING_ADD) ? "add" : "delete");
+        result["protocol"]     = entry.mapping.protocol;
+        result["externalPort"] = (int) entry.mapping.externalPort;
+        result["success"]      = entry.success;
+        if (!entry.success)
+        {
+            result["errorCode"]        = entry.errorCode;
+            result["errorDescription"] = entry.errorDescription;
+        }
+        results.push_back(result);
+
+        status |= entry.success;
+    }
+
+    DEBUG_PRINT(results.size() << " results");
+    m_request->resource->setAttribute(m_attrName, results, false);
+
+    if (m_onComplete)
+    {
+        m_onComplete();
+    }
+
+    if (m_running != nullptr)
+    {
+        m_running->erase(this);
+    }
+
+    UpnpRequest::requestDone(m_request, status);
+    delete this;
+}
@@ -0,0 +1,133 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#ifndef UPNP_PORT_MAPPING_BATCH_H_
+#define UPNP_PORT_MAPPING_BATCH_H_
+
+#include <functional>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <gupnp.h>
+
+#include "UpnpInternal.h"
+#include "UpnpPortMappingTable.h"
+#include "UpnpRequest.h"
+
+using namespace std;
+
+// Executes a list of port mapping additions/deletions for one POST request,
+// keeping up to WINDOW actions in flight. Operations on the same mapping
+// (or on a port of a range deletion) are never reordered. The per-entry
+// results are stored in the request attribute, the request completes once
+// all operations are done.
+//
+// The object deletes itself on completion, or when cancelled by the
+// service (cancelAll). All the methods must be called from the gupnp
+// thread.
+class UpnpPortMappingBatch
+{
+    public:
+        static const unsigned int WINDOW = 4;
+        // Operations in a batch, once the range deletions are expanded to
+        // one deletion per port (IGDs without DeletePortMappingRange)
+        static const unsigned int MAX_ENTRIES = 256;
+
+        // Batches in progress on a service
+        typedef std::set< UpnpPortMappingBatch * > Set;
+
+        // IGD2 actions supported by the service
+        typedef struct _Capabilities
+        {
+            bool addAnyPortMapping;
+            bool deletePortMappingRange;
+        } Capabilities;
+
+        // Returns false if the batch is malformed or too large (nothing is
+        // started). The batch is in running until done.
+        static bool start(GUPnPServiceProxy *proxy,
+                          UpnpRequest *request,
+                          const string &attrName,
+                          const Capabilities &capabilities,
+                          const CompositeAttribute &entries,
+                          Set *running,
+                          function< void() > onComplete);
+
+        // Cancels the actions of the batches in running and fails their
+        // requests, without calling onComplete (service stopping)
+        static void cancelAll(Set &running);
+
+    private:
+        typedef enum
+        {
+            PORT_MAPPING_ADD = 0,
+            PORT_MAPPING_DELETE
+        } Operation;
+
+        typedef struct _Entry
+        {
+            Operation op;
+            UpnpPortMapping mapping;
+            // Last port of a range deletion (0 if single mapping)
+            unsigned int externalPortEnd;
+            bool manage;
+
+            // Results
+            bool done;
+            bool success;
+            int errorCode;
+            string errorDescription;
+        } Entry;
+
+        GUPnPServiceProxy *m_proxy;
+        UpnpRequest *m_request;
+        string m_attrName;
+        Capabilities m_capabilities;
+        function< void() > m_onComplete;
+        Set *m_running;
+
+        vector <Entry> m_entries;
+        size_t m_next;
+        map <GUPnPServiceProxyAction *, size_t> m_pendingActions;
+
+        UpnpPortMappingBatch(GUPnPServiceProxy *proxy,
+                             UpnpRequest *request,
+                             const string &attrName,
+                             const Capabilities &capabilities,
+                             Set *running,
+                             function< void() > onComplete);
+
+        static bool parseEntry(const RCSResourceAttributes &attrs, Entry &entry);
+        static bool overlaps(const Entry &entry, const Entry &other);
+
+        bool isPending(const Entry &entry);
+        void cancel();
+        void fillWindow();
+        GUPnPServiceProxyAction *beginAction(Entry &entry);
+        void finish();
+
+        static void actionCb(GUPnPServiceProxy *proxy,
+                             GUPnPServiceProxyAction *action,
+                             gpointer userData);
+};
+
+#endif
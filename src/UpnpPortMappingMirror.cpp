@@ -0,0 +1,444 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include <algorithm>
+#include <cstdlib>
+
+#include <UpnpConstants.h>
+
+#include "UpnpPortMappingMirror.h"
+#include "UpnpActionStats.h"
+
+using namespace OIC::Service;
+
+static const string MODULE = "UpnpPortMappingMirror";
+
+// UPnP errors answered past the end of the table: SpecifiedArrayIndexInvalid
+// (per the specification), NoSuchEntryInArray and InvalidArgs (by some IGDs)
+static const int UPNP_ERROR_INVALID_ARGS = 402;
+static const int UPNP_ERROR_ARRAY_INDEX_INVALID = 713;
+static const int UPNP_ERROR_NO_SUCH_ENTRY = 714;
+
+const unsigned int UpnpPortMappingMirror::SYNC_WINDOW;
+const guint UpnpPortMappingMirror::RETRY_DELAY;
+const guint UpnpPortMappingMirror::MAX_RETRY_DELAY;
+
+static const UpnpPortMappingTable::Filter ALL_MAPPINGS = {"", 0, "", ""};
+
+UpnpPortMappingMirror::UpnpPortMappingMirror(UpnpResource *resource, const string &attrName)
+{
+    m_resource = resource;
+    m_attrName = attrName;
+    m_proxy = nullptr;
+    m_synced = false;
+    m_syncing = false;
+    m_resyncPending = false;
+    m_endReached = false;
+    m_failed = false;
+    m_numEntries = -1;
+    m_nextIndex = 0;
+    m_retryAt = 0;
+    m_retryDelay = RETRY_DELAY;
+}
+
+UpnpPortMappingMirror::~UpnpPortMappingMirror()
+{
+    cancelSync();
+    completeRequests(false);
+}
+
+void UpnpPortMappingMirror::setProxy(GUPnPServiceProxy *proxy)
+{
+    m_proxy = proxy;
+    startSync();
+}
+
+void UpnpPortMappingMirror::setNumberOfEntries(int numEntries)
+{
+    if (numEntries == m_numEntries)
+    {
+        return;
+    }
+
+    DEBUG_PRINT(m_resource->m_uri << ": " << m_numEntries << " -> " << numEntries);
+    m_numEntries = numEntries;
+    invalidate();
+}
+
+void UpnpPortMappingMirror::invalidate()
+{
+    if (m_proxy == nullptr)
+    {
+        // Nothing to synchronize yet
+        return;
+    }
+
+    if (m_syncing)
+    {
+        // Events usually come in bursts: let the current pass drain
+        // and do a single pass afterwards
+        m_resyncPending = true;
+        return;
+    }
+
+    startSync();
+}
+
+bool UpnpPortMappingMirror::get(UpnpRequest *request, const map< string, string > &queryParams)
+{
+    UpnpPortMappingTable::Filter filter = getFilter(queryParams);
+
+    if (m_synced && !m_syncing)
+    {
+        respond(request, filter);
+        return false;
+    }
+
+    if (!m_syncing && m_retryAt != 0 && g_get_monotonic_time() < m_retryAt)
+    {
+        // Failed lately: not a pass per GET
+        respond(request, filter);
+        return false;
+    }
+
+    if (!m_syncing)
+    {
+        startSync();
+        if (!m_syncing)
+        {
+            // Completed right away (empty table, or nothing could be issued)
+            respond(request, filter);
+            return false;
+        }
+    }
+
+    m_waitingRequests.push_back({request, filter});
+    return true;
+}
+
+const UpnpPortMappingTable &UpnpPortMappingMirror::getTable() const
+{
+    return m_table;
+}
+
+bool UpnpPortMappingMirror::isSynced() const
+{
+    return m_synced;
+}
+
+void UpnpPortMappingMirror::startSync()
+{
+    cancelSync();
+
+    if (m_proxy == nullptr)
+    {
+        return;
+    }
+
+    DEBUG_PRINT(m_resource->m_uri << ", entries: " << m_numEntries);
+    m_staging.clear();
+    m_syncing = true;
+    m_resyncPending = false;
+    m_endReached = false;
+    m_failed = false;
+    m_nextIndex = 0;
+
+    fillWindow();
+
+    if (m_pendingActions.empty())
+    {
+        // Empty table, or nothing could be issued
+        finishSync();
+    }
+}
+
+void UpnpPortMappingMirror::cancelSync()
+{
+    for (auto it = m_pendingActions.begin(); it != m_pendingActions.end(); ++it)
+    {
+        UpnpActionStats::cancelAction(m_proxy, it->first);
+    }
+    m_pendingActions.clear();
+    m_syncing = false;
+}
+
+void UpnpPortMappingMirror::fillWindow()
+{
+    while ((m_pendingActions.size() < SYNC_WINDOW) && !m_endReached && !m_failed)
+    {
+        if ((m_numEntries >= 0) && (m_nextIndex >= (unsigned int) m_numEntries))
+        {
+            m_endReached = true;
+            break;
+        }
+
+        GUPnPServiceProxyAction *actionProxy =
+            UpnpActionStats::beginAction (m_proxy,
+                                          "GetGenericPortMappingEntry",
+                                          getEntryCb,
+                                          (gpointer *) this,
+                                          "NewPortMappingIndex",
+                                          G_TYPE_UINT,
+                                          m_nextIndex,
+                                          NULL);
+        if (NULL == actionProxy)
+        {
+            ERROR_PRINT("GetGenericPortMappingEntry(" << m_nextIndex << ") failed");
+            m_failed = true;
+            break;
+        }
+
+        m_pendingActions[actionProxy] = m_nextIndex++;
+    }
+}
+
+void UpnpPortMappingMirror::getEntryCb(GUPnPServiceProxy *proxy,
+                                       GUPnPServiceProxyAction *actionProxy,
+                                       gpointer userData)
+{
+    GError *error = NULL;
+    char *remoteHost = NULL;
+    guint externalPort = 0;
+    char *protocol = NULL;
+    guint internalPort = 0;
+    char *internalClient = NULL;
+    gboolean enabled = FALSE;
+    char *description = NULL;
+    guint leaseDuration = 0;
+
+    UpnpPortMappingMirror *pMirror = static_cast<UpnpPortMappingMirror *> (userData);
+
+    std::map< GUPnPServiceProxyAction *, unsigned int >::iterator it =
+        pMirror->m_pendingActions.find(actionProxy);
+    assert(it != pMirror->m_pendingActions.end());
+
+    unsigned int index = it->second;
+    pMirror->m_pendingActions.erase(it);
+
+    bool status = UpnpActionStats::endAction (proxy,
+                                              actionProxy,
+                                              &error,
+                                              "NewRemoteHost",
+                                              G_TYPE_STRING,
+                                              &remoteHost,
+                                              "NewExternalPort",
+                                              G_TYPE_UINT,
+                                              &externalPort,
+                                              "NewProtocol",
+                                              G_TYPE_STRING,
+                                              &protocol,
+                                              "NewInternalPort",
+                                              G_TYPE_UINT,
+                                              &internalPort,
+                                              "NewInternalClient",
+                                              G_TYPE_STRING,
+                                              &internalClient,
+                                              "NewEnabled",
+                                              G_TYPE_BOOLEAN,
+                                              &enabled,
+                                              "NewPortMappingDescription",
+                                              G_TYPE_STRING,
+                                              &description,
+                                              "NewLeaseDuration",
+                                              G_TYPE_UINT,
+                                              &leaseDuration,
+                                              NULL);
+    if (error)
+    {
+        if (isEndOfTable(error, index, pMirror->m_numEntries))
+        {
+            // Table is shorter than expected (or its size is unknown)
+            DEBUG_PRINT("end of table at " << index);
+            pMirror->m_endReached = true;
+        }
+        else
+        {
+            ERROR_PRINT("GetGenericPortMappingEntry(" << index << ") failed: " << error->code << ", " <<
+                        error->message);
+            pMirror->m_failed = true;
+        }
+        g_error_free (error);
+        status = false;
+    }
+
+    if (status)
+    {
+        UpnpPortMapping mapping;
+
+        mapping.remoteHost     = (remoteHost != NULL) ? remoteHost : "";
+        mapping.externalPort   = externalPort;
+        mapping.protocol       = (protocol != NULL) ? protocol : "";
+        mapping.internalPort   = internalPort;
+        mapping.internalClient = (internalClient != NULL) ? internalClient : "";
+        mapping.enabled        = enabled;
+        mapping.description    = (description != NULL) ? description : "";
+        mapping.leaseDuration  = leaseDuration;
+
+        pMirror->m_staging.add(mapping);
+
+        g_free(remoteHost);
+        g_free(protocol);
+        g_free(internalClient);
+        g_free(description);
+    }
+
+    pMirror->fillWindow();
+
+    if (pMirror->m_pendingActions.empty())
+    {
+        pMirror->finishSync();
+    }
+}
+
+void UpnpPortMappingMirror::finishSync()
+{
+    bool status = !m_failed;
+
+    m_syncing = false;
+    if (status)
+    {
+        DEBUG_PRINT(m_resource->m_uri << ": " << m_staging.size() << " entries");
+        m_table.swap(m_staging);
+        m_synced = true;
+        m_resource->setAttribute(m_attrName, select(ALL_MAPPINGS), false);
+        m_retryAt = 0;
+        m_retryDelay = RETRY_DELAY;
+    }
+    else
+    {
+        DEBUG_PRINT(m_resource->m_uri << ": retry in " << m_retryDelay << " ms");
+        m_retryAt = g_get_monotonic_time() + (gint64) m_retryDelay * 1000;
+        m_retryDelay = std::min(m_retryDelay * 2, MAX_RETRY_DELAY);
+    }
+    m_staging.clear();
+
+    completeRequests(status);
+
+    if (m_resyncPending)
+    {
+        startSync();
+    }
+}
+
+void UpnpPortMappingMirror::completeRequests(bool status)
+{
+    // Requests may complete synchronously and queue new ones: work on a copy
+    vector <pair <UpnpRequest *, UpnpPortMappingTable::Filter>> requests;
+    requests.swap(m_waitingRequests);
+
+    for (auto &waiting : requests)
+    {
+        if (status)
+        {
+            respond(waiting.first, waiting.second);
+        }
+        UpnpRequest::requestDone(waiting.first, status);
+    }
+}
+
+// Concurrent GETs may ask for different views: the shared attribute is
+// not written here
+void UpnpPortMappingMirror::respond(UpnpRequest *request, const UpnpPortMappingTable::Filter &filter)
+{
+    if (isFiltered(filter) && request->response != nullptr)
+    {
+        (*request->response)[m_attrName] = select(filter);
+    }
+}
+
+CompositeAttribute UpnpPortMappingMirror::select(const UpnpPortMappingTable::Filter &filter)
+{
+    CompositeAttribute mappings;
+
+    for (const UpnpPortMapping *mapping : m_table.select(filter))
+    {
+        RCSResourceAttributes entry;
+
+        entry["remoteHost"]     = mapping->remoteHost;
+        entry["externalPort"]   = (int) mapping->externalPort;
+        entry["protocol"]       = mapping->protocol;
+        entry["internalPort"]   = (int) mapping->internalPort;
+        entry["internalClient"] = mapping->internalClient;
+        entry["enabled"]        = mapping->enabled;
+        entry["description"]    = mapping->description;
+        entry["leaseDuration"]  = (int) mapping->leaseDuration;
+        mappings.push_back(entry);
+    }
+    return mappings;
+}
+
+// The count may be stale (or unknown): SpecifiedArrayIndexInvalid ends the
+// table anywhere, the others only where the table should have ended
+bool UpnpPortMappingMirror::isEndOfTable(const GError *error, unsigned int index, int numEntries)
+{
+    if (error->domain != GUPNP_CONTROL_ERROR)
+    {
+        // Transport failure
+        return false;
+    }
+
+    switch (error->code)
+    {
+        case UPNP_ERROR_ARRAY_INDEX_INVALID:
+            return true;
+        case UPNP_ERROR_NO_SUCH_ENTRY:
+        case UPNP_ERROR_INVALID_ARGS:
+            return (numEntries < 0) || (index >= (unsigned int) numEntries);
+        default:
+            return false;
+    }
+}
+
+bool UpnpPortMappingMirror::isFiltered(const UpnpPortMappingTable::Filter &filter)
+{
+    return !filter.protocol.empty() || filter.externalPort != 0 || !filter.internalClient.empty() ||
+           !filter.remoteHost.empty();
+}
+
+UpnpPortMappingTable::Filter UpnpPortMappingMirror::getFilter(const map< string, string > &queryParams)
+{
+    UpnpPortMappingTable::Filter filter = ALL_MAPPINGS;
+
+    auto it = queryParams.find(UPNP_OIC_QUERY_PARAM_PM_PROTOCOL);
+    if (it != queryParams.end())
+    {
+        filter.protocol = it->second;
+    }
+
+    it = queryParams.find(UPNP_OIC_QUERY_PARAM_PM_EXTERNAL_PORT);
+    if (it != queryParams.end())
+    {
+        filter.externalPort = (unsigned int) strtoul(it->second.c_str(), NULL, 10);
+    }
+
+    it = queryParams.find(UPNP_OIC_QUERY_PARAM_PM_INTERNAL_CLIENT);
+    if (it != queryParams.end())
+    {
+        filter.internalClient = it->second;
+    }
+
+    it = queryParams.find(UPNP_OIC_QUERY_PARAM_PM_REMOTE_HOST);
+    if (it != queryParams.end())
+    {
+        filter.remoteHost = it->second;
+    }
+
+    return filter;
+}
@@ -0,0 +1,116 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#ifndef UPNP_PORT_MAPPING_MIRROR_H_
+#define UPNP_PORT_MAPPING_MIRROR_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <gupnp.h>
+
+#include "UpnpInternal.h"
+#include "UpnpPortMappingTable.h"
+#include "UpnpRequest.h"
+#include "UpnpResource.h"
+
+using namespace std;
+
+// Local copy of the port mapping table of a WANIPConnection or
+// WANPPPConnection service.
+//
+// The table is enumerated with GetGenericPortMappingEntry, keeping at most
+// SYNC_WINDOW actions in flight, and re-synchronized only when the IGD
+// signals a change (PortMappingNumberOfEntries, SystemUpdateID). After a
+// failed pass, GETs are answered from the last copy (if any) for RETRY_DELAY,
+// doubled by each failure up to MAX_RETRY_DELAY, before a GET tries again.
+// All the methods must be called from the gupnp thread.
+class UpnpPortMappingMirror
+{
+    public:
+        static const unsigned int SYNC_WINDOW = 4;
+        // Intervals (ms)
+        static const guint RETRY_DELAY = 5000;
+        static const guint MAX_RETRY_DELAY = 300000;
+
+        UpnpPortMappingMirror(UpnpResource *resource, const string &attrName);
+        ~UpnpPortMappingMirror();
+
+        // Starts the initial synchronization
+        void setProxy(GUPnPServiceProxy *proxy);
+
+        // Evented PortMappingNumberOfEntries
+        void setNumberOfEntries(int numEntries);
+
+        // Table changed on the IGD (e.g. SystemUpdateID event)
+        void invalidate();
+
+        // The resource attribute holds the whole table, a filtered view
+        // (pm* query params) goes to the response of the request only.
+        // Returns true if the request completes later, once the table is
+        // synchronized.
+        bool get(UpnpRequest *request, const map< string, string > &queryParams);
+
+        const UpnpPortMappingTable &getTable() const;
+        bool isSynced() const;
+
+    private:
+        UpnpResource *m_resource;
+        string m_attrName;
+        GUPnPServiceProxy *m_proxy;
+
+        // Last complete copy, and the one being enumerated
+        UpnpPortMappingTable m_table;
+        UpnpPortMappingTable m_staging;
+
+        bool m_synced;
+        bool m_syncing;
+        bool m_resyncPending;
+        bool m_endReached;
+        bool m_failed;
+        // Number of entries reported by the IGD (-1: unknown)
+        int m_numEntries;
+        unsigned int m_nextIndex;
+        // No GET triggers a pass before (monotonic time, 0: none)
+        gint64 m_retryAt;
+        guint m_retryDelay;
+
+        map <GUPnPServiceProxyAction *, unsigned int> m_pendingActions;
+        vector <pair <UpnpRequest *, UpnpPortMappingTable::Filter>> m_waitingRequests;
+
+        void startSync();
+        void cancelSync();
+        void fillWindow();
+        void finishSync();
+        void completeRequests(bool status);
+        void respond(UpnpRequest *request, const UpnpPortMappingTable::Filter &filter);
+        CompositeAttribute select(const UpnpPortMappingTable::Filter &filter);
+
+        static UpnpPortMappingTable::Filter getFilter(const map< string, string > &queryParams);
+        static bool isFiltered(const UpnpPortMappingTable::Filter &filter);
+        static bool isEndOfTable(const GError *error, unsigned int index, int numEntries);
+
+        static void getEntryCb(GUPnPServiceProxy *proxy,
+                               GUPnPServiceProxyAction *action,
+                               gpointer userData);
+};
+
+#endif
@@ -0,0 +1,99 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "UpnpPortMappingTable.h"
+
+UpnpPortMappingTable::Key UpnpPortMappingTable::getKey(const UpnpPortMapping &mapping)
+{
+    return Key(mapping.protocol, mapping.externalPort, mapping.remoteHost);
+}
+
+void UpnpPortMappingTable::add(const UpnpPortMapping &mapping)
+{
+    m_entries[getKey(mapping)] = mapping;
+}
+
+bool UpnpPortMappingTable::remove(const Key &key)
+{
+    return m_entries.erase(key) != 0;
+}
+
+const UpnpPortMapping *UpnpPortMappingTable::find(const Key &key) const
+{
+    auto it = m_entries.find(key);
+    if (it == m_entries.end())
+    {
+        return nullptr;
+    }
+    return &(it->second);
+}
+
+size_t UpnpPortMappingTable::size() const
+{
+    return m_entries.size();
+}
+
+void UpnpPortMappingTable::clear()
+{
+    m_entries.clear();
+}
+
+void UpnpPortMappingTable::swap(UpnpPortMappingTable &table)
+{
+    m_entries.swap(table.m_entries);
+}
+
+std::vector<const UpnpPortMapping *> UpnpPortMappingTable::select(const Filter &filter) const
+{
+    std::vector<const UpnpPortMapping *> entries;
+    std::map<Key, UpnpPortMapping>::const_iterator it = m_entries.begin();
+
+    // Protocol is the leading part of the key: skip to the first match
+    if (!filter.protocol.empty())
+    {
+        it = m_entries.lower_bound(Key(filter.protocol, 0, ""));
+    }
+
+    for (; it != m_entries.end(); ++it)
+    {
+        const UpnpPortMapping &mapping = it->second;
+
+        if (!filter.protocol.empty() && (mapping.protocol != filter.protocol))
+        {
+            // Past the last entry of the protocol
+            break;
+        }
+
+        if ((filter.externalPort != 0) && (mapping.externalPort != filter.externalPort))
+        {
+            continue;
+        }
+        if (!filter.internalClient.empty() && (mapping.internalClient != filter.internalClient))
+        {
+            continue;
+        }
+        if (!filter.remoteHost.empty() && (mapping.remoteHost != filter.remoteHost))
+        {
+            continue;
+        }
+        entries.push_back(&mapping);
+    }
+    return entries;
+}
@@ -0,0 +1,76 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#ifndef UPNP_PORT_MAPPING_TABLE_H_
+#define UPNP_PORT_MAPPING_TABLE_H_
+
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+// Port mapping entry as returned by GetGenericPortMappingEntry
+typedef struct _UpnpPortMapping
+{
+    std::string  remoteHost;
+    unsigned int externalPort;
+    std::string  protocol;
+    unsigned int internalPort;
+    std::string  internalClient;
+    bool         enabled;
+    std::string  description;
+    unsigned int leaseDuration;
+} UpnpPortMapping;
+
+// Port mapping table indexed the way the IGD identifies the entries:
+// (protocol, external port, remote host)
+class UpnpPortMappingTable
+{
+    public:
+        typedef std::tuple<std::string, unsigned int, std::string> Key;
+
+        // Selection criteria, empty strings and zero port match anything
+        typedef struct _Filter
+        {
+            std::string  protocol;
+            unsigned int externalPort;
+            std::string  internalClient;
+            std::string  remoteHost;
+        } Filter;
+
+        static Key getKey(const UpnpPortMapping &mapping);
+
+        // Adds the entry or replaces the entry with the same key
+        void add(const UpnpPortMapping &mapping);
+        bool remove(const Key &key);
+        const UpnpPortMapping *find(const Key &key) const;
+
+        size_t size() const;
+        void clear();
+        void swap(UpnpPortMappingTable &table);
+
+        // Entries matching the filter, ordered by key
+        std::vector<const UpnpPortMapping *> select(const Filter &filter) const;
+
+    private:
+        std::map<Key, UpnpPortMapping> m_entries;
+};
+
+#endif
@@ -19,6 +19,7 @@
 //-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
 
 #include "UpnpRenderingControlService.h"
+#include "UpnpActionStats.h"
 
 using namespace OIC::Service;
 
@@ -114,7 +115,7 @@ void UpnpRenderingControl::getPresetNameListCb(GUPnPServiceProxy *proxy,
 
     UpnpRequest *request = static_cast<UpnpRequest *> (userData);
 
-    bool status = gupnp_service_proxy_end_action (proxy,
+    bool status = UpnpActionStats::endAction (proxy,
                   actionProxy,
                   &error,
                   "CurrentPresetNameList",
@@ -165,14 +166,14 @@ bool UpnpRenderingControl::getPresetNameList(UpnpRequest *request,
     }
 
     GUPnPServiceProxyAction *actionProxy =
-        gupnp_service_proxy_begin_action (m_proxy,
-                                          "ListPresets",
-                                          getPresetNameListCb,
-                                          (gpointer *) request,
-                                          "InstanceID",
-                                          G_TYPE_UINT,
-                                          instanceId,
-                                          NULL);
+        UpnpActionStats::beginAction (m_proxy,
+                                      "ListPresets",
+                                      getPresetNameListCb,
+                                      (gpointer *) request,
+                                      "InstanceID",
+                                      G_TYPE_UINT,
+                                      instanceId,
+                                      NULL);
     if (NULL == actionProxy)
     {
         return false;
@@ -190,7 +191,7 @@ void UpnpRenderingControl::setPresetNameCb(GUPnPServiceProxy *proxy,
 
     UpnpRequest *request = static_cast<UpnpRequest *> (userData);
 
-    bool status = gupnp_service_proxy_end_action (proxy,
+    bool status = UpnpActionStats::endAction (proxy,
                   actionProxy,
                   &error,
                   NULL);
@@ -234,17 +235,17 @@ bool UpnpRenderingControl::setPresetName(UpnpRequest *request, RCSResourceAttrib
     }
 
     GUPnPServiceProxyAction *actionProxy =
-        gupnp_service_proxy_begin_action (m_proxy,
-                                          "SelectPreset",
-                                          setPresetNameCb,
-                                          (gpointer *) request,
-                                          "InstanceID",
-                                          G_TYPE_UINT,
-                                          instanceId,
-                                          "PresetName",
-                                          G_TYPE_STRING,
-                                          presetName.c_str(),
-                                          NULL);
+        UpnpActionStats::beginAction (m_proxy,
+                                      "SelectPreset",
+                                      setPresetNameCb,
+                                      (gpointer *) request,
+                                      "InstanceID",
+                                      G_TYPE_UINT,
+                                      instanceId,
+                                      "PresetName",
+                                      G_TYPE_STRING,
+                                      presetName.c_str(),
+                                      NULL);
     if (NULL == actionProxy)
     {
         return false;
@@ -263,7 +264,7 @@ void UpnpRenderingControl::getMuteCb(GUPnPServiceProxy *proxy, GUPnPServiceProxy
 
     UpnpRequest *request = static_cast<UpnpRequest *> (userData);
 
-    bool status = gupnp_service_proxy_end_action (proxy,
+    bool status = UpnpActionStats::endAction (proxy,
                   actionProxy,
                   &error,
                   "CurrentMute",
@@ -320,17 +321,17 @@ bool UpnpRenderingControl::getMute(UpnpRequest *request, const map< string, stri
     }
 
     GUPnPServiceProxyAction *actionProxy =
-        gupnp_service_proxy_begin_action (m_proxy,
-                                          "GetMute",
-                                          getMuteCb,
-                                          (gpointer *) request,
-                                          "InstanceID",
-                                          G_TYPE_UINT,
-                                          instanceId,
-                                          "Channel",
-                                          G_TYPE_STRING,
-                                          channel.c_str(),
-                                          NULL);
+        UpnpActionStats::beginAction (m_proxy,
+                                      "GetMute",
+                                      getMuteCb,
+                                      (gpointer *) request,
+                                      "InstanceID",
+                                      G_TYPE_UINT,
+                                      instanceId,
+                                      "Channel",
+                                      G_TYPE_STRING,
+                                      channel.c_str(),
+                                      NULL);
     if (NULL == actionProxy)
     {
         return false;
@@ -348,7 +349,7 @@ void UpnpRenderingControl::setMuteCb(GUPnPServiceProxy *proxy, GUPnPServiceProxy
 
     UpnpRequest *request = static_cast<UpnpRequest *> (userData);
 
-    bool status = gupnp_service_proxy_end_action (proxy,
+    bool status = UpnpActionStats::endAction (proxy,
                   actionProxy,
                   &error,
                   NULL);
@@ -367,6 +368,13 @@ bool UpnpRenderingControl::setMute(UpnpRequest *request, RCSResourceAttributes::
 {
     DEBUG_PRINT("");
 
+    return getCoalescer(m_muteCoalescers, value, &UpnpRenderingControl::sendMute).write(request, *value);
+}
+
+bool UpnpRenderingControl::sendMute(UpnpRequest *request, RCSResourceAttributes::Value *value)
+{
+    DEBUG_PRINT("");
+
     int instanceId = 0;
     string channel = "Master";
     bool mute = false;
@@ -399,20 +407,20 @@ bool UpnpRenderingControl::setMute(UpnpRequest *request, RCSResourceAttributes::
     }
 
     GUPnPServiceProxyAction *actionProxy =
-        gupnp_service_proxy_begin_action (m_proxy,
-                                          "SetMute",
-                                          setMuteCb,
-                                          (gpointer *) request,
-                                          "InstanceID",
-                                          G_TYPE_UINT,
-                                          instanceId,
-                                          "Channel",
-                                          G_TYPE_STRING,
-                                          channel.c_str(),
-                                          "DesiredMute",
-                                          G_TYPE_BOOLEAN,
-                                          mute,
-                                          NULL);
+        UpnpActionStats::beginAction (m_proxy,
+                                      "SetMute",
+                                      setMuteCb,
+                                      (gpointer *) request,
+                                      "InstanceID",
+                                      G_TYPE_UINT,
+                                      instanceId,
+                                      "Channel",
+                                      G_TYPE_STRING,
+                                      channel.c_str(),
+                                      "DesiredMute",
+                                      G_TYPE_BOOLEAN,
+                                      mute,
+                                      NULL);
     if (NULL == actionProxy)
     {
         return false;
@@ -431,7 +439,7 @@ void UpnpRenderingControl::getVolumeCb(GUPnPServiceProxy *proxy,
 
     UpnpRequest *request = static_cast<UpnpRequest *> (userData);
 
-    bool status = gupnp_service_proxy_end_action (proxy,
+    bool status = UpnpActionStats::endAction (proxy,
                   actionProxy,
                   &error,
                   "CurrentVolume",
@@ -488,17 +496,17 @@ bool UpnpRenderingControl::getVolume(UpnpRequest *request, const map< string, st
     }
 
     GUPnPServiceProxyAction *actionProxy =
-        gupnp_service_proxy_begin_action (m_proxy,
-                                          "GetVolume",
-                                          getVolumeCb,
-                                          (gpointer *) request,
-                                          "InstanceID",
-                                          G_TYPE_UINT,
-                                          instanceId,
-                                          "Channel",
-                                          G_TYPE_STRING,
-                                          channel.c_str(),
-                                          NULL);
+        UpnpActionStats::beginAction (m_proxy,
+                                      "GetVolume",
+                                      getVolumeCb,
+                                      (gpointer *) request,
+                                      "InstanceID",
+                                      G_TYPE_UINT,
+                                      instanceId,
+                                      "Channel",
+                                      G_TYPE_STRING,
+                                      channel.c_str(),
+                                      NULL);
     if (NULL == actionProxy)
     {
         return false;
@@ -516,7 +524,7 @@ void UpnpRenderingControl::setVolumeCb(GUPnPServiceProxy *proxy,
 
     UpnpRequest *request = static_cast<UpnpRequest *> (userData);
 
-    bool status = gupnp_service_proxy_end_action (proxy,
+    bool status = UpnpActionStats::endAction (proxy,
                   actionProxy,
                   &error,
                   NULL);
@@ -535,6 +543,13 @@ bool UpnpRenderingControl::setVolume(UpnpRequest *request, RCSResourceAttributes
 {
     DEBUG_PRINT("");
 
+    return getCoalescer(m_volumeCoalescers, value, &UpnpRenderingControl::sendVolume).write(request, *value);
+}
+
+bool UpnpRenderingControl::sendVolume(UpnpRequest *request, RCSResourceAttributes::Value *value)
+{
+    DEBUG_PRINT("");
+
     int instanceId = 0;
     string channel = "Master";
     int volume = 0;
@@ -568,20 +583,20 @@ bool UpnpRenderingControl::setVolume(UpnpRequest *request, RCSResourceAttributes
     }
 
     GUPnPServiceProxyAction *actionProxy =
-        gupnp_service_proxy_begin_action (m_proxy,
-                                          "SetVolume",
-                                          setVolumeCb,
-                                          (gpointer *) request,
-                                          "InstanceID",
-                                          G_TYPE_UINT,
-                                          instanceId,
-                                          "Channel",
-                                          G_TYPE_STRING,
-                                          channel.c_str(),
-                                          "DesiredVolume",
-                                          G_TYPE_UINT,
-                                          volume,
-                                          NULL);
+        UpnpActionStats::beginAction (m_proxy,
+                                      "SetVolume",
+                                      setVolumeCb,
+                                      (gpointer *) request,
+                                      "InstanceID",
+                                      G_TYPE_UINT,
+                                      instanceId,
+                                      "Channel",
+                                      G_TYPE_STRING,
+                                      channel.c_str(),
+                                      "DesiredVolume",
+                                      G_TYPE_UINT,
+                                      volume,
+                                      NULL);
     if (NULL == actionProxy)
     {
         return false;
@@ -592,6 +607,70 @@ bool UpnpRenderingControl::setVolume(UpnpRequest *request, RCSResourceAttributes
     return true;
 }
 
+UpnpSetCoalescer &UpnpRenderingControl::getCoalescer(map< string, unique_ptr< UpnpSetCoalescer > > &coalescers,
+        RCSResourceAttributes::Value *value, SendHandler send)
+{
+    int instanceId = 0;
+    string channel = "Master";
+
+    const auto &attrs = value->get< RCSResourceAttributes >();
+
+    for (const auto &kvPair : attrs)
+    {
+        if (kvPair.key() == "instanceId")
+        {
+            instanceId = std::max(0, (kvPair.value()).get< int >());
+        }
+
+        if (kvPair.key() == "channel")
+        {
+            channel = (kvPair.value()).get< string >();
+        }
+    }
+
+    string key = std::to_string(instanceId) + "/" + channel;
+    auto it = coalescers.find(key);
+    if (it == coalescers.end())
+    {
+        UpnpSetCoalescer *coalescer = new UpnpSetCoalescer(this,
+                [this, send](UpnpRequest *carrier, RCSResourceAttributes::Value *v)
+        {
+            return (this->*send)(carrier, v);
+        });
+        it = coalescers.insert(make_pair(key, unique_ptr< UpnpSetCoalescer >(coalescer))).first;
+    }
+
+    return *it->second;
+}
+
+void UpnpRenderingControl::stop()
+{
+    for (auto &coalescer : m_muteCoalescers)
+    {
+        coalescer.second->stop();
+    }
+    for (auto &coalescer : m_volumeCoalescers)
+    {
+        coalescer.second->stop();
+    }
+    UpnpService::stop();
+}
+
+int UpnpRenderingControl::cancelRequest(UpnpRequest *request)
+{
+    int count = UpnpService::cancelRequest(request);
+
+    for (auto &coalescer : m_muteCoalescers)
+    {
+        count += coalescer.second->cancel(request);
+    }
+    for (auto &coalescer : m_volumeCoalescers)
+    {
+        count += coalescer.second->cancel(request);
+    }
+    return count;
+}
+
 bool UpnpRenderingControl::getAttributesRequest(UpnpRequest *request,
         const map< string, string > &queryParams)
 {
@@ -601,7 +680,7 @@ bool UpnpRenderingControl::getAttributesRequest(UpnpRequest *request,
     {
         DEBUG_PRINT(" \"" << it->first << "\"");
         // Check the request
-        if (!UpnpAttribute::isValidRequest(&m_attributeMap, it->first, UPNP_ACTION_GET))
+        if (!isGetRequested(request, it->first))
         {
             request->done++;
             continue;
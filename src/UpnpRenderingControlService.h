@@ -23,12 +23,14 @@
 
 #include <string>
 #include <map>
+#include <memory>
 
 #include <gupnp.h>
 
 #include "UpnpResource.h"
 #include "UpnpInternal.h"
 #include "UpnpService.h"
+#include "UpnpSetCoalescer.h"
 
 using namespace std;
 
@@ -39,18 +41,30 @@ class UpnpRenderingControl: public UpnpService
     public:
         typedef bool (UpnpRenderingControl::*GetAttributeHandler)(UpnpRequest *, const map< string, string > &);
         typedef bool (UpnpRenderingControl::*SetAttributeHandler)(UpnpRequest *, RCSResourceAttributes::Value *, const map< string, string > &);
+        typedef bool (UpnpRenderingControl::*SendHandler)(UpnpRequest *, RCSResourceAttributes::Value *);
 
         UpnpRenderingControl(GUPnPServiceInfo *serviceInfo, UpnpRequestState *requestState) :
             UpnpService(serviceInfo, UPNP_OIC_TYPE_RENDERING_CONTROL, requestState, &Attributes)
         {
         }
 
+        void stop();
+
     private:
         static map< const string, UpnpRenderingControl::GetAttributeHandler > GetAttributeActionMap;
         static map< const string, UpnpRenderingControl::SetAttributeHandler > SetAttributeActionMap;
 
         static vector< UpnpAttributeInfo > Attributes;
 
+        // SetMute/SetVolume, by "instanceId/channel"
+        map< string, unique_ptr< UpnpSetCoalescer > > m_muteCoalescers;
+        map< string, unique_ptr< UpnpSetCoalescer > > m_volumeCoalescers;
+
+        int cancelRequest(UpnpRequest *request);
+
+        UpnpSetCoalescer &getCoalescer(map< string, unique_ptr< UpnpSetCoalescer > > &coalescers,
+                                       RCSResourceAttributes::Value *value, SendHandler send);
+
         bool getAttributesRequest(UpnpRequest *request, const map< string, string > &queryParams);
         bool setAttributesRequest(const RCSResourceAttributes &attrs, UpnpRequest *request, const map< string, string > &queryParams);
 
@@ -65,12 +79,14 @@ class UpnpRenderingControl: public UpnpService
 
         static void setMuteCb(GUPnPServiceProxy *proxy, GUPnPServiceProxyAction *action, gpointer userData);
         bool setMute(UpnpRequest *request, RCSResourceAttributes::Value *value, const map< string, string > &queryParams);
+        bool sendMute(UpnpRequest *request, RCSResourceAttributes::Value *value);
 
         static void getVolumeCb(GUPnPServiceProxy *proxy, GUPnPServiceProxyAction *action, gpointer userData);
         bool getVolume(UpnpRequest *request, const map< string, string > &queryParams);
 
         static void setVolumeCb(GUPnPServiceProxy *proxy, GUPnPServiceProxyAction *action, gpointer userData);
         bool setVolume(UpnpRequest *request, RCSResourceAttributes::Value *value, const map< string, string > &queryParams);
+        bool sendVolume(UpnpRequest *request, RCSResourceAttributes::Value *value);
 };
 
 #endif
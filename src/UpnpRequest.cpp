@@ -0,0 +1,247 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "UpnpRequest.h"
+#include "UpnpRequestScheduler.h"
+
+using namespace std;
+
+const size_t UpnpRequestBindings::INLINE_SIZE;
+const size_t UpnpRequest::MAX_FREE_REQUESTS;
+
+std::atomic< uint64_t > UpnpRequest::s_acquired(0);
+std::atomic< uint64_t > UpnpRequest::s_allocated(0);
+
+UpnpRequestBindings::UpnpRequestBindings()
+{
+    m_data = m_inline;
+    m_size = 0;
+    m_capacity = INLINE_SIZE;
+}
+
+UpnpAttributeInfo *&UpnpRequestBindings::operator[](GUPnPServiceProxyAction *key)
+{
+    iterator it = find(key);
+
+    if (it != end())
+    {
+        return it->second;
+    }
+
+    if (m_size == m_capacity)
+    {
+        // Move to (or grow) the heap storage
+        vector< value_type > heap(m_data, m_data + m_size);
+        heap.resize(m_capacity * 2);
+        m_heap.swap(heap);
+        m_data = m_heap.data();
+        m_capacity = m_heap.size();
+    }
+
+    m_data[m_size] = value_type(key, nullptr);
+    return m_data[m_size++].second;
+}
+
+UpnpRequestBindings::iterator UpnpRequestBindings::find(GUPnPServiceProxyAction *key)
+{
+    for (iterator it = begin(); it != end(); ++it)
+    {
+        if (it->first == key)
+        {
+            return it;
+        }
+    }
+    return end();
+}
+
+void UpnpRequestBindings::erase(iterator it)
+{
+    // Keep the insertion order
+    for (iterator next = it + 1; next != end(); ++it, ++next)
+    {
+        *it = *next;
+    }
+    --m_size;
+}
+
+void UpnpRequestBindings::clear()
+{
+    m_size = 0;
+}
+
+// Per thread free list, the requests are released by the thread that
+// acquired them (the one waiting for their completion)
+class UpnpRequestPool
+{
+    public:
+        UpnpRequestPool() : m_head(nullptr), m_size(0) {}
+
+        ~UpnpRequestPool()
+        {
+            while (m_head != nullptr)
+            {
+                UpnpRequest *request = m_head;
+                m_head = request->m_next;
+                delete request;
+            }
+        }
+
+        UpnpRequest *pop()
+        {
+            UpnpRequest *request = m_head;
+
+            if (request != nullptr)
+            {
+                m_head = request->m_next;
+                --m_size;
+            }
+            return request;
+        }
+
+        bool push(UpnpRequest *request)
+        {
+            if (m_size == UpnpRequest::MAX_FREE_REQUESTS)
+            {
+                return false;
+            }
+            request->m_next = m_head;
+            m_head = request;
+            ++m_size;
+            return true;
+        }
+
+    private:
+        UpnpRequest *m_head;
+        size_t m_size;
+};
+
+static thread_local UpnpRequestPool t_requestPool;
+
+UpnpRequest::UpnpRequest()
+{
+    m_next = nullptr;
+    reset();
+}
+
+void UpnpRequest::reset()
+{
+    handler = nullptr;
+    finishHandler = nullptr;
+    expected = 0;
+    done = 0;
+    resource = nullptr;
+    value = nullptr;
+    queryParams = nullptr;
+    attributes = nullptr;
+    response = nullptr;
+    data = nullptr;
+    startAt = 0;
+    startedAt = 0;
+    finishedAt = 0;
+    deadline = 0;
+    deadlineSource = nullptr;
+    expired = false;
+    rejected = false;
+    requestClass = CLASS_INTERACTIVE_SET;
+    queuedAt = 0;
+    scheduler = nullptr;
+    proxyMap.clear();
+    m_complete = false;
+    m_status = false;
+}
+
+UpnpRequest *UpnpRequest::acquire()
+{
+    UpnpRequest *request = t_requestPool.pop();
+
+    s_acquired.fetch_add(1, std::memory_order_relaxed);
+    if (request == nullptr)
+    {
+        s_allocated.fetch_add(1, std::memory_order_relaxed);
+        request = new UpnpRequest();
+    }
+    return request;
+}
+
+void UpnpRequest::release(UpnpRequest *request)
+{
+    request->reset();
+    if (!t_requestPool.push(request))
+    {
+        delete request;
+    }
+}
+
+uint64_t UpnpRequest::getAcquired()
+{
+    return s_acquired.load(std::memory_order_relaxed);
+}
+
+uint64_t UpnpRequest::getAllocated()
+{
+    return s_allocated.load(std::memory_order_relaxed);
+}
+
+bool UpnpRequest::start()
+{
+    return (handler != nullptr) ? handler(this) : false;
+}
+
+void UpnpRequest::finish(bool status)
+{
+    finishedAt = g_get_monotonic_time();
+
+    if (deadlineSource != nullptr)
+    {
+        g_source_destroy(deadlineSource);
+        g_source_unref(deadlineSource);
+        deadlineSource = nullptr;
+    }
+    if (expired)
+    {
+        status = false;
+    }
+    if (scheduler != nullptr)
+    {
+        UpnpRequestScheduler *requestScheduler = scheduler;
+        scheduler = nullptr;
+        requestScheduler->finished(this);
+    }
+
+    if (finishHandler != nullptr)
+    {
+        finishHandler(this, status);
+        return;
+    }
+
+    // Notify while holding the lock: the waiting thread may release the
+    // request as soon as it gets the lock
+    std::lock_guard< std::mutex > lock(m_lock);
+    m_status = status;
+    m_complete = true;
+    m_finished.notify_one();
+}
+
+bool UpnpRequest::wait()
+{
+    std::unique_lock< std::mutex > lock(m_lock);
+    m_finished.wait(lock, [this] { return m_complete; });
+    return m_status;
+}
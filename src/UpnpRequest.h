@@ -21,26 +21,139 @@
 #ifndef UPNP_REQUEST_H_
 #define UPNP_REQUEST_H_
 
+#include <atomic>
+#include <condition_variable>
 #include <functional>
 #include <mutex>
-#include <queue>
+#include <set>
+#include <utility>
+#include <vector>
 
 #include <glib.h>
 
 #include "UpnpInternal.h"
 #include "UpnpResource.h"
+#include "UpnpSubscriptionManager.h"
 
+class UpnpPoller;
+class UpnpRequestScheduler;
+
+// Action proxy -> attribute bindings of a request. The first INLINE_SIZE
+// bindings are kept in the request itself; past that, the storage moves to
+// the heap and is kept for the next uses of the (pooled) request.
+class UpnpRequestBindings
+{
+    public:
+        typedef std::pair< GUPnPServiceProxyAction *, UpnpAttributeInfo * > value_type;
+        typedef value_type *iterator;
+
+        static const size_t INLINE_SIZE = 8;
+
+        UpnpRequestBindings();
+
+        UpnpAttributeInfo *&operator[](GUPnPServiceProxyAction *key);
+        iterator find(GUPnPServiceProxyAction *key);
+        void erase(iterator it);
+        void clear();
+
+        iterator begin() { return m_data; }
+        iterator end() { return m_data + m_size; }
+        size_t size() const { return m_size; }
+        bool empty() const { return m_size == 0; }
+
+    private:
+        value_type m_inline[INLINE_SIZE];
+        std::vector< value_type > m_heap;
+        value_type *m_data;
+        size_t m_size;
+        size_t m_capacity;
+
+        UpnpRequestBindings(const UpnpRequestBindings &);
+        UpnpRequestBindings &operator=(const UpnpRequestBindings &);
+};
+
+// A GET/SET (or any other piece of work) handed over to the gupnp thread.
+//
+// Requests are pooled: acquire() takes one from the calling thread's free
+// list and release() gives it back, so that no allocation happens per
+// request in steady state. The handler is a plain function pointer and
+// completion is signalled through the request's own condition variable.
 class UpnpRequest
 {
     public:
-        std::function< bool() > start;
-        std::function< void(bool) > finish;
+        // Runs on the gupnp thread, returns false on failure. The request
+        // is complete once done == expected, either when the handler
+        // returns or from the action callbacks (requestDone).
+        typedef bool (*Handler)(UpnpRequest *request);
+        // Called instead of waking up wait() when set
+        typedef void (*FinishHandler)(UpnpRequest *request, bool status);
+
+        // Scheduling classes, by decreasing priority (UpnpRequestScheduler)
+        typedef enum
+        {
+            CLASS_INTERACTIVE_SET = 0,
+            CLASS_INTERACTIVE_GET,
+            CLASS_OBSERVE_REFRESH,
+            CLASS_BACKGROUND,
+            CLASS_COUNT
+        } Class;
+
+        static const size_t MAX_FREE_REQUESTS = 16;
+
+        Handler handler;
+        FinishHandler finishHandler;
         int expected;
         int done;
 
         UpnpResource *resource;
+        // Handler arguments
+        const RCSResourceAttributes *value;
+        const std::map< std::string, std::string > *queryParams;
+        // GET only: the attributes to fetch (nullptr: all), and the ones
+        // answered to this request only, over the resource attributes
+        // (e.g. a filtered view; nullptr: none)
+        const std::set< std::string > *attributes;
+        RCSResourceAttributes *response;
+        void *data;
+
+        // Monotonic times (us): not to be started before startAt (0: when
+        // dequeued, only honoured by the SET handler), started, finished
+        gint64 startAt;
+        gint64 startedAt;
+        gint64 finishedAt;
+
+        // Monotonic time (us) past which the request fails (0: none), armed
+        // when first started (see UpnpService::armDeadline). Work left once
+        // expired still completes the request, as a failure.
+        gint64 deadline;
+        GSource *deadlineSource;
+        bool expired;
+        // Failed by the scheduler without being started: not admitted,
+        // shed or scheduler stopped
+        bool rejected;
+
+        // Commands unless set otherwise by the issuer
+        Class requestClass;
+        // Monotonic time (us) when queued, scheduler the request counts
+        // against once started (nullptr when finished)
+        gint64 queuedAt;
+        UpnpRequestScheduler *scheduler;
+
         // We have to keep attribute info
-        std::map < GUPnPServiceProxyAction *, UpnpAttributeInfo * > proxyMap;
+        UpnpRequestBindings proxyMap;
+
+        static UpnpRequest *acquire();
+        static void release(UpnpRequest *request);
+
+        // Number of requests taken from/allocated for the pools since start
+        static uint64_t getAcquired();
+        static uint64_t getAllocated();
+
+        bool start();
+        void finish(bool status);
+
+        // Blocks the calling thread until finish() has been called
+        bool wait();
 
         static void requestDone (UpnpRequest *request, bool status)
         {
@@ -51,15 +164,35 @@ class UpnpRequest
                 request->finish(status);
             }
         }
+
+    private:
+        std::mutex m_lock;
+        std::condition_variable m_finished;
+        bool m_complete;
+        bool m_status;
+        UpnpRequest *m_next;
+
+        static std::atomic< uint64_t > s_acquired;
+        static std::atomic< uint64_t > s_allocated;
+
+        UpnpRequest();
+        void reset();
+
+        friend class UpnpRequestPool;
 };
 
 typedef struct _UpnpRequestState
 {
-    GSource *source;
-    guint sourceId;
     GMainContext *context;
 
-    std::queue< UpnpRequest * > requestQueue;
-    std::mutex queueLock;
+    UpnpRequestScheduler *scheduler;
+
+    // GENA subscriptions of the services on this context
+    UpnpSubscriptionManager *subscriptions;
+    // Polling of their attributes that are not evented
+    UpnpPoller *poller;
+
+    // Default request deadline (ms from the first start, 0: none)
+    gint64 requestTimeout;
 } UpnpRequestState;
 #endif
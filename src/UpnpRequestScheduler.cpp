@@ -0,0 +1,457 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include <algorithm>
+#include <iomanip>
+#include <vector>
+
+#include "UpnpInternal.h"
+#include "UpnpRequestScheduler.h"
+
+using namespace std;
+
+static const string MODULE = "UpnpRequestScheduler";
+
+const unsigned int UpnpRequestScheduler::DISPATCH_BATCH;
+
+// Starts per round, by class
+const unsigned int UpnpRequestScheduler::WEIGHTS[UpnpRequest::CLASS_COUNT] = {8, 4, 2, 1};
+
+const unsigned int UpnpRequestScheduler::MAX_IN_PROGRESS[UpnpRequest::CLASS_COUNT] = {0, 0, 8, 2};
+
+unsigned int UpnpRequestScheduler::s_maxOutstanding = 0;
+unsigned int UpnpRequestScheduler::s_maxPerDevice = 0;
+std::atomic< unsigned int > UpnpRequestScheduler::s_outstanding(0);
+
+UpnpRequestScheduler::UpnpRequestScheduler(GMainContext *context, Policy policy) :
+    m_context(context),
+    m_policy(policy),
+    m_source(nullptr),
+    m_stopped(false)
+{
+    for (int c = 0; c < UpnpRequest::CLASS_COUNT; ++c)
+    {
+        m_classes[c].maxDepth = 0;
+        m_classes[c].started = 0;
+        m_classes[c].outstanding = 0;
+        m_classes[c].rejected = 0;
+        m_classes[c].shed = 0;
+        m_classes[c].credits = WEIGHTS[c];
+    }
+}
+
+UpnpRequestScheduler::~UpnpRequestScheduler()
+{
+    stop();
+}
+
+void UpnpRequestScheduler::push(UpnpRequest *request)
+{
+    vector< UpnpRequest * > failed;
+
+    {
+        std::lock_guard< std::mutex > lock(m_lock);
+
+        if (m_stopped)
+        {
+            ERROR_PRINT("Scheduler stopped, failing request " << request);
+            failed.push_back(request);
+        }
+        else if (!admit(request, failed))
+        {
+            DEBUG_PRINT("Rejecting request " << request << " (" << getClassName(request->requestClass) << ")");
+            m_classes[request->requestClass].rejected++;
+            failed.push_back(request);
+        }
+        else
+        {
+            ClassQueue &queue = m_classes[request->requestClass];
+
+            request->queuedAt = g_get_monotonic_time();
+            queue.requests.push_back(request);
+            queue.maxDepth = std::max< uint64_t >(queue.maxDepth, queue.requests.size());
+
+            if (m_source == nullptr)
+            {
+                schedule();
+            }
+            else if (g_source_get_priority(m_source) > getPriority(request->requestClass))
+            {
+                g_source_set_priority(m_source, getPriority(request->requestClass));
+            }
+        }
+    }
+
+    for (auto request : failed)
+    {
+        request->rejected = true;
+        request->finish(false);
+    }
+}
+
+UpnpRequest *UpnpRequestScheduler::pop()
+{
+    std::lock_guard< std::mutex > lock(m_lock);
+
+    if (m_stopped)
+    {
+        return nullptr;
+    }
+
+    int requestClass = selectClass();
+    if (requestClass < 0)
+    {
+        return nullptr;
+    }
+
+    ClassQueue &queue = m_classes[requestClass];
+    UpnpRequest *request = queue.requests.front();
+
+    queue.requests.pop_front();
+    if (queue.credits > 0)
+    {
+        queue.credits--;
+    }
+    queue.started++;
+    queue.wait.record(g_get_monotonic_time() - request->queuedAt);
+
+    return request;
+}
+
+void UpnpRequestScheduler::finished(UpnpRequest *request)
+{
+    std::lock_guard< std::mutex > lock(m_lock);
+
+    unaccount(request);
+
+    // The queued requests of the class may have been held back
+    if (!m_stopped && m_source == nullptr)
+    {
+        schedule();
+    }
+}
+
+void UpnpRequestScheduler::stop()
+{
+    vector< UpnpRequest * > requests;
+
+    {
+        std::lock_guard< std::mutex > lock(m_lock);
+
+        m_stopped = true;
+        for (int c = 0; c < UpnpRequest::CLASS_COUNT; ++c)
+        {
+            requests.insert(requests.end(), m_classes[c].requests.begin(), m_classes[c].requests.end());
+            m_classes[c].requests.clear();
+        }
+
+        if (m_source != nullptr)
+        {
+            g_source_destroy(m_source);
+            g_source_unref(m_source);
+            m_source = nullptr;
+        }
+    }
+
+    for (auto request : requests)
+    {
+        request->rejected = true;
+        request->finish(false);
+    }
+}
+
+UpnpRequestScheduler::ClassStats UpnpRequestScheduler::getStats(UpnpRequest::Class requestClass)
+{
+    ClassStats stats;
+    std::lock_guard< std::mutex > lock(m_lock);
+    ClassQueue &queue = m_classes[requestClass];
+
+    stats.depth = queue.requests.size();
+    stats.maxDepth = queue.maxDepth;
+    stats.started = queue.started;
+    stats.inProgress = queue.outstanding - queue.requests.size();
+    stats.rejected = queue.rejected;
+    stats.shed = queue.shed;
+    stats.wait = queue.wait.getSnapshot();
+
+    return stats;
+}
+
+void UpnpRequestScheduler::dump(ostream &os, const string &name)
+{
+    os << std::fixed << std::setprecision(1);
+
+    for (int c = 0; c < UpnpRequest::CLASS_COUNT; ++c)
+    {
+        ClassStats stats = getStats((UpnpRequest::Class) c);
+
+        os << name << " " << getClassName((UpnpRequest::Class) c) <<
+           ": depth=" << stats.depth <<
+           " maxDepth=" << stats.maxDepth <<
+           " started=" << stats.started <<
+           " inProgress=" << stats.inProgress <<
+           " rejected=" << stats.rejected <<
+           " shed=" << stats.shed <<
+           " wait mean=" << stats.wait.getMean() / 1000 <<
+           " p50=" << stats.wait.getPercentile(50) / 1000.0 <<
+           " p99=" << stats.wait.getPercentile(99) / 1000.0 <<
+           " max=" << stats.wait.max / 1000.0 << std::endl;
+    }
+}
+
+const char *UpnpRequestScheduler::getClassName(UpnpRequest::Class requestClass)
+{
+    switch (requestClass)
+    {
+        case UpnpRequest::CLASS_INTERACTIVE_SET:
+            return "interactive-set";
+        case UpnpRequest::CLASS_INTERACTIVE_GET:
+            return "interactive-get";
+        case UpnpRequest::CLASS_OBSERVE_REFRESH:
+            return "observe-refresh";
+        case UpnpRequest::CLASS_BACKGROUND:
+            return "background";
+        default:
+            return "unknown";
+    }
+}
+
+void UpnpRequestScheduler::setLimits(unsigned int maxOutstanding, unsigned int maxPerDevice)
+{
+    s_maxOutstanding = maxOutstanding;
+    s_maxPerDevice = maxPerDevice;
+}
+
+unsigned int UpnpRequestScheduler::getOutstanding()
+{
+    return s_outstanding.load(std::memory_order_relaxed);
+}
+
+// Locked. The global limit is checked without synchronization between the
+// schedulers: it may be exceeded by the requests admitted concurrently.
+bool UpnpRequestScheduler::admit(UpnpRequest *request, vector< UpnpRequest * > &shed)
+{
+    if (request->resource == nullptr)
+    {
+        account(request);
+        return true;
+    }
+
+    const string udn = request->resource->getUdn();
+    bool overDevice = (s_maxPerDevice != 0 && m_devices[udn] >= s_maxPerDevice);
+    bool overGlobal = (s_maxOutstanding != 0 && s_outstanding.load() >= s_maxOutstanding);
+
+    if (overDevice || overGlobal)
+    {
+        // Over the device limit, only a request to the same device helps
+        UpnpRequest *victim = shedQueued(request->requestClass, overDevice ? &udn : nullptr);
+        if (victim == nullptr)
+        {
+            if (m_devices[udn] == 0)
+            {
+                m_devices.erase(udn);
+            }
+            return false;
+        }
+        DEBUG_PRINT("Shedding request " << victim << " (" << getClassName(victim->requestClass) << ")");
+        shed.push_back(victim);
+    }
+
+    account(request);
+    return true;
+}
+
+// Locked: removes and unaccounts the newest queued request of the lowest
+// class below the given one (of the device, if set)
+UpnpRequest *UpnpRequestScheduler::shedQueued(UpnpRequest::Class requestClass, const string *udn)
+{
+    for (int c = UpnpRequest::CLASS_COUNT - 1; c > requestClass; --c)
+    {
+        deque< UpnpRequest * > &requests = m_classes[c].requests;
+
+        for (auto it = requests.rbegin(); it != requests.rend(); ++it)
+        {
+            UpnpRequest *victim = *it;
+
+            if (victim->resource == nullptr || (udn != nullptr && victim->resource->getUdn() != *udn))
+            {
+                continue;
+            }
+
+            requests.erase(std::next(it).base());
+            m_classes[c].shed++;
+            unaccount(victim);
+            victim->scheduler = nullptr;
+            return victim;
+        }
+    }
+    return nullptr;
+}
+
+// Locked
+void UpnpRequestScheduler::account(UpnpRequest *request)
+{
+    m_classes[request->requestClass].outstanding++;
+    s_outstanding++;
+    if (request->resource != nullptr)
+    {
+        m_devices[request->resource->getUdn()]++;
+    }
+    request->scheduler = this;
+}
+
+// Locked
+void UpnpRequestScheduler::unaccount(UpnpRequest *request)
+{
+    m_classes[request->requestClass].outstanding--;
+    s_outstanding--;
+    if (request->resource != nullptr)
+    {
+        auto it = m_devices.find(request->resource->getUdn());
+        if (it != m_devices.end() && --it->second == 0)
+        {
+            m_devices.erase(it);
+        }
+    }
+}
+
+// Locked
+int UpnpRequestScheduler::selectClass()
+{
+    if (m_policy == POLICY_STRICT)
+    {
+        for (int c = 0; c < UpnpRequest::CLASS_COUNT; ++c)
+        {
+            if (isStartable(c))
+            {
+                return c;
+            }
+        }
+        return -1;
+    }
+
+    for (int round = 0; round < 2; ++round)
+    {
+        bool startable = false;
+
+        for (int c = 0; c < UpnpRequest::CLASS_COUNT; ++c)
+        {
+            if (isStartable(c))
+            {
+                if (m_classes[c].credits > 0)
+                {
+                    return c;
+                }
+                startable = true;
+            }
+        }
+
+        if (!startable)
+        {
+            break;
+        }
+
+        // The classes with requests have used their share, next round
+        for (int c = 0; c < UpnpRequest::CLASS_COUNT; ++c)
+        {
+            m_classes[c].credits = WEIGHTS[c];
+        }
+    }
+    return -1;
+}
+
+// Locked
+bool UpnpRequestScheduler::isStartable(int requestClass)
+{
+    const ClassQueue &queue = m_classes[requestClass];
+
+    return !queue.requests.empty() &&
+           (MAX_IN_PROGRESS[requestClass] == 0 ||
+            queue.outstanding - queue.requests.size() < MAX_IN_PROGRESS[requestClass]);
+}
+
+// Locked, attaches the dispatch source if a request may start
+void UpnpRequestScheduler::schedule()
+{
+    for (int c = 0; c < UpnpRequest::CLASS_COUNT; ++c)
+    {
+        if (isStartable(c))
+        {
+            m_source = g_idle_source_new();
+            g_source_set_priority(m_source, getPriority(c));
+            g_source_set_callback(m_source, dispatch, this, NULL);
+            g_source_attach(m_source, m_context);
+            return;
+        }
+    }
+}
+
+gint UpnpRequestScheduler::getPriority(int requestClass)
+{
+    // Interactive requests are started along with the action responses,
+    // the others when the loop is idle
+    return (requestClass <= UpnpRequest::CLASS_INTERACTIVE_GET) ? G_PRIORITY_DEFAULT :
+           G_PRIORITY_DEFAULT_IDLE;
+}
+
+gboolean UpnpRequestScheduler::dispatch(gpointer userData)
+{
+    UpnpRequestScheduler *scheduler = static_cast< UpnpRequestScheduler * >(userData);
+
+    for (unsigned int i = 0; i < DISPATCH_BATCH; ++i)
+    {
+        UpnpRequest *request = scheduler->pop();
+        if (request == nullptr)
+        {
+            break;
+        }
+
+        bool status = request->start();
+
+        // If request completed, finalize here
+        if (request->done == request->expected)
+        {
+            DEBUG_PRINT("finish " << request);
+            request->finish(status);
+        }
+    }
+
+    std::lock_guard< std::mutex > lock(scheduler->m_lock);
+
+    if (scheduler->m_stopped)
+    {
+        // The source is gone (see stop)
+        return G_SOURCE_REMOVE;
+    }
+
+    for (int c = 0; c < UpnpRequest::CLASS_COUNT; ++c)
+    {
+        if (scheduler->isStartable(c))
+        {
+            g_source_set_priority(scheduler->m_source, getPriority(c));
+            return G_SOURCE_CONTINUE;
+        }
+    }
+
+    // Scheduled again by push, or finished once the held back requests may start
+    g_source_unref(scheduler->m_source);
+    scheduler->m_source = nullptr;
+    return G_SOURCE_REMOVE;
+}
@@ -0,0 +1,148 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#ifndef UPNP_REQUEST_SCHEDULER_H_
+#define UPNP_REQUEST_SCHEDULER_H_
+
+#include <atomic>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <glib.h>
+
+#include "UpnpLatencyHistogram.h"
+#include "UpnpRequest.h"
+
+// Requests handed over to the gupnp thread of a shard, queued by class
+// (UpnpRequest::Class) in front of its main loop.
+//
+// The requests are started in priority order: strictly (a class only runs
+// when the higher ones are empty) or weighted (each class gets WEIGHTS
+// starts per round). While interactive requests are queued, the dispatch
+// source runs at the priority of the action responses, below it otherwise,
+// and starts at most DISPATCH_BATCH requests per iteration. The background
+// classes are also limited in the number of requests in progress, so that
+// they do not take all the connections to the devices.
+//
+// Admission: the requests outstanding (queued or in progress) are limited
+// globally and per device. Past a limit, a request takes the place of the
+// newest queued request of a lower class (shed), or fails right away
+// (rejected). Internal requests (no resource) are never limited or shed.
+class UpnpRequestScheduler
+{
+    public:
+        typedef enum
+        {
+            POLICY_STRICT = 0,
+            POLICY_WEIGHTED
+        } Policy;
+
+        typedef struct _ClassStats
+        {
+            uint64_t depth;
+            uint64_t maxDepth;
+            uint64_t started;
+            uint64_t inProgress;
+            uint64_t rejected;
+            uint64_t shed;
+            // Time spent queued (us)
+            UpnpLatencyHistogram::Snapshot wait;
+        } ClassStats;
+
+        static const unsigned int DISPATCH_BATCH = 16;
+        static const unsigned int WEIGHTS[UpnpRequest::CLASS_COUNT];
+        // 0: unlimited
+        static const unsigned int MAX_IN_PROGRESS[UpnpRequest::CLASS_COUNT];
+
+        UpnpRequestScheduler(GMainContext *context, Policy policy);
+        ~UpnpRequestScheduler();
+
+        // Any thread, fails the request if it is not admitted
+        void push(UpnpRequest *request);
+
+        // Runs on the gupnp thread: the next request to start, nullptr if
+        // none may start now. The request is in progress until it finishes.
+        UpnpRequest *pop();
+
+        // Called by UpnpRequest::finish for the admitted requests
+        void finished(UpnpRequest *request);
+
+        // Fails the queued requests, and the ones pushed from now on
+        void stop();
+
+        ClassStats getStats(UpnpRequest::Class requestClass);
+
+        // One line per class, wait times in ms
+        void dump(std::ostream &os, const std::string &name);
+
+        static const char *getClassName(UpnpRequest::Class requestClass);
+
+        // Outstanding request limits (0: unlimited), across the schedulers
+        static void setLimits(unsigned int maxOutstanding, unsigned int maxPerDevice);
+        static unsigned int getOutstanding();
+
+    private:
+        typedef struct _ClassQueue
+        {
+            std::deque< UpnpRequest * > requests;
+            uint64_t maxDepth;
+            uint64_t started;
+            // Queued or in progress
+            uint64_t outstanding;
+            uint64_t rejected;
+            uint64_t shed;
+            unsigned int credits;
+            UpnpLatencyHistogram wait;
+        } ClassQueue;
+
+        GMainContext *m_context;
+        Policy m_policy;
+
+        std::mutex m_lock;
+        ClassQueue m_classes[UpnpRequest::CLASS_COUNT];
+        GSource *m_source;
+        bool m_stopped;
+
+        // Outstanding requests by device UDN (devices stay on one shard)
+        std::map< std::string, unsigned int > m_devices;
+
+        static unsigned int s_maxOutstanding;
+        static unsigned int s_maxPerDevice;
+        static std::atomic< unsigned int > s_outstanding;
+
+        bool admit(UpnpRequest *request, std::vector< UpnpRequest * > &shed);
+        UpnpRequest *shedQueued(UpnpRequest::Class requestClass, const std::string *udn);
+        void account(UpnpRequest *request);
+        void unaccount(UpnpRequest *request);
+        int selectClass();
+        bool isStartable(int requestClass);
+        void schedule();
+        static gint getPriority(int requestClass);
+        static gboolean dispatch(gpointer userData);
+
+        UpnpRequestScheduler(const UpnpRequestScheduler &);
+        UpnpRequestScheduler &operator=(const UpnpRequestScheduler &);
+};
+
+#endif
@@ -17,6 +17,8 @@
 // limitations under the License.
 //
 //-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+#include <cstdio>
+
 #include <boost/regex.hpp>
 
 #include "UpnpResource.h"
@@ -34,6 +36,8 @@ UpnpResource::UpnpResource()
     m_registered = false;
     m_udn = "";
     m_links.clear();
+    m_epoch = g_random_int();
+    m_version = 0;
 }
 
 UpnpResource::~UpnpResource()
@@ -43,6 +47,127 @@ UpnpResource::~UpnpResource()
     m_links.clear();
 }
 
+UpnpResource::Snapshot UpnpResource::getSnapshot() const
+{
+    Snapshot base;
+    RCSResourceAttributes changes;
+    unsigned long version;
+
+    {
+        std::lock_guard< std::mutex > lock(m_attributeLock);
+
+        if (m_snapshot)
+        {
+            return m_snapshot;
+        }
+        for (const auto &key : m_changed)
+        {
+            changes[key] = m_attributes.at(key);
+        }
+        base = m_base;
+        version = m_version;
+    }
+
+    // The bulk of the copy, without holding off the writers
+    std::shared_ptr< RCSResourceAttributes > attributes =
+        base ? std::make_shared< RCSResourceAttributes >(*base) :
+        std::make_shared< RCSResourceAttributes >();
+    for (const auto &change : changes)
+    {
+        (*attributes)[change.key()] = change.value();
+    }
+    Snapshot snapshot = attributes;
+
+    std::lock_guard< std::mutex > lock(m_attributeLock);
+    if (m_version == version)
+    {
+        m_snapshot = snapshot;
+        m_base = snapshot;
+        m_changed.clear();
+    }
+    // Else still consistent (as of version), but out of date already
+    return snapshot;
+}
+
+RCSResourceAttributes UpnpResource::getAttributesResponse(const map< string, string > &queryParams)
+{
+    Snapshot snapshot = getSnapshot();
+
+    map< string, string >::const_iterator it = queryParams.find(UPNP_OIC_QUERY_PARAM_ETAG);
+    if (it != queryParams.end() && snapshot->contains("etag") &&
+        it->second == snapshot->at("etag").get< string >())
+    {
+        RCSResourceAttributes valid;
+        valid["etag"] = snapshot->at("etag");
+        valid["valid"] = true;
+        return valid;
+    }
+
+    return *snapshot;
+}
+
+// Called with m_attributeLock held
+void UpnpResource::bumpVersion()
+{
+    // "<epoch>.<version>": clients only test equality
+    char etag[32];
+    snprintf(etag, sizeof(etag), "%08x.%lu", m_epoch, ++m_version);
+    m_attributes["etag"] = string(etag);
+    m_changed.insert("etag");
+    m_snapshot.reset();
+}
+
+// Called with m_attributeLock held, before notifying the observers.
+// Returns false, changing nothing, if key already has that value.
+bool UpnpResource::update(const string &key, const RCSResourceAttributes::Value &value)
+{
+    if (m_attributes.contains(key) && m_attributes.at(key) == value)
+    {
+        return false;
+    }
+
+    m_attributes[key] = value;
+    m_changed.insert(key);
+    bumpVersion();
+    return true;
+}
+
+void UpnpResource::setAttribute(const string &key, RCSResourceAttributes::Value &&value, bool notify)
+{
+    std::lock_guard< std::mutex > lock(m_attributeLock);
+
+    update(key, value);
+    BundleResource::setAttribute(key, std::move(value), notify);
+}
+
+void UpnpResource::setAttribute(const string &key, const RCSResourceAttributes::Value &value,
+                                bool notify)
+{
+    std::lock_guard< std::mutex > lock(m_attributeLock);
+
+    update(key, value);
+    BundleResource::setAttribute(key, value, notify);
+}
+
+bool UpnpResource::setCompositeMember(const string &parent, const string &key,
+                                      RCSResourceAttributes::Value &&value, bool notify)
+{
+    // Held while notifying, for the writes of the composite to be ordered
+    std::lock_guard< std::mutex > lock(m_attributeLock);
+
+    RCSResourceAttributes &composite = m_attributes[parent].get< RCSResourceAttributes >();
+    if (composite.contains(key) && composite.at(key) == value)
+    {
+        return false;
+    }
+
+    composite[key] = std::move(value);
+    m_changed.insert(parent);
+    bumpVersion();
+    BundleResource::setAttribute(parent, composite, notify);
+    return true;
+}
+
 void UpnpResource::setRegistered(bool registered)
 {
     m_registered = registered;
@@ -69,7 +194,7 @@ void UpnpResource::setLinkAttribute()
     if (!m_links.empty())
     {
         DEBUG_PRINT("Setting links");
-        BundleResource::setAttribute("links", m_links);
+        setAttribute("links", m_links);
     }
 }
 
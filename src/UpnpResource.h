@@ -21,6 +21,12 @@
 #ifndef UPNP_RESOURCE_H_
 #define UPNP_RESOURCE_H_
 
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+
 #include <Configuration.h>
 #include <OCPlatform.h>
 #include <ProtocolBridgeResource.h>
@@ -37,6 +43,7 @@ class UpnpResource: public ProtocolBridgeResource
     public:
 
         typedef std::shared_ptr< UpnpResource > Ptr;
+        typedef std::shared_ptr< const RCSResourceAttributes > Snapshot;
 
         UpnpResource();
         virtual ~UpnpResource();
@@ -53,11 +60,55 @@ class UpnpResource: public ProtocolBridgeResource
         void setReady(bool isReady);
         bool isReady();
 
+        // Shadow those of BundleResource, so that the attributes behind
+        // the snapshots stay coherent with it
+        void setAttribute(const string &key, RCSResourceAttributes::Value &&value, bool notify = true);
+        void setAttribute(const string &key, const RCSResourceAttributes::Value &value, bool notify = true);
+
+        // Sets member key of the composite attribute parent, updated in
+        // place. Nothing is set (nor notified) if the member already has
+        // that value: returns false.
+        // The container builds the observe payloads from the whole
+        // attribute map, there is no way to hand it the changed members.
+        bool setCompositeMember(const string &parent, const string &key,
+                                RCSResourceAttributes::Value &&value, bool notify = true);
+
+        // Current attributes (any thread). Writes update the attributes in
+        // place and note the keys they changed; the first read after a batch
+        // of writes builds a new immutable snapshot, which later reads share
+        // until the next write. Readers hold the lock only to copy the
+        // changed values: the previous snapshot is copied outside it, and
+        // the new one is published unless a write came meanwhile.
+        Snapshot getSnapshot() const;
+
+        // Response to a GET: the attributes, with their version as "etag"
+        // (bumped by any change, links included), or only the version if
+        // the client's (UPNP_OIC_QUERY_PARAM_ETAG) is current.
+        // Versions start from a random epoch per instance, so that a
+        // resource created again for the same device (or uri) does not
+        // repeat the etags of the previous one.
+        RCSResourceAttributes getAttributesResponse(const map< string, string > &queryParams);
+
     protected:
         CompositeAttribute m_links;
         string m_udn;
         bool m_ready;
         bool m_registered;
+
+    private:
+        // Guards the members below
+        mutable std::mutex m_attributeLock;
+        RCSResourceAttributes m_attributes;
+        // Last published, null once a write made it out of date
+        mutable Snapshot m_snapshot;
+        // Last published, and the keys written since
+        mutable Snapshot m_base;
+        mutable set< string > m_changed;
+        guint32 m_epoch;
+        unsigned long m_version;
+
+        bool update(const string &key, const RCSResourceAttributes::Value &value);
+        void bumpVersion();
 };
 
 #endif
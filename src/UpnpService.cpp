@@ -18,13 +18,17 @@
 //
 //-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
 
+#include <algorithm>
 #include <soup.h>
-#include <future>
 #include <thread>
 
+#include "UpnpActionStats.h"
 #include "UpnpConstants.h"
+#include "UpnpDeviceHealth.h"
 #include "UpnpException.h"
 #include "UpnpInternal.h"
+#include "UpnpPoller.h"
+#include "UpnpRequestScheduler.h"
 #include "UpnpService.h"
 
 using namespace std;
@@ -40,6 +44,8 @@ UpnpService::UpnpService(GUPnPServiceInfo *serviceInfo,
     DEBUG_PRINT("(" << std::this_thread::get_id() << ")");
     m_proxy = nullptr;
     m_resourceType = type;
+    m_introspected = false;
+    m_introspectionCancellable = nullptr;
 
     if (attributeInfo == nullptr)
     {
@@ -93,9 +99,37 @@ UpnpService::UpnpService(GUPnPServiceInfo *serviceInfo,
 
 void UpnpService::stop()
 {
+    if (m_introspectionCancellable != nullptr)
+    {
+        // The introspection callback is invoked with G_IO_ERROR_CANCELLED
+        GCancellable *cancellable = m_introspectionCancellable;
+        m_introspectionCancellable = nullptr;
+        g_cancellable_cancel(cancellable);
+        g_object_unref(cancellable);
+    }
+
+    for (auto request : m_pendingRequests)
+    {
+        UpnpRequest::requestDone(request, false);
+    }
+    m_pendingRequests.clear();
+
+    for (auto &delayed : m_delayedRequests)
+    {
+        g_source_destroy(delayed.second);
+        g_source_unref(delayed.second);
+        UpnpRequest::requestDone(delayed.first, false);
+    }
+    m_delayedRequests.clear();
+
+    if (m_requestState->poller != nullptr)
+    {
+        m_requestState->poller->remove(this);
+    }
+
     if (!m_stateVarMap.empty())
     {
-        std::map<string, StateVarAttr>::iterator it;
+        std::map<string, UpnpStateVariable>::iterator it;
         for (it = m_stateVarMap.begin(); it != m_stateVarMap.end(); ++it)
         {
             DEBUG_PRINT("remove notify for \"" << it->first << "\"");
@@ -103,7 +137,7 @@ void UpnpService::stop()
             gupnp_service_proxy_remove_notify (m_proxy,
                                                (it->first).c_str(),
                                                onStateChanged,
-                                               this);
+                                               &(it->second));
         }
         m_stateVarMap.clear();
     }
@@ -120,30 +154,27 @@ RCSResourceAttributes UpnpService::handleGetAttributesRequest(const map< string,
 {
     DEBUG_PRINT("(" << std::this_thread::get_id() << "), uri:" << m_uri);
 
-    std::promise< bool > promise;
-    UpnpRequest request;
-    request.done = 0;
-    request.expected = m_attributeMap.size();
-    request.resource = this;
+    if (!UpnpDeviceHealth::isAvailable(m_udn))
     {
-        std::lock_guard< std::mutex > lock(m_requestState->queueLock);
-        request.start = [&] ()
-        {
-            bool status = getAttributesRequest(&request, queryParams);
-            return status;
-        };
-        request.finish = [&] (bool status) { DEBUG_PRINT("finish get request"); promise.set_value(status); };
-        m_requestState->requestQueue.push(&request);
-
-        // Add the gupnp callback if it has not been scheduled yet
-        if (m_requestState->sourceId == 0)
-        {
-            DEBUG_PRINT("source: " << m_requestState->source << "context: " << m_requestState->context);
-            m_requestState->sourceId = g_source_attach(m_requestState->source, m_requestState->context);
-        }
+        DEBUG_PRINT("circuit open, serving last known values for " << m_uri);
+        RCSResourceAttributes attrs = *getSnapshot();
+        attrs["stale"] = true;
+        return attrs;
     }
 
-    bool status = promise.get_future().get();
+    RCSResourceAttributes response;
+    UpnpRequest *request = UpnpRequest::acquire();
+    request->handler = startGetRequest;
+    request->requestClass = UpnpRequest::CLASS_INTERACTIVE_GET;
+    request->resource = this;
+    request->queryParams = &queryParams;
+    request->response = &response;
+    request->deadline = getDeadline(queryParams);
+    queueRequest(request);
+
+    bool status = request->wait();
+    bool rejected = request->rejected;
+    UpnpRequest::release(request);
 
     // Notice the API deficiency: there is no way to return error code
     // to the iotivity layer
@@ -152,7 +183,23 @@ RCSResourceAttributes UpnpService::handleGetAttributesRequest(const map< string,
         DEBUG_PRINT("Failed to get attributes for " << m_uri);
     }
 
-    return BundleResource::getAttributes();
+    RCSResourceAttributes attrs = getAttributesResponse(queryParams);
+    if (!attrs.contains("valid"))
+    {
+        for (auto &attr : response)
+        {
+            attrs[attr.key()] = attr.value();
+        }
+    }
+
+    // Not admitted or shed under load: nothing was fetched, as when the
+    // circuit is open
+    if (rejected)
+    {
+        DEBUG_PRINT("request rejected, serving last known values for " << m_uri);
+        attrs["stale"] = true;
+    }
+    return attrs;
 
 }
 
@@ -161,28 +208,7 @@ void UpnpService::handleSetAttributesRequest(const RCSResourceAttributes &value,
 {
     DEBUG_PRINT("(" << std::this_thread::get_id() << "), uri:" << m_uri);
 
-    std::promise< bool > promise;
-    UpnpRequest request;
-    request.done = 0;
-    request.expected = value.size();
-    request.resource = this;
-    {
-        std::lock_guard< std::mutex > lock(m_requestState->queueLock);
-        request.start = [&] ()
-        {
-            bool status = setAttributesRequest(value, &request, queryParams);
-            return status;
-        };
-        request.finish = [&] (bool status) { DEBUG_PRINT("finish set request"); promise.set_value(status); };
-        m_requestState->requestQueue.push(&request);
-
-        // Add the gupnp callback if it has not been scheduled yet
-        if (m_requestState->sourceId == 0)
-        {
-            m_requestState->sourceId = g_source_attach(m_requestState->source, m_requestState->context);
-        }
-    }
-    bool status = promise.get_future().get();
+    bool status = endRequest(beginSetAttributesRequest(value, queryParams));
 
     // Notice the API deficiency: there is no way to return error code
     // to the iotivity layer
@@ -192,6 +218,83 @@ void UpnpService::handleSetAttributesRequest(const RCSResourceAttributes &value,
     }
 }
 
+UpnpRequest *UpnpService::beginSetAttributesRequest(const RCSResourceAttributes &value,
+        const map< string, string > &queryParams,
+        gint64 startAt)
+{
+    UpnpRequest *request = UpnpRequest::acquire();
+    request->handler = startSetRequest;
+    request->resource = this;
+    request->value = &value;
+    request->queryParams = &queryParams;
+    request->startAt = startAt;
+    request->deadline = getDeadline(queryParams);
+
+    if (!UpnpDeviceHealth::isAvailable(m_udn))
+    {
+        // Fail fast, nothing is sent
+        DEBUG_PRINT("circuit open, failing SET for " << m_uri);
+        request->finish(false);
+        return request;
+    }
+    queueRequest(request);
+
+    return request;
+}
+
+bool UpnpService::endRequest(UpnpRequest *request)
+{
+    bool status = request->wait();
+    UpnpRequest::release(request);
+
+    return status;
+}
+
+void UpnpService::beginRefresh(const set< string > *attributes, UpnpRequest::FinishHandler handler,
+                               void *data)
+{
+    static const map< string, string > noQueryParams;
+
+    UpnpRequest *request = UpnpRequest::acquire();
+    request->handler = startGetRequest;
+    request->requestClass = UpnpRequest::CLASS_OBSERVE_REFRESH;
+    request->resource = this;
+    request->queryParams = &noQueryParams;
+    request->attributes = attributes;
+    request->finishHandler = handler;
+    request->data = data;
+    request->deadline = getDeadline(noQueryParams);
+    queueRequest(request);
+}
+
+set< string > UpnpService::getUneventedAttributes()
+{
+    set< string > attributes;
+
+    for (auto &attr : m_attributeMap)
+    {
+        if (!attr.second.first->evented && (attr.second.second & UPNP_ACTION_GET))
+        {
+            attributes.insert(attr.first);
+        }
+    }
+    return attributes;
+}
+
+bool UpnpService::isGetRequested(UpnpRequest *request, const string &attrName)
+{
+    if (!UpnpAttribute::isValidRequest(&m_attributeMap, attrName, UPNP_ACTION_GET))
+    {
+        return false;
+    }
+    return (request->attributes == nullptr) || (request->attributes->count(attrName) != 0);
+}
+
+void UpnpService::queueRequest(UpnpRequest *request)
+{
+    m_requestState->scheduler->push(request);
+}
+
 void UpnpService::setProxy(GUPnPServiceProxy *proxy)
 {
     m_proxy = proxy;
@@ -207,9 +310,260 @@ string UpnpService::getId()
     return m_serviceId;
 }
 
+bool UpnpService::isIntrospected()
+{
+    return m_introspected;
+}
+
+void UpnpService::setIntrospected(bool introspected)
+{
+    m_introspected = introspected;
+}
+
+bool UpnpService::startGetRequest(UpnpRequest *request)
+{
+    UpnpService *pService = static_cast<UpnpService *> (request->resource);
+
+    if (!pService->armDeadline(request))
+    {
+        return false;
+    }
+
+    if (!pService->m_introspected)
+    {
+        return pService->deferRequest(request);
+    }
+
+    // The attribute map is only complete after introspection
+    request->expected = pService->m_attributeMap.size();
+    return pService->getAttributesRequest(request, *request->queryParams);
+}
+
+bool UpnpService::startSetRequest(UpnpRequest *request)
+{
+    UpnpService *pService = static_cast<UpnpService *> (request->resource);
+
+    if (!pService->armDeadline(request))
+    {
+        return false;
+    }
+
+    if (!pService->m_introspected)
+    {
+        return pService->deferRequest(request);
+    }
+
+    gint64 now = g_get_monotonic_time();
+    if (request->startAt > now)
+    {
+        return pService->delayRequest(request, now);
+    }
+
+    request->startedAt = now;
+    request->expected = request->value->size();
+    return pService->setAttributesRequest(*request->value, request, *request->queryParams);
+}
+
+// Runs on the gupnp thread: the request is started again at its start time
+bool UpnpService::delayRequest(UpnpRequest *request, gint64 now)
+{
+    // Keep the request open until then
+    request->expected = request->done + 1;
+
+    GSource *source = g_timeout_source_new((request->startAt - now + 999) / 1000);
+    g_source_set_priority(source, G_PRIORITY_HIGH);
+    g_source_set_callback(source, onStartTime, request, NULL);
+    g_source_attach(source, m_requestState->context);
+    m_delayedRequests[request] = source;
+
+    return true;
+}
+
+gboolean UpnpService::onStartTime(gpointer userData)
+{
+    UpnpRequest *request = static_cast<UpnpRequest *> (userData);
+    UpnpService *pService = static_cast<UpnpService *> (request->resource);
+
+    auto it = pService->m_delayedRequests.find(request);
+    g_source_unref(it->second);
+    pService->m_delayedRequests.erase(it);
+
+    // Rounded up to the ms: the start time has passed
+    request->startAt = 0;
+    bool status = request->start();
+    if (request->done == request->expected)
+    {
+        request->finish(status);
+    }
+
+    return G_SOURCE_REMOVE;
+}
+
+gint64 UpnpService::getDeadline(const map< string, string > &queryParams)
+{
+    gint64 timeout = m_requestState->requestTimeout;
+
+    auto it = queryParams.find(UPNP_OIC_QUERY_PARAM_TIMEOUT);
+    if (it != queryParams.end())
+    {
+        try
+        {
+            timeout = std::max(0, std::stoi(it->second));
+        }
+        catch (const std::exception &e)
+        {
+            ERROR_PRINT("Invalid queryParam " << it->first << "=" << it->second);
+        }
+    }
+
+    return (timeout > 0) ? g_get_monotonic_time() + timeout * 1000 : 0;
+}
+
+// Runs on the gupnp thread, returns false if the request has expired before
+// being started. Armed once: restarts (deferred, delayed) keep the source.
+bool UpnpService::armDeadline(UpnpRequest *request)
+{
+    if (request->deadline == 0 || request->deadlineSource != nullptr)
+    {
+        return true;
+    }
+
+    gint64 now = g_get_monotonic_time();
+    if (request->deadline <= now)
+    {
+        DEBUG_PRINT("uri: " << m_uri << ", request expired in the queue");
+        return false;
+    }
+
+    GSource *source = g_timeout_source_new((request->deadline - now + 999) / 1000);
+    g_source_set_callback(source, onDeadline, request, NULL);
+    g_source_attach(source, m_requestState->context);
+    request->deadlineSource = source;
+
+    return true;
+}
+
+gboolean UpnpService::onDeadline(gpointer userData)
+{
+    UpnpRequest *request = static_cast<UpnpRequest *> (userData);
+    UpnpService *pService = static_cast<UpnpService *> (request->resource);
+
+    g_source_unref(request->deadlineSource);
+    request->deadlineSource = nullptr;
+
+    ERROR_PRINT("uri: " << pService->m_uri << ", request deadline passed");
+    request->expired = true;
+    request->done += pService->cancelRequest(request);
+
+    // Otherwise, the work not owned by the request (e.g. batches) completes it
+    if (request->done >= request->expected)
+    {
+        request->done = request->expected;
+        request->proxyMap.clear();
+        request->finish(false);
+    }
+
+    return G_SOURCE_REMOVE;
+}
+
+int UpnpService::cancelRequest(UpnpRequest *request)
+{
+    auto pending = std::find(m_pendingRequests.begin(), m_pendingRequests.end(), request);
+    if (pending != m_pendingRequests.end())
+    {
+        m_pendingRequests.erase(pending);
+        return 1;
+    }
+
+    auto delayed = m_delayedRequests.find(request);
+    if (delayed != m_delayedRequests.end())
+    {
+        g_source_destroy(delayed->second);
+        g_source_unref(delayed->second);
+        m_delayedRequests.erase(delayed);
+        return 1;
+    }
+
+    // The action callbacks are not invoked once cancelled
+    return UpnpActionStats::cancelActions(m_proxy, request);
+}
+
+// Runs on the gupnp thread. Requests on a service that has not been
+// introspected yet are parked until its SCPD has been fetched.
+bool UpnpService::deferRequest(UpnpRequest *request)
+{
+    // Keep the request open until the introspection completes
+    request->expected = request->done + 1;
+    m_pendingRequests.push_back(request);
+
+    if (m_introspectionCancellable == nullptr && m_proxy != nullptr)
+    {
+        DEBUG_PRINT("Introspecting " << m_uri);
+        m_introspectionCancellable = g_cancellable_new();
+        gupnp_service_info_get_introspection_async_full(GUPNP_SERVICE_INFO(m_proxy),
+                onIntrospectionAvailable,
+                m_introspectionCancellable,
+                this);
+    }
+    return true;
+}
+
+void UpnpService::onIntrospectionAvailable(GUPnPServiceInfo *info,
+        GUPnPServiceIntrospection *introspection,
+        const GError *error,
+        gpointer userData)
+{
+    UpnpService *pService = static_cast<UpnpService *> (userData);
+    vector <UpnpRequest *> pending;
+
+    if (error && g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    {
+        // See stop(), the pending requests have been failed
+        return;
+    }
+
+    g_object_unref(pService->m_introspectionCancellable);
+    pService->m_introspectionCancellable = nullptr;
+    pending.swap(pService->m_pendingRequests);
+
+    if (error)
+    {
+        // Requests fail, the next one retries
+        ERROR_PRINT(pService->m_uri << ": " << error->message);
+        for (auto request : pending)
+        {
+            UpnpRequest::requestDone(request, false);
+        }
+        return;
+    }
+
+    pService->processIntrospection(pService->m_proxy, introspection);
+    pService->m_introspected = true;
+    g_object_unref(introspection);
+
+    if (pService->isRegistered())
+    {
+        // Subscribe to notifications, see UpnpConnector::registerService
+        pService->m_requestState->subscriptions->addObserver(pService->m_proxy);
+        pService->m_requestState->poller->add(pService);
+    }
+
+    for (auto request : pending)
+    {
+        bool status = request->start();
+
+        // If request completed, finalize here
+        if (request->done == request->expected)
+        {
+            request->finish(status);
+        }
+    }
+}
+
 void UpnpService::processIntrospection(GUPnPServiceProxy *proxy,
                                        GUPnPServiceIntrospection *introspection)
 {
+    UpnpActionStats::attach(proxy, introspection);
 
     // Load attributes description
     vector <UpnpAttributeInfo> *attributeList = m_serviceAttributeInfo;
@@ -277,7 +631,7 @@ void UpnpService::processIntrospection(GUPnPServiceProxy *proxy,
 
     // Generate convenient map of UPnP state variables that are observed/notified to
     // corresponding OCF attributes
-    map <string, StateVarAttr> varMap;
+    map <string, UpnpStateVariable> varMap;
 
     for (attr = attributeList->begin() ; attr != attributeList->end() ; ++attr)
     {
@@ -290,9 +644,7 @@ void UpnpService::processIntrospection(GUPnPServiceProxy *proxy,
         if (string(attr->varName) != "")
         {
             DEBUG_PRINT("Attr State variable: " << attr->varName);
-            varMap[string(attr->varName)].attrName = attr->name;
-            varMap[string(attr->varName)].type = attr->type;
-            varMap[string(attr->varName)].parentName = "";
+            varMap[string(attr->varName)] = UpnpStateVariable(this, attr->name, "", attr->type);
         }
         else if (!attr->attrs.empty()) // check if embedded attributes
             // are observable
@@ -304,9 +656,7 @@ void UpnpService::processIntrospection(GUPnPServiceProxy *proxy,
                     string stateVarName = string(it.varName);
 
                     DEBUG_PRINT("Attr State variable: " << stateVarName);
-                    varMap[stateVarName].attrName = it.name;
-                    varMap[stateVarName].type = it.type;
-                    varMap[stateVarName].parentName = attr->name;
+                    varMap[stateVarName] = UpnpStateVariable(this, it.name, attr->name, it.type);
                 }
             }
         }
@@ -329,26 +679,26 @@ void UpnpService::processIntrospection(GUPnPServiceProxy *proxy,
             const char *varName = (const char *) l->data;
             DEBUG_PRINT("State variable: " << varName);
 
-            std::map<string, StateVarAttr>::iterator it = varMap.find(string(varName));
+            std::map<string, UpnpStateVariable>::iterator it = varMap.find(string(varName));
 
             if (it != varMap.end())
             {
-                if (string(it->first) == string(varName))
+                // The node address is stable: it is the user data of the notify
+                UpnpStateVariable *stateVar = &(m_stateVarMap[it->first] = it->second);
+
+                if (!gupnp_service_proxy_add_notify (proxy,
+                                                     varName,
+                                                     stateVar->type,
+                                                     onStateChanged,
+                                                     stateVar))
                 {
-                    if (!gupnp_service_proxy_add_notify (proxy,
-                                                         varName,
-                                                         (it->second).type,
-                                                         onStateChanged,
-                                                         this))
-                    {
-                        ERROR_PRINT("Failed to add notify for " << varName);
-                    }
-                    else
-                    {
-                        DEBUG_PRINT("Added notify for: " << varName << ", " << (it->second).attrName <<
-                                    ", " << g_type_name((it->second).type));
-                        m_stateVarMap[it->first] = it->second;
-                    }
+                    ERROR_PRINT("Failed to add notify for " << varName);
+                    m_stateVarMap.erase(it->first);
+                }
+                else
+                {
+                    DEBUG_PRINT("Added notify for: " << varName << ", " << stateVar->attrName <<
+                                ", " << g_type_name(stateVar->type));
                 }
             }
 
@@ -361,97 +711,25 @@ void UpnpService::onStateChanged(GUPnPServiceProxy *proxy,
                                  GValue *value,
                                  gpointer userData)
 {
-    UpnpService *pService = (UpnpService *) userData;
-
-    std::map<string, StateVarAttr>::iterator it = pService->m_stateVarMap.find(string(variable));
-
-    DEBUG_PRINT("(" << std::this_thread::get_id() << "): notification state variable: " << variable);
-
-    if (it == pService->m_stateVarMap.end())
-    {
-        DEBUG_PRINT("state var not found: " << variable);
-        return;
-    }
-
-
-    string attrName = (it->second).attrName;
-    string parentName = (it->second).parentName;
+    // Hot path: no per event lookup, copy or trace
+    UpnpStateVariable *stateVar = static_cast<UpnpStateVariable *> (userData);
+    UpnpService *pService = static_cast<UpnpService *> (stateVar->resource);
 
     // Check if the value needs customized conversion (specific
     // to a particular service obect)
-    if (pService->processNotification(attrName, parentName, value))
+    if (pService->processNotification(stateVar->attrName, stateVar->parentName, value))
     {
         return;
     }
 
-    GType type = (it->second).type;
-    if (parentName == "")
+    if (!stateVar->isConvertible())
     {
-        if (type == G_TYPE_BOOLEAN)
-        {
-            bool vbool = g_value_get_boolean(value);
-            DEBUG_PRINT("set " << attrName << " to " << vbool);
-            pService->BundleResource::setAttribute(attrName, vbool);
-        }
-        else if (type == G_TYPE_UINT)
-        {
-            DEBUG_PRINT("set " << attrName << " to " << g_value_get_uint(value));
-            pService->BundleResource::setAttribute(attrName, (int) (g_value_get_uint(value)));
-        }
-        else if (type == G_TYPE_INT)
-        {
-            DEBUG_PRINT("set " << attrName << " to " << g_value_get_int(value));
-            pService->BundleResource::setAttribute(attrName, (int) (g_value_get_int(value)));
-        }
-        else if (type == G_TYPE_STRING)
-        {
-            DEBUG_PRINT("set " << attrName << " to " << g_value_get_string(value));
-            pService->BundleResource::setAttribute(attrName, string(g_value_get_string(value)));
-        }
-        else
-        {
-            //TODO this should probably throw and error.
-            ERROR_PRINT("Type handling not implemented: " << g_type_name(type));
-        }
+        //TODO this should probably throw and error.
+        ERROR_PRINT("Type handling not implemented: " << g_type_name(stateVar->type));
+        return;
     }
-    else
-    {
-        RCSResourceAttributes::Value attrValue = pService->BundleResource::getAttribute(parentName);
-        RCSResourceAttributes composite = attrValue.get < RCSResourceAttributes > ();
 
-        if (type == G_TYPE_BOOLEAN)
-        {
-            bool vbool = g_value_get_boolean(value);
-            DEBUG_PRINT("set composite: " << parentName <<  "->" << attrName << " to " << vbool);
-            composite[attrName] = vbool;
-        }
-        else if (type == G_TYPE_UINT)
-        {
-            DEBUG_PRINT("set composite: " << parentName <<  "->" << attrName << " to " << g_value_get_uint(
-                            value));
-            composite[attrName] = (int) (g_value_get_uint(value));
-        }
-        else if (type == G_TYPE_INT)
-        {
-            DEBUG_PRINT("set composite: " << parentName <<  "->" << attrName << " to " << g_value_get_int(
-                            value));
-            composite[attrName] = (int) (g_value_get_int(value));
-        }
-        else if (type == G_TYPE_STRING)
-        {
-            DEBUG_PRINT("set composite: " << parentName <<  "->" << attrName << " to " << g_value_get_string(
-                            value));
-            composite[attrName] = string(g_value_get_string(value));
-        }
-        else
-        {
-            //TODO this should probably throw and error.
-            ERROR_PRINT("Type handling not implemented: " << g_type_name(type));
-            return;
-        }
-
-        pService->BundleResource::setAttribute(parentName, composite);
-    }
+    stateVar->apply(value);
 }
 
 // TODO: This should probably live in some UpnpUtil class
@@ -499,36 +777,36 @@ void UpnpService::initCompositeAttribute(RCSResourceAttributes composite,
 void UpnpService::initAttributes()
 {
 
-    BundleResource::setAttribute("name", m_name,
-                                 false); // need to keep name with attributes (OCRepresentation bug)
-    BundleResource::setAttribute("uri", m_uri,
-                                 false);   // need to keep uri with attributes (OCRepresentation bug)
-    BundleResource::setAttribute("if", m_interface, false);
+    setAttribute("name", m_name,
+                 false); // need to keep name with attributes (OCRepresentation bug)
+    setAttribute("uri", m_uri,
+                 false);   // need to keep uri with attributes (OCRepresentation bug)
+    setAttribute("if", m_interface, false);
 
     for (auto attr : m_attributeMap)
     {
         if (attr.second.first->type == G_TYPE_BOOLEAN)
         {
-            BundleResource::setAttribute(attr.second.first->name, false);
+            setAttribute(attr.second.first->name, false);
         }
         else if ((attr.second.first->type == G_TYPE_UINT) || (attr.second.first->type == G_TYPE_INT))
         {
-            BundleResource::setAttribute(attr.second.first->name, 0);
+            setAttribute(attr.second.first->name, 0);
         }
         else if ((attr.second.first->type == G_TYPE_UINT64) || (attr.second.first->type == G_TYPE_INT64))
         {
-            BundleResource::setAttribute(attr.second.first->name, (double) 0);
+            setAttribute(attr.second.first->name, (double) 0);
         }
         else if (attr.second.first->type == G_TYPE_STRING)
         {
-            BundleResource::setAttribute(attr.second.first->name, "");
+            setAttribute(attr.second.first->name, "");
         }
         else if (!attr.second.first->attrs.empty()) // composite attribute
         {
             RCSResourceAttributes composite;
 
             initCompositeAttribute(composite, attr.second.first->attrs);
-            BundleResource::setAttribute(attr.second.first->name, composite);
+            setAttribute(attr.second.first->name, composite);
         }
         else
         {
@@ -538,7 +816,7 @@ void UpnpService::initAttributes()
 
 }
 
-bool UpnpService::processNotification(string attrName, string parent, GValue *value)
+bool UpnpService::processNotification(const string &attrName, const string &parent, GValue *value)
 {
     // Default: no custom variable->attribute conversion
     return false;
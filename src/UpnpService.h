@@ -27,6 +27,7 @@
 #include "UpnpInternal.h"
 #include "UpnpRequest.h"
 #include "UpnpResource.h"
+#include "UpnpStateVariable.h"
 
 using namespace std;
 using namespace OIC::Service;
@@ -46,6 +47,25 @@ class UpnpService: public UpnpResource
 
         virtual RCSResourceAttributes handleGetAttributesRequest(const map< string, string > &queryParams);
 
+        // Non-blocking variant of handleSetAttributesRequest: the value and
+        // query parameters must outlive the request, which is completed
+        // and released with endRequest. The actions are not started before
+        // startAt (monotonic time, us) if set.
+        UpnpRequest *beginSetAttributesRequest(const RCSResourceAttributes &value,
+                                               const map< string, string > &queryParams,
+                                               gint64 startAt = 0);
+        static bool endRequest(UpnpRequest *request);
+
+        // Non-blocking GET of some attributes (observe refresh, runs on the
+        // gupnp thread): the finish handler is called once done, possibly
+        // before returning, and releases the request. The attributes must
+        // outlive the request.
+        void beginRefresh(const set< string > *attributes, UpnpRequest::FinishHandler handler, void *data);
+
+        // Attributes with a GET action and no state variable events, once
+        // introspected
+        set< string > getUneventedAttributes();
+
         void setProxy(GUPnPServiceProxy *proxy);
         GUPnPServiceProxy *getProxy();
 
@@ -59,11 +79,16 @@ class UpnpService: public UpnpResource
                                           UpnpRequest *request,
                                           const map< string, string > &queryParams) = 0;
 
-        virtual bool processNotification(string attrName, string parent, GValue *value);
+        virtual bool processNotification(const string &attrName, const string &parent, GValue *value);
 
         string getId();
 
-        void stop();
+        // False until processIntrospection has run (lazy introspection
+        // defers it to the first request on the resource)
+        bool isIntrospected();
+        void setIntrospected(bool introspected);
+
+        virtual void stop();
 
     protected:
         // Map of associated attributes (OIC)
@@ -78,20 +103,48 @@ class UpnpService: public UpnpResource
 
         virtual void initAttributes();
 
+        void queueRequest(UpnpRequest *request);
+        bool deferRequest(UpnpRequest *request);
+
+        // GET loops: whether the attribute is to be fetched for the request
+        bool isGetRequested(UpnpRequest *request, const string &attrName);
+
+        // Runs on the gupnp thread when the deadline of a request started
+        // on the service has passed: drops the request from wherever it is
+        // parked and cancels its actions. Returns the number of completions
+        // (requestDone) the request will not get.
+        virtual int cancelRequest(UpnpRequest *request);
+
     private:
 
         string m_serviceId;
 
-        typedef struct _StateVarAttr
-        {
-            string attrName;
-            GType type;
-            string parentName;
-        } StateVarAttr;
+        bool m_introspected;
+        GCancellable *m_introspectionCancellable;
+
+        // Requests waiting for the deferred introspection to complete
+        vector <UpnpRequest *> m_pendingRequests;
+
+        // Requests waiting for their start time
+        map <UpnpRequest *, GSource *> m_delayedRequests;
+
+        static bool startGetRequest(UpnpRequest *request);
+        static bool startSetRequest(UpnpRequest *request);
+        bool delayRequest(UpnpRequest *request, gint64 now);
+        static gboolean onStartTime(gpointer userData);
+
+        gint64 getDeadline(const map< string, string > &queryParams);
+        bool armDeadline(UpnpRequest *request);
+        static gboolean onDeadline(gpointer userData);
+
+        static void onIntrospectionAvailable(GUPnPServiceInfo *info,
+                                             GUPnPServiceIntrospection *introspection,
+                                             const GError *error,
+                                             gpointer userData);
 
         // Mapping of UPnP state variables that are observed/notified to
-        // corresponding OCF attributes
-        map <string, StateVarAttr> m_stateVarMap;
+        // corresponding OCF attributes (nodes are the notify user data)
+        map <string, UpnpStateVariable> m_stateVarMap;
 
         void initCompositeAttribute(RCSResourceAttributes composite, vector<EmbeddedAttribute> attrs);
 
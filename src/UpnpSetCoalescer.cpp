@@ -0,0 +1,142 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "UpnpSetCoalescer.h"
+#include "UpnpActionStats.h"
+#include "UpnpInternal.h"
+#include "UpnpService.h"
+
+using namespace std;
+
+static const string MODULE = "UpnpSetCoalescer";
+
+UpnpSetCoalescer::UpnpSetCoalescer(UpnpService *service, Sender sender) :
+    m_service(service),
+    m_sender(sender),
+    m_inFlight(nullptr),
+    m_pending(false),
+    m_coalesced(0)
+{
+}
+
+UpnpSetCoalescer::~UpnpSetCoalescer()
+{
+    stop();
+}
+
+bool UpnpSetCoalescer::write(UpnpRequest *request, const RCSResourceAttributes::Value &value)
+{
+    if (m_pending)
+    {
+        DEBUG_PRINT("uri: " << m_service->m_uri << ", replacing pending value");
+        m_coalesced++;
+    }
+
+    m_pendingValue = value;
+    m_pending = true;
+    m_pendingWaiters.push_back(request);
+
+    if (m_inFlight != nullptr || send())
+    {
+        return true;
+    }
+
+    // Nothing was in flight: the request is the only one waiting
+    m_pendingWaiters.clear();
+    return false;
+}
+
+bool UpnpSetCoalescer::send()
+{
+    UpnpRequest *carrier = UpnpRequest::acquire();
+    carrier->finishHandler = onFinish;
+    carrier->expected = 1;
+    carrier->resource = m_service;
+    carrier->data = this;
+
+    m_pending = false;
+    if (!m_sender(carrier, &m_pendingValue))
+    {
+        ERROR_PRINT("uri: " << m_service->m_uri << ", failed to send SET");
+        UpnpRequest::release(carrier);
+        return false;
+    }
+
+    m_inFlight = carrier;
+    m_inFlightWaiters.swap(m_pendingWaiters);
+    return true;
+}
+
+void UpnpSetCoalescer::complete(vector< UpnpRequest * > &waiters, bool status)
+{
+    for (auto request : waiters)
+    {
+        UpnpRequest::requestDone(request, status);
+    }
+    // Keeps the capacity for the next SETs
+    waiters.clear();
+}
+
+void UpnpSetCoalescer::onFinish(UpnpRequest *carrier, bool status)
+{
+    UpnpSetCoalescer *coalescer = static_cast< UpnpSetCoalescer * >(carrier->data);
+
+    coalescer->m_inFlight = nullptr;
+    UpnpRequest::release(carrier);
+
+    complete(coalescer->m_inFlightWaiters, status);
+
+    if (coalescer->m_pending && !coalescer->send())
+    {
+        complete(coalescer->m_pendingWaiters, false);
+    }
+}
+
+void UpnpSetCoalescer::stop()
+{
+    if (m_inFlight != nullptr)
+    {
+        // The action callback is not invoked once cancelled
+        for (auto it = m_inFlight->proxyMap.begin(); it != m_inFlight->proxyMap.end(); ++it)
+        {
+            UpnpActionStats::cancelAction(m_service->getProxy(), it->first);
+        }
+        UpnpRequest::release(m_inFlight);
+        m_inFlight = nullptr;
+    }
+
+    m_pending = false;
+    complete(m_inFlightWaiters, false);
+    complete(m_pendingWaiters, false);
+}
+
+int UpnpSetCoalescer::cancel(UpnpRequest *request)
+{
+    return remove(m_inFlightWaiters, request) + remove(m_pendingWaiters, request);
+}
+
+int UpnpSetCoalescer::remove(vector< UpnpRequest * > &waiters, UpnpRequest *request)
+{
+    auto it = std::remove(waiters.begin(), waiters.end(), request);
+    int count = waiters.end() - it;
+
+    waiters.erase(it, waiters.end());
+    return count;
+}
@@ -0,0 +1,93 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#ifndef UPNP_SET_COALESCER_H_
+#define UPNP_SET_COALESCER_H_
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+#include <gupnp.h>
+
+#include <RCSResourceAttributes.h>
+
+#include "UpnpRequest.h"
+#include "UpnpResource.h"
+
+class UpnpService;
+
+// Last-write-wins SET of one attribute of one service.
+//
+// While a SET is in flight, the values written replace each other and only
+// the newest one is sent once the device has acknowledged the previous SET.
+// Every SET request written still completes, with the status of the action
+// that carried its value (or a newer one).
+//
+// Not thread safe: to be used from the gupnp thread (request handlers).
+class UpnpSetCoalescer
+{
+    public:
+        // Starts the action for the value, completing the carrier request
+        // from its callback (UpnpRequest::requestDone). Returns false if
+        // the action could not be started.
+        typedef std::function< bool(UpnpRequest *carrier, RCSResourceAttributes::Value *value) > Sender;
+
+        UpnpSetCoalescer(UpnpService *service, Sender sender);
+        ~UpnpSetCoalescer();
+
+        // Counts for one unit of the request (requestDone) once sent, unless
+        // false is returned: the value could not be sent.
+        bool write(UpnpRequest *request, const RCSResourceAttributes::Value &value);
+
+        // Cancels the action in flight and fails the waiting requests
+        void stop();
+
+        // Stops waiting for the request (e.g. past its deadline), returns
+        // the number of completions it will not get. The value written
+        // is still sent.
+        int cancel(UpnpRequest *request);
+
+        // Number of values replaced before being sent
+        uint64_t getCoalesced() { return m_coalesced; }
+
+    private:
+        UpnpService *m_service;
+        Sender m_sender;
+
+        UpnpRequest *m_inFlight;
+        std::vector< UpnpRequest * > m_inFlightWaiters;
+
+        bool m_pending;
+        RCSResourceAttributes::Value m_pendingValue;
+        std::vector< UpnpRequest * > m_pendingWaiters;
+
+        uint64_t m_coalesced;
+
+        bool send();
+        static void complete(std::vector< UpnpRequest * > &waiters, bool status);
+        static int remove(std::vector< UpnpRequest * > &waiters, UpnpRequest *request);
+        static void onFinish(UpnpRequest *carrier, bool status);
+
+        UpnpSetCoalescer(const UpnpSetCoalescer &);
+        UpnpSetCoalescer &operator=(const UpnpSetCoalescer &);
+};
+
+#endif
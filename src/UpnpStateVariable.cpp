@@ -0,0 +1,95 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+
+#include "UpnpStateVariable.h"
+
+using namespace std;
+
+static const string MODULE = "UpnpStateVariable";
+
+static void convertBoolean(const GValue *value, RCSResourceAttributes::Value &attrValue)
+{
+    attrValue = (bool) g_value_get_boolean(value);
+}
+
+static void convertInt(const GValue *value, RCSResourceAttributes::Value &attrValue)
+{
+    attrValue = (int) g_value_get_int(value);
+}
+
+static void convertUint(const GValue *value, RCSResourceAttributes::Value &attrValue)
+{
+    attrValue = (int) g_value_get_uint(value);
+}
+
+static void convertString(const GValue *value, RCSResourceAttributes::Value &attrValue)
+{
+    const gchar *s = g_value_get_string(value);
+    attrValue = string(s != NULL ? s : "");
+}
+
+UpnpStateVariable::UpnpStateVariable() :
+    resource(nullptr),
+    type(G_TYPE_NONE),
+    m_convert(nullptr)
+{
+}
+
+UpnpStateVariable::UpnpStateVariable(UpnpResource *resource, const string &attrName,
+                                     const string &parentName, GType type) :
+    resource(resource),
+    attrName(attrName),
+    parentName(parentName),
+    type(type),
+    m_convert(getConverter(type))
+{
+}
+
+UpnpStateVariable::Converter UpnpStateVariable::getConverter(GType type)
+{
+    switch (type)
+    {
+        case G_TYPE_BOOLEAN:
+            return convertBoolean;
+        case G_TYPE_INT:
+            return convertInt;
+        case G_TYPE_UINT:
+            return convertUint;
+        case G_TYPE_STRING:
+            return convertString;
+        default:
+            return nullptr;
+    }
+}
+
+void UpnpStateVariable::apply(const GValue *value)
+{
+    RCSResourceAttributes::Value attrValue;
+
+    m_convert(value, attrValue);
+    if (parentName.empty())
+    {
+        resource->setAttribute(attrName, std::move(attrValue));
+        return;
+    }
+
+    resource->setCompositeMember(parentName, attrName, std::move(attrValue));
+}
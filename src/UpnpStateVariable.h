@@ -0,0 +1,67 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+
+#ifndef UPNP_STATE_VARIABLE_H_
+#define UPNP_STATE_VARIABLE_H_
+
+#include <string>
+
+#include <glib-object.h>
+
+#include <RCSResourceAttributes.h>
+
+#include "UpnpResource.h"
+
+// An evented UPnP state variable and the OCF attribute (or the member of
+// a composite attribute) it is notified as.
+//
+// The conversion of its GValue is resolved once, when subscribing, and
+// the variable itself is given as user data of the notify callback: an
+// event is applied without lookup or type dispatch (see
+// UpnpService::onStateChanged).
+class UpnpStateVariable
+{
+    public:
+        typedef void (*Converter)(const GValue *value, RCSResourceAttributes::Value &attrValue);
+
+        UpnpStateVariable();
+        UpnpStateVariable(UpnpResource *resource, const std::string &attrName,
+                          const std::string &parentName, GType type);
+
+        // Null if values of the type cannot be converted
+        static Converter getConverter(GType type);
+
+        bool isConvertible() { return m_convert != nullptr; }
+
+        // Sets the attribute (in place, if a composite member) to the
+        // converted value, notifying the observers
+        void apply(const GValue *value);
+
+        UpnpResource *resource;
+        std::string attrName;
+        std::string parentName;
+        GType type;
+
+    private:
+        Converter m_convert;
+};
+
+#endif
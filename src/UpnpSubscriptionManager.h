@@ -0,0 +1,91 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+
+#ifndef UPNP_SUBSCRIPTION_MANAGER_H_
+#define UPNP_SUBSCRIPTION_MANAGER_H_
+
+#include <map>
+
+#include <glib.h>
+#include <gupnp.h>
+
+// GENA subscriptions of the services handled by one GLib main context,
+// driven by the number of observers of each service.
+//
+// A service is subscribed once it gets its first observer and unsubscribed
+// a grace period after its last observer leaves. Subscriptions are spread
+// over a jitter window: gupnp renews a subscription relative to the time it
+// was made, so services discovered together would otherwise renew together.
+// Lost subscriptions (failed renewals) are retried the same way. All the
+// pending (un)subscriptions share a single timer.
+//
+// Renewals are not driven by that timer: gupnp arms a timeout per
+// subscription from the duration the device granted, and exposes no way
+// to renew a SID or to turn its own renewal off (resubscribing instead
+// would get a new SID and the initial event again). The jitter of the
+// initial SUBSCRIBE is the only control over when renewals happen: they
+// stay spread as long as the devices grant the same duration, and
+// services with different durations may still renew together at times.
+//
+// Not thread safe: to be used from the thread running the main context.
+class UpnpSubscriptionManager
+{
+    public:
+        // Window (ms) over which new subscriptions are spread
+        static const guint SUBSCRIBE_JITTER = 5000;
+        // Delay (ms) before unsubscribing once the last observer is gone
+        static const guint UNSUBSCRIBE_GRACE = 30000;
+        // Delay (ms) before resubscribing after a subscription was lost
+        static const guint RESUBSCRIBE_DELAY = 10000;
+
+        UpnpSubscriptionManager(GMainContext *context);
+        ~UpnpSubscriptionManager();
+
+        void addObserver(GUPnPServiceProxy *proxy);
+        void removeObserver(GUPnPServiceProxy *proxy);
+        unsigned int getObservers(GUPnPServiceProxy *proxy);
+
+        // Unsubscribes now and forgets the proxy (service going away)
+        void remove(GUPnPServiceProxy *proxy);
+
+    private:
+        typedef struct _Subscription
+        {
+            unsigned int observers;
+            gint64 due;             // next (un)subscription, 0 if none
+            gulong lostHandler;
+        } Subscription;
+
+        GMainContext *m_context;
+        GSource *m_timer;
+        gint64 m_timerDue;
+        std::map <GUPnPServiceProxy *, Subscription> m_subscriptions;
+
+        Subscription &find(GUPnPServiceProxy *proxy);
+        void schedule(Subscription &subscription, guint delay);
+        void rearm();
+        void stopTimer();
+
+        static gboolean onTimer(gpointer userData);
+        static void onSubscriptionLost(GUPnPServiceProxy *proxy, const GError *error, gpointer userData);
+};
+
+#endif
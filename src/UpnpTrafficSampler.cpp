@@ -0,0 +1,151 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include <cassert>
+
+#include "UpnpTrafficSampler.h"
+
+const double UpnpTrafficSampler::DEFAULT_MAX_BYTE_RATE = 1.25e9;
+const double UpnpTrafficSampler::DEFAULT_MAX_PACKET_RATE = 1.488e7;
+
+UpnpTrafficSampler::UpnpTrafficSampler(size_t capacity)
+{
+    assert(capacity > 0);
+    m_samples.resize(capacity);
+    m_maxRate[BYTES_SENT] = DEFAULT_MAX_BYTE_RATE;
+    m_maxRate[BYTES_RECEIVED] = DEFAULT_MAX_BYTE_RATE;
+    m_maxRate[PACKETS_SENT] = DEFAULT_MAX_PACKET_RATE;
+    m_maxRate[PACKETS_RECEIVED] = DEFAULT_MAX_PACKET_RATE;
+    reset();
+}
+
+void UpnpTrafficSampler::setMaxRate(Counter counter, double maxRate)
+{
+    m_maxRate[counter] = maxRate;
+}
+
+void UpnpTrafficSampler::reset()
+{
+    m_head = 0;
+    m_count = 0;
+    m_lastMonotonicUs = 0;
+    for (int i = 0; i < NUM_COUNTERS; ++i)
+    {
+        m_lastRaw[i] = 0;
+    }
+}
+
+void UpnpTrafficSampler::addSample(int64_t monotonicUs,
+                                   double timestamp,
+                                   const uint32_t raw[NUM_COUNTERS])
+{
+    Sample sample;
+    sample.timestamp = timestamp;
+
+    if (m_count == 0)
+    {
+        for (int i = 0; i < NUM_COUNTERS; ++i)
+        {
+            sample.total[i] = raw[i];
+            sample.rate[i] = 0;
+            sample.rateValid[i] = false;
+        }
+    }
+    else
+    {
+        const Sample &previous = latest();
+        double elapsed = (double) (monotonicUs - m_lastMonotonicUs) / 1000000;
+
+        for (int i = 0; i < NUM_COUNTERS; ++i)
+        {
+            // Unsigned subtraction takes care of the 32-bit wraparound
+            uint32_t delta = raw[i] - m_lastRaw[i];
+            double rate = (elapsed > 0) ? (delta / elapsed) : 0;
+
+            if ((raw[i] < m_lastRaw[i]) && ((elapsed <= 0) || (rate > m_maxRate[i])))
+            {
+                // Reset: counting again from 0, the traffic since the
+                // previous sample is unknown
+                sample.total[i] = previous.total[i] + raw[i];
+                sample.rate[i] = 0;
+                sample.rateValid[i] = false;
+            }
+            else
+            {
+                sample.total[i] = previous.total[i] + delta;
+                sample.rate[i] = rate;
+                sample.rateValid[i] = (elapsed > 0);
+            }
+        }
+    }
+
+    for (int i = 0; i < NUM_COUNTERS; ++i)
+    {
+        m_lastRaw[i] = raw[i];
+    }
+    m_lastMonotonicUs = monotonicUs;
+
+    // Overwrite the oldest sample once the buffer is full
+    m_samples[m_head] = sample;
+    m_head = (m_head + 1) % m_samples.size();
+    if (m_count < m_samples.size())
+    {
+        m_count++;
+    }
+}
+
+bool UpnpTrafficSampler::empty() const
+{
+    return m_count == 0;
+}
+
+size_t UpnpTrafficSampler::size() const
+{
+    return m_count;
+}
+
+size_t UpnpTrafficSampler::capacity() const
+{
+    return m_samples.size();
+}
+
+const UpnpTrafficSampler::Sample &UpnpTrafficSampler::latest() const
+{
+    assert(m_count > 0);
+    return m_samples[(m_head + m_samples.size() - 1) % m_samples.size()];
+}
+
+int64_t UpnpTrafficSampler::latestTime() const
+{
+    return m_lastMonotonicUs;
+}
+
+std::vector<UpnpTrafficSampler::Sample> UpnpTrafficSampler::history() const
+{
+    std::vector<Sample> samples;
+    size_t first = (m_head + m_samples.size() - m_count) % m_samples.size();
+
+    samples.reserve(m_count);
+    for (size_t i = 0; i < m_count; ++i)
+    {
+        samples.push_back(m_samples[(first + i) % m_samples.size()]);
+    }
+    return samples;
+}
@@ -0,0 +1,101 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#ifndef UPNP_TRAFFIC_SAMPLER_H_
+#define UPNP_TRAFFIC_SAMPLER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Accumulates samples of the 32-bit WAN traffic counters
+// (TotalBytesSent/Received, TotalPacketsSent/Received) into 64-bit
+// totals and per-second rates, keeping the last N samples in a ring buffer.
+//
+// Counter wraparound is handled with modular arithmetic, i.e. at most one
+// wrap per counter between two consecutive samples is assumed. A counter
+// going down is taken for a wrap only if the traffic it implies is possible
+// (within the maximum rate of the counter); otherwise the counter was reset
+// (e.g. the device rebooted): the totals go on from its new value, and that
+// interval has no rate.
+class UpnpTrafficSampler
+{
+    public:
+        typedef enum
+        {
+            BYTES_SENT = 0,
+            BYTES_RECEIVED,
+            PACKETS_SENT,
+            PACKETS_RECEIVED,
+            NUM_COUNTERS
+        } Counter;
+
+        typedef struct _Sample
+        {
+            // Wall clock time of the sample (seconds since epoch)
+            double timestamp;
+            uint64_t total[NUM_COUNTERS];
+            // Per-second rate since the previous sample (0 if not rateValid:
+            // first sample, or counter reset)
+            double rate[NUM_COUNTERS];
+            bool rateValid[NUM_COUNTERS];
+        } Sample;
+
+        // Default maximum rates (per second): 10 Gbit/s, of minimum size
+        // Ethernet frames for the packets
+        static const double DEFAULT_MAX_BYTE_RATE;
+        static const double DEFAULT_MAX_PACKET_RATE;
+
+        UpnpTrafficSampler(size_t capacity);
+
+        // Above maxRate (per second), a counter going down was reset
+        void setMaxRate(Counter counter, double maxRate);
+
+        // monotonicUs: monotonic clock (for rate computation)
+        // timestamp: wall clock time reported with the sample
+        // raw: raw 32-bit counter values, indexed by Counter
+        void addSample(int64_t monotonicUs, double timestamp, const uint32_t raw[NUM_COUNTERS]);
+
+        void reset();
+
+        bool empty() const;
+        size_t size() const;
+        size_t capacity() const;
+
+        // Most recent sample, valid only if the history is not empty
+        const Sample &latest() const;
+
+        // Monotonic time (us) of the most recent sample
+        int64_t latestTime() const;
+
+        // Samples ordered from the oldest to the most recent
+        std::vector<Sample> history() const;
+
+    private:
+        std::vector<Sample> m_samples;
+        size_t m_head;
+        size_t m_count;
+
+        uint32_t m_lastRaw[NUM_COUNTERS];
+        int64_t m_lastMonotonicUs;
+        double m_maxRate[NUM_COUNTERS];
+};
+
+#endif
@@ -19,6 +19,7 @@
 //-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
 
 #include "UpnpWanCableLinkConfigService.h"
+#include "UpnpActionStats.h"
 
 using namespace OIC::Service;
 
@@ -117,16 +118,16 @@ void UpnpWanCableLinkConfig::getLinkInfoCb(GUPnPServiceProxy *proxy,
 
     UpnpRequest *request = static_cast<UpnpRequest *> (userData);
 
-    bool status = gupnp_service_proxy_end_action (proxy,
-                                                  actionProxy,
-                                                  &error,
-                                                  "NewCableLinkConfigState",
-                                                  G_TYPE_STRING,
-                                                  &linkState,
-                                                  "NewLinkType",
-                                                  G_TYPE_STRING,
-                                                  &linkType,
-                                                  NULL);
+    bool status = UpnpActionStats::endAction (proxy,
+                                              actionProxy,
+                                              &error,
+                                              "NewCableLinkConfigState",
+                                              G_TYPE_STRING,
+                                              &linkState,
+                                              "NewLinkType",
+                                              G_TYPE_STRING,
+                                              &linkType,
+                                              NULL);
     if (error)
     {
         ERROR_PRINT("GetCableLinkConfigInfo failed: " << error->code << ", " << error->message);
@@ -154,11 +155,11 @@ bool UpnpWanCableLinkConfig::getLinkInfo(UpnpRequest *request)
 {
     DEBUG_PRINT("");
     GUPnPServiceProxyAction *actionProxy =
-        gupnp_service_proxy_begin_action (m_proxy,
-                                          "GetCableLinkConfigInfo",
-                                          getLinkInfoCb,
-                                          (gpointer *) request,
-                                          NULL);
+        UpnpActionStats::beginAction (m_proxy,
+                                      "GetCableLinkConfigInfo",
+                                      getLinkInfoCb,
+                                      (gpointer *) request,
+                                      NULL);
     if (NULL == actionProxy)
     {
         return false;
@@ -179,7 +180,7 @@ bool UpnpWanCableLinkConfig::getAttributesRequest(UpnpRequest *request,
 
         DEBUG_PRINT(" \"" << it->first << "\"");
         // Check the request
-        if (!UpnpAttribute::isValidRequest(&m_attributeMap, it->first, UPNP_ACTION_GET))
+        if (!isGetRequested(request, it->first))
         {
             request->done++;
             continue;
@@ -18,7 +18,10 @@
 //
 //-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
 
+#include <algorithm>
+
 #include "UpnpWanCommonInterfaceConfigService.h"
+#include "UpnpActionStats.h"
 
 using namespace OIC::Service;
 
@@ -109,9 +112,39 @@ vector <UpnpAttributeInfo> UpnpWanCommonInterfaceConfig::Attributes =
         {   {"deviceContainer", "ActiveConnectionDeviceContainer", G_TYPE_STRING, false},
             {"serviceId",       "ActiveConnectionServiceID", G_TYPE_STRING, false}
         }
+    },
+    //Special case: no matching UPnP action, the value is maintained by
+    //the background sampler of the traffic counters.
+    //"trafficHistory" is a sequence of samples with tags:
+    //    "timestamp", "bytesSent", "bytesReceived", "packetsSent", "packetsReceived"
+    //    (64-bit totals) and "bytesSentRate", "bytesReceivedRate", "packetsSentRate",
+    //    "packetsReceivedRate" (per second)
+    {
+        "trafficHistory",
+        "", G_TYPE_NONE, false,
+        {{"", UPNP_ACTION_GET, "", G_TYPE_NONE}},
+        {}
+    },
+    //Special case: traffic sampling period in seconds (0 disables sampling)
+    {
+        "trafficSamplePeriod",
+        "", G_TYPE_UINT, false,
+        {   {"", UPNP_ACTION_GET, "", G_TYPE_NONE},
+            {"", UPNP_ACTION_POST, "", G_TYPE_NONE}
+        },
+        {}
     }
 };
 
+// Attributes backed by the traffic sampler, indexed by UpnpTrafficSampler::Counter
+static const char *TrafficCounterAttrs[UpnpTrafficSampler::NUM_COUNTERS] =
+{
+    "bytesSent",
+    "bytesReceived",
+    "packetsSent",
+    "packetsReceived"
+};
+
 // Custom action map:
 // "attribute name" -> GET request handlers
 map <const string, UpnpWanCommonInterfaceConfig::GetAttributeHandler>
@@ -121,6 +154,220 @@ UpnpWanCommonInterfaceConfig::GetAttributeActionMap =
     {"connectionInfo", &UpnpWanCommonInterfaceConfig::getConnectionInfo}
 };
 
+UpnpWanCommonInterfaceConfig::~UpnpWanCommonInterfaceConfig()
+{
+    stopTrafficSampling();
+}
+
+void UpnpWanCommonInterfaceConfig::processIntrospection(GUPnPServiceProxy *proxy,
+                                                        GUPnPServiceIntrospection *introspection)
+{
+    UpnpService::processIntrospection(proxy, introspection);
+
+    if (!isTrafficSamplingSupported())
+    {
+        DEBUG_PRINT("traffic counters not supported by " << m_uri);
+        return;
+    }
+
+    m_attributeMap["trafficHistory"] =
+    {UpnpAttribute::getAttributeInfo(&Attributes, "trafficHistory"), UPNP_ACTION_GET};
+    m_attributeMap["trafficSamplePeriod"] =
+    {UpnpAttribute::getAttributeInfo(&Attributes, "trafficSamplePeriod"), UPNP_ACTION_GET | UPNP_ACTION_POST};
+
+    setAttribute("trafficHistory", CompositeAttribute(), false);
+    setAttribute("trafficSamplePeriod", (int) m_samplePeriod, false);
+
+    // The service proxy is set only after the introspection is processed
+    m_proxy = proxy;
+    startTrafficSampling();
+}
+
+bool UpnpWanCommonInterfaceConfig::isTrafficSamplingSupported()
+{
+    for (int i = 0; i < UpnpTrafficSampler::NUM_COUNTERS; ++i)
+    {
+        if (!UpnpAttribute::isValidRequest(&m_attributeMap, TrafficCounterAttrs[i], UPNP_ACTION_GET))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool UpnpWanCommonInterfaceConfig::isTrafficSampleFresh()
+{
+    if ((m_sampleSource == NULL) || m_trafficSampler.empty())
+    {
+        return false;
+    }
+
+    // Allow for one missed (or slow) sampling round
+    gint64 age = g_get_monotonic_time() - m_trafficSampler.latestTime();
+    return age < (gint64) (2 * m_samplePeriod) * G_USEC_PER_SEC;
+}
+
+void UpnpWanCommonInterfaceConfig::startTrafficSampling()
+{
+    stopTrafficSampling();
+
+    if (m_samplePeriod == 0)
+    {
+        DEBUG_PRINT("traffic sampling disabled for " << m_uri);
+        return;
+    }
+
+    DEBUG_PRINT("sampling every " << m_samplePeriod << "s for " << m_uri);
+
+    // Samples taken with a different period (or after a pause) are
+    // not comparable, start from scratch
+    m_trafficSampler.reset();
+
+    m_sampleSource = g_timeout_source_new_seconds(m_samplePeriod);
+    g_source_set_callback(m_sampleSource, onSampleTimeout, this, NULL);
+    g_source_attach(m_sampleSource, m_requestState->context);
+
+    // Take the first sample right away
+    sampleTrafficCounters();
+}
+
+void UpnpWanCommonInterfaceConfig::stopTrafficSampling()
+{
+    if (m_sampleSource != NULL)
+    {
+        g_source_destroy(m_sampleSource);
+        g_source_unref(m_sampleSource);
+        m_sampleSource = NULL;
+    }
+
+    for (auto it = m_sampleActions.begin(); it != m_sampleActions.end(); ++it)
+    {
+        UpnpActionStats::cancelAction(m_proxy, it->first);
+    }
+    m_sampleActions.clear();
+    m_sampleFailed = false;
+}
+
+gboolean UpnpWanCommonInterfaceConfig::onSampleTimeout(gpointer userData)
+{
+    UpnpWanCommonInterfaceConfig *pService = static_cast<UpnpWanCommonInterfaceConfig *> (userData);
+
+    pService->sampleTrafficCounters();
+    return G_SOURCE_CONTINUE;
+}
+
+void UpnpWanCommonInterfaceConfig::sampleTrafficCounters()
+{
+    if (!m_sampleActions.empty())
+    {
+        DEBUG_PRINT("previous sample still pending for " << m_uri);
+        return;
+    }
+
+    // Issue all the four actions back to back, the sample is
+    // complete when the last of the responses arrives
+    for (int i = 0; i < UpnpTrafficSampler::NUM_COUNTERS; ++i)
+    {
+        UpnpAttributeInfo *attrInfo = m_attributeMap[TrafficCounterAttrs[i]].first;
+        GUPnPServiceProxyAction *actionProxy = UpnpActionStats::beginAction (m_proxy,
+                                               attrInfo->actions[0].name,
+                                               sampleTrafficCountersCb,
+                                               (gpointer *) this,
+                                               NULL);
+        if (NULL == actionProxy)
+        {
+            ERROR_PRINT("Failed to sample " << attrInfo->actions[0].name);
+            m_sampleFailed = true;
+            continue;
+        }
+        m_sampleActions[actionProxy] = i;
+    }
+
+    if (m_sampleActions.empty())
+    {
+        m_sampleFailed = false;
+    }
+}
+
+void UpnpWanCommonInterfaceConfig::sampleTrafficCountersCb(GUPnPServiceProxy *proxy,
+                                                           GUPnPServiceProxyAction *actionProxy,
+                                                           gpointer userData)
+{
+    GError *error = NULL;
+    guint value = 0;
+    UpnpWanCommonInterfaceConfig *pService = static_cast<UpnpWanCommonInterfaceConfig *> (userData);
+
+    std::map< GUPnPServiceProxyAction *, int >::iterator it = pService->m_sampleActions.find(actionProxy);
+    assert(it != pService->m_sampleActions.end());
+
+    int counter = it->second;
+    UpnpAttributeInfo *attrInfo = pService->m_attributeMap[TrafficCounterAttrs[counter]].first;
+
+    bool status = UpnpActionStats::endAction (proxy,
+                                              actionProxy,
+                                              &error,
+                                              attrInfo->actions[0].varName,
+                                              G_TYPE_UINT,
+                                              &value,
+                                              NULL);
+    if (error)
+    {
+        ERROR_PRINT("\"" << attrInfo->actions[0].name << "\" action failed: " << error->code << ", " <<
+                    error->message);
+        g_error_free (error);
+        status = false;
+    }
+
+    pService->m_sampleRaw[counter] = value;
+    pService->m_sampleFailed |= !status;
+    pService->m_sampleActions.erase(it);
+
+    if (!pService->m_sampleActions.empty())
+    {
+        // More counters are pending
+        return;
+    }
+
+    // Partial samples would skew the rates: drop them
+    if (!pService->m_sampleFailed)
+    {
+        pService->m_trafficSampler.addSample(g_get_monotonic_time(),
+                                             (double) g_get_real_time() / G_USEC_PER_SEC,
+                                             pService->m_sampleRaw);
+        pService->updateTrafficAttributes();
+    }
+    pService->m_sampleFailed = false;
+}
+
+void UpnpWanCommonInterfaceConfig::updateTrafficAttributes()
+{
+    CompositeAttribute history;
+
+    for (int i = 0; i < UpnpTrafficSampler::NUM_COUNTERS; ++i)
+    {
+        setAttribute(TrafficCounterAttrs[i], (int) m_sampleRaw[i], false);
+    }
+
+    for (auto &sample : m_trafficSampler.history())
+    {
+        RCSResourceAttributes entry;
+
+        entry["timestamp"] = sample.timestamp;
+        for (int i = 0; i < UpnpTrafficSampler::NUM_COUNTERS; ++i)
+        {
+            entry[TrafficCounterAttrs[i]] = (double) sample.total[i];
+            if (sample.rateValid[i])
+            {
+                entry[string(TrafficCounterAttrs[i]) + "Rate"] = sample.rate[i];
+            }
+        }
+        history.push_back(entry);
+    }
+
+    DEBUG_PRINT(m_uri << ": " << history.size() << " samples");
+    setAttribute("trafficHistory", history, false);
+}
+
 void UpnpWanCommonInterfaceConfig::getLinkPropertiesCb(GUPnPServiceProxy *proxy,
                                                        GUPnPServiceProxyAction *actionProxy,
                                                        gpointer userData)
@@ -133,22 +380,22 @@ void UpnpWanCommonInterfaceConfig::getLinkPropertiesCb(GUPnPServiceProxy *proxy,
 
     UpnpRequest *request = static_cast<UpnpRequest *> (userData);
 
-    bool status = gupnp_service_proxy_end_action (proxy,
-                                                  actionProxy,
-                                                  &error,
-                                                  "NewWANAccessType",
-                                                  G_TYPE_STRING,
-                                                  &accessType,
-                                                  "NewLayer1UpstreamMaxBitRate",
-                                                  G_TYPE_UINT,
-                                                  &upBitrate,
-                                                  "NewLayer1DownstreamMaxBitRate",
-                                                  G_TYPE_UINT,
-                                                  &downBitrate,
-                                                  "NewPhysicalLinkStatus",
-                                                  G_TYPE_STRING,
-                                                  &linkStatus,
-                                                  NULL);
+    bool status = UpnpActionStats::endAction (proxy,
+                                              actionProxy,
+                                              &error,
+                                              "NewWANAccessType",
+                                              G_TYPE_STRING,
+                                              &accessType,
+                                              "NewLayer1UpstreamMaxBitRate",
+                                              G_TYPE_UINT,
+                                              &upBitrate,
+                                              "NewLayer1DownstreamMaxBitRate",
+                                              G_TYPE_UINT,
+                                              &downBitrate,
+                                              "NewPhysicalLinkStatus",
+                                              G_TYPE_STRING,
+                                              &linkStatus,
+                                              NULL);
     if (error)
     {
         ERROR_PRINT("GetCommonLinkProperties failed: " << error->code << ", " << error->message);
@@ -168,6 +415,21 @@ void UpnpWanCommonInterfaceConfig::getLinkPropertiesCb(GUPnPServiceProxy *proxy,
         properties["linkStatus"]     = string(linkStatus);
 
         request->resource->setAttribute("linkProperties", properties, false);
+
+        // Tells the counter resets from the wraps: twice the line rate
+        // leaves room for sampling jitter
+        UpnpWanCommonInterfaceConfig *pService = static_cast<UpnpWanCommonInterfaceConfig *>
+                (request->resource);
+        if (upBitrate > 0)
+        {
+            pService->m_trafficSampler.setMaxRate(UpnpTrafficSampler::BYTES_SENT,
+                                                  2 * (double) upBitrate / 8);
+        }
+        if (downBitrate > 0)
+        {
+            pService->m_trafficSampler.setMaxRate(UpnpTrafficSampler::BYTES_RECEIVED,
+                                                  2 * (double) downBitrate / 8);
+        }
         g_free(accessType);
         g_free(linkStatus);
     }
@@ -178,7 +440,7 @@ void UpnpWanCommonInterfaceConfig::getLinkPropertiesCb(GUPnPServiceProxy *proxy,
 bool UpnpWanCommonInterfaceConfig::getLinkProperties(UpnpRequest *request)
 {
     DEBUG_PRINT("");
-    GUPnPServiceProxyAction *actionProxy = gupnp_service_proxy_begin_action (m_proxy,
+    GUPnPServiceProxyAction *actionProxy = UpnpActionStats::beginAction (m_proxy,
                                            "GetCommonLinkProperties",
                                            getLinkPropertiesCb,
                                            (gpointer *) request,
@@ -204,20 +466,19 @@ void UpnpWanCommonInterfaceConfig::getConnectionInfoCb(GUPnPServiceProxy *proxy,
     UpnpWanCommonInterfaceConfig *pService = static_cast<UpnpWanCommonInterfaceConfig *>
             (request->resource);
 
-    std::map< GUPnPServiceProxyAction *, UpnpAttributeInfo * >::iterator
-        it = request->proxyMap.find(actionProxy);
+    UpnpRequestBindings::iterator it = request->proxyMap.find(actionProxy);
     assert(it != request->proxyMap.end());
 
-    bool status = gupnp_service_proxy_end_action (proxy,
-                                                  actionProxy,
-                                                  &error,
-                                                  "NewActiveConnectionDeviceContainer",
-                                                  G_TYPE_STRING,
-                                                  &deviceContainer,
-                                                  "NewActiveConnectionServiceID",
-                                                  G_TYPE_STRING,
-                                                  &serviceId,
-                                                  NULL);
+    bool status = UpnpActionStats::endAction (proxy,
+                                              actionProxy,
+                                              &error,
+                                              "NewActiveConnectionDeviceContainer",
+                                              G_TYPE_STRING,
+                                              &deviceContainer,
+                                              "NewActiveConnectionServiceID",
+                                              G_TYPE_STRING,
+                                              &serviceId,
+                                              NULL);
     if (error)
     {
         ERROR_PRINT("GetActiveConnectionInfo failed: " << error->code << ", " << error->message);
@@ -279,14 +540,14 @@ bool UpnpWanCommonInterfaceConfig::getConnectionInfo(UpnpRequest *request)
     while (++index < m_numConnections)
     {
         GUPnPServiceProxyAction *actionProxy =
-            gupnp_service_proxy_begin_action (m_proxy,
-                                              "GetActiveConnectionInfo",
-                                              getConnectionInfoCb,
-                                              (gpointer *) request,
-                                              "NewActiveConnectionIndex",
-                                              G_TYPE_UINT,
-                                              (unsigned int)index,
-                                              NULL);
+            UpnpActionStats::beginAction (m_proxy,
+                                          "GetActiveConnectionInfo",
+                                          getConnectionInfoCb,
+                                          (gpointer *) request,
+                                          "NewActiveConnectionIndex",
+                                          G_TYPE_UINT,
+                                          (unsigned int)index,
+                                          NULL);
         status |= (NULL == actionProxy);
 
         if (actionProxy != NULL)
@@ -318,7 +579,17 @@ bool UpnpWanCommonInterfaceConfig::getAttributesRequest(UpnpRequest *request,
 
         DEBUG_PRINT(" \"" << it->first << "\"");
         // Check the request
-        if (!UpnpAttribute::isValidRequest(&m_attributeMap, it->first, UPNP_ACTION_GET))
+        if (!isGetRequested(request, it->first))
+        {
+            request->done++;
+            continue;
+        }
+
+        // Sampler backed attributes are served from the cache
+        if ((it->first == "trafficHistory") || (it->first == "trafficSamplePeriod") ||
+            ((attrInfo->type == G_TYPE_UINT) && isTrafficSampleFresh() &&
+             (std::find(std::begin(TrafficCounterAttrs), std::end(TrafficCounterAttrs), it->first)
+              != std::end(TrafficCounterAttrs))))
         {
             request->done++;
             continue;
@@ -366,6 +637,24 @@ bool UpnpWanCommonInterfaceConfig::setAttributesRequest(const RCSResourceAttribu
         }
         RCSResourceAttributes::Value attrValue = it->value();
 
+        if (attrName == "trafficSamplePeriod")
+        {
+            int period = attrValue.get< int >();
+            if (period >= 0)
+            {
+                m_samplePeriod = (unsigned int) period;
+                setAttribute("trafficSamplePeriod", period, false);
+                startTrafficSampling();
+            }
+            else
+            {
+                ERROR_PRINT("Invalid sampling period " << period);
+            }
+            status |= (period >= 0);
+            request->done++;
+            continue;
+        }
+
         UpnpAttributeInfo *attrInfo = m_attributeMap[attrName].first;
         result = UpnpAttribute::set(m_proxy, request, attrInfo, &attrValue);
         status |= result;
@@ -378,8 +667,8 @@ bool UpnpWanCommonInterfaceConfig::setAttributesRequest(const RCSResourceAttribu
     return status;
 }
 
-bool UpnpWanCommonInterfaceConfig::processNotification(string attrName,
-                                                       string parent,
+bool UpnpWanCommonInterfaceConfig::processNotification(const string &attrName,
+                                                       const string &parent,
                                                        GValue *value)
 {
 
@@ -387,7 +676,7 @@ bool UpnpWanCommonInterfaceConfig::processNotification(string attrName,
     {
         // Need to keep number of active connections around
         m_numConnections = (int) g_value_get_uint(value);
-        BundleResource::setAttribute("numConnections", m_numConnections);
+        setAttribute("numConnections", m_numConnections);
         return true;
     }
 
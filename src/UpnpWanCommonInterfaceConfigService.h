@@ -29,6 +29,7 @@
 #include "UpnpResource.h"
 #include "UpnpInternal.h"
 #include "UpnpService.h"
+#include "UpnpTrafficSampler.h"
 
 using namespace std;
 
@@ -46,15 +47,36 @@ class UpnpWanCommonInterfaceConfig: public UpnpService
 
         UpnpWanCommonInterfaceConfig(GUPnPServiceInfo *serviceInfo,
                                      UpnpRequestState *requestState):
-            UpnpService(serviceInfo, UPNP_OIC_TYPE_WAN_IF_CONFIG, requestState, &Attributes)
+            UpnpService(serviceInfo, UPNP_OIC_TYPE_WAN_IF_CONFIG, requestState, &Attributes),
+            m_trafficSampler(TRAFFIC_HISTORY_SIZE)
         {
             m_numConnections = 0;
+            m_samplePeriod = TRAFFIC_SAMPLE_PERIOD;
+            m_sampleSource = NULL;
+            m_sampleFailed = false;
         }
 
+        virtual ~UpnpWanCommonInterfaceConfig();
+
+        void processIntrospection(GUPnPServiceProxy *proxy,
+                                  GUPnPServiceIntrospection *introspection);
+
     private:
+        // Default traffic sampling period (seconds) and number of samples kept
+        static const unsigned int TRAFFIC_SAMPLE_PERIOD = 10;
+        static const size_t TRAFFIC_HISTORY_SIZE = 60;
+
         int m_numConnections;
         map <UpnpRequest *, CompositeAttribute> m_ConnectionInfoRequestMap;
 
+        // Background sampling of the traffic counters
+        UpnpTrafficSampler m_trafficSampler;
+        unsigned int m_samplePeriod;
+        GSource *m_sampleSource;
+        map <GUPnPServiceProxyAction *, int> m_sampleActions;
+        uint32_t m_sampleRaw[UpnpTrafficSampler::NUM_COUNTERS];
+        bool m_sampleFailed;
+
         static map <const string, GetAttributeHandler> GetAttributeActionMap;
 
         static vector <UpnpAttributeInfo> Attributes;
@@ -64,7 +86,7 @@ class UpnpWanCommonInterfaceConfig: public UpnpService
         bool setAttributesRequest(const RCSResourceAttributes &attrs,
                                   UpnpRequest *request,
                                   const map< string, string > &queryParams);
-        bool processNotification(string attrName, string parent, GValue *value);
+        bool processNotification(const string &attrName, const string &parent, GValue *value);
 
         static void getLinkPropertiesCb(GUPnPServiceProxy *proxy,
                                         GUPnPServiceProxyAction *action,
@@ -78,6 +100,19 @@ class UpnpWanCommonInterfaceConfig: public UpnpService
 
         bool getConnectionInfo(UpnpRequest *request);
 
+        bool isTrafficSamplingSupported();
+        bool isTrafficSampleFresh();
+        void startTrafficSampling();
+        void stopTrafficSampling();
+        void sampleTrafficCounters();
+        void updateTrafficAttributes();
+
+        static gboolean onSampleTimeout(gpointer userData);
+
+        static void sampleTrafficCountersCb(GUPnPServiceProxy *proxy,
+                                            GUPnPServiceProxyAction *action,
+                                            gpointer userData);
+
 };
 
 #endif
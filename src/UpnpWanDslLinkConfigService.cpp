@@ -19,6 +19,7 @@
 //-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
 
 #include "UpnpWanDslLinkConfigService.h"
+#include "UpnpActionStats.h"
 
 using namespace OIC::Service;
 
@@ -105,16 +106,16 @@ void UpnpWanDslLinkConfig::getLinkInfoCb(GUPnPServiceProxy *proxy,
 
     UpnpRequest *request = static_cast<UpnpRequest *> (userData);
 
-    bool status = gupnp_service_proxy_end_action (proxy,
-                                                  actionProxy,
-                                                  &error,
-                                                  "NewDSLLinkType",
-                                                  G_TYPE_STRING,
-                                                  &linkType,
-                                                  "NewDSLLinkStatus",
-                                                  G_TYPE_STRING,
-                                                  &linkStatus,
-                                                  NULL);
+    bool status = UpnpActionStats::endAction (proxy,
+                                              actionProxy,
+                                              &error,
+                                              "NewDSLLinkType",
+                                              G_TYPE_STRING,
+                                              &linkType,
+                                              "NewDSLLinkStatus",
+                                              G_TYPE_STRING,
+                                              &linkStatus,
+                                              NULL);
     if (error)
     {
         ERROR_PRINT("GetDSLLinkInfo failed: " << error->code << ", " << error->message);
@@ -142,11 +143,11 @@ bool UpnpWanDslLinkConfig::getLinkInfo(UpnpRequest *request)
 {
     DEBUG_PRINT("");
     GUPnPServiceProxyAction *actionProxy =
-        gupnp_service_proxy_begin_action (m_proxy,
-                                          "GetDSLLinkInfo",
-                                          getLinkInfoCb,
-                                          (gpointer *) request,
-                                          NULL);
+        UpnpActionStats::beginAction (m_proxy,
+                                      "GetDSLLinkInfo",
+                                      getLinkInfoCb,
+                                      (gpointer *) request,
+                                      NULL);
     if (NULL == actionProxy)
     {
         return false;
@@ -163,10 +164,10 @@ void UpnpWanDslLinkConfig::setLinkInfoCb(GUPnPServiceProxy *proxy,
 
     UpnpRequest *request = static_cast<UpnpRequest *> (userData);
 
-    bool status = gupnp_service_proxy_end_action (proxy,
-                                                  actionProxy,
-                                                  &error,
-                                                  NULL);
+    bool status = UpnpActionStats::endAction (proxy,
+                                              actionProxy,
+                                              &error,
+                                              NULL);
     if (error)
     {
         ERROR_PRINT("SetLinkType failed: " << error->code << ", " << error->message);
@@ -203,14 +204,14 @@ bool UpnpWanDslLinkConfig::setLinkInfo(UpnpRequest *request,
         return false;
     }
 
-    actionProxy = gupnp_service_proxy_begin_action (m_proxy,
-                                                    "SetLinkType",
-                                                    setLinkInfoCb,
-                                                    (gpointer *) request,
-                                                    "NewLinkType",
-                                                    G_TYPE_STRING,
-                                                    sNewType,
-                                                    NULL);
+    actionProxy = UpnpActionStats::beginAction (m_proxy,
+                                                "SetLinkType",
+                                                setLinkInfoCb,
+                                                (gpointer *) request,
+                                                "NewLinkType",
+                                                G_TYPE_STRING,
+                                                sNewType,
+                                                NULL);
     if (NULL == actionProxy)
     {
         return false;
@@ -232,7 +233,7 @@ bool UpnpWanDslLinkConfig::getAttributesRequest(UpnpRequest *request,
 
         DEBUG_PRINT(" \"" << it->first << "\"");
         // Check the request
-        if (!UpnpAttribute::isValidRequest(&m_attributeMap, it->first, UPNP_ACTION_GET))
+        if (!isGetRequested(request, it->first))
         {
             request->done++;
             continue;
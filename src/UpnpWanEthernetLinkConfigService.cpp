@@ -55,7 +55,7 @@ bool UpnpWanEthernetLinkConfig::getAttributesRequest(UpnpRequest *request,
 
         DEBUG_PRINT(" \"" << it->first << "\"");
         // Check the request
-        if (!UpnpAttribute::isValidRequest(&m_attributeMap, it->first, UPNP_ACTION_GET))
+        if (!isGetRequested(request, it->first))
         {
             request->done++;
             continue;
@@ -78,7 +78,7 @@ bool UpnpWanEthernetLinkConfig::setAttributesRequest(const RCSResourceAttributes
 {
     // There are no "SET" actions associated with this service
     request->proxyMap.clear();
-    request->finish(false);
+    request->expected = request->done;
     return false;
 }
 
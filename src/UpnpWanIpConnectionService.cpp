@@ -19,6 +19,7 @@
 //-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
 
 #include "UpnpWanIpConnectionService.h"
+#include "UpnpActionStats.h"
 
 using namespace OIC::Service;
 
@@ -97,6 +98,39 @@ vector <UpnpAttributeInfo> UpnpWanIpConnection::Attributes =
         "PortMappingNumberOfEntries", G_TYPE_UINT, true,
         {{"", UPNP_ACTION_GET, "", G_TYPE_NONE}}, {}
     },
+    // "portMappings" is a sequence of port mapping entries, served from
+    // the mirrored port mapping table. Each entry has tags:
+    //    "remoteHost", "externalPort", "protocol", "internalPort",
+    //    "internalClient", "enabled", "description", "leaseDuration"
+    {
+        "portMappings",
+        "", G_TYPE_NONE, false,
+        {{"GetGenericPortMappingEntry", UPNP_ACTION_GET, NULL, G_TYPE_NONE}},
+        {   {"remoteHost",     "RemoteHost",                G_TYPE_STRING,  false},
+            {"externalPort",   "ExternalPort",              G_TYPE_UINT,    false},
+            {"protocol",       "PortMappingProtocol",       G_TYPE_STRING,  false},
+            {"internalPort",   "InternalPort",              G_TYPE_UINT,    false},
+            {"internalClient", "InternalClient",            G_TYPE_STRING,  false},
+            {"enabled",        "PortMappingEnabled",        G_TYPE_BOOLEAN, false},
+            {"description",    "PortMappingDescription",    G_TYPE_STRING,  false},
+            {"leaseDuration",  "PortMappingLeaseDuration",  G_TYPE_UINT,    false}
+        }
+    },
+    // Special case: POST-only attribute taking a sequence of port mapping
+    // operations executed as one batch. Each operation has tags:
+    //    "op" ("add" or "delete"), "protocol", "externalPort", "remoteHost",
+    //    "internalPort", "internalClient", "enabled", "description", "leaseDuration"
+    //    and, for deletion of a port range, "externalPortEnd" and "manage".
+    // The attribute is set to the per-operation results: "op", "protocol",
+    // "externalPort", "success" and, on failure, "errorCode", "errorDescription".
+    {
+        "portMappingBatch",
+        "", G_TYPE_NONE, false,
+        {   {NULL}, // no GET action
+            {"AddPortMapping", UPNP_ACTION_POST, NULL, G_TYPE_NONE}
+        },
+        {}
+    },
     {
         "connectionState",
         "", G_TYPE_NONE, true,
@@ -131,7 +165,8 @@ map <const string, UpnpWanIpConnection::SetAttributeHandler>
     UpnpWanIpConnection::SetAttributeActionMap =
 {
     {"connectionTypeInfo", &UpnpWanIpConnection::setConnectionTypeInfo},
-    {"connectionState", &UpnpWanIpConnection::changeConnectionStatus}
+    {"connectionState", &UpnpWanIpConnection::changeConnectionStatus},
+    {"portMappingBatch", &UpnpWanIpConnection::setPortMappingBatch}
 };
 
 vector <const char *> UpnpWanIpConnection::statusUpdateActions =
@@ -149,16 +184,16 @@ void UpnpWanIpConnection::getNatStatusCb(GUPnPServiceProxy *proxy,
 
     UpnpRequest *request = static_cast<UpnpRequest *> (userData);
 
-    bool status = gupnp_service_proxy_end_action (proxy,
-                                                  actionProxy,
-                                                  &error,
-                                                  "NewRSIPAvailable",
-                                                  G_TYPE_BOOLEAN,
-                                                  &rsip,
-                                                  "NewNATEnabled",
-                                                  G_TYPE_BOOLEAN,
-                                                  &natEnabled,
-                                                  NULL);
+    bool status = UpnpActionStats::endAction (proxy,
+                                              actionProxy,
+                                              &error,
+                                              "NewRSIPAvailable",
+                                              G_TYPE_BOOLEAN,
+                                              &rsip,
+                                              "NewNATEnabled",
+                                              G_TYPE_BOOLEAN,
+                                              &natEnabled,
+                                              NULL);
     if (error)
     {
         ERROR_PRINT("GetNatStatus failed: " << error->code << ", " << error->message);
@@ -182,7 +217,7 @@ void UpnpWanIpConnection::getNatStatusCb(GUPnPServiceProxy *proxy,
 bool UpnpWanIpConnection::getNatStatus(UpnpRequest *request)
 {
     DEBUG_PRINT("");
-    GUPnPServiceProxyAction *actionProxy = gupnp_service_proxy_begin_action (m_proxy,
+    GUPnPServiceProxyAction *actionProxy = UpnpActionStats::beginAction (m_proxy,
                                            "GetNATRSIPStatus",
                                            getNatStatusCb,
                                            (gpointer *) request,
@@ -206,19 +241,19 @@ void UpnpWanIpConnection::getStatusInfoCb(GUPnPServiceProxy *proxy,
 
     UpnpRequest *request = static_cast<UpnpRequest *> (userData);
 
-    bool status = gupnp_service_proxy_end_action (proxy,
-                                                  actionProxy,
-                                                  &error,
-                                                  "NewConnectionStatus",
-                                                  G_TYPE_STRING,
-                                                  &connStatus,
-                                                  "NewLastConnectionError",
-                                                  G_TYPE_STRING,
-                                                  &lastError,
-                                                  "NewUptime",
-                                                  G_TYPE_UINT,
-                                                  &uptime,
-                                                  NULL);
+    bool status = UpnpActionStats::endAction (proxy,
+                                              actionProxy,
+                                              &error,
+                                              "NewConnectionStatus",
+                                              G_TYPE_STRING,
+                                              &connStatus,
+                                              "NewLastConnectionError",
+                                              G_TYPE_STRING,
+                                              &lastError,
+                                              "NewUptime",
+                                              G_TYPE_UINT,
+                                              &uptime,
+                                              NULL);
     if (error)
     {
         ERROR_PRINT("GetStatusInfo failed: " << error->code << ", " << error->message);
@@ -249,11 +284,11 @@ bool UpnpWanIpConnection::getStatusInfo(UpnpRequest *request)
 {
     DEBUG_PRINT("");
     GUPnPServiceProxyAction *actionProxy =
-        gupnp_service_proxy_begin_action (m_proxy,
-                                          "GetStatusInfo",
-                                          getStatusInfoCb,
-                                          (gpointer *) request,
-                                          NULL);
+        UpnpActionStats::beginAction (m_proxy,
+                                      "GetStatusInfo",
+                                      getStatusInfoCb,
+                                      (gpointer *) request,
+                                      NULL);
     if (NULL == actionProxy)
     {
         return false;
@@ -272,16 +307,16 @@ void UpnpWanIpConnection::getConnectionTypeInfoCb(GUPnPServiceProxy *proxy,
 
     UpnpRequest *request = static_cast<UpnpRequest *> (userData);
 
-    bool status = gupnp_service_proxy_end_action (proxy,
-                                                  actionProxy,
-                                                  &error,
-                                                  "NewConnectionType",
-                                                  G_TYPE_STRING,
-                                                  &connType,
-                                                  "NewPossibleConnectionTypes",
-                                                  G_TYPE_STRING,
-                                                  &allTypes,
-                                                  NULL);
+    bool status = UpnpActionStats::endAction (proxy,
+                                              actionProxy,
+                                              &error,
+                                              "NewConnectionType",
+                                              G_TYPE_STRING,
+                                              &connType,
+                                              "NewPossibleConnectionTypes",
+                                              G_TYPE_STRING,
+                                              &allTypes,
+                                              NULL);
     if (error)
     {
         ERROR_PRINT("GetConnectionTypeInfo failed: " << error->code << ", " << error->message);
@@ -308,11 +343,11 @@ bool UpnpWanIpConnection::getConnectionTypeInfo(UpnpRequest *request)
 {
     DEBUG_PRINT("");
     GUPnPServiceProxyAction *actionProxy
-        = gupnp_service_proxy_begin_action (m_proxy,
-                                            "GetConnectionTypeInfo",
-                                            getConnectionTypeInfoCb,
-                                            (gpointer *) request,
-                                            NULL);
+        = UpnpActionStats::beginAction (m_proxy,
+                                        "GetConnectionTypeInfo",
+                                        getConnectionTypeInfoCb,
+                                        (gpointer *) request,
+                                        NULL);
     if (NULL == actionProxy)
     {
         return false;
@@ -329,10 +364,10 @@ void UpnpWanIpConnection::setConnectionTypeInfoCb(GUPnPServiceProxy *proxy,
 
     UpnpRequest *request = static_cast<UpnpRequest *> (userData);
 
-    bool status = gupnp_service_proxy_end_action (proxy,
-                                                  actionProxy,
-                                                  &error,
-                                                  NULL);
+    bool status = UpnpActionStats::endAction (proxy,
+                                              actionProxy,
+                                              &error,
+                                              NULL);
     if (error)
     {
         ERROR_PRINT("SetConnectionTypeInfo failed: " << error->code << ", " << error->message);
@@ -369,14 +404,14 @@ bool UpnpWanIpConnection::setConnectionTypeInfo(UpnpRequest *request,
         return false;
     }
 
-    actionProxy = gupnp_service_proxy_begin_action (m_proxy,
-                                                    "SetConnectionType",
-                                                    setConnectionTypeInfoCb,
-                                                    (gpointer *) request,
-                                                    "NewConnectionType",
-                                                    G_TYPE_STRING,
-                                                    sNewType,
-                                                    NULL);
+    actionProxy = UpnpActionStats::beginAction (m_proxy,
+                                                "SetConnectionType",
+                                                setConnectionTypeInfoCb,
+                                                (gpointer *) request,
+                                                "NewConnectionType",
+                                                G_TYPE_STRING,
+                                                sNewType,
+                                                NULL);
     if (NULL == actionProxy)
     {
         return false;
@@ -394,10 +429,10 @@ void UpnpWanIpConnection::changeConnectionStatusCb(GUPnPServiceProxy *proxy,
 
     UpnpRequest *request = static_cast<UpnpRequest *> (userData);
 
-    bool status = gupnp_service_proxy_end_action (proxy,
-                                                  actionProxy,
-                                                  &error,
-                                                  NULL);
+    bool status = UpnpActionStats::endAction (proxy,
+                                              actionProxy,
+                                              &error,
+                                              NULL);
     if (error)
     {
         ERROR_PRINT("ChangeConnectionStatus failed: " << error->code << ", " << error->message);
@@ -441,11 +476,11 @@ bool UpnpWanIpConnection::changeConnectionStatus(UpnpRequest *request,
         return false;
     }
 
-    actionProxy = gupnp_service_proxy_begin_action (m_proxy,
-                                                    action,
-                                                    changeConnectionStatusCb,
-                                                    (gpointer *) request,
-                                                    NULL);
+    actionProxy = UpnpActionStats::beginAction (m_proxy,
+                                                action,
+                                                changeConnectionStatusCb,
+                                                (gpointer *) request,
+                                                NULL);
     if (NULL == actionProxy)
     {
         ERROR_PRINT("ChangeConnectionStatus failed: " << action);
@@ -456,6 +491,53 @@ bool UpnpWanIpConnection::changeConnectionStatus(UpnpRequest *request,
     return true;
 }
 
+UpnpWanIpConnection::~UpnpWanIpConnection()
+{
+    UpnpPortMappingBatch::cancelAll(m_portMappingBatches);
+}
+
+// The batches in progress would outlive the service
+void UpnpWanIpConnection::stop()
+{
+    UpnpPortMappingBatch::cancelAll(m_portMappingBatches);
+    UpnpService::stop();
+}
+
+void UpnpWanIpConnection::processIntrospection(GUPnPServiceProxy *proxy,
+                                               GUPnPServiceIntrospection *introspection)
+{
+    UpnpService::processIntrospection(proxy, introspection);
+
+    m_portMappingCapabilities.addAnyPortMapping =
+        (gupnp_service_introspection_get_action(introspection, "AddAnyPortMapping") != NULL);
+    m_portMappingCapabilities.deletePortMappingRange =
+        (gupnp_service_introspection_get_action(introspection, "DeletePortMappingRange") != NULL);
+
+    if (UpnpAttribute::isValidRequest(&m_attributeMap, "portMappings", UPNP_ACTION_GET))
+    {
+        setAttribute("portMappings", CompositeAttribute(), false);
+        m_portMappingMirror.setProxy(proxy);
+    }
+}
+
+bool UpnpWanIpConnection::setPortMappingBatch(UpnpRequest *request,
+                                              RCSResourceAttributes::Value *attrValue)
+{
+    DEBUG_PRINT("");
+    UpnpPortMappingMirror *pMirror = &m_portMappingMirror;
+    const auto &entries = attrValue->get< CompositeAttribute >();
+
+    // Mappings are not necessarily evented (e.g. replaced entries):
+    // refresh the mirror once the batch is done
+    return UpnpPortMappingBatch::start(m_proxy,
+                                       request,
+                                       "portMappingBatch",
+                                       m_portMappingCapabilities,
+                                       entries,
+                                       &m_portMappingBatches,
+                                       [pMirror] () { pMirror->invalidate(); });
+}
+
 bool UpnpWanIpConnection::getAttributesRequest(UpnpRequest *request,
                                                const map< string, string > &queryParams)
 {
@@ -468,7 +550,7 @@ bool UpnpWanIpConnection::getAttributesRequest(UpnpRequest *request,
 
         DEBUG_PRINT(" \"" << it->first << "\"");
         // Check the request
-        if (!UpnpAttribute::isValidRequest(&m_attributeMap, it->first, UPNP_ACTION_GET))
+        if (!isGetRequested(request, it->first))
         {
             request->done++;
             continue;
@@ -476,7 +558,12 @@ bool UpnpWanIpConnection::getAttributesRequest(UpnpRequest *request,
 
         // Check if custom GET needs to be called
         auto attr = this->GetAttributeActionMap.find(it->first);
-        if (attr != this->GetAttributeActionMap.end())
+        if (it->first == "portMappings")
+        {
+            // Served from the mirrored port mapping table
+            result = m_portMappingMirror.get(request, queryParams);
+        }
+        else if (attr != this->GetAttributeActionMap.end())
         {
             GetAttributeHandler fp = attr->second;
             result = (this->*fp)(request);
@@ -540,8 +627,8 @@ bool UpnpWanIpConnection::setAttributesRequest(const RCSResourceAttributes &valu
     return status;
 }
 
-bool UpnpWanIpConnection::processNotification(string attrName,
-                                              string parent,
+bool UpnpWanIpConnection::processNotification(const string &attrName,
+                                              const string &parent,
                                               GValue *value)
 {
 
@@ -549,10 +636,18 @@ bool UpnpWanIpConnection::processNotification(string attrName,
     {
         // Need to keep number of ports around
         m_sizePortMap = (int) g_value_get_uint(value);
-        BundleResource::setAttribute("sizePortMap", m_sizePortMap);
+        setAttribute("sizePortMap", m_sizePortMap);
+        m_portMappingMirror.setNumberOfEntries(m_sizePortMap);
         return true;
     }
 
+    if (attrName == "updateId")
+    {
+        // Port mapping table may have changed, the attribute
+        // itself takes the default conversion
+        m_portMappingMirror.invalidate();
+    }
+
     // Default: no custom variable->attribute conversion
     return false;
 }
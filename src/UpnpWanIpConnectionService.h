@@ -29,6 +29,8 @@
 #include "UpnpResource.h"
 #include "UpnpInternal.h"
 #include "UpnpService.h"
+#include "UpnpPortMappingBatch.h"
+#include "UpnpPortMappingMirror.h"
 
 using namespace std;
 
@@ -44,10 +46,18 @@ class UpnpWanIpConnection: public UpnpService
 
         UpnpWanIpConnection(GUPnPServiceInfo *serviceInfo,
                             UpnpRequestState *requestState):
-            UpnpService(serviceInfo, UPNP_OIC_TYPE_WAN_IP_CONNECTION, requestState, &Attributes)
+            UpnpService(serviceInfo, UPNP_OIC_TYPE_WAN_IP_CONNECTION, requestState, &Attributes),
+            m_portMappingMirror(this, "portMappings")
         {
             m_sizePortMap = 0;
+            m_portMappingCapabilities = {false, false};
         }
+        virtual ~UpnpWanIpConnection();
+
+        void processIntrospection(GUPnPServiceProxy *proxy,
+                                  GUPnPServiceIntrospection *introspection);
+
+        void stop();
 
     private:
         static map <const string, GetAttributeHandler> GetAttributeActionMap;
@@ -56,14 +66,17 @@ class UpnpWanIpConnection: public UpnpService
         static vector <const char *> statusUpdateActions;
 
         int m_sizePortMap;
+        UpnpPortMappingMirror m_portMappingMirror;
+        UpnpPortMappingBatch::Capabilities m_portMappingCapabilities;
+        UpnpPortMappingBatch::Set m_portMappingBatches;
 
         bool getAttributesRequest(UpnpRequest *request,
                                   const map< string, string > &queryParams);
         bool setAttributesRequest(const RCSResourceAttributes &attrs,
                                   UpnpRequest *request,
                                   const map< string, string > &queryParams);
-        bool processNotification(string attrName,
-                                 string parent,
+        bool processNotification(const string &attrName,
+                                 const string &parent,
                                  GValue *value);
 
         static void getNatStatusCb(GUPnPServiceProxy *proxy,
@@ -98,6 +111,9 @@ class UpnpWanIpConnection: public UpnpService
         bool changeConnectionStatus(UpnpRequest *request,
                                     RCSResourceAttributes::Value *value);
 
+        bool setPortMappingBatch(UpnpRequest *request,
+                                 RCSResourceAttributes::Value *value);
+
 };
 
 #endif
@@ -19,6 +19,7 @@
 //-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
 
 #include "UpnpWanPotsLinkConfigService.h"
+#include "UpnpActionStats.h"
 
 using namespace OIC::Service;
 
@@ -113,19 +114,19 @@ void UpnpWanPotsLinkConfig::getIspInfoCb(GUPnPServiceProxy *proxy,
 
     UpnpRequest *request = static_cast<UpnpRequest *> (userData);
 
-    bool status = gupnp_service_proxy_end_action (proxy,
-                                                  actionProxy,
-                                                  &error,
-                                                  "NewISPPhoneNumber",
-                                                  G_TYPE_STRING,
-                                                  &phoneNumber,
-                                                  "NewISPInfo",
-                                                  G_TYPE_STRING,
-                                                  &info,
-                                                  "NewLinkType",
-                                                  G_TYPE_STRING,
-                                                  &linkType,
-                                                  NULL);
+    bool status = UpnpActionStats::endAction (proxy,
+                                              actionProxy,
+                                              &error,
+                                              "NewISPPhoneNumber",
+                                              G_TYPE_STRING,
+                                              &phoneNumber,
+                                              "NewISPInfo",
+                                              G_TYPE_STRING,
+                                              &info,
+                                              "NewLinkType",
+                                              G_TYPE_STRING,
+                                              &linkType,
+                                              NULL);
     if (error)
     {
         ERROR_PRINT("GetISPInfo failed: " << error->code << ", " << error->message);
@@ -155,11 +156,11 @@ bool UpnpWanPotsLinkConfig::getIspInfo(UpnpRequest *request)
 {
     DEBUG_PRINT("");
     GUPnPServiceProxyAction *actionProxy =
-        gupnp_service_proxy_begin_action (m_proxy,
-                                          "GetISPInfo",
-                                          getIspInfoCb,
-                                          (gpointer *) request,
-                                          NULL);
+        UpnpActionStats::beginAction (m_proxy,
+                                      "GetISPInfo",
+                                      getIspInfoCb,
+                                      (gpointer *) request,
+                                      NULL);
     if (NULL == actionProxy)
     {
         return false;
@@ -178,16 +179,16 @@ void UpnpWanPotsLinkConfig::getCallRetryInfoCb(GUPnPServiceProxy *proxy,
 
     UpnpRequest *request = static_cast<UpnpRequest *> (userData);
 
-    bool status = gupnp_service_proxy_end_action (proxy,
-                                                  actionProxy,
-                                                  &error,
-                                                  "NewNumberOfRetries",
-                                                  G_TYPE_UINT,
-                                                  &numRetries,
-                                                  "NewDelayBetweenRetries",
-                                                  G_TYPE_UINT,
-                                                  &interval,
-                                                  NULL);
+    bool status = UpnpActionStats::endAction (proxy,
+                                              actionProxy,
+                                              &error,
+                                              "NewNumberOfRetries",
+                                              G_TYPE_UINT,
+                                              &numRetries,
+                                              "NewDelayBetweenRetries",
+                                              G_TYPE_UINT,
+                                              &interval,
+                                              NULL);
     if (error)
     {
         ERROR_PRINT("GetCallRetryInfo failed: " << error->code << ", " << error->message);
@@ -212,11 +213,11 @@ bool UpnpWanPotsLinkConfig::getCallRetryInfo(UpnpRequest *request)
 {
     DEBUG_PRINT("");
     GUPnPServiceProxyAction *actionProxy =
-        gupnp_service_proxy_begin_action (m_proxy,
-                                          "GetCallRetryInfo",
-                                          getCallRetryInfoCb,
-                                          (gpointer *) request,
-                                          NULL);
+        UpnpActionStats::beginAction (m_proxy,
+                                      "GetCallRetryInfo",
+                                      getCallRetryInfoCb,
+                                      (gpointer *) request,
+                                      NULL);
     if (NULL == actionProxy)
     {
         return false;
@@ -233,10 +234,10 @@ void UpnpWanPotsLinkConfig::setIspInfoCb(GUPnPServiceProxy *proxy,
 
     UpnpRequest *request = static_cast<UpnpRequest *> (userData);
 
-    bool status = gupnp_service_proxy_end_action (proxy,
-                                                  actionProxy,
-                                                  &error,
-                                                  NULL);
+    bool status = UpnpActionStats::endAction (proxy,
+                                              actionProxy,
+                                              &error,
+                                              NULL);
     if (error)
     {
         ERROR_PRINT("SetISPInfo failed: " << error->code << ", " << error->message);
@@ -287,20 +288,20 @@ bool UpnpWanPotsLinkConfig::setIspInfo(UpnpRequest *request,
         return false;
     }
 
-    actionProxy = gupnp_service_proxy_begin_action (m_proxy,
-                                                    "SetISPInfo",
-                                                    setIspInfoCb,
-                                                    (gpointer *) request,
-                                                    "NewISPPhoneNumber",
-                                                    G_TYPE_STRING,
-                                                    sPhoneNumber,
-                                                    "NewISPInfo",
-                                                    G_TYPE_STRING,
-                                                    sInfo,
-                                                    "NewLinkType",
-                                                    G_TYPE_STRING,
-                                                    sType,
-                                                    NULL);
+    actionProxy = UpnpActionStats::beginAction (m_proxy,
+                                                "SetISPInfo",
+                                                setIspInfoCb,
+                                                (gpointer *) request,
+                                                "NewISPPhoneNumber",
+                                                G_TYPE_STRING,
+                                                sPhoneNumber,
+                                                "NewISPInfo",
+                                                G_TYPE_STRING,
+                                                sInfo,
+                                                "NewLinkType",
+                                                G_TYPE_STRING,
+                                                sType,
+                                                NULL);
     if (NULL == actionProxy)
     {
         return false;
@@ -318,10 +319,10 @@ void UpnpWanPotsLinkConfig::setCallRetryInfoCb(GUPnPServiceProxy *proxy,
 
     UpnpRequest *request = static_cast<UpnpRequest *> (userData);
 
-    bool status = gupnp_service_proxy_end_action (proxy,
-                                                  actionProxy,
-                                                  &error,
-                                                  NULL);
+    bool status = UpnpActionStats::endAction (proxy,
+                                              actionProxy,
+                                              &error,
+                                              NULL);
     if (error)
     {
         ERROR_PRINT("SeCallRetryInfo failed: " << error->code << ", " << error->message);
@@ -363,17 +364,17 @@ bool UpnpWanPotsLinkConfig::setCallRetryInfo(UpnpRequest *request,
         return false;
     }
 
-    actionProxy = gupnp_service_proxy_begin_action (m_proxy,
-                                                    "SetCallRetryInfo",
-                                                    setCallRetryInfoCb,
-                                                    (gpointer *) request,
-                                                    "NewNumberOfRetries",
-                                                    G_TYPE_UINT,
-                                                    numRetries,
-                                                    "NewDelayBetweenRetries",
-                                                    G_TYPE_UINT,
-                                                    interval,
-                                                    NULL);
+    actionProxy = UpnpActionStats::beginAction (m_proxy,
+                                                "SetCallRetryInfo",
+                                                setCallRetryInfoCb,
+                                                (gpointer *) request,
+                                                "NewNumberOfRetries",
+                                                G_TYPE_UINT,
+                                                numRetries,
+                                                "NewDelayBetweenRetries",
+                                                G_TYPE_UINT,
+                                                interval,
+                                                NULL);
     if (NULL == actionProxy)
     {
         return false;
@@ -395,7 +396,7 @@ bool UpnpWanPotsLinkConfig::getAttributesRequest(UpnpRequest *request,
 
         DEBUG_PRINT(" \"" << it->first << "\"");
         // Check the request
-        if (!UpnpAttribute::isValidRequest(&m_attributeMap, it->first, UPNP_ACTION_GET))
+        if (!isGetRequested(request, it->first))
         {
             request->done++;
             continue;
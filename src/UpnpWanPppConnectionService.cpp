@@ -19,6 +19,7 @@
 //-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
 
 #include "UpnpWanPppConnectionService.h"
+#include "UpnpActionStats.h"
 
 using namespace OIC::Service;
 
@@ -163,8 +164,39 @@ vector <UpnpAttributeInfo> UpnpWanPppConnection::Attributes =
         "PortMappingNumberOfEntries", G_TYPE_UINT, true,
         {{"", UPNP_ACTION_GET, "", G_TYPE_NONE}}, {}
     },
-
-    //TODO: add port mapping
+    // "portMappings" is a sequence of port mapping entries, served from
+    // the mirrored port mapping table. Each entry has tags:
+    //    "remoteHost", "externalPort", "protocol", "internalPort",
+    //    "internalClient", "enabled", "description", "leaseDuration"
+    {
+        "portMappings",
+        "", G_TYPE_NONE, false,
+        {{"GetGenericPortMappingEntry", UPNP_ACTION_GET, NULL, G_TYPE_NONE}},
+        {   {"remoteHost",     "RemoteHost",                G_TYPE_STRING,  false},
+            {"externalPort",   "ExternalPort",              G_TYPE_UINT,    false},
+            {"protocol",       "PortMappingProtocol",       G_TYPE_STRING,  false},
+            {"internalPort",   "InternalPort",              G_TYPE_UINT,    false},
+            {"internalClient", "InternalClient",            G_TYPE_STRING,  false},
+            {"enabled",        "PortMappingEnabled",        G_TYPE_BOOLEAN, false},
+            {"description",    "PortMappingDescription",    G_TYPE_STRING,  false},
+            {"leaseDuration",  "PortMappingLeaseDuration",  G_TYPE_UINT,    false}
+        }
+    },
+    // Special case: POST-only attribute taking a sequence of port mapping
+    // operations executed as one batch. Each operation has tags:
+    //    "op" ("add" or "delete"), "protocol", "externalPort", "remoteHost",
+    //    "internalPort", "internalClient", "enabled", "description", "leaseDuration"
+    //    and, for deletion of a port range, "externalPortEnd" and "manage".
+    // The attribute is set to the per-operation results: "op", "protocol",
+    // "externalPort", "success" and, on failure, "errorCode", "errorDescription".
+    {
+        "portMappingBatch",
+        "", G_TYPE_NONE, false,
+        {   {NULL}, // no GET action
+            {"AddPortMapping", UPNP_ACTION_POST, NULL, G_TYPE_NONE}
+        },
+        {}
+    },
 };
 
 // Custom action map:
@@ -185,7 +217,8 @@ map <const string, UpnpWanPppConnection::SetAttributeHandler>
 {
     {"connectionTypeInfo",  &UpnpWanPppConnection::setConnectionTypeInfo},
     {"statusUpdateRequest", &UpnpWanPppConnection::changeConnectionStatus},
-    {"connectionConfig",    &UpnpWanPppConnection::configureConnection}
+    {"connectionConfig",    &UpnpWanPppConnection::configureConnection},
+    {"portMappingBatch", &UpnpWanPppConnection::setPortMappingBatch}
 };
 
 vector <const char *> UpnpWanPppConnection::statusUpdateActions =
@@ -203,16 +236,16 @@ void UpnpWanPppConnection::getNatStatusCb(GUPnPServiceProxy *proxy,
 
     UpnpRequest *request = static_cast<UpnpRequest *> (userData);
 
-    bool status = gupnp_service_proxy_end_action (proxy,
-                                                  actionProxy,
-                                                  &error,
-                                                  "NewRSIPAvailable",
-                                                  G_TYPE_BOOLEAN,
-                                                  &rsip,
-                                                  "NewNATEnabled",
-                                                  G_TYPE_BOOLEAN,
-                                                  &natEnabled,
-                                                  NULL);
+    bool status = UpnpActionStats::endAction (proxy,
+                                              actionProxy,
+                                              &error,
+                                              "NewRSIPAvailable",
+                                              G_TYPE_BOOLEAN,
+                                              &rsip,
+                                              "NewNATEnabled",
+                                              G_TYPE_BOOLEAN,
+                                              &natEnabled,
+                                              NULL);
     if (error)
     {
         ERROR_PRINT("GetNatStatus failed: " << error->code << ", " << error->message);
@@ -236,7 +269,7 @@ void UpnpWanPppConnection::getNatStatusCb(GUPnPServiceProxy *proxy,
 bool UpnpWanPppConnection::getNatStatus(UpnpRequest *request)
 {
     DEBUG_PRINT("");
-    GUPnPServiceProxyAction *actionProxy = gupnp_service_proxy_begin_action (m_proxy,
+    GUPnPServiceProxyAction *actionProxy = UpnpActionStats::beginAction (m_proxy,
                                            "GetNATRSIPStatus",
                                            getNatStatusCb,
                                            (gpointer *) request,
@@ -258,16 +291,16 @@ void UpnpWanPppConnection::getMaxBitRateCb(GUPnPServiceProxy *proxy,
 
     UpnpRequest *request = static_cast<UpnpRequest *> (userData);
 
-    bool status = gupnp_service_proxy_end_action (proxy,
-                                                  actionProxy,
-                                                  &error,
-                                                  "NewUpstreamMaxBitRate",
-                                                  G_TYPE_UINT,
-                                                  &up,
-                                                  "NewDownstreamMaxBitRate",
-                                                  G_TYPE_UINT,
-                                                  &down,
-                                                  NULL);
+    bool status = UpnpActionStats::endAction (proxy,
+                                              actionProxy,
+                                              &error,
+                                              "NewUpstreamMaxBitRate",
+                                              G_TYPE_UINT,
+                                              &up,
+                                              "NewDownstreamMaxBitRate",
+                                              G_TYPE_UINT,
+                                              &down,
+                                              NULL);
     if (error)
     {
         ERROR_PRINT("GetLinkLayerMaxBitRates failed: " << error->code << ", " << error->message);
@@ -291,7 +324,7 @@ void UpnpWanPppConnection::getMaxBitRateCb(GUPnPServiceProxy *proxy,
 bool UpnpWanPppConnection::getMaxBitRate(UpnpRequest *request)
 {
     DEBUG_PRINT("");
-    GUPnPServiceProxyAction *actionProxy = gupnp_service_proxy_begin_action (m_proxy,
+    GUPnPServiceProxyAction *actionProxy = UpnpActionStats::beginAction (m_proxy,
                                            "GetLinkLayerMaxBitRates",
                                            getMaxBitRateCb,
                                            (gpointer *) request,
@@ -315,19 +348,19 @@ void UpnpWanPppConnection::getStatusInfoCb(GUPnPServiceProxy *proxy,
 
     UpnpRequest *request = static_cast<UpnpRequest *> (userData);
 
-    bool status = gupnp_service_proxy_end_action (proxy,
-                                                  actionProxy,
-                                                  &error,
-                                                  "NewConnectionStatus",
-                                                  G_TYPE_STRING,
-                                                  &connStatus,
-                                                  "NewLastConnectionError",
-                                                  G_TYPE_STRING,
-                                                  &lastError,
-                                                  "NewUptime",
-                                                  G_TYPE_UINT,
-                                                  &uptime,
-                                                  NULL);
+    bool status = UpnpActionStats::endAction (proxy,
+                                              actionProxy,
+                                              &error,
+                                              "NewConnectionStatus",
+                                              G_TYPE_STRING,
+                                              &connStatus,
+                                              "NewLastConnectionError",
+                                              G_TYPE_STRING,
+                                              &lastError,
+                                              "NewUptime",
+                                              G_TYPE_UINT,
+                                              &uptime,
+                                              NULL);
     if (error)
     {
         ERROR_PRINT("GetStatusInfo failed: " << error->code << ", " << error->message);
@@ -357,11 +390,11 @@ bool UpnpWanPppConnection::getStatusInfo(UpnpRequest *request)
 {
     DEBUG_PRINT("");
     GUPnPServiceProxyAction *actionProxy =
-        gupnp_service_proxy_begin_action (m_proxy,
-                                          "GetStatusInfo",
-                                          getStatusInfoCb,
-                                          (gpointer *) request,
-                                          NULL);
+        UpnpActionStats::beginAction (m_proxy,
+                                      "GetStatusInfo",
+                                      getStatusInfoCb,
+                                      (gpointer *) request,
+                                      NULL);
     if (NULL == actionProxy)
     {
         return false;
@@ -380,16 +413,16 @@ void UpnpWanPppConnection::getConnectionTypeInfoCb(GUPnPServiceProxy *proxy,
 
     UpnpRequest *request = static_cast<UpnpRequest *> (userData);
 
-    bool status = gupnp_service_proxy_end_action (proxy,
-                                                  actionProxy,
-                                                  &error,
-                                                  "NewConnectionType",
-                                                  G_TYPE_STRING,
-                                                  &connType,
-                                                  "NewPossibleConnectionTypes",
-                                                  G_TYPE_STRING,
-                                                  &allTypes,
-                                                  NULL);
+    bool status = UpnpActionStats::endAction (proxy,
+                                              actionProxy,
+                                              &error,
+                                              "NewConnectionType",
+                                              G_TYPE_STRING,
+                                              &connType,
+                                              "NewPossibleConnectionTypes",
+                                              G_TYPE_STRING,
+                                              &allTypes,
+                                              NULL);
     if (error)
     {
         ERROR_PRINT("GetConnectionTypeInfo failed: " << error->code << ", " << error->message);
@@ -416,11 +449,11 @@ bool UpnpWanPppConnection::getConnectionTypeInfo(UpnpRequest *request)
 {
     DEBUG_PRINT("");
     GUPnPServiceProxyAction *actionProxy
-        = gupnp_service_proxy_begin_action (m_proxy,
-                                            "GetConnectionTypeInfo",
-                                            getConnectionTypeInfoCb,
-                                            (gpointer *) request,
-                                            NULL);
+        = UpnpActionStats::beginAction (m_proxy,
+                                        "GetConnectionTypeInfo",
+                                        getConnectionTypeInfoCb,
+                                        (gpointer *) request,
+                                        NULL);
     if (NULL == actionProxy)
     {
         return false;
@@ -437,10 +470,10 @@ void UpnpWanPppConnection::setConnectionTypeInfoCb(GUPnPServiceProxy *proxy,
 
     UpnpRequest *request = static_cast<UpnpRequest *> (userData);
 
-    bool status = gupnp_service_proxy_end_action (proxy,
-                                                  actionProxy,
-                                                  &error,
-                                                  NULL);
+    bool status = UpnpActionStats::endAction (proxy,
+                                              actionProxy,
+                                              &error,
+                                              NULL);
     if (error)
     {
         ERROR_PRINT("SetConnectionTypeInfo failed: " << error->code << ", " << error->message);
@@ -477,14 +510,14 @@ bool UpnpWanPppConnection::setConnectionTypeInfo(UpnpRequest *request,
         return false;
     }
 
-    actionProxy = gupnp_service_proxy_begin_action (m_proxy,
-                                                    "SetConnectionType",
-                                                    setConnectionTypeInfoCb,
-                                                    (gpointer *) request,
-                                                    "NewConnectionType",
-                                                    G_TYPE_STRING,
-                                                    sNewType,
-                                                    NULL);
+    actionProxy = UpnpActionStats::beginAction (m_proxy,
+                                                "SetConnectionType",
+                                                setConnectionTypeInfoCb,
+                                                (gpointer *) request,
+                                                "NewConnectionType",
+                                                G_TYPE_STRING,
+                                                sNewType,
+                                                NULL);
     if (NULL == actionProxy)
     {
         return false;
@@ -502,10 +535,10 @@ void UpnpWanPppConnection::configureConnectionCb(GUPnPServiceProxy *proxy,
 
     UpnpRequest *request = static_cast<UpnpRequest *> (userData);
 
-    bool status = gupnp_service_proxy_end_action (proxy,
-                                                  actionProxy,
-                                                  &error,
-                                                  NULL);
+    bool status = UpnpActionStats::endAction (proxy,
+                                              actionProxy,
+                                              &error,
+                                              NULL);
     if (error)
     {
         ERROR_PRINT("ConfigureConnection failed: " << error->code << ", " << error->message);
@@ -550,17 +583,17 @@ bool UpnpWanPppConnection::configureConnection(UpnpRequest *request,
         return false;
     }
 
-    actionProxy = gupnp_service_proxy_begin_action (m_proxy,
-                                                    "ConfigureConnection",
-                                                    configureConnectionCb,
-                                                    (gpointer *) request,
-                                                    "NewUserName",
-                                                    G_TYPE_STRING,
-                                                    sNewUser,
-                                                    "NewPassword",
-                                                    G_TYPE_STRING,
-                                                    sNewPassword,
-                                                    NULL);
+    actionProxy = UpnpActionStats::beginAction (m_proxy,
+                                                "ConfigureConnection",
+                                                configureConnectionCb,
+                                                (gpointer *) request,
+                                                "NewUserName",
+                                                G_TYPE_STRING,
+                                                sNewUser,
+                                                "NewPassword",
+                                                G_TYPE_STRING,
+                                                sNewPassword,
+                                                NULL);
     if (NULL == actionProxy)
     {
         return false;
@@ -578,10 +611,10 @@ void UpnpWanPppConnection::changeConnectionStatusCb(GUPnPServiceProxy *proxy,
 
     UpnpRequest *request = static_cast<UpnpRequest *> (userData);
 
-    bool status = gupnp_service_proxy_end_action (proxy,
-                                                  actionProxy,
-                                                  &error,
-                                                  NULL);
+    bool status = UpnpActionStats::endAction (proxy,
+                                              actionProxy,
+                                              &error,
+                                              NULL);
     if (error)
     {
         ERROR_PRINT("ChangeConnectionStatus failed: " << error->code << ", " << error->message);
@@ -617,11 +650,11 @@ bool UpnpWanPppConnection::changeConnectionStatus(UpnpRequest *request,
         return false;
     }
 
-    actionProxy = gupnp_service_proxy_begin_action (m_proxy,
-                                                    action,
-                                                    changeConnectionStatusCb,
-                                                    (gpointer *) request,
-                                                    NULL);
+    actionProxy = UpnpActionStats::beginAction (m_proxy,
+                                                action,
+                                                changeConnectionStatusCb,
+                                                (gpointer *) request,
+                                                NULL);
     if (NULL == actionProxy)
     {
         ERROR_PRINT("ChangePPPConnectionStatus failed: " << action);
@@ -632,6 +665,53 @@ bool UpnpWanPppConnection::changeConnectionStatus(UpnpRequest *request,
     return true;
 }
 
+UpnpWanPppConnection::~UpnpWanPppConnection()
+{
+    UpnpPortMappingBatch::cancelAll(m_portMappingBatches);
+}
+
+// The batches in progress would outlive the service
+void UpnpWanPppConnection::stop()
+{
+    UpnpPortMappingBatch::cancelAll(m_portMappingBatches);
+    UpnpService::stop();
+}
+
+void UpnpWanPppConnection::processIntrospection(GUPnPServiceProxy *proxy,
+                                                GUPnPServiceIntrospection *introspection)
+{
+    UpnpService::processIntrospection(proxy, introspection);
+
+    m_portMappingCapabilities.addAnyPortMapping =
+        (gupnp_service_introspection_get_action(introspection, "AddAnyPortMapping") != NULL);
+    m_portMappingCapabilities.deletePortMappingRange =
+        (gupnp_service_introspection_get_action(introspection, "DeletePortMappingRange") != NULL);
+
+    if (UpnpAttribute::isValidRequest(&m_attributeMap, "portMappings", UPNP_ACTION_GET))
+    {
+        setAttribute("portMappings", CompositeAttribute(), false);
+        m_portMappingMirror.setProxy(proxy);
+    }
+}
+
+bool UpnpWanPppConnection::setPortMappingBatch(UpnpRequest *request,
+                                               RCSResourceAttributes::Value *attrValue)
+{
+    DEBUG_PRINT("");
+    UpnpPortMappingMirror *pMirror = &m_portMappingMirror;
+    const auto &entries = attrValue->get< CompositeAttribute >();
+
+    // Mappings are not necessarily evented (e.g. replaced entries):
+    // refresh the mirror once the batch is done
+    return UpnpPortMappingBatch::start(m_proxy,
+                                       request,
+                                       "portMappingBatch",
+                                       m_portMappingCapabilities,
+                                       entries,
+                                       &m_portMappingBatches,
+                                       [pMirror] () { pMirror->invalidate(); });
+}
+
 bool UpnpWanPppConnection::getAttributesRequest(UpnpRequest *request,
                                                 const map< string, string > &queryParams)
 {
@@ -644,7 +724,7 @@ bool UpnpWanPppConnection::getAttributesRequest(UpnpRequest *request,
 
         DEBUG_PRINT(" \"" << it->first << "\"");
         // Check the request
-        if (!UpnpAttribute::isValidRequest(&m_attributeMap, it->first, UPNP_ACTION_GET))
+        if (!isGetRequested(request, it->first))
         {
             request->done++;
             continue;
@@ -652,7 +732,12 @@ bool UpnpWanPppConnection::getAttributesRequest(UpnpRequest *request,
 
         // Check if custom GET needs to be called
         auto attr = this->GetAttributeActionMap.find(it->first);
-        if (attr != this->GetAttributeActionMap.end())
+        if (it->first == "portMappings")
+        {
+            // Served from the mirrored port mapping table
+            result = m_portMappingMirror.get(request, queryParams);
+        }
+        else if (attr != this->GetAttributeActionMap.end())
         {
             GetAttributeHandler fp = attr->second;
             result = (this->*fp)(request);
@@ -716,8 +801,8 @@ bool UpnpWanPppConnection::setAttributesRequest(const RCSResourceAttributes &val
     return status;
 }
 
-bool UpnpWanPppConnection::processNotification(string attrName,
-                                               string parent,
+bool UpnpWanPppConnection::processNotification(const string &attrName,
+                                               const string &parent,
                                                GValue *value)
 {
 
@@ -725,7 +810,8 @@ bool UpnpWanPppConnection::processNotification(string attrName,
     {
         // Need to keep number of ports around
         m_sizePortMap = (int) g_value_get_uint(value);
-        BundleResource::setAttribute("sizePortMap", m_sizePortMap);
+        setAttribute("sizePortMap", m_sizePortMap);
+        m_portMappingMirror.setNumberOfEntries(m_sizePortMap);
         return true;
     }
 
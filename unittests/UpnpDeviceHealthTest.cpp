@@ -0,0 +1,59 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include <gtest/gtest.h>
+#include <UpnpActionStats.h>
+#include <UpnpDeviceHealth.h>
+
+TEST(UpnpDeviceHealth, expiredRequestsOpenCircuit)
+{
+    const string udn = "uuid:device-health-expired";
+    // Recorded for each action cancelled by a request deadline
+    const GError *timeout = UpnpActionStats::getDeadlineError();
+
+    for (unsigned int i = 0; i < UpnpDeviceHealth::FAILURE_THRESHOLD; ++i)
+    {
+        EXPECT_TRUE(UpnpDeviceHealth::isAvailable(udn));
+        UpnpDeviceHealth::record(udn, timeout, NULL);
+    }
+    EXPECT_FALSE(UpnpDeviceHealth::isAvailable(udn));
+    EXPECT_EQ(1u, UpnpDeviceHealth::getOpenCircuits());
+
+    UpnpDeviceHealth::remove(udn);
+    EXPECT_TRUE(UpnpDeviceHealth::isAvailable(udn));
+    EXPECT_EQ(0u, UpnpDeviceHealth::getOpenCircuits());
+}
+
+TEST(UpnpDeviceHealth, soapFaultShowsAlive)
+{
+    const string udn = "uuid:device-health-fault";
+    const GError *timeout = UpnpActionStats::getDeadlineError();
+    GError fault = {GUPNP_CONTROL_ERROR, 402, (gchar *) "Invalid Args"};
+
+    for (unsigned int i = 1; i < UpnpDeviceHealth::FAILURE_THRESHOLD; ++i)
+    {
+        UpnpDeviceHealth::record(udn, timeout, NULL);
+    }
+    UpnpDeviceHealth::record(udn, &fault, NULL);
+    UpnpDeviceHealth::record(udn, timeout, NULL);
+    EXPECT_TRUE(UpnpDeviceHealth::isAvailable(udn));
+
+    UpnpDeviceHealth::remove(udn);
+}
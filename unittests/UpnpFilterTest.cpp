@@ -0,0 +1,96 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include <gtest/gtest.h>
+#include <UpnpFilter.h>
+
+static std::map< std::string, std::string > rule(const std::string &field, const std::string &value)
+{
+    return {{field, value}};
+}
+
+TEST(UpnpFilter, empty)
+{
+    UpnpFilter filter;
+    std::string udn;
+
+    EXPECT_TRUE(filter.isEmpty());
+    EXPECT_TRUE(filter.accepts(UpnpFilter::fromUsn("uuid:light", udn, "eth0")));
+    EXPECT_FALSE(filter.addRule(true, rule("vendor", "Acme")));
+    EXPECT_TRUE(filter.isEmpty());
+}
+
+TEST(UpnpFilter, usn)
+{
+    std::string udn;
+    UpnpFilter::Subject subject = UpnpFilter::fromUsn(
+            "uuid:light::urn:schemas-upnp-org:service:SwitchPower:1", udn, "eth0");
+
+    EXPECT_EQ("uuid:light", udn);
+    EXPECT_STREQ("uuid:light", subject.fields[UpnpFilter::FIELD_UDN]);
+    EXPECT_STREQ("urn:schemas-upnp-org:service:SwitchPower:1",
+                 subject.fields[UpnpFilter::FIELD_SERVICE_TYPE]);
+    EXPECT_TRUE(subject.fields[UpnpFilter::FIELD_DEVICE_TYPE] == NULL);
+    EXPECT_TRUE(subject.fields[UpnpFilter::FIELD_MANUFACTURER] == NULL);
+
+    subject = UpnpFilter::fromUsn("uuid:light::upnp:rootdevice", udn, "eth0");
+    EXPECT_EQ("uuid:light", udn);
+    EXPECT_TRUE(subject.fields[UpnpFilter::FIELD_DEVICE_TYPE] == NULL);
+    EXPECT_TRUE(subject.fields[UpnpFilter::FIELD_SERVICE_TYPE] == NULL);
+}
+
+TEST(UpnpFilter, denyAndAllow)
+{
+    UpnpFilter filter;
+    std::string udn;
+
+    EXPECT_TRUE(filter.addRule(false, rule("deviceType",
+                                           "urn:schemas-upnp-org:device:InternetGatewayDevice:*")));
+    EXPECT_TRUE(filter.addRule(true, rule("interface", "eth0")));
+
+    EXPECT_FALSE(filter.accepts(UpnpFilter::fromUsn(
+            "uuid:igd::urn:schemas-upnp-org:device:InternetGatewayDevice:2", udn, "eth0")));
+    EXPECT_TRUE(filter.accepts(UpnpFilter::fromUsn(
+            "uuid:light::urn:schemas-upnp-org:device:BinaryLight:1", udn, "eth0")));
+    EXPECT_FALSE(filter.accepts(UpnpFilter::fromUsn(
+            "uuid:light::urn:schemas-upnp-org:device:BinaryLight:1", udn, "wlan0")));
+}
+
+TEST(UpnpFilter, unknownFields)
+{
+    UpnpFilter filter;
+    std::string udn;
+    std::map< std::string, std::string > acme = {{"manufacturer", "Acme"}, {"model", "Lamp"}};
+
+    EXPECT_TRUE(filter.addRule(false, acme));
+    EXPECT_TRUE(filter.addRule(true, rule("model", "Lamp*")));
+
+    // Not decided before the description
+    UpnpFilter::Subject subject = UpnpFilter::fromUsn("uuid:lamp", udn, "eth0");
+    EXPECT_TRUE(filter.accepts(subject));
+
+    subject.fields[UpnpFilter::FIELD_MANUFACTURER] = "Acme";
+    subject.fields[UpnpFilter::FIELD_MODEL] = "Lamp";
+    EXPECT_FALSE(filter.accepts(subject));
+    subject.fields[UpnpFilter::FIELD_MANUFACTURER] = "Other";
+    EXPECT_TRUE(filter.accepts(subject));
+    subject.fields[UpnpFilter::FIELD_MODEL] = "Speaker";
+    EXPECT_FALSE(filter.accepts(subject));
+}
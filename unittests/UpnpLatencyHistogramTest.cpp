@@ -0,0 +1,73 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include <gtest/gtest.h>
+#include <UpnpLatencyHistogram.h>
+
+TEST(UpnpLatencyHistogram, bucketBounds)
+{
+    for (uint64_t value : {0ull, 1ull, 7ull, 8ull, 9ull, 15ull, 16ull, 1000ull, 123456789ull})
+    {
+        size_t index = UpnpLatencyHistogram::getBucketIndex(value);
+
+        EXPECT_LE(UpnpLatencyHistogram::getBucketLowerBound(index), value);
+        EXPECT_GE(UpnpLatencyHistogram::getBucketUpperBound(index), value);
+    }
+
+    EXPECT_EQ(UpnpLatencyHistogram::NUM_BUCKETS - 1, UpnpLatencyHistogram::getBucketIndex(~0ull));
+}
+
+TEST(UpnpLatencyHistogram, relativeError)
+{
+    for (uint64_t value = 8; value < 1000000; value = value * 3 + 1)
+    {
+        size_t index = UpnpLatencyHistogram::getBucketIndex(value);
+        uint64_t lower = UpnpLatencyHistogram::getBucketLowerBound(index);
+        uint64_t upper = UpnpLatencyHistogram::getBucketUpperBound(index);
+
+        EXPECT_LE((double) (upper - lower), lower / 8.0);
+    }
+}
+
+TEST(UpnpLatencyHistogram, percentiles)
+{
+    UpnpLatencyHistogram histogram;
+
+    for (uint64_t value = 1; value <= 100; ++value)
+    {
+        histogram.record(value * 1000);
+    }
+
+    UpnpLatencyHistogram::Snapshot snapshot = histogram.getSnapshot();
+    EXPECT_EQ(100u, snapshot.count);
+    EXPECT_EQ(100000u, snapshot.max);
+    EXPECT_DOUBLE_EQ(50500, snapshot.getMean());
+    EXPECT_NEAR(50000, snapshot.getPercentile(50), 50000 / 8);
+    EXPECT_NEAR(99000, snapshot.getPercentile(99), 99000 / 8);
+    EXPECT_EQ(100000u, snapshot.getPercentile(100));
+}
+
+TEST(UpnpLatencyHistogram, empty)
+{
+    UpnpLatencyHistogram histogram;
+
+    EXPECT_EQ(0u, histogram.getSnapshot().count);
+    EXPECT_EQ(0u, histogram.getSnapshot().getPercentile(99));
+}
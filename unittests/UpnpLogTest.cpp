@@ -0,0 +1,116 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include <gtest/gtest.h>
+#include <UpnpLog.h>
+
+static const std::string MODULE = "UpnpLogTest";
+
+static bool pushMessage(UpnpLogRing &ring, const char *message)
+{
+    return ring.push([&] (UpnpLogRing::Record & record)
+    {
+        record.length = strlen(message);
+        memcpy(record.message, message, record.length);
+    });
+}
+
+TEST(UpnpLogRing, fifo)
+{
+    UpnpLogRing ring(4);
+    UpnpLogRing::Record record;
+
+    EXPECT_TRUE(ring.empty());
+    EXPECT_TRUE(pushMessage(ring, "first"));
+    EXPECT_TRUE(pushMessage(ring, "second"));
+
+    ASSERT_TRUE(ring.pop(record));
+    EXPECT_EQ("first", std::string(record.message, record.length));
+    ASSERT_TRUE(ring.pop(record));
+    EXPECT_EQ("second", std::string(record.message, record.length));
+    EXPECT_FALSE(ring.pop(record));
+}
+
+TEST(UpnpLogRing, dropWhenFull)
+{
+    UpnpLogRing ring(4);
+    UpnpLogRing::Record record;
+
+    for (size_t i = 0; i < ring.capacity(); ++i)
+    {
+        EXPECT_TRUE(pushMessage(ring, "message"));
+    }
+    EXPECT_FALSE(pushMessage(ring, "dropped"));
+    EXPECT_EQ(1u, ring.getDropped());
+
+    ASSERT_TRUE(ring.pop(record));
+    EXPECT_TRUE(pushMessage(ring, "message"));
+}
+
+TEST(UpnpLog, configure)
+{
+    EXPECT_TRUE(UpnpLog::configure("error,UpnpLogTestModule=debug"));
+    EXPECT_EQ(UpnpLog::LEVEL_ERROR, UpnpLog::getLevel("UpnpLogTestOther"));
+    EXPECT_EQ(UpnpLog::LEVEL_DEBUG, UpnpLog::getLevel("UpnpLogTestModule"));
+    EXPECT_FALSE(UpnpLog::configure("verbose"));
+
+    UpnpLog::Site site("UpnpLogTestOther", UpnpLog::LEVEL_DEBUG);
+    EXPECT_FALSE(site.enabled());
+    UpnpLog::setLevel("UpnpLogTestOther", UpnpLog::LEVEL_DEBUG);
+    EXPECT_TRUE(site.enabled());
+}
+
+TEST(UpnpLog, rateLimit)
+{
+    UpnpLog::setLevel("UpnpLogTestRate", UpnpLog::LEVEL_ERROR);
+    UpnpLog::Site site("UpnpLogTestRate", UpnpLog::LEVEL_ERROR);
+
+    for (uint32_t i = 0; i < UpnpLog::RATE_LIMIT_BURST; ++i)
+    {
+        EXPECT_TRUE(site.enabled());
+    }
+    EXPECT_FALSE(site.enabled());
+    EXPECT_FALSE(site.enabled());
+    EXPECT_EQ(2u, site.takeSuppressed());
+    EXPECT_EQ(0u, site.takeSuppressed());
+}
+
+TEST(UpnpLog, binaryDump)
+{
+    std::string path = testing::TempDir() + "UpnpLogTest.bin";
+
+    UpnpLog::setLevel(MODULE, UpnpLog::LEVEL_DEBUG);
+    ASSERT_TRUE(UpnpLog::setBinaryDump(path));
+    UPNP_LOG(UpnpLog::LEVEL_DEBUG, "value=" << 42);
+    UpnpLog::flush();
+    ASSERT_TRUE(UpnpLog::setBinaryDump(""));
+
+    std::ifstream is(path.c_str(), std::ios::binary);
+    std::ostringstream os;
+    UpnpLog::decodeBinary(is, os);
+    EXPECT_NE(std::string::npos, os.str().find("UpnpLogTest:TestBody(): value=42"));
+
+    remove(path.c_str());
+}
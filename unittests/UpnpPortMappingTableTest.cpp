@@ -0,0 +1,84 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include <gtest/gtest.h>
+#include <UpnpPortMappingTable.h>
+
+static UpnpPortMapping makeMapping(const std::string &protocol,
+                                   unsigned int externalPort,
+                                   const std::string &internalClient)
+{
+    return {"", externalPort, protocol, externalPort, internalClient, true, "test", 0};
+}
+
+TEST(UpnpPortMappingTable, addReplacesSameKey)
+{
+    UpnpPortMappingTable table;
+    UpnpPortMapping mapping = makeMapping("TCP", 8080, "192.168.1.10");
+
+    table.add(mapping);
+    mapping.internalClient = "192.168.1.11";
+    table.add(mapping);
+
+    ASSERT_EQ(1u, table.size());
+    const UpnpPortMapping *found = table.find(UpnpPortMappingTable::getKey(mapping));
+    ASSERT_TRUE(found != nullptr);
+    EXPECT_EQ("192.168.1.11", found->internalClient);
+}
+
+TEST(UpnpPortMappingTable, keyIncludesProtocol)
+{
+    UpnpPortMappingTable table;
+
+    table.add(makeMapping("TCP", 5000, "192.168.1.10"));
+    table.add(makeMapping("UDP", 5000, "192.168.1.10"));
+
+    EXPECT_EQ(2u, table.size());
+    EXPECT_TRUE(table.remove(UpnpPortMappingTable::Key("UDP", 5000, "")));
+    EXPECT_FALSE(table.remove(UpnpPortMappingTable::Key("UDP", 5000, "")));
+    EXPECT_EQ(1u, table.size());
+}
+
+TEST(UpnpPortMappingTable, select)
+{
+    UpnpPortMappingTable table;
+    UpnpPortMappingTable::Filter all = {"", 0, "", ""};
+    UpnpPortMappingTable::Filter udp = {"UDP", 0, "", ""};
+    UpnpPortMappingTable::Filter client = {"", 0, "192.168.1.11", ""};
+    UpnpPortMappingTable::Filter port = {"TCP", 80, "", ""};
+
+    table.add(makeMapping("TCP", 80, "192.168.1.10"));
+    table.add(makeMapping("TCP", 443, "192.168.1.11"));
+    table.add(makeMapping("UDP", 53, "192.168.1.10"));
+    table.add(makeMapping("UDP", 5060, "192.168.1.11"));
+
+    EXPECT_EQ(4u, table.select(all).size());
+
+    std::vector<const UpnpPortMapping *> entries = table.select(udp);
+    ASSERT_EQ(2u, entries.size());
+    EXPECT_EQ(53u, entries[0]->externalPort);
+    EXPECT_EQ(5060u, entries[1]->externalPort);
+
+    EXPECT_EQ(2u, table.select(client).size());
+
+    entries = table.select(port);
+    ASSERT_EQ(1u, entries.size());
+    EXPECT_EQ("192.168.1.10", entries[0]->internalClient);
+}
@@ -0,0 +1,242 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+
+#include <gtest/gtest.h>
+#include <UpnpRequestScheduler.h>
+
+namespace
+{
+class TestResource: public UpnpResource
+{
+    public:
+        TestResource(const string &udn)
+        {
+            m_udn = udn;
+        }
+
+        RCSResourceAttributes handleGetAttributesRequest(const map< string, string > &)
+        {
+            return RCSResourceAttributes();
+        }
+        void handleSetAttributesRequest(const RCSResourceAttributes &, const map< string, string > &) {}
+        void initAttributes() {}
+};
+}
+
+static UpnpRequest *request(UpnpRequest::Class requestClass, UpnpResource *resource = nullptr)
+{
+    UpnpRequest *request = UpnpRequest::acquire();
+    request->requestClass = requestClass;
+    request->resource = resource;
+    return request;
+}
+
+// Finishes (out of the scheduler) and releases the request
+static void done(UpnpRequest *request)
+{
+    request->finishHandler = [](UpnpRequest *, bool) {};
+    request->finish(true);
+    UpnpRequest::release(request);
+}
+
+static void onFinish(UpnpRequest *request, bool status)
+{
+    *static_cast<int *>(request->data) = status ? 1 : -1;
+}
+
+TEST(UpnpRequestScheduler, strictOrder)
+{
+    UpnpRequestScheduler scheduler(nullptr, UpnpRequestScheduler::POLICY_STRICT);
+    UpnpRequest *background = request(UpnpRequest::CLASS_BACKGROUND);
+    UpnpRequest *get = request(UpnpRequest::CLASS_INTERACTIVE_GET);
+    UpnpRequest *set = request(UpnpRequest::CLASS_INTERACTIVE_SET);
+
+    scheduler.push(background);
+    scheduler.push(get);
+    scheduler.push(set);
+    EXPECT_EQ(set, scheduler.pop());
+    EXPECT_EQ(get, scheduler.pop());
+    EXPECT_EQ(background, scheduler.pop());
+    EXPECT_TRUE(scheduler.pop() == nullptr);
+
+    EXPECT_EQ(1u, scheduler.getStats(UpnpRequest::CLASS_BACKGROUND).inProgress);
+    done(background);
+    done(get);
+    done(set);
+    EXPECT_EQ(0u, scheduler.getStats(UpnpRequest::CLASS_BACKGROUND).inProgress);
+    EXPECT_EQ(1u, scheduler.getStats(UpnpRequest::CLASS_BACKGROUND).started);
+}
+
+TEST(UpnpRequestScheduler, weightedShare)
+{
+    UpnpRequestScheduler scheduler(nullptr, UpnpRequestScheduler::POLICY_WEIGHTED);
+    const unsigned int sets = UpnpRequestScheduler::WEIGHTS[UpnpRequest::CLASS_INTERACTIVE_SET];
+    UpnpRequest *background = request(UpnpRequest::CLASS_BACKGROUND);
+    std::vector< UpnpRequest * > started;
+
+    scheduler.push(background);
+    for (unsigned int i = 0; i < sets * 2; ++i)
+    {
+        scheduler.push(request(UpnpRequest::CLASS_INTERACTIVE_SET));
+    }
+
+    // The background request gets its share once the SETs have had theirs
+    for (unsigned int i = 0; i <= sets; ++i)
+    {
+        started.push_back(scheduler.pop());
+    }
+    EXPECT_EQ(background, started.back());
+    EXPECT_EQ(sets, scheduler.getStats(UpnpRequest::CLASS_INTERACTIVE_SET).started);
+
+    while (UpnpRequest *request = scheduler.pop())
+    {
+        started.push_back(request);
+    }
+    EXPECT_EQ(sets * 2 + 1, started.size());
+    for (auto request : started)
+    {
+        done(request);
+    }
+}
+
+TEST(UpnpRequestScheduler, inProgressLimit)
+{
+    UpnpRequestScheduler scheduler(nullptr, UpnpRequestScheduler::POLICY_STRICT);
+    const unsigned int limit = UpnpRequestScheduler::MAX_IN_PROGRESS[UpnpRequest::CLASS_BACKGROUND];
+    std::vector< UpnpRequest * > started;
+
+    for (unsigned int i = 0; i <= limit; ++i)
+    {
+        scheduler.push(request(UpnpRequest::CLASS_BACKGROUND));
+    }
+    for (unsigned int i = 0; i < limit; ++i)
+    {
+        started.push_back(scheduler.pop());
+    }
+    EXPECT_TRUE(scheduler.pop() == nullptr);
+    EXPECT_EQ(1u, scheduler.getStats(UpnpRequest::CLASS_BACKGROUND).depth);
+
+    done(started.back());
+    started.back() = scheduler.pop();
+    EXPECT_TRUE(started.back() != nullptr);
+    for (auto request : started)
+    {
+        done(request);
+    }
+}
+
+TEST(UpnpRequestScheduler, deviceLimit)
+{
+    UpnpRequestScheduler scheduler(nullptr, UpnpRequestScheduler::POLICY_STRICT);
+    TestResource device("uuid:device"), other("uuid:other");
+    int status = 0;
+
+    UpnpRequestScheduler::setLimits(0, 2);
+    UpnpRequest *get = request(UpnpRequest::CLASS_INTERACTIVE_GET, &device);
+    UpnpRequest *background = request(UpnpRequest::CLASS_BACKGROUND, &device);
+    scheduler.push(get);
+    scheduler.push(background);
+    scheduler.push(request(UpnpRequest::CLASS_INTERACTIVE_GET, &other));
+
+    // Rejected: nothing of a lower class to shed for the device
+    UpnpRequest *rejected = request(UpnpRequest::CLASS_BACKGROUND, &device);
+    rejected->data = &status;
+    rejected->finishHandler = onFinish;
+    scheduler.push(rejected);
+    EXPECT_EQ(-1, status);
+    EXPECT_TRUE(rejected->rejected);
+    EXPECT_EQ(1u, scheduler.getStats(UpnpRequest::CLASS_BACKGROUND).rejected);
+    UpnpRequest::release(rejected);
+
+    // Sheds the queued background request of the device
+    status = 0;
+    background->data = &status;
+    background->finishHandler = onFinish;
+    UpnpRequest *set = request(UpnpRequest::CLASS_INTERACTIVE_SET, &device);
+    scheduler.push(set);
+    EXPECT_EQ(-1, status);
+    EXPECT_TRUE(background->rejected);
+    EXPECT_FALSE(set->rejected);
+    EXPECT_EQ(1u, scheduler.getStats(UpnpRequest::CLASS_BACKGROUND).shed);
+    EXPECT_EQ(0u, scheduler.getStats(UpnpRequest::CLASS_BACKGROUND).depth);
+    UpnpRequest::release(background);
+
+    EXPECT_EQ(3u, UpnpRequestScheduler::getOutstanding());
+    while (UpnpRequest *request = scheduler.pop())
+    {
+        done(request);
+    }
+    EXPECT_EQ(0u, UpnpRequestScheduler::getOutstanding());
+    UpnpRequestScheduler::setLimits(0, 0);
+}
+
+TEST(UpnpRequestScheduler, globalLimit)
+{
+    UpnpRequestScheduler scheduler(nullptr, UpnpRequestScheduler::POLICY_STRICT);
+    TestResource device("uuid:device");
+    int status = 0;
+
+    UpnpRequestScheduler::setLimits(1, 0);
+    UpnpRequest *get = request(UpnpRequest::CLASS_INTERACTIVE_GET, &device);
+    scheduler.push(get);
+
+    UpnpRequest *rejected = request(UpnpRequest::CLASS_INTERACTIVE_GET, &device);
+    rejected->data = &status;
+    rejected->finishHandler = onFinish;
+    scheduler.push(rejected);
+    EXPECT_EQ(-1, status);
+    UpnpRequest::release(rejected);
+
+    // Internal requests are not limited
+    UpnpRequest *internal = request(UpnpRequest::CLASS_INTERACTIVE_SET);
+    scheduler.push(internal);
+    EXPECT_EQ(internal, scheduler.pop());
+    EXPECT_EQ(get, scheduler.pop());
+    done(internal);
+    done(get);
+    UpnpRequestScheduler::setLimits(0, 0);
+}
+
+TEST(UpnpRequestScheduler, stopFailsQueued)
+{
+    UpnpRequestScheduler scheduler(nullptr, UpnpRequestScheduler::POLICY_WEIGHTED);
+    UpnpRequest *queued = request(UpnpRequest::CLASS_INTERACTIVE_GET);
+    UpnpRequest *late = request(UpnpRequest::CLASS_INTERACTIVE_GET);
+    int queuedStatus = 0;
+    int lateStatus = 0;
+
+    queued->data = &queuedStatus;
+    queued->finishHandler = onFinish;
+    late->data = &lateStatus;
+    late->finishHandler = onFinish;
+
+    scheduler.push(queued);
+    scheduler.stop();
+    EXPECT_EQ(-1, queuedStatus);
+    EXPECT_TRUE(queued->rejected);
+
+    scheduler.push(late);
+    EXPECT_EQ(-1, lateStatus);
+    EXPECT_TRUE(scheduler.pop() == nullptr);
+
+    UpnpRequest::release(queued);
+    UpnpRequest::release(late);
+}
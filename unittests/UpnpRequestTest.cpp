@@ -0,0 +1,145 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+
+#include <thread>
+
+#include <gtest/gtest.h>
+#include <UpnpRequest.h>
+
+static GUPnPServiceProxyAction *action(uintptr_t i)
+{
+    return reinterpret_cast<GUPnPServiceProxyAction *>(i + 1);
+}
+
+TEST(UpnpRequestBindings, findAndErase)
+{
+    UpnpRequestBindings bindings;
+    UpnpAttributeInfo info[3];
+
+    for (uintptr_t i = 0; i < 3; ++i)
+    {
+        bindings[action(i)] = &info[i];
+    }
+    EXPECT_EQ(3u, bindings.size());
+    EXPECT_EQ(&info[1], bindings.find(action(1))->second);
+    EXPECT_TRUE(bindings.find(action(5)) == bindings.end());
+
+    bindings.erase(bindings.find(action(0)));
+    EXPECT_EQ(2u, bindings.size());
+    EXPECT_EQ(action(1), bindings.begin()->first);
+    EXPECT_TRUE(bindings.find(action(0)) == bindings.end());
+
+    bindings.clear();
+    EXPECT_TRUE(bindings.empty());
+}
+
+TEST(UpnpRequestBindings, overflow)
+{
+    UpnpRequestBindings bindings;
+    UpnpAttributeInfo info;
+    const uintptr_t count = UpnpRequestBindings::INLINE_SIZE * 3;
+
+    for (uintptr_t i = 0; i < count; ++i)
+    {
+        bindings[action(i)] = &info;
+    }
+    EXPECT_EQ(count, bindings.size());
+    for (uintptr_t i = 0; i < count; ++i)
+    {
+        ASSERT_FALSE(bindings.find(action(i)) == bindings.end());
+    }
+}
+
+TEST(UpnpRequest, poolReuse)
+{
+    // Warm up this thread's pool
+    UpnpRequest::release(UpnpRequest::acquire());
+
+    uint64_t allocated = UpnpRequest::getAllocated();
+    for (int i = 0; i < 100; ++i)
+    {
+        UpnpRequest *request = UpnpRequest::acquire();
+        EXPECT_EQ(0, request->done);
+        EXPECT_TRUE(request->proxyMap.empty());
+        request->proxyMap[action(i)] = nullptr;
+        UpnpRequest::release(request);
+    }
+    EXPECT_EQ(allocated, UpnpRequest::getAllocated());
+}
+
+TEST(UpnpRequest, finishFromOtherThread)
+{
+    UpnpRequest *request = UpnpRequest::acquire();
+
+    request->expected = 2;
+    std::thread worker([request] ()
+    {
+        UpnpRequest::requestDone(request, true);
+        UpnpRequest::requestDone(request, true);
+    });
+
+    EXPECT_TRUE(request->wait());
+    worker.join();
+    UpnpRequest::release(request);
+}
+
+static void onFinish(UpnpRequest *request, bool status)
+{
+    *static_cast<int *>(request->data) = status ? 1 : -1;
+}
+
+TEST(UpnpRequest, finishHandler)
+{
+    UpnpRequest *request = UpnpRequest::acquire();
+    int finished = 0;
+
+    request->expected = 1;
+    request->data = &finished;
+    request->finishHandler = onFinish;
+    UpnpRequest::requestDone(request, false);
+    EXPECT_EQ(-1, finished);
+
+    // Not kept by the pooled request
+    UpnpRequest::release(request);
+    request = UpnpRequest::acquire();
+    EXPECT_TRUE(request->finishHandler == nullptr);
+    UpnpRequest::release(request);
+}
+
+TEST(UpnpRequest, expiredFails)
+{
+    UpnpRequest *request = UpnpRequest::acquire();
+    int finished = 0;
+
+    // Late completion of the work left past the deadline
+    request->expected = 1;
+    request->data = &finished;
+    request->finishHandler = onFinish;
+    request->expired = true;
+    UpnpRequest::requestDone(request, true);
+    EXPECT_EQ(-1, finished);
+
+    UpnpRequest::release(request);
+    request = UpnpRequest::acquire();
+    EXPECT_FALSE(request->expired);
+    EXPECT_EQ(0, request->deadline);
+    UpnpRequest::release(request);
+}
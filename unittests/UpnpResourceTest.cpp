@@ -0,0 +1,130 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+
+
+#include <gtest/gtest.h>
+#include <UpnpConstants.h>
+#include <UpnpResource.h>
+
+namespace
+{
+class VersionedResource: public UpnpResource
+{
+    public:
+        RCSResourceAttributes handleGetAttributesRequest(const std::map< std::string, std::string > &)
+        {
+            return getAttributes();
+        }
+        void handleSetAttributesRequest(const RCSResourceAttributes &,
+                                        const std::map< std::string, std::string > &) {}
+        void initAttributes() {}
+};
+}
+
+TEST(UpnpResource, compositeMember)
+{
+    VersionedResource resource;
+    RCSResourceAttributes link;
+
+    link["up"] = false;
+    link["rate"] = 0;
+    resource.setAttribute("link", link, false);
+
+    EXPECT_TRUE(resource.setCompositeMember("link", "rate", 100, false));
+    EXPECT_FALSE(resource.setCompositeMember("link", "up", false, false));
+    EXPECT_EQ(100, resource.getAttribute("link").get< RCSResourceAttributes >()["rate"].get< int >());
+
+    // Direct write of the whole composite: members are updated from it
+    link["rate"] = 10;
+    resource.setAttribute("link", link, false);
+    EXPECT_TRUE(resource.setCompositeMember("link", "up", true, false));
+    link = resource.getAttribute("link").get< RCSResourceAttributes >();
+    EXPECT_EQ(10, link["rate"].get< int >());
+    EXPECT_TRUE(link["up"].get< bool >());
+}
+
+TEST(UpnpResource, snapshot)
+{
+    VersionedResource resource;
+
+    resource.setAttribute("volume", 1, false);
+    UpnpResource::Snapshot before = resource.getSnapshot();
+    resource.setAttribute("volume", 2, false);
+    resource.setAttribute("mute", true, false);
+
+    // Published snapshots are never modified
+    EXPECT_EQ(1, before->at("volume").get< int >());
+    EXPECT_FALSE(before->contains("mute"));
+
+    UpnpResource::Snapshot after = resource.getSnapshot();
+    EXPECT_EQ(2, after->at("volume").get< int >());
+    EXPECT_TRUE(after->at("mute").get< bool >());
+
+    // Shared until the next change
+    EXPECT_EQ(after, resource.getSnapshot());
+    resource.setAttribute("mute", true, false);
+    EXPECT_EQ(after, resource.getSnapshot());
+}
+
+TEST(UpnpResource, etag)
+{
+    VersionedResource resource;
+    std::map< std::string, std::string > queryParams;
+
+    resource.setAttribute("volume", 1, false);
+    RCSResourceAttributes response = resource.getAttributesResponse(queryParams);
+    std::string etag = response.at("etag").get< std::string >();
+    EXPECT_EQ(1, response.at("volume").get< int >());
+
+    // Same value: same version
+    resource.setAttribute("volume", 1, false);
+    queryParams[UPNP_OIC_QUERY_PARAM_ETAG] = etag;
+    response = resource.getAttributesResponse(queryParams);
+    EXPECT_TRUE(response.at("valid").get< bool >());
+    EXPECT_FALSE(response.contains("volume"));
+
+    resource.setAttribute("volume", 2, false);
+    response = resource.getAttributesResponse(queryParams);
+    EXPECT_FALSE(response.contains("valid"));
+    EXPECT_NE(etag, response.at("etag").get< std::string >());
+    EXPECT_EQ(2, response.at("volume").get< int >());
+}
+
+// A resource created again for the same device does not repeat the etags
+// its clients may still hold
+TEST(UpnpResource, etagEpoch)
+{
+    std::map< std::string, std::string > queryParams;
+    std::string etag;
+
+    {
+        VersionedResource resource;
+        resource.setAttribute("volume", 1, false);
+        etag = resource.getAttributesResponse(queryParams).at("etag").get< std::string >();
+    }
+
+    VersionedResource resource;
+    resource.setAttribute("volume", 1, false);
+    queryParams[UPNP_OIC_QUERY_PARAM_ETAG] = etag;
+    RCSResourceAttributes response = resource.getAttributesResponse(queryParams);
+    EXPECT_FALSE(response.contains("valid"));
+    EXPECT_EQ(1, response.at("volume").get< int >());
+}
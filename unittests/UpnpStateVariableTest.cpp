@@ -0,0 +1,118 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+
+
+#include <chrono>
+#include <iostream>
+
+#include <gtest/gtest.h>
+#include <UpnpStateVariable.h>
+
+namespace
+{
+class TestResource: public UpnpResource
+{
+    public:
+        RCSResourceAttributes handleGetAttributesRequest(const std::map< std::string, std::string > &)
+        {
+            return getAttributes();
+        }
+        void handleSetAttributesRequest(const RCSResourceAttributes &,
+                                        const std::map< std::string, std::string > &) {}
+        void initAttributes() {}
+};
+}
+
+TEST(UpnpStateVariable, converters)
+{
+    EXPECT_TRUE(UpnpStateVariable::getConverter(G_TYPE_BOOLEAN) != nullptr);
+    EXPECT_TRUE(UpnpStateVariable::getConverter(G_TYPE_INT) != nullptr);
+    EXPECT_TRUE(UpnpStateVariable::getConverter(G_TYPE_UINT) != nullptr);
+    EXPECT_TRUE(UpnpStateVariable::getConverter(G_TYPE_STRING) != nullptr);
+    EXPECT_TRUE(UpnpStateVariable::getConverter(G_TYPE_DOUBLE) == nullptr);
+}
+
+TEST(UpnpStateVariable, apply)
+{
+    TestResource resource;
+    GValue value = G_VALUE_INIT;
+
+    UpnpStateVariable volume(&resource, "volume", "", G_TYPE_UINT);
+    g_value_init(&value, G_TYPE_UINT);
+    g_value_set_uint(&value, 42);
+    volume.apply(&value);
+    g_value_unset(&value);
+    EXPECT_EQ(42, resource.getAttribute("volume").get< int >());
+
+    UpnpStateVariable name(&resource, "name", "", G_TYPE_STRING);
+    g_value_init(&value, G_TYPE_STRING);
+    name.apply(&value);
+    EXPECT_EQ("", resource.getAttribute("name").get< std::string >());
+    g_value_set_string(&value, "kitchen");
+    name.apply(&value);
+    g_value_unset(&value);
+    EXPECT_EQ("kitchen", resource.getAttribute("name").get< std::string >());
+
+    // Member of a composite attribute, the others are kept
+    RCSResourceAttributes link;
+    link["up"] = false;
+    link["rate"] = 0;
+    resource.setAttribute("link", link);
+    UpnpStateVariable up(&resource, "up", "link", G_TYPE_BOOLEAN);
+    g_value_init(&value, G_TYPE_BOOLEAN);
+    g_value_set_boolean(&value, TRUE);
+    up.apply(&value);
+    g_value_unset(&value);
+    link = resource.getAttribute("link").get< RCSResourceAttributes >();
+    EXPECT_TRUE(link["up"].get< bool >());
+    EXPECT_EQ(0, link["rate"].get< int >());
+}
+
+// Events applied per second on the calling (GLib) thread, as reported by
+// the notify callback of a subscribed service
+TEST(UpnpStateVariable, eventRate)
+{
+    const int EVENTS = 200000;
+    TestResource resource;
+    UpnpStateVariable volume(&resource, "volume", "", G_TYPE_INT);
+    UpnpStateVariable mute(&resource, "mute", "status", G_TYPE_BOOLEAN);
+    GValue intValue = G_VALUE_INIT;
+    GValue boolValue = G_VALUE_INIT;
+
+    resource.setAttribute("status", RCSResourceAttributes());
+    g_value_init(&intValue, G_TYPE_INT);
+    g_value_init(&boolValue, G_TYPE_BOOLEAN);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < EVENTS; ++i)
+    {
+        g_value_set_int(&intValue, i);
+        volume.apply(&intValue);
+        g_value_set_boolean(&boolValue, i & 1);
+        mute.apply(&boolValue);
+    }
+    std::chrono::duration< double > elapsed = std::chrono::steady_clock::now() - start;
+
+    EXPECT_EQ(EVENTS - 1, resource.getAttribute("volume").get< int >());
+    double rate = 2 * EVENTS / elapsed.count();
+    std::cout << "[ RATE     ] " << static_cast< uint64_t >(rate) << " events/s" << std::endl;
+    RecordProperty("eventsPerSecond", static_cast< int >(rate));
+}
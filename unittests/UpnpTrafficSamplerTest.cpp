@@ -0,0 +1,99 @@
+//******************************************************************
+//
+// Copyright 2016 Intel Corporation All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include <gtest/gtest.h>
+#include <UpnpTrafficSampler.h>
+
+static void addSample(UpnpTrafficSampler &sampler, int64_t seconds, uint32_t value)
+{
+    const uint32_t raw[UpnpTrafficSampler::NUM_COUNTERS] = {value, value, value, value};
+    sampler.addSample(seconds * 1000000, (double) seconds, raw);
+}
+
+TEST(UpnpTrafficSampler, firstSample)
+{
+    UpnpTrafficSampler sampler(4);
+
+    EXPECT_TRUE(sampler.empty());
+    addSample(sampler, 10, 1000);
+
+    EXPECT_EQ(1u, sampler.size());
+    EXPECT_EQ(1000u, sampler.latest().total[UpnpTrafficSampler::BYTES_SENT]);
+    EXPECT_DOUBLE_EQ(0, sampler.latest().rate[UpnpTrafficSampler::BYTES_SENT]);
+}
+
+TEST(UpnpTrafficSampler, rate)
+{
+    UpnpTrafficSampler sampler(4);
+
+    addSample(sampler, 10, 1000);
+    addSample(sampler, 20, 6000);
+
+    EXPECT_EQ(6000u, sampler.latest().total[UpnpTrafficSampler::PACKETS_RECEIVED]);
+    EXPECT_DOUBLE_EQ(500, sampler.latest().rate[UpnpTrafficSampler::PACKETS_RECEIVED]);
+}
+
+TEST(UpnpTrafficSampler, wraparound)
+{
+    UpnpTrafficSampler sampler(4);
+
+    addSample(sampler, 10, 0xFFFFFF00);
+    addSample(sampler, 20, 0x100);
+
+    EXPECT_EQ(0x100000100ull, sampler.latest().total[UpnpTrafficSampler::BYTES_RECEIVED]);
+    EXPECT_DOUBLE_EQ(51.2, sampler.latest().rate[UpnpTrafficSampler::BYTES_RECEIVED]);
+}
+
+TEST(UpnpTrafficSampler, counterReset)
+{
+    UpnpTrafficSampler sampler(4);
+
+    // A wrap would mean 4 GB in 10 s, above the 100 MB/s of the link
+    sampler.setMaxRate(UpnpTrafficSampler::BYTES_SENT, 1e8);
+    addSample(sampler, 10, 5000000);
+    addSample(sampler, 20, 1000);
+
+    EXPECT_EQ(5001000u, sampler.latest().total[UpnpTrafficSampler::BYTES_SENT]);
+    EXPECT_FALSE(sampler.latest().rateValid[UpnpTrafficSampler::BYTES_SENT]);
+    EXPECT_DOUBLE_EQ(0, sampler.latest().rate[UpnpTrafficSampler::BYTES_SENT]);
+
+    // Then counting from the new baseline
+    addSample(sampler, 30, 11000);
+    EXPECT_EQ(5011000u, sampler.latest().total[UpnpTrafficSampler::BYTES_SENT]);
+    EXPECT_TRUE(sampler.latest().rateValid[UpnpTrafficSampler::BYTES_SENT]);
+    EXPECT_DOUBLE_EQ(1000, sampler.latest().rate[UpnpTrafficSampler::BYTES_SENT]);
+}
+
+TEST(UpnpTrafficSampler, history)
+{
+    UpnpTrafficSampler sampler(3);
+
+    for (int i = 1; i <= 5; ++i)
+    {
+        addSample(sampler, i, i * 100);
+    }
+
+    std::vector<UpnpTrafficSampler::Sample> history = sampler.history();
+    ASSERT_EQ(3u, history.size());
+    EXPECT_DOUBLE_EQ(3, history[0].timestamp);
+    EXPECT_DOUBLE_EQ(4, history[1].timestamp);
+    EXPECT_DOUBLE_EQ(5, history[2].timestamp);
+    EXPECT_EQ(500u, history[2].total[UpnpTrafficSampler::BYTES_SENT]);
+}